@@ -12,6 +12,7 @@
 #include "atlas/light.h"
 #include "atlas/network/pipe.h"
 #include "atlas/object.h"
+#include "atlas/particle.h"
 #include "atlas/scene.h"
 #include "atlas/texture.h"
 #include "atlas/tracer/data.h"
@@ -497,6 +498,16 @@ computeShadowCasterSignature(const std::vector<Renderable *> &shadowCasters) {
 
     return signature;
 }
+
+bool castsShadowInto(Renderable *obj, const Frustum &lightFrustum) {
+    std::optional<BoundingBox> bounds = obj->getWorldBounds();
+    return !bounds.has_value() || lightFrustum.intersects(*bounds);
+}
+
+bool castsShadowInto(Renderable *obj, const BoundingBox &lightBounds) {
+    std::optional<BoundingBox> bounds = obj->getWorldBounds();
+    return !bounds.has_value() || lightBounds.intersects(*bounds);
+}
 } // namespace
 
 Window::Window(const WindowConfiguration &config)
@@ -774,7 +785,7 @@ void Window::initializeRunLoop() {
         this->camera = new Camera();
     }
     this->physicsWorld = std::make_shared<bezel::PhysicsWorld>();
-    this->physicsWorld->init();
+    this->physicsWorld->init(this->physicsSettings);
 
     for (auto &obj : this->renderables) {
         obj->initialize();
@@ -1023,6 +1034,21 @@ bool Window::stepFrame() {
 
     currentScene->updateScene(this->deltaTime);
 
+    // Step every emitter together so their particles share the job system;
+    // the update() calls below then skip the emitters stepped here.
+    this->particleEmitters.clear();
+    for (auto *list : {&this->firstRenderables, &this->renderables}) {
+        for (auto *obj : *list) {
+            auto *emitter = dynamic_cast<ParticleEmitter *>(obj);
+            if (emitter != nullptr &&
+                std::ranges::find(this->particleEmitters, emitter) ==
+                    this->particleEmitters.end()) {
+                this->particleEmitters.push_back(emitter);
+            }
+        }
+    }
+    ParticleEmitter::updateEmitters(*this, this->particleEmitters);
+
     for (auto &obj : this->firstRenderables) {
         if (obj == nullptr) {
             continue;
@@ -1042,11 +1068,26 @@ bool Window::stepFrame() {
     }
 
     currentScene->update(*this);
+#ifdef VULKAN
+    if (useClusteredLighting && camera != nullptr &&
+        !camera->useOrthographic) {
+        int fbWidth, fbHeight;
+        this->queryDrawableSizeInPixels(&fbWidth, &fbHeight);
+        lightFrameData.update(*currentScene, camera,
+                              static_cast<float>(fbWidth) /
+                                  static_cast<float>(std::max(fbHeight, 1)));
+    } else {
+        lightFrameData.update(*currentScene);
+    }
+#else
+    lightFrameData.update(*currentScene);
+#endif
 
     uint64_t cpuTime = cpuTimer.stop();
 
     DebugTimer gpuTimer("Gpu Data");
 
+    cullRenderables();
     renderLightsToShadowMaps(commandBuffer);
 
     static std::unique_ptr<RenderTarget> modeScreenTarget = nullptr;
@@ -1174,18 +1215,15 @@ bool Window::stepFrame() {
                             shouldRefreshPipeline(obj));
             };
 
-            for (auto &obj : this->firstRenderables) {
+            for (auto &obj : this->visibleFirstRenderables) {
                 renderForwardOnly(obj);
             }
 
-            for (auto &obj : this->renderables) {
-                if (obj != nullptr && obj->renderLateForward) {
-                    continue;
-                }
+            for (auto &obj : this->visibleRenderables) {
                 renderForwardOnly(obj);
             }
 
-            for (auto &obj : this->lateForwardRenderables) {
+            for (auto &obj : this->visibleLateForwardRenderables) {
                 obj->setViewMatrix(this->camera->calculateViewMatrix());
                 obj->setProjectionMatrix(calculateProjectionMatrix());
                 obj->render(getDeltaTime(), commandBuffer,
@@ -1200,24 +1238,21 @@ bool Window::stepFrame() {
                                   this->clearColor.b, this->clearColor.a);
         commandBuffer->clearDepth(1.0f);
 
-        for (auto &obj : this->firstRenderables) {
+        for (auto &obj : this->visibleFirstRenderables) {
             obj->setViewMatrix(this->camera->calculateViewMatrix());
             obj->setProjectionMatrix(calculateProjectionMatrix());
             obj->render(getDeltaTime(), commandBuffer,
                         shouldRefreshPipeline(obj));
         }
 
-        for (auto &obj : this->renderables) {
-            if (obj->renderLateForward) {
-                continue;
-            }
+        for (auto &obj : this->visibleRenderables) {
             obj->setViewMatrix(this->camera->calculateViewMatrix());
             obj->setProjectionMatrix(calculateProjectionMatrix());
             obj->render(getDeltaTime(), commandBuffer,
                         shouldRefreshPipeline(obj));
         }
         updateFluidCaptures(commandBuffer);
-        for (auto &obj : this->lateForwardRenderables) {
+        for (auto &obj : this->visibleLateForwardRenderables) {
             obj->setViewMatrix(this->camera->calculateViewMatrix());
             obj->setProjectionMatrix(calculateProjectionMatrix());
             obj->render(getDeltaTime(), commandBuffer,
@@ -1245,17 +1280,14 @@ bool Window::stepFrame() {
     if (this->renderTargets.empty() && !usesModeScreenTarget) {
         updateBackbufferTarget(fbWidth, fbHeight);
         this->currentRenderTarget = this->screenRenderTarget.get();
-        for (auto &obj : this->firstRenderables) {
+        for (auto &obj : this->visibleFirstRenderables) {
             obj->setViewMatrix(this->camera->calculateViewMatrix());
             obj->setProjectionMatrix(calculateProjectionMatrix());
             obj->render(getDeltaTime(), commandBuffer,
                         shouldRefreshPipeline(obj));
         }
 
-        for (auto &obj : this->renderables) {
-            if (obj->renderLateForward) {
-                continue;
-            }
+        for (auto &obj : this->visibleRenderables) {
             obj->setViewMatrix(this->camera->calculateViewMatrix());
             obj->setProjectionMatrix(calculateProjectionMatrix());
             obj->render(getDeltaTime(), commandBuffer,
@@ -1264,7 +1296,7 @@ bool Window::stepFrame() {
 
         updateFluidCaptures(commandBuffer);
 
-        for (auto &obj : this->lateForwardRenderables) {
+        for (auto &obj : this->visibleLateForwardRenderables) {
             obj->setViewMatrix(this->camera->calculateViewMatrix());
             obj->setProjectionMatrix(calculateProjectionMatrix());
             obj->render(getDeltaTime(), commandBuffer,
@@ -1303,6 +1335,10 @@ bool Window::stepFrame() {
         frameInfo.frameTimeMs = this->deltaTime * 1000.0f;
         frameInfo.frameNumber = device->frameCount;
         frameInfo.fps = this->framesPerSecond;
+        frameInfo.visibleObjects =
+            static_cast<unsigned int>(this->visibleObjectCount);
+        frameInfo.culledObjects =
+            static_cast<unsigned int>(this->culledObjectCount);
         frameInfo.send();
 
         FrameResourcesInfo frameResourcesInfo{};
@@ -1565,7 +1601,7 @@ void Window::applyScene(Scene *scene) {
 
     if (this->physicsWorld != nullptr) {
         this->physicsWorld = std::make_shared<bezel::PhysicsWorld>();
-        this->physicsWorld->init();
+        this->physicsWorld->init(this->physicsSettings);
         this->physicsWorld->setGravity({0.0f, -this->gravity, 0.0f});
     }
 
@@ -1577,6 +1613,7 @@ void Window::applyScene(Scene *scene) {
     this->uiRenderables.clear();
     this->lateForwardRenderables.clear();
     this->lateFluids.clear();
+    this->particleEmitters.clear();
     this->renderTargets.clear();
     this->screenRenderTarget.reset();
     this->gBuffer = nullptr;
@@ -2072,9 +2109,15 @@ void Window::renderLightsToShadowMaps(
         }
         renderedShadows = true;
 
-        depthPipeline->setViewport(
-            0, 0, shadowRenderTarget->texture.creationData.width,
-            shadowRenderTarget->texture.creationData.height);
+        // Cascades share the shadow map, each one drawn into its own tile of
+        // a 2x2 grid so the lighting shaders bind a single texture.
+        const int mapSize = shadowRenderTarget->texture.creationData.width;
+        const bool cascaded = light->cascadeCount > 1 &&
+                              this->camera != nullptr &&
+                              !this->camera->useOrthographic;
+        const int tileSize = cascaded ? mapSize / 2 : mapSize;
+
+        depthPipeline->setViewport(0, 0, tileSize, tileSize);
         depthPipeline->setCullMode(opal::CullMode::None);
         depthPipeline->setFrontFace(this->frontFace);
         depthPipeline->enableDepthTest(true);
@@ -2084,28 +2127,64 @@ void Window::renderLightsToShadowMaps(
 
         depthPipeline = this->depthProgram.requestPipeline(depthPipeline);
 
-        // Set up render pass for shadow framebuffer
+        std::vector<ShadowParams> cascadeParams;
+        glm::vec3 viewDirection(0.0f, 0.0f, -1.0f);
+        if (cascaded) {
+            int fbWidth, fbHeight;
+            this->queryDrawableSizeInPixels(&fbWidth, &fbHeight);
+            const float aspectRatio = static_cast<float>(fbWidth) /
+                                      static_cast<float>(std::max(1, fbHeight));
+            cascadeParams = light->calculateCascadeMatrices(
+                shadowCasters, *this->camera, aspectRatio, tileSize);
+            viewDirection = this->camera->getFrontVector().toGlm();
+        } else {
+            cascadeParams.push_back(
+                light->calculateLightSpaceMatrix(shadowCasters));
+        }
+        light->lastShadowParams = cascadeParams.front();
+
         auto shadowRenderPass = opal::RenderPass::create();
         shadowRenderPass->setFramebuffer(shadowRenderTarget->getFramebuffer());
         commandBuffer->beginPass(shadowRenderPass);
 
         shadowRenderTarget->bind();
         commandBuffer->clearDepth(1.0f);
-        ShadowParams lightParams =
-            light->calculateLightSpaceMatrix(shadowCasters);
-        glm::mat4 lightView = lightParams.lightView;
-        glm::mat4 lightProjection = lightParams.lightProjection;
-        light->lastShadowParams = lightParams;
-        for (auto *obj : shadowCasters) {
-            if (!obj->canCastShadows()) {
-                continue;
-            }
 
-            obj->setPipeline(depthPipeline);
+        auto &cascades = light->shadowCascades;
+        cascades.resize(cascadeParams.size());
+        const int grid = cascades.size() > 1 ? 2 : 1;
+        const int cascadeSize = mapSize / grid;
+        const float tile = 1.0f / static_cast<float>(grid);
+        for (std::size_t i = 0; i < cascades.size(); i++) {
+            ShadowCascade &cascade = cascades[i];
+            const int column = static_cast<int>(i) % grid;
+            const int row = static_cast<int>(i) / grid;
+            cascade.renderTarget = shadowRenderTarget;
+            cascade.params = cascadeParams[i];
+            cascade.atlasRect = glm::vec4(static_cast<float>(column) * tile,
+                                          static_cast<float>(row) * tile, tile,
+                                          tile);
+            cascade.viewDirection = viewDirection;
+
+            depthPipeline->setViewport(column * cascadeSize, row * cascadeSize,
+                                       cascadeSize, cascadeSize);
+
+            glm::mat4 lightView = cascade.params.lightView;
+            glm::mat4 lightProjection = cascade.params.lightProjection;
+            const Frustum lightFrustum =
+                Frustum::fromMatrix(lightProjection * lightView);
+            for (auto *obj : shadowCasters) {
+                if (!obj->canCastShadows() ||
+                    !castsShadowInto(obj, lightFrustum)) {
+                    continue;
+                }
+
+                obj->setPipeline(depthPipeline);
 
-            obj->setProjectionMatrix(lightProjection);
-            obj->setViewMatrix(lightView);
-            obj->render(getDeltaTime(), commandBuffer, false);
+                obj->setProjectionMatrix(lightProjection);
+                obj->setViewMatrix(lightView);
+                obj->render(getDeltaTime(), commandBuffer, false);
+            }
         }
 
         commandBuffer->endPass();
@@ -2152,8 +2231,11 @@ void Window::renderLightsToShadowMaps(
         cached.lightProjection = lightProjection;
         cached.bias = 0.001f;
         light->lastShadowParams = cached;
+        const Frustum lightFrustum =
+            Frustum::fromMatrix(lightProjection * lightView);
         for (auto *obj : shadowCasters) {
-            if (!obj->canCastShadows()) {
+            if (!obj->canCastShadows() ||
+                !castsShadowInto(obj, lightFrustum)) {
                 continue;
             }
 
@@ -2202,9 +2284,12 @@ void Window::renderLightsToShadowMaps(
         glm::mat4 lightView = lightParams.lightView;
         glm::mat4 lightProjection = lightParams.lightProjection;
         light->lastShadowParams = lightParams;
+        const Frustum lightFrustum =
+            Frustum::fromMatrix(lightProjection * lightView);
 
         for (auto *obj : shadowCasters) {
-            if (!obj->canCastShadows()) {
+            if (!obj->canCastShadows() ||
+                !castsShadowInto(obj, lightFrustum)) {
                 continue;
             }
 
@@ -2249,6 +2334,10 @@ void Window::renderLightsToShadowMaps(
                                          light->position.y, light->position.z);
         pointLightPipeline->setUniform1f("far_plane", light->distance);
         light->lastShadowParams.farPlane = light->distance;
+        const glm::vec3 lightReach(light->distance);
+        const BoundingBox lightBounds(
+            Position3d::fromGlm(light->position.toGlm() - lightReach),
+            Position3d::fromGlm(light->position.toGlm() + lightReach));
 
         if (this->useMultiPassPointShadows) {
             // Multi-pass rendering: render 6 times, once per cubemap face
@@ -2269,7 +2358,8 @@ void Window::renderLightsToShadowMaps(
                 pointLightPipeline->setUniform1i("faceIndex", face);
 
                 for (auto *obj : shadowCasters) {
-                    if (!obj->canCastShadows()) {
+                    if (!obj->canCastShadows() ||
+                        !castsShadowInto(obj, lightBounds)) {
                         continue;
                     }
 
@@ -2298,7 +2388,8 @@ void Window::renderLightsToShadowMaps(
             }
 
             for (auto *obj : shadowCasters) {
-                if (!obj->canCastShadows()) {
+                if (!obj->canCastShadows() ||
+                    !castsShadowInto(obj, lightBounds)) {
                     continue;
                 }
 
@@ -2601,7 +2692,7 @@ void Window::updateFluidCaptures(
         if (fluid == nullptr) {
             continue;
         }
-        if (fluid->captureDirty) {
+        if (fluid->hasPendingCapture()) {
             fluid->updateCapture(*this, commandBuffer);
         }
     }
@@ -2696,27 +2787,9 @@ void Window::captureFluidReflection(
     glm::mat4 view = this->camera->calculateViewMatrix();
     glm::mat4 projection = calculateProjectionMatrix();
 
-    auto renderQueue = [&](const std::vector<Renderable *> &queue,
-                           bool skipLate) {
-        for (auto *obj : queue) {
-            if (obj == nullptr) {
-                continue;
-            }
-            if (skipLate && obj->renderLateForward) {
-                continue;
-            }
-            if (dynamic_cast<Fluid *>(obj) == &fluid) {
-                continue;
-            }
-            obj->setViewMatrix(view);
-            obj->setProjectionMatrix(projection);
-            obj->render(getDeltaTime(), commandBuffer,
-                        shouldRefreshPipeline(obj));
-        }
-    };
-
-    renderQueue(firstRenderables, false);
-    renderQueue(renderables, true);
+    fluid.reflectionViewProjection = projection * view;
+    fluid.hasReflectionCapture = true;
+    renderFluidCaptureQueue(fluid, true, view, projection, commandBuffer);
 
     if (previousTarget && previousTarget->getFramebuffer()) {
         previousTarget->bind();
@@ -2822,27 +2895,9 @@ void Window::captureFluidRefraction(
     glm::mat4 view = this->camera->calculateViewMatrix();
     glm::mat4 projection = calculateProjectionMatrix();
 
-    auto renderQueue = [&](const std::vector<Renderable *> &queue,
-                           bool skipLate) {
-        for (auto *obj : queue) {
-            if (obj == nullptr) {
-                continue;
-            }
-            if (skipLate && obj->renderLateForward) {
-                continue;
-            }
-            if (dynamic_cast<Fluid *>(obj) == &fluid) {
-                continue;
-            }
-            obj->setViewMatrix(view);
-            obj->setProjectionMatrix(projection);
-            obj->render(getDeltaTime(), commandBuffer,
-                        shouldRefreshPipeline(obj));
-        }
-    };
-
-    renderQueue(firstRenderables, false);
-    renderQueue(renderables, true);
+    fluid.refractionViewProjection = projection * view;
+    fluid.hasRefractionCapture = true;
+    renderFluidCaptureQueue(fluid, false, view, projection, commandBuffer);
 
     if (previousTarget && previousTarget->getFramebuffer()) {
         previousTarget->bind();
@@ -2877,6 +2932,73 @@ void Window::captureFluidRefraction(
     updatePipelineStateField(this->depthCompareOp, previousDepthCompare);
 }
 
+void Window::renderFluidCaptureQueue(
+    Fluid &fluid, bool aboveSurface, const glm::mat4 &view,
+    const glm::mat4 &projection,
+    const std::shared_ptr<opal::CommandBuffer> &commandBuffer) {
+    // Keeps objects that barely cross the plane, since waves move the
+    // visible surface up and down.
+    constexpr float kPlaneMargin = 0.1f;
+
+    const glm::vec4 plane = fluid.calculateClipPlane();
+    const glm::vec3 normal(plane);
+    const glm::vec3 eye = this->camera->position.toGlm();
+
+    fluidCaptureQueue.clear();
+    auto collect = [&](const std::vector<Renderable *> &queue) {
+        for (auto *obj : queue) {
+            if (obj == nullptr || dynamic_cast<Fluid *>(obj) == &fluid) {
+                continue;
+            }
+            std::optional<BoundingBox> bounds = obj->getWorldBounds();
+            if (!bounds.has_value()) {
+                fluidCaptureQueue.push_back(obj);
+                continue;
+            }
+            const glm::vec3 minimum = bounds->min.toGlm();
+            const glm::vec3 maximum = bounds->max.toGlm();
+
+            if (fluid.captureDrawDistance > 0.0f) {
+                const glm::vec3 closest = glm::clamp(eye, minimum, maximum);
+                if (glm::length(closest - eye) > fluid.captureDrawDistance) {
+                    continue;
+                }
+            }
+
+            // Reflections only show what is above the water and refractions
+            // what is below it, so test the corner of the box that reaches
+            // furthest into the side that is kept.
+            glm::vec3 corner;
+            for (int axis = 0; axis < 3; axis++) {
+                const bool towardsNormal = normal[axis] >= 0.0f;
+                corner[axis] = towardsNormal == aboveSurface ? maximum[axis]
+                                                             : minimum[axis];
+            }
+            const float distance = glm::dot(normal, corner) + plane.w;
+            if (aboveSurface ? distance < -kPlaneMargin
+                             : distance > kPlaneMargin) {
+                continue;
+            }
+            fluidCaptureQueue.push_back(obj);
+        }
+    };
+
+    // Both captures are drawn with the main camera's view and projection, so
+    // the visible lists are already culled against the frustum they use and
+    // leave out late forward objects.
+    collect(visibleFirstRenderables);
+    collect(visibleRenderables);
+
+    const bool shadowsBackup = suppressShadows;
+    suppressShadows = !fluid.captureShadows;
+    for (auto *obj : fluidCaptureQueue) {
+        obj->setViewMatrix(view);
+        obj->setProjectionMatrix(projection);
+        obj->render(getDeltaTime(), commandBuffer, shouldRefreshPipeline(obj));
+    }
+    suppressShadows = shadowsBackup;
+}
+
 void Window::markPipelineStateDirty() { ++pipelineStateVersion; }
 
 bool Window::shouldRefreshPipeline(Renderable *renderable) {
@@ -2953,6 +3075,63 @@ BoundingBox Window::getSceneBoundingBox() {
     return {Position3d::fromGlm(worldMin), Position3d::fromGlm(worldMax)};
 }
 
+bool Window::isInView(Renderable *renderable) const {
+    if (!this->useFrustumCulling || renderable == nullptr) {
+        return true;
+    }
+    std::optional<BoundingBox> bounds = renderable->getWorldBounds();
+    if (!bounds.has_value()) {
+        return true;
+    }
+
+    if (renderable->maxDrawDistance > 0.0f && this->camera != nullptr) {
+        const glm::vec3 eye = this->camera->position.toGlm();
+        const glm::vec3 closest =
+            glm::clamp(eye, bounds->min.toGlm(), bounds->max.toGlm());
+        if (glm::length(closest - eye) > renderable->maxDrawDistance) {
+            return false;
+        }
+    }
+
+    return this->viewFrustum.intersects(*bounds);
+}
+
+void Window::cullRenderables() {
+    this->viewFrustum =
+        this->camera->calculateFrustum(calculateProjectionMatrix());
+    this->visibleFirstRenderables.clear();
+    this->visibleRenderables.clear();
+    this->visibleLateForwardRenderables.clear();
+    this->visibleObjectCount = 0;
+    this->culledObjectCount = 0;
+
+    auto cull = [&](Renderable *obj, std::vector<Renderable *> &visible) {
+        if (obj == nullptr) {
+            return;
+        }
+        if (isInView(obj)) {
+            visible.push_back(obj);
+            this->visibleObjectCount++;
+            return;
+        }
+        obj->renderCulled(getDeltaTime());
+        this->culledObjectCount++;
+    };
+
+    for (auto *obj : this->firstRenderables) {
+        cull(obj, this->visibleFirstRenderables);
+    }
+    for (auto *obj : this->renderables) {
+        if (obj != nullptr && obj->renderLateForward) {
+            continue;
+        }
+        cull(obj, this->visibleRenderables);
+    }
+    for (auto *obj : this->lateForwardRenderables) {
+        cull(obj, this->visibleLateForwardRenderables);
+    }
+}
+
 bool Window::isActionTriggered(const std::string &actionName) {
     auto inputAction = getInputAction(actionName);
     if (inputAction) {
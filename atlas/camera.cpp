@@ -59,6 +59,47 @@ glm::mat4 Camera::calculateViewMatrix() const {
     return glm::mat4(glm::lookAt(camPos, camTarget, upVector));
 }
 
+Frustum Camera::calculateFrustum(const glm::mat4 &projection) const {
+    return Frustum::fromMatrix(projection * calculateViewMatrix());
+}
+
+Frustum Frustum::fromMatrix(const glm::mat4 &viewProjection) {
+    const glm::mat4 m = glm::transpose(viewProjection);
+
+    Frustum frustum;
+    frustum.planes[0] = m[3] + m[0];
+    frustum.planes[1] = m[3] - m[0];
+    frustum.planes[2] = m[3] + m[1];
+    frustum.planes[3] = m[3] - m[1];
+    // Uses the -1..1 depth range. With 0..1 projections this plane ends up
+    // slightly behind the real near plane, which only makes the test looser.
+    frustum.planes[4] = m[3] + m[2];
+    frustum.planes[5] = m[3] - m[2];
+
+    for (auto &plane : frustum.planes) {
+        const float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) {
+            plane /= length;
+        }
+    }
+    return frustum;
+}
+
+bool Frustum::intersects(const BoundingBox &box) const {
+    const glm::vec3 boxMin = box.min.toGlm();
+    const glm::vec3 boxMax = box.max.toGlm();
+    for (const auto &plane : planes) {
+        // Only the corner furthest along the plane normal needs testing.
+        const glm::vec3 corner(plane.x >= 0.0f ? boxMax.x : boxMin.x,
+                               plane.y >= 0.0f ? boxMax.y : boxMin.y,
+                               plane.z >= 0.0f ? boxMax.z : boxMin.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void Camera::move(const Position3d &delta) {
     position.x += delta.x;
     position.y += delta.y;
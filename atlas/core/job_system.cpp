@@ -0,0 +1,109 @@
+//
+// job_system.cpp
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: Shared worker pool implementation
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#include "atlas/core/job_system.h"
+#include <algorithm>
+
+JobSystem::JobSystem() {
+    // The caller of parallelFor works too, so leave one core for it.
+    const unsigned int hardwareThreads =
+        std::max(1u, std::thread::hardware_concurrency());
+    workers.reserve(hardwareThreads - 1);
+    for (unsigned int i = 0; i + 1 < hardwareThreads; i++) {
+        workers.emplace_back(&JobSystem::workerLoop, this);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grainSize,
+                            const std::function<void(size_t, size_t)> &func) {
+    if (count == 0) {
+        return;
+    }
+    grainSize = std::max<size_t>(1, grainSize);
+    if (workers.empty() || count <= grainSize) {
+        func(0, count);
+        return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->func = &func;
+    job->count = count;
+    job->grainSize = grainSize;
+    job->chunkCount = (count + grainSize - 1) / grainSize;
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        jobs.push_back(job);
+    }
+    jobAvailable.notify_all();
+
+    runChunks(*job);
+    retireJob(job);
+
+    std::unique_lock<std::mutex> lock(job->doneMutex);
+    job->done.wait(lock, [&job]() {
+        return job->finishedChunks.load(std::memory_order_acquire) ==
+               job->chunkCount;
+    });
+}
+
+void JobSystem::runChunks(Job &job) {
+    while (true) {
+        const size_t chunk =
+            job.nextChunk.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= job.chunkCount) {
+            return;
+        }
+        const size_t begin = chunk * job.grainSize;
+        const size_t end = std::min(job.count, begin + job.grainSize);
+        (*job.func)(begin, end);
+
+        if (job.finishedChunks.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+            job.chunkCount) {
+            std::lock_guard<std::mutex> lock(job.doneMutex);
+            job.done.notify_all();
+        }
+    }
+}
+
+void JobSystem::retireJob(const std::shared_ptr<Job> &job) {
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    auto it = std::find(jobs.begin(), jobs.end(), job);
+    if (it != jobs.end()) {
+        jobs.erase(it);
+    }
+}
+
+void JobSystem::workerLoop() {
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(jobsMutex);
+            jobAvailable.wait(lock,
+                              [this]() { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = jobs.front();
+        }
+        runChunks(*job);
+        // Every chunk is claimed, stop handing this job to other workers.
+        retireJob(job);
+    }
+}
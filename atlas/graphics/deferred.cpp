@@ -14,11 +14,60 @@
 #include <cmath>
 #include <cstring>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 namespace {
+constexpr int LIGHT_PASS_SHADOW_SAMPLERS = 5;
+constexpr int LIGHT_PASS_TEXTURE_UNITS = 16;
+
+struct ShadowParamUniforms {
+    opal::UniformHandle textureIndex;
+    opal::UniformHandle lightView;
+    opal::UniformHandle lightProjection;
+    opal::UniformHandle bias;
+    opal::UniformHandle farPlane;
+    opal::UniformHandle lightPos;
+    opal::UniformHandle lightType;
+};
+
+// Indexed names used by the light pass, built once instead of every frame.
+struct LightPassUniforms {
+    std::vector<opal::UniformHandle> shadowTextures;
+    std::vector<opal::UniformHandle> cubeMaps;
+    std::vector<opal::UniformHandle> textureUnits;
+    std::vector<ShadowParamUniforms> shadowParams;
+
+    LightPassUniforms() {
+        for (int i = 1; i <= LIGHT_PASS_SHADOW_SAMPLERS; i++) {
+            shadowTextures.emplace_back("texture" + std::to_string(i));
+            cubeMaps.emplace_back("cubeMap" + std::to_string(i));
+        }
+        textureUnits =
+            opal::UniformHandle::array("textures", LIGHT_PASS_TEXTURE_UNITS);
+        for (int i = 0; i < LIGHT_PASS_SHADOW_SAMPLERS * 2; i++) {
+            const std::string base =
+                "shadowParams[" + std::to_string(i) + "].";
+            shadowParams.push_back({
+                opal::UniformHandle(base + "textureIndex"),
+                opal::UniformHandle(base + "lightView"),
+                opal::UniformHandle(base + "lightProjection"),
+                opal::UniformHandle(base + "bias"),
+                opal::UniformHandle(base + "farPlane"),
+                opal::UniformHandle(base + "lightPos"),
+                opal::UniformHandle(base + "lightType"),
+            });
+        }
+    }
+};
+
+const LightPassUniforms &lightPassUniforms() {
+    static const LightPassUniforms uniforms;
+    return uniforms;
+}
+
 std::shared_ptr<opal::Texture> createFallbackSSAOTexture() {
     const unsigned char white = 255;
     auto texture = opal::Texture::create(
@@ -140,115 +189,6 @@ computeDeferredGeometrySignature(const std::vector<Renderable *> &renderables) {
     }
     return signature;
 }
-
-std::vector<GPUDirectionalLight>
-buildGPUDirectionalLights(const std::vector<DirectionalLight *> &lights,
-                          int maxCount) {
-    std::vector<GPUDirectionalLight> result;
-    int count = std::min(static_cast<int>(lights.size()), maxCount);
-    result.reserve(count);
-    for (int i = 0; i < count; i++) {
-        DirectionalLight *light = lights.at(i);
-        GPUDirectionalLight gpu{};
-        gpu.direction = glm::vec3(light->direction.x, light->direction.y,
-                                  light->direction.z);
-        gpu.diffuse = glm::vec3(light->color.r, light->color.g, light->color.b);
-        gpu.specular = glm::vec3(light->shineColor.r, light->shineColor.g,
-                                 light->shineColor.b);
-        gpu._pad1 = 0.0f;
-        gpu._pad2 = 0.0f;
-        gpu.intensity = light->intensity;
-        result.push_back(gpu);
-    }
-    return result;
-}
-
-std::vector<GPUPointLight>
-buildGPUPointLights(const std::vector<Light *> &lights, int maxCount) {
-    std::vector<GPUPointLight> result;
-    int count = std::min(static_cast<int>(lights.size()), maxCount);
-    result.reserve(count);
-    for (int i = 0; i < count; i++) {
-        Light *light = lights.at(i);
-        PointLightConstants plc = light->calculateConstants();
-        GPUPointLight gpu{};
-        gpu.position =
-            glm::vec3(light->position.x, light->position.y, light->position.z);
-        gpu.diffuse = glm::vec3(light->color.r, light->color.g, light->color.b);
-        gpu.specular = glm::vec3(light->shineColor.r, light->shineColor.g,
-                                 light->shineColor.b);
-        gpu.intensity = light->intensity;
-        gpu.constant = plc.constant;
-        gpu.linear = plc.linear;
-        gpu.quadratic = plc.quadratic;
-        gpu.radius = plc.radius;
-        gpu._pad1 = 0.0f;
-        gpu._pad2 = 0.0f;
-        gpu._pad3 = 0.0f;
-        result.push_back(gpu);
-    }
-    return result;
-}
-
-std::vector<GPUSpotLight>
-buildGPUSpotLights(const std::vector<Spotlight *> &lights, int maxCount) {
-    std::vector<GPUSpotLight> result;
-    int count = std::min(static_cast<int>(lights.size()), maxCount);
-    result.reserve(count);
-    for (int i = 0; i < count; i++) {
-        Spotlight *light = lights.at(i);
-        GPUSpotLight gpu{};
-        gpu.position =
-            glm::vec3(light->position.x, light->position.y, light->position.z);
-        gpu.direction = glm::vec3(light->direction.x, light->direction.y,
-                                  light->direction.z);
-        gpu.cutOff = light->cutOff;
-        gpu.outerCutOff = light->outerCutoff;
-        gpu.diffuse = glm::vec3(light->color.r, light->color.g, light->color.b);
-        gpu.specular = glm::vec3(light->shineColor.r, light->shineColor.g,
-                                 light->shineColor.b);
-        gpu._pad1 = 0.0f;
-        gpu.intensity = light->intensity;
-        gpu.range = light->range;
-        gpu._pad4 = 0.0f;
-        gpu._pad5 = 0.0f;
-        gpu._pad6 = 0.0f;
-        result.push_back(gpu);
-    }
-    return result;
-}
-
-std::vector<GPUAreaLight>
-buildGPUAreaLights(const std::vector<AreaLight *> &lights, int maxCount) {
-    std::vector<GPUAreaLight> result;
-    int count = std::min(static_cast<int>(lights.size()), maxCount);
-    result.reserve(count);
-    for (int i = 0; i < count; i++) {
-        AreaLight *light = lights.at(i);
-        GPUAreaLight gpu{};
-        gpu.position =
-            glm::vec3(light->position.x, light->position.y, light->position.z);
-        gpu.right = glm::vec3(light->right.x, light->right.y, light->right.z);
-        gpu.up = glm::vec3(light->up.x, light->up.y, light->up.z);
-        gpu.size = glm::vec2(light->size.width, light->size.height);
-        gpu.diffuse = glm::vec3(light->color.r, light->color.g, light->color.b);
-        gpu.specular = glm::vec3(light->shineColor.r, light->shineColor.g,
-                                 light->shineColor.b);
-        gpu.angle = light->angle;
-        gpu.castsBothSides = light->castsBothSides ? 1 : 0;
-        gpu._pad1 = 0.0f;
-        gpu._pad2 = 0.0f;
-        gpu._pad3 = 0.0f;
-        gpu._pad4 = 0.0f;
-        gpu._pad5 = 0.0f;
-        gpu._pad6 = 0.0f;
-        gpu.intensity = light->intensity;
-        gpu.range = light->range;
-        gpu._pad9 = 0.0f;
-        result.push_back(gpu);
-    }
-    return result;
-}
 } // anonymous namespace
 
 #ifdef METAL
@@ -458,7 +398,12 @@ void Window::deferredRendering(
         }
     };
 
+    // Culled objects stay in the ordered list so their cached programs and
+    // pipelines survive while they are off screen.
     for (auto *obj : orderedDeferredRenderables) {
+        if (!isInView(obj)) {
+            continue;
+        }
         renderDeferredRenderable(obj);
     }
 
@@ -606,13 +551,14 @@ void Window::deferredRendering(
         lightPipeline->bindTexture2D("ssao", fallbackSSAOTexture->textureID, 4);
     }
     boundTextures++;
-    for (int i = 0; i < 5; i++) {
-        lightPipeline->bindTexture2D("texture" + std::to_string(i + 1),
+    const LightPassUniforms &uniforms = lightPassUniforms();
+    for (int i = 0; i < LIGHT_PASS_SHADOW_SAMPLERS; i++) {
+        lightPipeline->bindTexture2D(uniforms.shadowTextures[i],
                                      fallbackSSAOTexture->textureID,
                                      boundTextures + i);
         lightPipeline->bindTextureCubemap(
-            "cubeMap" + std::to_string(i + 1),
-            fallbackShadowCubemapTexture->textureID, 10 + i);
+            uniforms.cubeMaps[i], fallbackShadowCubemapTexture->textureID,
+            10 + i);
     }
 
 #ifdef METAL
@@ -686,66 +632,12 @@ void Window::deferredRendering(
                                 getCamera()->position.y,
                                 getCamera()->position.z);
 
-    // Send directional lights using buffer binding
-    int dirLightCount = std::min((int)scene->directionalLights.size(), 256);
-    std::vector<GPUDirectionalLight> gpuDirLights;
-    if (dirLightCount > 0) {
-        gpuDirLights =
-            buildGPUDirectionalLights(scene->directionalLights, dirLightCount);
-    } else if (scene->atmosphere.isEnabled()) {
-        GPUDirectionalLight gpu{};
-        glm::vec3 sunDir = scene->atmosphere.getSunAngle().toGlm();
-        if (glm::length(sunDir) > 0.0001f) {
-            gpu.direction = -glm::normalize(sunDir);
-        } else {
-            gpu.direction = glm::vec3(0.0f, -1.0f, 0.0f);
-        }
-        Color skyLight = scene->atmosphere.getLightColor();
-        gpu.diffuse = glm::vec3(skyLight.r, skyLight.g, skyLight.b);
-        gpu.specular = gpu.diffuse;
-        gpu.intensity = scene->atmosphere.getLightIntensity() * 1.2f;
-        gpuDirLights.push_back(gpu);
-        dirLightCount = 1;
-    }
-    lightPipeline->setUniform1i("directionalLightCount", dirLightCount);
-
-    if (!gpuDirLights.empty()) {
-        lightPipeline->bindBuffer("DirectionalLights", gpuDirLights);
-    }
+    // Lights are packed once per frame; the atmosphere sun stands in when
+    // the scene has no directional light.
+    lightFrameData.bind(*lightPipeline, true);
 
-    // Send point lights using buffer binding
-    int pointLightCount = std::min((int)scene->pointLights.size(), 256);
-    lightPipeline->setUniform1i("pointLightCount", pointLightCount);
-
-    if (pointLightCount > 0) {
-        auto gpuPointLights =
-            buildGPUPointLights(scene->pointLights, pointLightCount);
-        lightPipeline->bindBuffer("PointLights", gpuPointLights);
-    }
-
-    // Send spotlights using buffer binding
-    int spotlightCount = std::min((int)scene->spotlights.size(), 256);
-    lightPipeline->setUniform1i("spotlightCount", spotlightCount);
-
-    if (spotlightCount > 0) {
-        auto gpuSpotLights =
-            buildGPUSpotLights(scene->spotlights, spotlightCount);
-        lightPipeline->bindBuffer("SpotLights", gpuSpotLights);
-    }
-
-    // Send area lights using buffer binding
-    int areaLightCount = std::min((int)scene->areaLights.size(), 256);
-    lightPipeline->setUniform1i("areaLightCount", areaLightCount);
-
-    if (areaLightCount > 0) {
-        auto gpuAreaLights =
-            buildGPUAreaLights(scene->areaLights, areaLightCount);
-        lightPipeline->bindBuffer("AreaLights", gpuAreaLights);
-    }
-
-    for (int i = 0; i < 5; i++) {
-        std::string uniformName = "cubeMap" + std::to_string(i + 1);
-        lightPipeline->setUniform1i(uniformName, i + 10);
+    for (int i = 0; i < LIGHT_PASS_SHADOW_SAMPLERS; i++) {
+        lightPipeline->setUniform1i(uniforms.cubeMaps[i], i + 10);
     }
 
     int shadow2DSamplerIndex = 0;
@@ -763,42 +655,56 @@ void Window::deferredRendering(
         if (light->shadowRenderTarget == nullptr) {
             continue;
         }
-        if (boundTextures >= 16) {
-            break;
-        }
 
-        if (shadow2DSamplerIndex >= 5) {
-            break;
+        const std::vector<ShadowCascade> &cascades = light->getShadowCascades();
+        if (cascades.empty() || boundTextures >= 16 ||
+            shadow2DSamplerIndex >= 5) {
+            continue;
         }
-        std::string baseName =
-            "shadowParams[" + std::to_string(boundParameters) + "]";
+
+        // The cascades share one shadow map and one sampler. The first entry
+        // is a directional shadow and the rest of the cascades follow it with
+        // lightType 4, so the shader can pick one of them per fragment.
         lightPipeline->bindTexture2D(
-            "texture" + std::to_string(shadow2DSamplerIndex + 1),
+            uniforms.shadowTextures[shadow2DSamplerIndex],
             light->shadowRenderTarget->texture.id, boundTextures);
-        lightPipeline->setUniform1i(baseName + ".textureIndex",
-                                    shadow2DSamplerIndex);
-        ShadowParams shadowParams = light->lastShadowParams;
+        for (std::size_t i = 0; i < cascades.size(); i++) {
+            if (boundParameters >= LIGHT_PASS_SHADOW_SAMPLERS * 2) {
+                break;
+            }
+            const ShadowCascade &cascade = cascades[i];
+            const int lightType = i == 0 ? 0 : 4;
+            const ShadowParamUniforms &param =
+                uniforms.shadowParams[boundParameters];
+            lightPipeline->setUniform1i(param.textureIndex,
+                                        shadow2DSamplerIndex);
+            const ShadowParams &shadowParams = cascade.params;
 #ifdef METAL
-        GPUShadowParams gpuShadow{};
-        gpuShadow.lightView = shadowParams.lightView;
-        gpuShadow.lightProjection = shadowParams.lightProjection;
-        gpuShadow.bias = shadowParams.bias;
-        gpuShadow.textureIndex = shadow2DSamplerIndex;
-        gpuShadow.farPlane = 0.0f;
-        gpuShadow._pad1 = 0.0f;
-        gpuShadow.lightPos = glm::vec3(0.0f);
-        gpuShadow.lightType = 0;
-        gpuShadowParams.push_back(gpuShadow);
+            GPUShadowParams gpuShadow{};
+            gpuShadow.lightView = shadowParams.lightView;
+            gpuShadow.lightProjection = shadowParams.lightProjection;
+            gpuShadow.bias = shadowParams.bias;
+            gpuShadow.textureIndex = shadow2DSamplerIndex;
+            gpuShadow.farPlane = shadowParams.farPlane;
+            gpuShadow._pad1 = 0.0f;
+            gpuShadow.lightPos = cascade.viewDirection;
+            gpuShadow.lightType = lightType;
+            gpuShadowParams.push_back(gpuShadow);
 #else
-        lightPipeline->setUniformMat4f(baseName + ".lightView",
-                                       shadowParams.lightView);
-        lightPipeline->setUniformMat4f(baseName + ".lightProjection",
-                                       shadowParams.lightProjection);
-        lightPipeline->setUniform1f(baseName + ".bias", shadowParams.bias);
-        lightPipeline->setUniform1i(baseName + ".lightType", 0);
+            lightPipeline->setUniformMat4f(param.lightView,
+                                           shadowParams.lightView);
+            lightPipeline->setUniformMat4f(param.lightProjection,
+                                           shadowParams.lightProjection);
+            lightPipeline->setUniform1f(param.bias, shadowParams.bias);
+            lightPipeline->setUniform1f(param.farPlane, shadowParams.farPlane);
+            lightPipeline->setUniform3f(
+                param.lightPos, cascade.viewDirection.x,
+                cascade.viewDirection.y, cascade.viewDirection.z);
+            lightPipeline->setUniform1i(param.lightType, lightType);
 #endif
 
-        boundParameters++;
+            boundParameters++;
+        }
         shadow2DSamplerIndex++;
         boundTextures++;
     }
@@ -811,20 +717,20 @@ void Window::deferredRendering(
         if (light->shadowRenderTarget == nullptr) {
             continue;
         }
-        if (boundTextures >= 16) {
+        if (boundTextures >= 16 ||
+            boundParameters >= LIGHT_PASS_SHADOW_SAMPLERS * 2) {
             break;
         }
 
         if (shadow2DSamplerIndex >= 5) {
             break;
         }
-        std::string baseName =
-            "shadowParams[" + std::to_string(boundParameters) + "]";
+        const ShadowParamUniforms &param =
+            uniforms.shadowParams[boundParameters];
         lightPipeline->bindTexture2D(
-            "texture" + std::to_string(shadow2DSamplerIndex + 1),
+            uniforms.shadowTextures[shadow2DSamplerIndex],
             light->shadowRenderTarget->texture.id, boundTextures);
-        lightPipeline->setUniform1i(baseName + ".textureIndex",
-                                    shadow2DSamplerIndex);
+        lightPipeline->setUniform1i(param.textureIndex, shadow2DSamplerIndex);
         ShadowParams shadowParams = light->lastShadowParams;
 #ifdef METAL
         GPUShadowParams gpuShadow{};
@@ -838,12 +744,12 @@ void Window::deferredRendering(
         gpuShadow.lightType = 1;
         gpuShadowParams.push_back(gpuShadow);
 #else
-        lightPipeline->setUniformMat4f(baseName + ".lightView",
+        lightPipeline->setUniformMat4f(param.lightView,
                                        shadowParams.lightView);
-        lightPipeline->setUniformMat4f(baseName + ".lightProjection",
+        lightPipeline->setUniformMat4f(param.lightProjection,
                                        shadowParams.lightProjection);
-        lightPipeline->setUniform1f(baseName + ".bias", shadowParams.bias);
-        lightPipeline->setUniform1i(baseName + ".lightType", 1);
+        lightPipeline->setUniform1f(param.bias, shadowParams.bias);
+        lightPipeline->setUniform1i(param.lightType, 1);
 #endif
 
         boundParameters++;
@@ -858,20 +764,20 @@ void Window::deferredRendering(
         if (light->shadowRenderTarget == nullptr) {
             continue;
         }
-        if (boundTextures >= 16) {
+        if (boundTextures >= 16 ||
+            boundParameters >= LIGHT_PASS_SHADOW_SAMPLERS * 2) {
             break;
         }
         if (shadow2DSamplerIndex >= 5) {
             break;
         }
 
-        std::string baseName =
-            "shadowParams[" + std::to_string(boundParameters) + "]";
+        const ShadowParamUniforms &param =
+            uniforms.shadowParams[boundParameters];
         lightPipeline->bindTexture2D(
-            "texture" + std::to_string(shadow2DSamplerIndex + 1),
+            uniforms.shadowTextures[shadow2DSamplerIndex],
             light->shadowRenderTarget->texture.id, boundTextures);
-        lightPipeline->setUniform1i(baseName + ".textureIndex",
-                                    shadow2DSamplerIndex);
+        lightPipeline->setUniform1i(param.textureIndex, shadow2DSamplerIndex);
         ShadowParams shadowParams = light->lastShadowParams;
 #ifdef METAL
         GPUShadowParams gpuShadow{};
@@ -885,12 +791,12 @@ void Window::deferredRendering(
         gpuShadow.lightType = 2;
         gpuShadowParams.push_back(gpuShadow);
 #else
-        lightPipeline->setUniformMat4f(baseName + ".lightView",
+        lightPipeline->setUniformMat4f(param.lightView,
                                        shadowParams.lightView);
-        lightPipeline->setUniformMat4f(baseName + ".lightProjection",
+        lightPipeline->setUniformMat4f(param.lightProjection,
                                        shadowParams.lightProjection);
-        lightPipeline->setUniform1f(baseName + ".bias", shadowParams.bias);
-        lightPipeline->setUniform1i(baseName + ".lightType", 2);
+        lightPipeline->setUniform1f(param.bias, shadowParams.bias);
+        lightPipeline->setUniform1i(param.lightType, 2);
 #endif
 
         boundParameters++;
@@ -905,16 +811,17 @@ void Window::deferredRendering(
         if (light->shadowRenderTarget == nullptr) {
             continue;
         }
-        if (boundCubemaps >= 5) {
+        if (boundCubemaps >= 5 ||
+            boundParameters >= LIGHT_PASS_SHADOW_SAMPLERS * 2) {
             break;
         }
 
-        std::string baseName =
-            "shadowParams[" + std::to_string(boundParameters) + "]";
+        const ShadowParamUniforms &param =
+            uniforms.shadowParams[boundParameters];
         lightPipeline->bindTextureCubemap(
-            "cubeMap" + std::to_string(boundCubemaps + 1),
+            uniforms.cubeMaps[boundCubemaps],
             light->shadowRenderTarget->texture.id, 10 + boundCubemaps);
-        lightPipeline->setUniform1i(baseName + ".textureIndex", boundCubemaps);
+        lightPipeline->setUniform1i(param.textureIndex, boundCubemaps);
 #ifdef METAL
         GPUShadowParams gpuShadow{};
         gpuShadow.lightView = glm::mat4(1.0f);
@@ -929,10 +836,10 @@ void Window::deferredRendering(
         gpuShadow.lightType = 3;
         gpuShadowParams.push_back(gpuShadow);
 #else
-        lightPipeline->setUniform1f(baseName + ".farPlane", light->distance);
-        lightPipeline->setUniform3f(baseName + ".lightPos", light->position.x,
+        lightPipeline->setUniform1f(param.farPlane, light->distance);
+        lightPipeline->setUniform3f(param.lightPos, light->position.x,
                                     light->position.y, light->position.z);
-        lightPipeline->setUniform1i(baseName + ".lightType", 3);
+        lightPipeline->setUniform1i(param.lightType, 3);
 #endif
 
         boundParameters++;
@@ -947,9 +854,8 @@ void Window::deferredRendering(
 #endif
 
     // Set texture units array using pipeline
-    for (int i = 0; i < boundTextures && i < 16; i++) {
-        std::string uniformName = "textures[" + std::to_string(i) + "]";
-        lightPipeline->setUniform1i(uniformName, i);
+    for (int i = 0; i < boundTextures && i < LIGHT_PASS_TEXTURE_UNITS; i++) {
+        lightPipeline->setUniform1i(uniforms.textureUnits[i], i);
     }
 
     // Bind skybox
@@ -984,7 +890,8 @@ void Window::deferredRendering(
     bool hasVolumetricTexture = false;
     bool hasSSRTexture = false;
     const auto &volumetricSettings = scene->environment.volumetricLighting;
-    bool useVolumetric = dirLightCount > 0 && volumetricSettings.enabled &&
+    bool useVolumetric = lightFrameData.getDirectionalLightCount(true) > 0 &&
+                         volumetricSettings.enabled &&
                          volumetricSettings.density > 0.0f &&
                          volumetricSettings.weight > 0.0f &&
                          volumetricSettings.exposure > 0.0f;
@@ -14,6 +14,11 @@
 #include "atlas/tracer/log.h"
 #include "atlas/window.h"
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <optional>
 #include <tuple>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -22,6 +27,101 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/string_cast.hpp>
 
+namespace {
+
+ShadowParams identityShadowParams() {
+    glm::mat4 identity = glm::mat4(1.0f);
+    return {.lightView = identity,
+            .lightProjection = identity,
+            .bias = 0.0f,
+            .farPlane = 0.0f};
+}
+
+glm::vec3 shadowDirection(const Magnitude3d &direction) {
+    glm::vec3 lightDir = direction.toGlm();
+    if (glm::dot(lightDir, lightDir) < 1e-8f) {
+        lightDir = glm::vec3(0.0f, -1.0f, 0.0f);
+    }
+    return glm::normalize(lightDir);
+}
+
+glm::vec3 shadowUpAxis(const glm::vec3 &lightDir) {
+    glm::vec3 upAxis(0.0f, 1.0f, 0.0f);
+    if (glm::abs(glm::dot(lightDir, upAxis)) > 0.95f) {
+        upAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    }
+    if (glm::abs(glm::dot(lightDir, upAxis)) > 0.95f) {
+        upAxis = glm::vec3(1.0f, 0.0f, 0.0f);
+    }
+    return upAxis;
+}
+
+std::array<glm::vec3, 8> boxCorners(const BoundingBox &box) {
+    const glm::vec3 boxMin = box.min.toGlm();
+    const glm::vec3 boxMax = box.max.toGlm();
+    std::array<glm::vec3, 8> corners;
+    for (int i = 0; i < 8; i++) {
+        corners[i] = glm::vec3((i & 1) ? boxMax.x : boxMin.x,
+                               (i & 2) ? boxMax.y : boxMin.y,
+                               (i & 4) ? boxMax.z : boxMin.z);
+    }
+    return corners;
+}
+
+void mergeBounds(std::optional<BoundingBox> &bounds,
+                 const BoundingBox &other) {
+    bounds = bounds.has_value() ? bounds->merged(other) : other;
+}
+
+// Uses the cached bounds of every caster, so the cost grows with the number
+// of objects rather than with their vertex count.
+std::optional<BoundingBox>
+collectCasterBounds(const std::vector<Renderable *> &renderables) {
+    std::optional<BoundingBox> bounds;
+    for (auto *obj : renderables) {
+        if (obj == nullptr || !obj->canCastShadows()) {
+            continue;
+        }
+
+        if (auto *modelObj = dynamic_cast<Model *>(obj)) {
+            for (const auto &modelMesh : modelObj->getObjects()) {
+                if (modelMesh == nullptr || !modelMesh->canCastShadows()) {
+                    continue;
+                }
+                if (auto meshBounds = modelMesh->getWorldBounds()) {
+                    mergeBounds(bounds, *meshBounds);
+                }
+            }
+            continue;
+        }
+
+        if (auto objBounds = obj->getWorldBounds()) {
+            mergeBounds(bounds, *objBounds);
+            continue;
+        }
+
+        // Renderables without cached bounds fall back to their vertices.
+        const auto vertices = obj->getVertices();
+        if (vertices.empty()) {
+            continue;
+        }
+        const glm::vec3 pos = obj->getPosition().toGlm();
+        const glm::vec3 scale = obj->getScale().toGlm();
+        glm::vec3 vertexMin(std::numeric_limits<float>::max());
+        glm::vec3 vertexMax(std::numeric_limits<float>::lowest());
+        for (const auto &vertex : vertices) {
+            const glm::vec3 worldPos = pos + (vertex.position.toGlm() * scale);
+            vertexMin = glm::min(vertexMin, worldPos);
+            vertexMax = glm::max(vertexMax, worldPos);
+        }
+        mergeBounds(bounds, {Position3d::fromGlm(vertexMin),
+                             Position3d::fromGlm(vertexMax)});
+    }
+    return bounds;
+}
+
+} // namespace
+
 void Light::createDebugObject() {
     CoreObject sphere = createSphere(0.05f, 36, 18, this->color);
     sphere.setPosition(this->position);
@@ -216,115 +316,31 @@ void DirectionalLight::castShadows(Window &window, int resolution) {
 
 ShadowParams DirectionalLight::calculateLightSpaceMatrix(
     const std::vector<Renderable *> &renderable) const {
-    if (renderable.empty()) {
-        glm::mat4 identity = glm::mat4(1.0f);
-        return {.lightView = identity,
-                .lightProjection = identity,
-                .bias = 0.0f,
-                .farPlane = 0.0f};
-    }
-
-    std::vector<glm::vec3> worldPoints;
-    worldPoints.reserve(4096);
-    glm::vec3 worldMin(std::numeric_limits<float>::max());
-    glm::vec3 worldMax(std::numeric_limits<float>::lowest());
-
-    for (auto *obj : renderable) {
-        if (obj == nullptr || !obj->canCastShadows())
-            continue;
-
-        if (const auto *modelObj = dynamic_cast<const Model *>(obj)) {
-            const auto &modelObjects = modelObj->getObjects();
-            for (const auto &modelMesh : modelObjects) {
-                if (modelMesh == nullptr || !modelMesh->canCastShadows()) {
-                    continue;
-                }
-                const auto &modelVertices = modelMesh->getVertices();
-                if (modelVertices.empty()) {
-                    continue;
-                }
-                glm::mat4 modelMatrix = glm::mat4(1.0f);
-                modelMatrix = glm::translate(modelMatrix,
-                                             modelMesh->getPosition().toGlm());
-                modelMatrix *= glm::mat4_cast(
-                    glm::normalize(modelMesh->getRotation().toGlmQuat()));
-                modelMatrix =
-                    glm::scale(modelMatrix, modelMesh->getScale().toGlm());
-
-                for (const auto &vertex : modelVertices) {
-                    glm::vec3 worldPos = glm::vec3(
-                        modelMatrix * glm::vec4(vertex.position.toGlm(), 1.0f));
-                    worldPoints.push_back(worldPos);
-                    worldMin = glm::min(worldMin, worldPos);
-                    worldMax = glm::max(worldMax, worldPos);
-                }
-            }
-            continue;
-        }
-
-        const auto &vertices = obj->getVertices();
-        if (vertices.empty())
-            continue;
-
-        if (const auto *coreObj = dynamic_cast<const CoreObject *>(obj)) {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, coreObj->getPosition().toGlm());
-            model *= glm::mat4_cast(
-                glm::normalize(coreObj->getRotation().toGlmQuat()));
-            model = glm::scale(model, coreObj->getScale().toGlm());
-            for (const auto &vertex : vertices) {
-                glm::vec3 worldPos =
-                    glm::vec3(model * glm::vec4(vertex.position.toGlm(), 1.0f));
-                worldPoints.push_back(worldPos);
-                worldMin = glm::min(worldMin, worldPos);
-                worldMax = glm::max(worldMax, worldPos);
-            }
-        } else {
-            glm::vec3 pos = obj->getPosition().toGlm();
-            glm::vec3 scale = obj->getScale().toGlm();
-            for (const auto &vertex : vertices) {
-                glm::vec3 worldPos = pos + (vertex.position.toGlm() * scale);
-                worldPoints.push_back(worldPos);
-                worldMin = glm::min(worldMin, worldPos);
-                worldMax = glm::max(worldMax, worldPos);
-            }
-        }
+    std::optional<BoundingBox> casterBounds = collectCasterBounds(renderable);
+    if (!casterBounds.has_value()) {
+        return identityShadowParams();
     }
 
-    if (worldPoints.empty()) {
-        glm::mat4 identity = glm::mat4(1.0f);
-        return {.lightView = identity,
-                .lightProjection = identity,
-                .bias = 0.0f,
-                .farPlane = 0.0f};
-    }
+    const std::array<glm::vec3, 8> corners = boxCorners(*casterBounds);
+    const glm::vec3 worldMin = casterBounds->min.toGlm();
+    const glm::vec3 worldMax = casterBounds->max.toGlm();
 
     glm::vec3 center = (worldMin + worldMax) * 0.5f;
     glm::vec3 extent = worldMax - worldMin;
 
-    glm::vec3 lightDir = direction.toGlm();
-    if (glm::dot(lightDir, lightDir) < 1e-8f) {
-        lightDir = glm::vec3(0.0f, -1.0f, 0.0f);
-    }
-    lightDir = glm::normalize(lightDir);
+    glm::vec3 lightDir = shadowDirection(direction);
 
     float sceneRadius = std::max(1.0f, glm::length(extent) * 0.5f);
     float lightDistance = std::max(10.0f, sceneRadius + 5.0f);
     glm::vec3 lightPos = center - lightDir * lightDistance;
 
-    glm::vec3 upAxis(0.0f, 1.0f, 0.0f);
-    if (glm::abs(glm::dot(lightDir, upAxis)) > 0.95f) {
-        upAxis = glm::vec3(0.0f, 0.0f, 1.0f);
-    }
-    if (glm::abs(glm::dot(lightDir, upAxis)) > 0.95f) {
-        upAxis = glm::vec3(1.0f, 0.0f, 0.0f);
-    }
-    glm::mat4 lightView = glm::lookAt(lightPos, center, upAxis);
+    glm::mat4 lightView =
+        glm::lookAt(lightPos, center, shadowUpAxis(lightDir));
 
     glm::vec3 lightSpaceMin(std::numeric_limits<float>::max());
     glm::vec3 lightSpaceMax(std::numeric_limits<float>::lowest());
 
-    for (const auto &worldPos : worldPoints) {
+    for (const auto &worldPos : corners) {
         glm::vec3 lightSpacePos =
             glm::vec3(lightView * glm::vec4(worldPos, 1.0f));
         lightSpaceMin = glm::min(lightSpaceMin, lightSpacePos);
@@ -352,6 +368,119 @@ ShadowParams DirectionalLight::calculateLightSpaceMatrix(
             .farPlane = 0.0f};
 }
 
+std::vector<ShadowParams> DirectionalLight::calculateCascadeMatrices(
+    const std::vector<Renderable *> &renderable, const Camera &camera,
+    float aspectRatio, int resolution) const {
+    std::optional<BoundingBox> casterBounds = collectCasterBounds(renderable);
+    if (!casterBounds.has_value()) {
+        return {identityShadowParams()};
+    }
+
+    const int count = std::clamp(cascadeCount, 1, MAX_SHADOW_CASCADES);
+    const float nearClip = std::max(0.01f, camera.nearClip);
+    const float farClip =
+        std::max(nearClip + 1.0f, std::min(camera.farClip, cascadeDistance));
+    const float lambda = std::clamp(cascadeSplitLambda, 0.0f, 1.0f);
+    const glm::mat4 view = camera.calculateViewMatrix();
+
+    std::vector<ShadowParams> cascades;
+    cascades.reserve(count);
+    float sliceNear = nearClip;
+    for (int i = 0; i < count; i++) {
+        const float fraction =
+            static_cast<float>(i + 1) / static_cast<float>(count);
+        const float logSplit =
+            nearClip * std::pow(farClip / nearClip, fraction);
+        const float uniformSplit = nearClip + (farClip - nearClip) * fraction;
+        const float sliceFar =
+            (lambda * logSplit) + ((1.0f - lambda) * uniformSplit);
+
+        const glm::mat4 sliceProjection = glm::perspective(
+            glm::radians(camera.fov), aspectRatio, sliceNear, sliceFar);
+        const glm::mat4 toWorld = glm::inverse(sliceProjection * view);
+
+        std::array<glm::vec3, 8> slice;
+        for (int corner = 0; corner < 8; corner++) {
+            const glm::vec4 ndc((corner & 1) ? 1.0f : -1.0f,
+                                (corner & 2) ? 1.0f : -1.0f,
+                                (corner & 4) ? 1.0f : -1.0f, 1.0f);
+            const glm::vec4 world = toWorld * ndc;
+            slice[corner] = glm::vec3(world) / world.w;
+        }
+
+        cascades.push_back(fitShadowVolume(slice, *casterBounds, resolution));
+        // Shaders pick the cascade of a fragment by comparing its view depth
+        // against the split depths.
+        cascades.back().farPlane = sliceFar;
+        sliceNear = sliceFar;
+    }
+    return cascades;
+}
+
+ShadowParams
+DirectionalLight::fitShadowVolume(const std::array<glm::vec3, 8> &volume,
+                                  const BoundingBox &casterBounds,
+                                  int resolution) const {
+    glm::vec3 center(0.0f);
+    for (const auto &corner : volume) {
+        center += corner;
+    }
+    center /= static_cast<float>(volume.size());
+
+    // A bounding sphere keeps the projection size constant while the camera
+    // rotates, which avoids shadow edges crawling between frames.
+    float radius = 1.0f;
+    for (const auto &corner : volume) {
+        radius = std::max(radius, glm::length(corner - center));
+    }
+    radius = std::ceil(radius);
+
+    const glm::vec3 lightDir = shadowDirection(direction);
+    const glm::mat4 lightView = glm::lookAt(center - lightDir * radius, center,
+                                            shadowUpAxis(lightDir));
+
+    float nearest = std::numeric_limits<float>::lowest();
+    float furthest = std::numeric_limits<float>::max();
+    for (const auto &corner : volume) {
+        const float depth = (lightView * glm::vec4(corner, 1.0f)).z;
+        nearest = std::max(nearest, depth);
+        furthest = std::min(furthest, depth);
+    }
+    // Casters outside the slice can still shadow it, so the depth range is
+    // pulled back towards the light until it contains all of them.
+    for (const auto &corner : boxCorners(casterBounds)) {
+        nearest =
+            std::max(nearest, (lightView * glm::vec4(corner, 1.0f)).z);
+    }
+
+    const float zMargin = std::max(2.0f, radius * 0.1f);
+    const float near_plane = -nearest - zMargin;
+    const float far_plane = std::max(near_plane + 1.0f, -furthest + zMargin);
+
+    glm::mat4 lightProjection =
+        glm::ortho(-radius, radius, -radius, radius, near_plane, far_plane);
+
+    if (resolution > 0) {
+        // Snap the projection to whole shadow map texels.
+        const float halfResolution = static_cast<float>(resolution) * 0.5f;
+        glm::vec4 origin =
+            lightProjection * lightView * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        origin *= halfResolution;
+        const glm::vec2 offset =
+            (glm::round(glm::vec2(origin)) - glm::vec2(origin)) /
+            halfResolution;
+        lightProjection[3][0] += offset.x;
+        lightProjection[3][1] += offset.y;
+    }
+
+    float bias = std::clamp(0.000008f * radius * 2.0f, 0.00002f, 0.00025f);
+
+    return {.lightView = lightView,
+            .lightProjection = lightProjection,
+            .bias = bias,
+            .farPlane = 0.0f};
+}
+
 std::tuple<glm::mat4, glm::mat4> Spotlight::calculateLightSpaceMatrix() const {
     float near_plane = 0.1f, far_plane = 100.f;
     glm::mat4 lightProjection =
@@ -533,3 +662,311 @@ void AreaLight::addDebugObject(Window &window) {
     }
     window.addObject(this->debugObject.get());
 }
+
+namespace {
+
+struct LightCountUniforms {
+    opal::UniformHandle directional{"directionalLightCount"};
+    opal::UniformHandle point{"pointLightCount"};
+    opal::UniformHandle spot{"spotlightCount"};
+    opal::UniformHandle area{"areaLightCount"};
+};
+
+const LightCountUniforms &lightCountUniforms() {
+    static const LightCountUniforms uniforms;
+    return uniforms;
+}
+
+void packLight(const DirectionalLight &light, GPUDirectionalLight &gpu) {
+    gpu.direction =
+        glm::vec3(light.direction.x, light.direction.y, light.direction.z);
+    gpu.diffuse = glm::vec3(light.color.r, light.color.g, light.color.b);
+    gpu.specular =
+        glm::vec3(light.shineColor.r, light.shineColor.g, light.shineColor.b);
+    gpu.intensity = light.intensity;
+}
+
+void packLight(const Light &light, GPUPointLight &gpu) {
+    PointLightConstants plc = light.calculateConstants();
+    gpu.position =
+        glm::vec3(light.position.x, light.position.y, light.position.z);
+    gpu.diffuse = glm::vec3(light.color.r, light.color.g, light.color.b);
+    gpu.specular =
+        glm::vec3(light.shineColor.r, light.shineColor.g, light.shineColor.b);
+    gpu.intensity = light.intensity;
+    gpu.constant = plc.constant;
+    gpu.linear = plc.linear;
+    gpu.quadratic = plc.quadratic;
+    gpu.radius = plc.radius;
+}
+
+void packLight(const Spotlight &light, GPUSpotLight &gpu) {
+    gpu.position =
+        glm::vec3(light.position.x, light.position.y, light.position.z);
+    gpu.direction =
+        glm::vec3(light.direction.x, light.direction.y, light.direction.z);
+    gpu.cutOff = light.cutOff;
+    gpu.outerCutOff = light.outerCutoff;
+    gpu.diffuse = glm::vec3(light.color.r, light.color.g, light.color.b);
+    gpu.specular =
+        glm::vec3(light.shineColor.r, light.shineColor.g, light.shineColor.b);
+    gpu.intensity = light.intensity;
+    gpu.range = light.range;
+}
+
+void packLight(const AreaLight &light, GPUAreaLight &gpu) {
+    gpu.position =
+        glm::vec3(light.position.x, light.position.y, light.position.z);
+    gpu.right = glm::vec3(light.right.x, light.right.y, light.right.z);
+    gpu.up = glm::vec3(light.up.x, light.up.y, light.up.z);
+    gpu.size = glm::vec2(light.size.width, light.size.height);
+    gpu.diffuse = glm::vec3(light.color.r, light.color.g, light.color.b);
+    gpu.specular =
+        glm::vec3(light.shineColor.r, light.shineColor.g, light.shineColor.b);
+    gpu.angle = light.angle;
+    gpu.castsBothSides = light.castsBothSides ? 1 : 0;
+    gpu.intensity = light.intensity;
+    gpu.range = light.range;
+}
+
+// Packed structs are compared bytewise, so each one starts zeroed to keep
+// its padding stable.
+template <typename T> T &appendZeroed(std::vector<T> &packed) {
+    T &gpu = packed.emplace_back();
+    std::memset(static_cast<void *>(&gpu), 0, sizeof(T));
+    return gpu;
+}
+
+template <typename T, typename L>
+void packLights(const std::vector<L *> &lights, std::vector<T> &packed,
+                int limit = LightFrameData::MAX_LIGHTS) {
+    packed.clear();
+    for (L *light : lights) {
+        if (light == nullptr) {
+            continue;
+        }
+        if (packed.size() >= static_cast<size_t>(limit)) {
+            break;
+        }
+        packLight(*light, appendZeroed(packed));
+    }
+}
+
+void bindLightBuffer(opal::Pipeline &pipeline, const std::string &name,
+                     const std::shared_ptr<opal::Buffer> &buffer, int count) {
+    if (count > 0 && buffer != nullptr && pipeline.hasBufferBinding(name)) {
+        pipeline.bindBuffer(name, buffer);
+    }
+}
+
+// Matches the header of the LightClusters buffer in the shaders.
+struct GPULightClusterHeader {
+    // Tiles along x and y, depth slices, and whether clusters are in use.
+    glm::uvec4 grid;
+    // Near and far planes, then the scale and bias from log(depth) to slice.
+    glm::vec4 depth;
+    // Tangents of half the horizontal and vertical field of view.
+    glm::vec4 projection;
+    glm::mat4 view;
+};
+static_assert(sizeof(GPULightClusterHeader) == 112,
+              "GPULightClusterHeader must match the shader layout");
+
+#ifndef OPENGL
+// Grows a shader buffer by doubling, so a frame with more lights than the
+// last does not reallocate every time, and uploads `size` bytes into it.
+void uploadClusterBuffer(std::shared_ptr<opal::Buffer> &buffer,
+                         size_t &capacity, const void *data, size_t size) {
+    if (buffer == nullptr || size > capacity) {
+        capacity = std::max({size, capacity * 2, sizeof(uint32_t)});
+        buffer = opal::Buffer::create(opal::BufferUsage::ShaderRead, capacity,
+                                      nullptr, opal::MemoryUsageType::GPUOnly);
+    }
+    if (size > 0) {
+        buffer->updateData(0, size, data);
+    }
+}
+#endif
+
+} // namespace
+
+template <typename T> void LightFrameData::upload(LightList<T> &list) {
+#ifdef OPENGL
+    // OpenGL pipelines have no storage buffers to bind the lights to.
+    (void)list;
+#else
+    const size_t count = std::max<size_t>(list.packed.size(), 1);
+    if (list.buffer == nullptr || count > list.capacity) {
+        list.capacity = std::max(count, list.capacity * 2);
+        list.buffer = opal::Buffer::create(
+            opal::BufferUsage::ShaderRead, list.capacity * sizeof(T), nullptr,
+            opal::MemoryUsageType::GPUOnly);
+        list.uploaded.clear();
+    }
+
+    // Upload the single span covering every light that changed.
+    size_t first = list.packed.size();
+    size_t last = 0;
+    for (size_t i = 0; i < list.packed.size(); i++) {
+        if (i < list.uploaded.size() &&
+            std::memcmp(&list.packed[i], &list.uploaded[i], sizeof(T)) == 0) {
+            continue;
+        }
+        first = std::min(first, i);
+        last = i + 1;
+    }
+    if (first < last) {
+        list.buffer->updateData(first * sizeof(T), (last - first) * sizeof(T),
+                                list.packed.data() + first);
+    }
+
+    list.uploaded.resize(list.packed.size());
+    if (!list.packed.empty()) {
+        std::memcpy(static_cast<void *>(list.uploaded.data()),
+                    list.packed.data(), list.packed.size() * sizeof(T));
+    }
+#endif
+}
+
+void LightFrameData::update(Scene &scene, const Camera *clusterCamera,
+                            float aspectRatio) {
+    packLights(scene.getDirectionalLights(), directionalLights.packed);
+    sceneDirectionalCount = static_cast<int>(directionalLights.packed.size());
+    if (sceneDirectionalCount == 0 && scene.atmosphere.isEnabled()) {
+        GPUDirectionalLight &sun = appendZeroed(directionalLights.packed);
+        glm::vec3 sunDir = scene.atmosphere.getSunAngle().toGlm();
+        if (glm::length(sunDir) > 0.0001f) {
+            sun.direction = -glm::normalize(sunDir);
+        } else {
+            sun.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+        }
+        Color skyLight = scene.atmosphere.getLightColor();
+        sun.diffuse = glm::vec3(skyLight.r, skyLight.g, skyLight.b);
+        sun.specular = sun.diffuse;
+        sun.intensity = scene.atmosphere.getLightIntensity() * 1.2f;
+    }
+    const int limit =
+        clusterCamera != nullptr ? MAX_CLUSTERED_LIGHTS : MAX_LIGHTS;
+    packLights(scene.getPointLights(), pointLights.packed, limit);
+    packLights(scene.getSpotlights(), spotlights.packed, limit);
+    packLights(scene.getAreaLights(), areaLights.packed, limit);
+
+    upload(directionalLights);
+    upload(pointLights);
+    upload(spotlights);
+    upload(areaLights);
+
+    if (clusterCamera != nullptr) {
+        updateClusters(*clusterCamera, aspectRatio);
+    } else {
+        disableClusters();
+    }
+}
+
+void LightFrameData::updateClusters(const Camera &camera,
+                                    float aspectRatio) {
+#ifdef OPENGL
+    // OpenGL pipelines have no storage buffers to read the clusters from.
+    (void)camera;
+    (void)aspectRatio;
+#else
+    const glm::mat4 view = camera.calculateViewMatrix();
+    clusters.configure(glm::radians(camera.fov), aspectRatio, camera.nearClip,
+                       camera.farClip);
+
+    // Every light fades out completely at its range, so a sphere of that
+    // radius bounds everything it can light.
+    auto toView = [&view](const glm::vec3 &position) {
+        return glm::vec3(view * glm::vec4(position, 1.0f));
+    };
+    clusterLights.clear();
+    for (size_t i = 0; i < pointLights.packed.size(); i++) {
+        const GPUPointLight &light = pointLights.packed[i];
+        clusterLights.push_back(
+            {.center = toView(light.position),
+             .radius = std::max(light.radius, 0.001f),
+             .entry = LightClusters::encode(ClusterLightType::Point,
+                                            static_cast<uint32_t>(i))});
+    }
+    for (size_t i = 0; i < spotlights.packed.size(); i++) {
+        const GPUSpotLight &light = spotlights.packed[i];
+        clusterLights.push_back(
+            {.center = toView(light.position),
+             .radius = std::max(light.range, 0.001f),
+             .entry = LightClusters::encode(ClusterLightType::Spot,
+                                            static_cast<uint32_t>(i))});
+    }
+    for (size_t i = 0; i < areaLights.packed.size(); i++) {
+        // Area lights reach their range from the closest point of the
+        // rectangle, so grow the sphere by half its diagonal.
+        const GPUAreaLight &light = areaLights.packed[i];
+        clusterLights.push_back(
+            {.center = toView(light.position),
+             .radius = std::max(light.range, 0.001f) +
+                       (0.5f * glm::length(light.size)),
+             .entry = LightClusters::encode(ClusterLightType::Area,
+                                            static_cast<uint32_t>(i))});
+    }
+    clusters.build(clusterLights);
+
+    GPULightClusterHeader header{};
+    header.grid = glm::uvec4(clusters.tilesX, clusters.tilesY, clusters.slices,
+                             1u);
+    header.depth = glm::vec4(clusters.nearPlane, clusters.farPlane,
+                             clusters.getSliceScale(),
+                             clusters.getSliceBias());
+    header.projection =
+        glm::vec4(clusters.tanHalfFovX, clusters.tanHalfFovY, 0.0f, 0.0f);
+    header.view = view;
+
+    const std::vector<glm::uvec2> &ranges = clusters.getRanges();
+    const size_t rangeBytes = ranges.size() * sizeof(glm::uvec2);
+    clusterData.resize(sizeof(header) + rangeBytes);
+    std::memcpy(clusterData.data(), &header, sizeof(header));
+    std::memcpy(clusterData.data() + sizeof(header), ranges.data(),
+                rangeBytes);
+    uploadClusterBuffer(clusterBuffer, clusterCapacity, clusterData.data(),
+                        clusterData.size());
+
+    const std::vector<uint32_t> &indices = clusters.getIndices();
+    uploadClusterBuffer(clusterIndexBuffer, clusterIndexCapacity,
+                        indices.data(), indices.size() * sizeof(uint32_t));
+    clustersEnabled = true;
+#endif
+}
+
+void LightFrameData::disableClusters() {
+    if (!clustersEnabled) {
+        return;
+    }
+    clustersEnabled = false;
+    // Pipelines keep the cluster buffers bound, so clear the flag the
+    // shaders check instead of unbinding them.
+    GPULightClusterHeader header{};
+    clusterBuffer->updateData(0, sizeof(header), &header);
+}
+
+int LightFrameData::getDirectionalLightCount(bool includeSun) const {
+    return includeSun ? static_cast<int>(directionalLights.packed.size())
+                      : sceneDirectionalCount;
+}
+
+void LightFrameData::bind(opal::Pipeline &pipeline, bool includeSun) const {
+    const LightCountUniforms &uniforms = lightCountUniforms();
+    const int directionalCount = getDirectionalLightCount(includeSun);
+    pipeline.setUniform1i(uniforms.directional, directionalCount);
+    pipeline.setUniform1i(uniforms.point, getPointLightCount());
+    pipeline.setUniform1i(uniforms.spot, getSpotlightCount());
+    pipeline.setUniform1i(uniforms.area, getAreaLightCount());
+
+    bindLightBuffer(pipeline, "DirectionalLights", directionalLights.buffer,
+                    directionalCount);
+    bindLightBuffer(pipeline, "PointLights", pointLights.buffer,
+                    getPointLightCount());
+    bindLightBuffer(pipeline, "SpotLights", spotlights.buffer,
+                    getSpotlightCount());
+    bindLightBuffer(pipeline, "AreaLights", areaLights.buffer,
+                    getAreaLightCount());
+    bindLightBuffer(pipeline, "LightClusters", clusterBuffer, 1);
+    bindLightBuffer(pipeline, "LightClusterIndices", clusterIndexBuffer, 1);
+}
@@ -0,0 +1,224 @@
+//
+// light_clusters.cpp
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: Parallel light binning into a view-space froxel grid
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#include "atlas/light_clusters.h"
+#include "atlas/core/job_system.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Finds a conservative range of tiles whose boxes can overlap [low, high]
+// along one axis of a slice. Tile edges sit at -1 + 2t/tiles in NDC, and a
+// box reaches furthest from the axis on the far side of the slice.
+bool tileSpan(float low, float high, float tanHalfFov, float sliceNear,
+              float sliceFar, uint32_t tiles, uint32_t &first,
+              uint32_t &last) {
+    const float ndcLow =
+        low / (tanHalfFov * (low >= 0.0f ? sliceFar : sliceNear));
+    const float ndcHigh =
+        high / (tanHalfFov * (high >= 0.0f ? sliceNear : sliceFar));
+    const float scale = static_cast<float>(tiles) * 0.5f;
+    const float start = std::floor((ndcLow + 1.0f) * scale) - 1.0f;
+    const float end = std::floor((ndcHigh + 1.0f) * scale);
+    const auto maxTile = static_cast<float>(tiles - 1);
+    if (start > maxTile || end < 0.0f) {
+        return false;
+    }
+    first = static_cast<uint32_t>(std::max(start, 0.0f));
+    last = static_cast<uint32_t>(std::min(end, maxTile));
+    return first <= last;
+}
+
+} // namespace
+
+void LightClusters::configure(float fovY, float aspectRatio, float nearClip,
+                              float farClip) {
+    tanHalfFovY = std::tan(fovY * 0.5f);
+    tanHalfFovX = tanHalfFovY * aspectRatio;
+    nearPlane = std::max(nearClip, 1e-4f);
+    farPlane = std::max(farClip, nearPlane * 1.001f);
+}
+
+float LightClusters::getSliceDepth(uint32_t slice) const {
+    if (slice >= slices) {
+        return farPlane;
+    }
+    const float t = static_cast<float>(slice) / static_cast<float>(slices);
+    return nearPlane * std::pow(farPlane / nearPlane, t);
+}
+
+float LightClusters::getSliceScale() const {
+    return static_cast<float>(slices) / std::log(farPlane / nearPlane);
+}
+
+float LightClusters::getSliceBias() const {
+    return -getSliceScale() * std::log(nearPlane);
+}
+
+bool LightClusters::overlaps(const ClusterLight &light, uint32_t x,
+                             uint32_t y, uint32_t z) const {
+    return overlapsBox(light, x, y, getSliceDepth(z), getSliceDepth(z + 1));
+}
+
+bool LightClusters::overlapsBox(const ClusterLight &light, uint32_t x,
+                                uint32_t y, float sliceNear,
+                                float sliceFar) const {
+    const float stepX = 2.0f / static_cast<float>(tilesX);
+    const float stepY = 2.0f / static_cast<float>(tilesY);
+    const float ndcX0 = -1.0f + (static_cast<float>(x) * stepX);
+    const float ndcX1 = -1.0f + (static_cast<float>(x + 1) * stepX);
+    const float ndcY0 = -1.0f + (static_cast<float>(y) * stepY);
+    const float ndcY1 = -1.0f + (static_cast<float>(y + 1) * stepY);
+
+    // Bounding box of the frustum cell between the two slice planes.
+    const glm::vec3 boxMin(
+        std::min(ndcX0 * tanHalfFovX * sliceNear,
+                 ndcX0 * tanHalfFovX * sliceFar),
+        std::min(ndcY0 * tanHalfFovY * sliceNear,
+                 ndcY0 * tanHalfFovY * sliceFar),
+        -sliceFar);
+    const glm::vec3 boxMax(
+        std::max(ndcX1 * tanHalfFovX * sliceNear,
+                 ndcX1 * tanHalfFovX * sliceFar),
+        std::max(ndcY1 * tanHalfFovY * sliceNear,
+                 ndcY1 * tanHalfFovY * sliceFar),
+        -sliceNear);
+
+    const glm::vec3 offset =
+        light.center - glm::clamp(light.center, boxMin, boxMax);
+    return glm::dot(offset, offset) <= light.radius * light.radius;
+}
+
+void LightClusters::updateDepths() {
+    depths.resize(slices + 1);
+    for (uint32_t z = 0; z <= slices; z++) {
+        depths[z] = getSliceDepth(z);
+    }
+}
+
+void LightClusters::build(const std::vector<ClusterLight> &lights) {
+    updateDepths();
+
+    const size_t count = lights.size();
+    centerX.resize(count);
+    centerY.resize(count);
+    minDepth.resize(count);
+    maxDepth.resize(count);
+    paddedRadii.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const ClusterLight &light = lights[i];
+        // The rejection tests run before the exact one, so pad them enough
+        // that rounding can never drop a light the exact test accepts.
+        const float pad =
+            1e-4f * (1.0f + std::abs(light.center.z) + light.radius);
+        centerX[i] = light.center.x;
+        centerY[i] = light.center.y;
+        minDepth[i] = -light.center.z - light.radius - pad;
+        maxDepth[i] = -light.center.z + light.radius + pad;
+        paddedRadii[i] = light.radius + pad;
+    }
+
+    sliceData.resize(slices);
+    JobSystem::getInstance().parallelFor(
+        slices, 1, [&](size_t begin, size_t end) {
+            for (size_t z = begin; z < end; z++) {
+                binSlice(lights, static_cast<uint32_t>(z));
+            }
+        });
+    gather();
+}
+
+void LightClusters::binSlice(const std::vector<ClusterLight> &lights,
+                             uint32_t z) {
+    Slice &slice = sliceData[z];
+    const float sliceNear = depths[z];
+    const float sliceFar = depths[z + 1];
+
+    slice.hits.clear();
+    const size_t count = lights.size();
+    for (size_t i = 0; i < count; i++) {
+        if (maxDepth[i] < sliceNear || minDepth[i] > sliceFar) {
+            continue;
+        }
+        uint32_t firstX = 0;
+        uint32_t lastX = 0;
+        uint32_t firstY = 0;
+        uint32_t lastY = 0;
+        if (!tileSpan(centerX[i] - paddedRadii[i], centerX[i] + paddedRadii[i],
+                      tanHalfFovX, sliceNear, sliceFar, tilesX, firstX,
+                      lastX) ||
+            !tileSpan(centerY[i] - paddedRadii[i], centerY[i] + paddedRadii[i],
+                      tanHalfFovY, sliceNear, sliceFar, tilesY, firstY,
+                      lastY)) {
+            continue;
+        }
+        for (uint32_t y = firstY; y <= lastY; y++) {
+            for (uint32_t x = firstX; x <= lastX; x++) {
+                if (overlapsBox(lights[i], x, y, sliceNear, sliceFar)) {
+                    slice.hits.emplace_back((y * tilesX) + x, lights[i].entry);
+                }
+            }
+        }
+    }
+
+    // Counting sort by tile keeps the light order inside every cluster.
+    const size_t tileCount = static_cast<size_t>(tilesX) * tilesY;
+    slice.counts.assign(tileCount, 0);
+    for (const glm::uvec2 &hit : slice.hits) {
+        slice.counts[hit.x]++;
+    }
+    slice.offsets.resize(tileCount);
+    uint32_t offset = 0;
+    for (size_t tile = 0; tile < tileCount; tile++) {
+        slice.offsets[tile] = offset;
+        offset += slice.counts[tile];
+    }
+    slice.entries.resize(slice.hits.size());
+    for (const glm::uvec2 &hit : slice.hits) {
+        slice.entries[slice.offsets[hit.x]++] = hit.y;
+    }
+}
+
+void LightClusters::gather() {
+    const uint32_t tileCount = tilesX * tilesY;
+    ranges.resize(getClusterCount());
+    indices.clear();
+    for (uint32_t z = 0; z < slices; z++) {
+        const Slice &slice = sliceData[z];
+        auto offset = static_cast<uint32_t>(indices.size());
+        for (uint32_t tile = 0; tile < tileCount; tile++) {
+            ranges[(z * tileCount) + tile] =
+                glm::uvec2(offset, slice.counts[tile]);
+            offset += slice.counts[tile];
+        }
+        indices.insert(indices.end(), slice.entries.begin(),
+                       slice.entries.end());
+    }
+}
+
+void LightClusters::buildReference(const std::vector<ClusterLight> &lights) {
+    updateDepths();
+    ranges.resize(getClusterCount());
+    indices.clear();
+    for (uint32_t z = 0; z < slices; z++) {
+        for (uint32_t y = 0; y < tilesY; y++) {
+            for (uint32_t x = 0; x < tilesX; x++) {
+                const auto offset = static_cast<uint32_t>(indices.size());
+                for (const ClusterLight &light : lights) {
+                    if (overlapsBox(light, x, y, depths[z], depths[z + 1])) {
+                        indices.push_back(light.entry);
+                    }
+                }
+                ranges[clusterIndex(x, y, z)] = glm::uvec2(
+                    offset, static_cast<uint32_t>(indices.size()) - offset);
+            }
+        }
+    }
+}
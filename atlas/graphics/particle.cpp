@@ -5,6 +5,7 @@
 //
 
 #include "atlas/camera.h"
+#include "atlas/core/job_system.h"
 #include "atlas/core/shader.h"
 #include "atlas/object.h"
 #include "atlas/tracer/data.h"
@@ -12,9 +13,10 @@
 #include "atlas/units.h"
 #include "atlas/window.h"
 #include "opal/opal.h"
+#include <algorithm>
+#include <cmath>
 #include <numbers>
 #include <random>
-#include <utility>
 #include "atlas/particle.h"
 
 struct QuadVertex {
@@ -22,46 +24,30 @@ struct QuadVertex {
     float u, v;
 };
 
-struct ParticleInstanceData {
-    float posX, posY, posZ;
-    float colorR, colorG, colorB, colorA;
-    float size;
-};
+namespace {
 
-ParticleEmitter::ParticleEmitter(unsigned int maxParticles)
-    : maxParticles(maxParticles), vao(nullptr), quadBuffer(nullptr),
-      instanceBuffer(nullptr), indexBuffer(nullptr), program({}), texture({}) {
-    particles.reserve(maxParticles);
+// Particles handled by one job. A multiple of the kernel lane width so
+// chunks of the same emitter never share a lane group.
+constexpr size_t PARTICLE_CHUNK_SIZE = 2048;
 
-    this->direction = {0.0, 1.0, 0.0};
-    for (auto& p : particles) {
-        p.active = false;
+struct ParticleChunk {
+    ParticleEmitter* emitter;
+    size_t begin;
+    size_t end;
+};
+
+void appendChunks(std::vector<ParticleChunk>& chunks,
+                  ParticleEmitter* emitter, size_t count) {
+    for (size_t begin = 0; begin < count; begin += PARTICLE_CHUNK_SIZE) {
+        chunks.push_back(
+            {emitter, begin, std::min(count, begin + PARTICLE_CHUNK_SIZE)});
     }
 }
 
-void ParticleEmitter::initialize() {
-    static const QuadVertex quadVertices[] = {
-        {.x = -0.5f, .y = -0.5f, .z = 0.0f, .u = 0.0f, .v = 0.0f},
-        {.x = 0.5f, .y = -0.5f, .z = 0.0f, .u = 1.0f, .v = 0.0f},
-        {.x = 0.5f, .y = 0.5f, .z = 0.0f, .u = 1.0f, .v = 1.0f},
-        {.x = -0.5f, .y = 0.5f, .z = 0.0f, .u = 0.0f, .v = 1.0f}
-    };
-
-    static const unsigned int indices[] = {0, 1, 2, 2, 3, 0};
-
-    quadBuffer = opal::Buffer::create(opal::BufferUsage::VertexBuffer,
-                                      sizeof(quadVertices), quadVertices,
-                                      opal::MemoryUsageType::GPUOnly, id);
-    indexBuffer =
-        opal::Buffer::create(opal::BufferUsage::IndexArray, sizeof(indices),
-                             indices, opal::MemoryUsageType::GPUOnly, id);
-    instanceBuffer =
-        opal::Buffer::create(opal::BufferUsage::GeneralPurpose,
-                             maxParticles * sizeof(ParticleInstanceData),
-                             nullptr, opal::MemoryUsageType::CPUToGPU, id);
-    vao = opal::DrawingState::create(quadBuffer, indexBuffer);
-    vao->setBuffers(quadBuffer, indexBuffer);
-
+void configureParticleAttributes(
+    const std::shared_ptr<opal::DrawingState>& drawingState,
+    const std::shared_ptr<opal::Buffer>& quadBuffer,
+    const std::shared_ptr<opal::Buffer>& instanceBuffer) {
     opal::VertexAttribute positionAttr{
         .name = "particlePosition",
         .type = opal::VertexAttributeType::Float,
@@ -125,77 +111,288 @@ void ParticleEmitter::initialize() {
         {.attribute = instanceColor, .sourceBuffer = instanceBuffer},
         {.attribute = instanceSize, .sourceBuffer = instanceBuffer}
     };
-    vao->configureAttributes(bindings);
+    drawingState->configureAttributes(bindings);
+}
+
+} // namespace
+
+ParticleEmitter::ParticleEmitter(unsigned int maxParticles)
+    : maxParticles(maxParticles), vao(nullptr), quadBuffer(nullptr),
+      instanceBuffer(nullptr), indexBuffer(nullptr), program({}), texture({}),
+      rng(std::random_device{}()) {
+    particles.reserve(maxParticles);
+
+    this->direction = {0.0, 1.0, 0.0};
+}
+
+void ParticleEmitter::initialize() {
+    static const QuadVertex quadVertices[] = {
+        {.x = -0.5f, .y = -0.5f, .z = 0.0f, .u = 0.0f, .v = 0.0f},
+        {.x = 0.5f, .y = -0.5f, .z = 0.0f, .u = 1.0f, .v = 0.0f},
+        {.x = 0.5f, .y = 0.5f, .z = 0.0f, .u = 1.0f, .v = 1.0f},
+        {.x = -0.5f, .y = 0.5f, .z = 0.0f, .u = 0.0f, .v = 1.0f}
+    };
+
+    static const unsigned int indices[] = {0, 1, 2, 2, 3, 0};
+
+    quadBuffer = opal::Buffer::create(opal::BufferUsage::VertexBuffer,
+                                      sizeof(quadVertices), quadVertices,
+                                      opal::MemoryUsageType::GPUOnly, id);
+    indexBuffer =
+        opal::Buffer::create(opal::BufferUsage::IndexArray, sizeof(indices),
+                             indices, opal::MemoryUsageType::GPUOnly, id);
+    instanceBuffer =
+        opal::Buffer::create(opal::BufferUsage::GeneralPurpose,
+                             maxParticles * sizeof(ParticleInstanceData),
+                             nullptr, opal::MemoryUsageType::CPUToGPU, id);
+    vao = opal::DrawingState::create(quadBuffer, indexBuffer);
+    vao->setBuffers(quadBuffer, indexBuffer);
+
+    configureParticleAttributes(vao, quadBuffer, instanceBuffer);
 
     program = ShaderProgram::fromDefaultShaders(AtlasVertexShader::Particle,
                                                 AtlasFragmentShader::Particle);
-}
 
-void ParticleEmitter::spawnParticle() {
-    int index = findInactiveParticle();
-    if (index != -1) {
-        activateParticle(index);
+    if (computeRequested) {
+        computeActive = initializeCompute();
     }
 }
 
-void ParticleEmitter::updateParticle(Particle& p, float deltaTime) {
-    if (!p.active)
-        return;
+bool ParticleEmitter::initializeCompute() {
+#ifdef METAL
+    if (maxParticles == 0) {
+        return false;
+    }
+    try {
+        ComputeShader kernel = ComputeShader::fromDefaultShader(
+            AtlasComputeShader::ParticleSimulation);
+        kernel.compile();
+        ShaderProgram kernelProgram;
+        kernelProgram.computeShader = kernel;
+        kernelProgram.compile();
+
+        computePipeline = opal::Pipeline::create();
+        computePipeline->setShaderProgram(kernelProgram.shader);
+        computePipeline->setComputeThreadgroupSize(64, 1, 1);
+        computePipeline->build();
+
+        std::vector<ParticleSlot> emptySlots(maxParticles);
+        computeSlots = opal::Buffer::create(
+            opal::BufferUsage::ShaderReadWrite,
+            emptySlots.size() * sizeof(ParticleSlot), emptySlots.data(),
+            opal::MemoryUsageType::GPUOnly, id);
+        computeInstances = opal::Buffer::create(
+            opal::BufferUsage::ShaderReadWrite,
+            maxParticles * sizeof(ParticleInstanceData), nullptr,
+            opal::MemoryUsageType::GPUOnly, id);
+        opal::DrawIndexedIndirectArguments arguments;
+        arguments.indexCount = 6;
+        for (size_t i = 0; i < COMPUTE_FRAME_COUNT; i++) {
+            computeSpawns[i] = opal::Buffer::create(
+                opal::BufferUsage::ShaderRead,
+                maxParticles * sizeof(ParticleSlot), nullptr,
+                opal::MemoryUsageType::CPUToGPU, id);
+            computeArguments[i] = opal::Buffer::create(
+                opal::BufferUsage::ShaderReadWrite, sizeof(arguments),
+                &arguments, opal::MemoryUsageType::CPUToGPU, id);
+        }
 
-    p.life -= deltaTime;
-    if (p.life <= 0.0f) {
-        p.active = false;
-        return;
+        computeVao = opal::DrawingState::create(quadBuffer, indexBuffer);
+        computeVao->setBuffers(quadBuffer, indexBuffer);
+        configureParticleAttributes(computeVao, quadBuffer, computeInstances);
+    } catch (const std::exception& e) {
+        atlas_warning("Particle compute simulation unavailable, using the "
+                      "CPU: " +
+                      std::string(e.what()));
+        computePipeline = nullptr;
+        return false;
     }
 
-    if (emissionType == ParticleEmissionType::Fountain) {
-        p.velocity.y += settings.gravity * deltaTime;
+    // Particles simulated so far on the CPU continue on the GPU.
+    for (size_t i = 0; i < particles.getCount() &&
+                       pendingSpawns.size() < maxParticles;
+         i++) {
+        ParticleSlot slot;
+        slot.posX = particles.positionX[i];
+        slot.posY = particles.positionY[i];
+        slot.posZ = particles.positionZ[i];
+        slot.velX = particles.velocityX[i];
+        slot.velY = particles.velocityY[i];
+        slot.velZ = particles.velocityZ[i];
+        slot.colorR = particles.colorR[i];
+        slot.colorG = particles.colorG[i];
+        slot.colorB = particles.colorB[i];
+        slot.colorA = particles.colorA[i];
+        slot.life = particles.life[i];
+        slot.maxLife = particles.maxLife[i];
+        slot.size = particles.size[i];
+        pendingSpawns.push_back(slot);
     }
-    else if (emissionType == ParticleEmissionType::Ambient) {
-        p.velocity.y += settings.gravity * 0.1f * deltaTime;
+    particles.clear();
+    activeParticleCount = 0;
+    return true;
+#else
+    atlas_warning("Particle compute simulation needs the Metal backend, "
+                  "using the CPU");
+    return false;
+#endif
+}
 
-        float time = atlasGetTimeSeconds();
-        p.velocity.x +=
-            sin((time * 1.0f) + (p.position.x * 0.1f)) * 0.02f * deltaTime;
-        p.velocity.z +=
-            cos((time * 0.8f) + (p.position.z * 0.1f)) * 0.02f * deltaTime;
+void ParticleEmitter::enableComputeSimulation() {
+    computeRequested = true;
+    if (vao != nullptr && !computeActive) {
+        computeActive = initializeCompute();
     }
+}
+
+void ParticleEmitter::disableComputeSimulation() {
+    // GPU particles are not read back, the CPU simulation starts empty.
+    computeRequested = false;
+    computeActive = false;
+    pendingSpawns.clear();
+}
 
-    Magnitude3d windDirection = Magnitude3d{0.0f, 0.0f, 0.0f};
-    if (Window::mainWindow->getCurrentScene()->atmosphere.isEnabled()) {
-        windDirection = Window::mainWindow->getCurrentScene()->atmosphere.wind;
+void ParticleEmitter::dispatchCompute(Window& window) {
+    auto commandBuffer = window.activeCommandBuffer;
+    if (commandBuffer == nullptr || computePipeline == nullptr) {
+        return;
     }
 
-    p.velocity.x += windDirection.x * deltaTime;
-    p.velocity.y += windDirection.y * deltaTime;
-    p.velocity.z += windDirection.z * deltaTime;
+    ParticleComputeParams params;
+    params.deltaTime = frameConstants.deltaTime;
+    params.time = frameConstants.time;
+    params.gravity = frameConstants.gravity;
+    params.ambient = frameConstants.ambientSway ? 1u : 0u;
+    params.windX = frameConstants.windX;
+    params.windY = frameConstants.windY;
+    params.windZ = frameConstants.windZ;
+    params.originX = position.x;
+    params.originY = position.y;
+    params.originZ = position.z;
+    params.capacity = maxParticles;
+    params.spawnCursor = spawnCursor;
+    params.spawnCount = static_cast<unsigned int>(pendingSpawns.size());
+
+    computeFrame =
+        static_cast<size_t>(window.device->frameCount) % COMPUTE_FRAME_COUNT;
+    const std::shared_ptr<opal::Buffer> &spawns = computeSpawns[computeFrame];
+    const std::shared_ptr<opal::Buffer> &drawArguments =
+        computeArguments[computeFrame];
+
+    if (!pendingSpawns.empty()) {
+        spawns->updateData(0, pendingSpawns.size() * sizeof(ParticleSlot),
+                           pendingSpawns.data());
+        spawnCursor = (spawnCursor + params.spawnCount) % maxParticles;
+        pendingSpawns.clear();
+    }
 
-    p.position = p.position + p.velocity * deltaTime;
+    opal::DrawIndexedIndirectArguments arguments;
+    arguments.indexCount = 6;
+    drawArguments->updateData(0, sizeof(arguments), &arguments);
+
+    computePipeline->bindShaderReadWriteBuffer("slots", computeSlots, id);
+    computePipeline->bindShaderReadWriteBuffer("spawned", spawns, id);
+    computePipeline->bindShaderReadWriteBuffer("instances", computeInstances,
+                                               id);
+    computePipeline->bindShaderReadWriteBuffer("drawArguments", drawArguments,
+                                               id);
+    computePipeline->bindBufferData("params", &params, sizeof(params));
+
+    commandBuffer->bindPipeline(computePipeline);
+    commandBuffer->dispatch(maxParticles, 1, 1);
+    commandBuffer->computeBarrier();
+}
 
+void ParticleEmitter::spawnParticle() {
+    if (computeActive) {
+        if (pendingSpawns.size() < maxParticles) {
+            pendingSpawns.push_back(makeParticle());
+        }
+        return;
+    }
+    size_t index = particles.spawn();
+    if (index != ParticleStore::npos) {
+        activateParticle(index);
+    }
+}
+
+ParticleFrameConstants ParticleEmitter::makeFrameConstants(Window& window,
+                                                           float dt) const {
+    ParticleFrameConstants constants;
+    constants.deltaTime = dt;
+    constants.time = atlasGetTimeSeconds();
+    constants.gravity = settings.gravity;
     if (emissionType == ParticleEmissionType::Ambient) {
-        if (p.position.y < position.y - 15.0f ||
-            abs(p.position.x - position.x) > 25.0f ||
-            abs(p.position.z - position.z) > 25.0f) {
-            p.position = generateSpawnPosition();
-            p.velocity = generateRandomVelocity();
-            p.life = p.maxLife;
+        constants.gravity *= 0.1f;
+        constants.ambientSway = true;
+    }
+
+    Scene* scene = window.getCurrentScene();
+    if (scene != nullptr && scene->atmosphere.isEnabled()) {
+        constants.windX = scene->atmosphere.wind.x;
+        constants.windY = scene->atmosphere.wind.y;
+        constants.windZ = scene->atmosphere.wind.z;
+    }
+    return constants;
+}
+
+void ParticleEmitter::retireParticles() {
+    const bool ambient = emissionType == ParticleEmissionType::Ambient;
+    size_t i = 0;
+    while (i < particles.getCount()) {
+        if (particles.life[i] <= 0.0f) {
+            // Swap-remove, the particle moved into this slot is checked next.
+            particles.remove(i);
+            continue;
+        }
+        if (ambient &&
+            (particles.positionY[i] < position.y - 15.0f ||
+             std::abs(particles.positionX[i] - position.x) > 25.0f ||
+             std::abs(particles.positionZ[i] - position.z) > 25.0f)) {
+            respawnParticle(i);
         }
+        i++;
+    }
+}
+
+void ParticleEmitter::beginUpload() {
+    activeParticleCount = static_cast<unsigned int>(particles.getCount());
+    uploadTarget = nullptr;
+    uploadMapped = false;
+    if (instanceBuffer == nullptr || activeParticleCount == 0) {
+        return;
+    }
+
+    const size_t byteSize = activeParticleCount * sizeof(ParticleInstanceData);
+    uploadTarget =
+        static_cast<ParticleInstanceData*>(instanceBuffer->map(0, byteSize));
+    if (uploadTarget != nullptr) {
+        uploadMapped = true;
+        return;
     }
 
-    float lifeRatio = p.life / p.maxLife;
-    p.color.a = lifeRatio;
+    instanceData.resize(activeParticleCount);
+    uploadTarget = instanceData.data();
 }
 
-Position3d ParticleEmitter::generateSpawnPosition() {
-    static std::default_random_engine rng([]
-    {
-        std::random_device rd;
-        return std::default_random_engine(rd());
-    }());
-    static std::uniform_real_distribution<float> rand01(0.0f, 1.0f);
-    static std::uniform_real_distribution<float> randAngle(0.0f,
-                                                           2.0f * std::numbers::pi_v<float>);
+void ParticleEmitter::finishUpload() {
+    if (uploadTarget == nullptr) {
+        return;
+    }
+    if (uploadMapped) {
+        instanceBuffer->unmap();
+    } else {
+        instanceBuffer->bind();
+        instanceBuffer->updateData(
+            0, activeParticleCount * sizeof(ParticleInstanceData),
+            instanceData.data());
+        instanceBuffer->unbind();
+    }
+    uploadTarget = nullptr;
+    uploadMapped = false;
+}
 
+Position3d ParticleEmitter::generateSpawnPosition() {
     if (emissionType == ParticleEmissionType::Ambient) {
         Position3d spawnPos = position;
 
@@ -210,7 +407,7 @@ Position3d ParticleEmitter::generateSpawnPosition() {
         return position;
     }
 
-    float angle = randAngle(rng);
+    float angle = rand01(rng) * 2.0f * std::numbers::pi_v<float>;
     float radius = rand01(rng) * spawnRadius;
 
     Position3d spawnPos = position;
@@ -221,13 +418,6 @@ Position3d ParticleEmitter::generateSpawnPosition() {
 }
 
 Magnitude3d ParticleEmitter::generateRandomVelocity() {
-    static std::default_random_engine rng([]
-    {
-        std::random_device rd;
-        return std::default_random_engine(rd());
-    }());
-    static std::uniform_real_distribution<float> rand01(0.0f, 1.0f);
-
     Magnitude3d vel = direction;
 
     if (emissionType == ParticleEmissionType::Fountain) {
@@ -250,31 +440,20 @@ Magnitude3d ParticleEmitter::generateRandomVelocity() {
     return vel;
 }
 
-int ParticleEmitter::findInactiveParticle() {
-    for (size_t i = 0; i < particles.size(); ++i) {
-        if (!particles.at(i).active) {
-            return i;
-        }
-    }
-    return -1;
-}
-
-void ParticleEmitter::activateParticle(int index) {
-    if (index < 0 || std::cmp_greater_equal(index, particles.size()))
-        return;
-
-    static std::default_random_engine rng([]
-    {
-        std::random_device rd;
-        return std::default_random_engine(rd());
-    }());
-    static std::uniform_real_distribution<float> rand01(0.0f, 1.0f);
-
-    Particle& p = particles.at(index);
-    p.active = true;
-    p.position = generateSpawnPosition();
-    p.velocity = generateRandomVelocity();
-    p.color = color;
+ParticleSlot ParticleEmitter::makeParticle() {
+    Position3d spawnPos = generateSpawnPosition();
+    Magnitude3d velocity = generateRandomVelocity();
+    ParticleSlot slot;
+    slot.posX = spawnPos.x;
+    slot.posY = spawnPos.y;
+    slot.posZ = spawnPos.z;
+    slot.velX = velocity.x;
+    slot.velY = velocity.y;
+    slot.velZ = velocity.z;
+    slot.colorR = color.r;
+    slot.colorG = color.g;
+    slot.colorB = color.b;
+    slot.colorA = color.a;
 
     float baseLifetime =
         settings.minLifetime +
@@ -291,13 +470,65 @@ void ParticleEmitter::activateParticle(int index) {
             std::clamp(1.0f + (heightDifference * 0.1f), 1.0f, 3.0f);
     }
 
-    p.life = baseLifetime * heightMultiplier;
-    p.maxLife = p.life;
-    p.size =
+    slot.life = baseLifetime * heightMultiplier;
+    slot.maxLife = slot.life;
+    slot.size =
         settings.minSize + ((settings.maxSize - settings.minSize) * rand01(rng));
+    return slot;
 }
 
-void ParticleEmitter::update(Window& window) {
+void ParticleEmitter::activateParticle(size_t index) {
+    if (index >= particles.getCount())
+        return;
+
+    const ParticleSlot slot = makeParticle();
+    particles.positionX[index] = slot.posX;
+    particles.positionY[index] = slot.posY;
+    particles.positionZ[index] = slot.posZ;
+    particles.velocityX[index] = slot.velX;
+    particles.velocityY[index] = slot.velY;
+    particles.velocityZ[index] = slot.velZ;
+    particles.colorR[index] = slot.colorR;
+    particles.colorG[index] = slot.colorG;
+    particles.colorB[index] = slot.colorB;
+    particles.colorA[index] = slot.colorA;
+    particles.life[index] = slot.life;
+    particles.maxLife[index] = slot.maxLife;
+    particles.size[index] = slot.size;
+}
+
+void ParticleEmitter::respawnParticle(size_t index) {
+    Position3d spawnPos = generateSpawnPosition();
+    Magnitude3d velocity = generateRandomVelocity();
+    particles.positionX[index] = spawnPos.x;
+    particles.positionY[index] = spawnPos.y;
+    particles.positionZ[index] = spawnPos.z;
+    particles.velocityX[index] = velocity.x;
+    particles.velocityY[index] = velocity.y;
+    particles.velocityZ[index] = velocity.z;
+    particles.life[index] = particles.maxLife[index];
+    particles.colorA[index] = 1.0f;
+}
+
+Particle ParticleEmitter::getParticle(unsigned int index) const {
+    Particle p{};
+    if (index >= particles.getCount()) {
+        return p;
+    }
+    p.position = {particles.positionX[index], particles.positionY[index],
+                  particles.positionZ[index]};
+    p.velocity = {particles.velocityX[index], particles.velocityY[index],
+                  particles.velocityZ[index]};
+    p.color = {particles.colorR[index], particles.colorG[index],
+               particles.colorB[index], particles.colorA[index]};
+    p.life = particles.life[index];
+    p.maxLife = particles.maxLife[index];
+    p.size = particles.size[index];
+    p.active = true;
+    return p;
+}
+
+void ParticleEmitter::prepareStep(Window& window) {
     float dt = window.getDeltaTime();
     Camera* cam = window.getCamera();
     this->model = glm::translate(
@@ -326,37 +557,80 @@ void ParticleEmitter::update(Window& window) {
         }
     }
 
-    for (auto& p : particles) {
-        updateParticle(p, dt);
-    }
+    frameConstants = makeFrameConstants(window, dt);
+}
 
-    std::vector<ParticleInstanceData> instanceData;
-    instanceData.reserve(maxParticles);
+void ParticleEmitter::update(Window& window) {
+    if (lastSimulatedFrame == window.device->frameCount) {
+        return;
+    }
+    updateEmitters(window, {this});
+}
 
-    for (const auto& p : particles) {
-        if (p.active) {
-            ParticleInstanceData data;
-            data.posX = static_cast<float>(p.position.x);
-            data.posY = static_cast<float>(p.position.y);
-            data.posZ = static_cast<float>(p.position.z);
-            data.colorR = static_cast<float>(p.color.r);
-            data.colorG = static_cast<float>(p.color.g);
-            data.colorB = static_cast<float>(p.color.b);
-            data.colorA = static_cast<float>(p.color.a);
-            data.size = p.size;
-            instanceData.push_back(data);
+void ParticleEmitter::updateEmitters(
+    Window& window, const std::vector<ParticleEmitter*>& emitters) {
+    const long frame = window.device->frameCount;
+    std::vector<ParticleEmitter*> stepped;
+    std::vector<ParticleChunk> chunks;
+    stepped.reserve(emitters.size());
+
+    // Spawning touches the scene and the camera, and compute dispatches
+    // record into the frame command buffer, keep both on this thread.
+    for (auto* emitter : emitters) {
+        if (emitter == nullptr || emitter->lastSimulatedFrame == frame) {
+            continue;
         }
+        emitter->lastSimulatedFrame = frame;
+        emitter->prepareStep(window);
+        if (emitter->computeActive) {
+            emitter->dispatchCompute(window);
+            continue;
+        }
+        appendChunks(chunks, emitter, emitter->particles.getCount());
+        stepped.push_back(emitter);
+    }
+    if (stepped.empty()) {
+        return;
     }
 
-    if (instanceBuffer != nullptr && !instanceData.empty()) {
-        instanceBuffer->bind();
-        instanceBuffer->updateData(
-            0, instanceData.size() * sizeof(ParticleInstanceData),
-            instanceData.data());
-        instanceBuffer->unbind();
+    JobSystem& jobs = JobSystem::getInstance();
+    jobs.parallelFor(chunks.size(), 1, [&chunks](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            const ParticleChunk& chunk = chunks[i];
+            integrateParticles(chunk.emitter->particles,
+                               chunk.emitter->frameConstants, chunk.begin,
+                               chunk.end);
+        }
+    });
+
+    // Retiring reorders the whole store, so it runs once per emitter.
+    jobs.parallelFor(stepped.size(), 1, [&stepped](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            stepped[i]->retireParticles();
+        }
+    });
+
+    // Mapping and uploading have to happen on the thread owning the device.
+    chunks.clear();
+    for (auto* emitter : stepped) {
+        emitter->beginUpload();
+        if (emitter->uploadTarget != nullptr) {
+            appendChunks(chunks, emitter, emitter->activeParticleCount);
+        }
     }
 
-    activeParticleCount = instanceData.size();
+    jobs.parallelFor(chunks.size(), 1, [&chunks](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            const ParticleChunk& chunk = chunks[i];
+            writeParticleInstances(chunk.emitter->particles,
+                                   chunk.emitter->uploadTarget + chunk.begin,
+                                   chunk.begin, chunk.end);
+        }
+    });
+
+    for (auto* emitter : stepped) {
+        emitter->finishUpload();
+    }
 }
 
 void ParticleEmitter::render(float dt,
@@ -366,7 +640,7 @@ void ParticleEmitter::render(float dt,
     for (auto& component : components) {
         component->update(dt);
     }
-    if (activeParticleCount == 0)
+    if (activeParticleCount == 0 && !computeActive)
         return;
     if (commandBuffer == nullptr) {
         atlas_error("ParticleEmitter::render requires a valid command buffer");
@@ -398,9 +672,16 @@ void ParticleEmitter::render(float dt,
         particlePipeline->bindTexture2D("particleTexture", texture.id, 0, id);
     }
 
-    commandBuffer->bindDrawingState(vao);
-    commandBuffer->bindPipeline(particlePipeline);
-    commandBuffer->drawIndexed(6, activeParticleCount, 0, 0, 0, id);
+    if (computeActive) {
+        commandBuffer->bindDrawingState(computeVao);
+        commandBuffer->bindPipeline(particlePipeline);
+        commandBuffer->drawIndexedIndirect(computeArguments[computeFrame], 0,
+                                           id);
+    } else {
+        commandBuffer->bindDrawingState(vao);
+        commandBuffer->bindPipeline(particlePipeline);
+        commandBuffer->drawIndexed(6, activeParticleCount, 0, 0, 0, id);
+    }
     commandBuffer->unbindDrawingState();
 
     particlePipeline->enableDepthWrite(true);
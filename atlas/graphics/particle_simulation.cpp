@@ -0,0 +1,365 @@
+//
+// particle_simulation.cpp
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: SIMD particle integration kernel
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#include "atlas/particle_simulation.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ATLAS_PARTICLES_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define ATLAS_PARTICLES_NEON
+#endif
+
+namespace {
+
+// Thin wrapper over four float lanes. Every backend performs the same
+// operations in the same order, so results only depend on the input.
+#if defined(ATLAS_PARTICLES_SSE2)
+using Lanes = __m128;
+
+inline Lanes loadLanes(const float *p) { return _mm_loadu_ps(p); }
+inline void storeLanes(float *p, Lanes v) { _mm_storeu_ps(p, v); }
+inline Lanes splat(float v) { return _mm_set1_ps(v); }
+inline Lanes add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+inline Lanes sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+inline Lanes mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+inline Lanes divide(Lanes a, Lanes b) { return _mm_div_ps(a, b); }
+inline Lanes absolute(Lanes a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline Lanes roundNearest(Lanes a) {
+    return _mm_cvtepi32_ps(_mm_cvtps_epi32(a));
+}
+#elif defined(ATLAS_PARTICLES_NEON)
+using Lanes = float32x4_t;
+
+inline Lanes loadLanes(const float *p) { return vld1q_f32(p); }
+inline void storeLanes(float *p, Lanes v) { vst1q_f32(p, v); }
+inline Lanes splat(float v) { return vdupq_n_f32(v); }
+inline Lanes add(Lanes a, Lanes b) { return vaddq_f32(a, b); }
+inline Lanes sub(Lanes a, Lanes b) { return vsubq_f32(a, b); }
+inline Lanes mul(Lanes a, Lanes b) { return vmulq_f32(a, b); }
+inline Lanes divide(Lanes a, Lanes b) { return vdivq_f32(a, b); }
+inline Lanes absolute(Lanes a) { return vabsq_f32(a); }
+inline Lanes roundNearest(Lanes a) { return vcvtq_f32_s32(vcvtnq_s32_f32(a)); }
+#else
+struct Lanes {
+    float v[4];
+};
+
+template <typename Op> inline Lanes apply(Lanes a, Lanes b, Op op) {
+    return {{op(a.v[0], b.v[0]), op(a.v[1], b.v[1]), op(a.v[2], b.v[2]),
+             op(a.v[3], b.v[3])}};
+}
+
+inline Lanes loadLanes(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void storeLanes(float *p, Lanes v) { std::copy(v.v, v.v + 4, p); }
+inline Lanes splat(float v) { return {{v, v, v, v}}; }
+inline Lanes add(Lanes a, Lanes b) {
+    return apply(a, b, [](float x, float y) { return x + y; });
+}
+inline Lanes sub(Lanes a, Lanes b) {
+    return apply(a, b, [](float x, float y) { return x - y; });
+}
+inline Lanes mul(Lanes a, Lanes b) {
+    return apply(a, b, [](float x, float y) { return x * y; });
+}
+inline Lanes divide(Lanes a, Lanes b) {
+    return apply(a, b, [](float x, float y) { return x / y; });
+}
+inline Lanes absolute(Lanes a) {
+    return {{std::fabs(a.v[0]), std::fabs(a.v[1]), std::fabs(a.v[2]),
+             std::fabs(a.v[3])}};
+}
+inline Lanes roundNearest(Lanes a) {
+    return {{std::nearbyint(a.v[0]), std::nearbyint(a.v[1]),
+             std::nearbyint(a.v[2]), std::nearbyint(a.v[3])}};
+}
+#endif
+
+// Parabolic sine approximation with one refinement step. It is accurate to
+// about 0.001, plenty for the sway, and avoids calling std::sin per lane.
+inline Lanes fastSin(Lanes x) {
+    constexpr float pi = std::numbers::pi_v<float>;
+    x = sub(x, mul(splat(2.0f * pi), roundNearest(mul(x, splat(0.5f / pi)))));
+    Lanes y = add(mul(splat(4.0f / pi), x),
+                  mul(mul(splat(-4.0f / (pi * pi)), x), absolute(x)));
+    return add(mul(splat(0.225f), sub(mul(y, absolute(y)), y)), y);
+}
+
+size_t roundUpToLanes(size_t value) {
+    constexpr size_t width = ParticleStore::LANE_WIDTH;
+    return (value + width - 1) / width * width;
+}
+
+// Per-step values splatted across the lanes once.
+struct StepLanes {
+    Lanes dt;
+    Lanes gravityStep;
+    Lanes windStepX, windStepY, windStepZ;
+    Lanes swayStep;
+    Lanes swayScale;
+    Lanes swayPhaseX, swayPhaseZ;
+    bool ambientSway;
+};
+
+StepLanes makeStepLanes(float dtScalar, float time, float gravity,
+                        float windX, float windY, float windZ, bool sway) {
+    constexpr float pi = std::numbers::pi_v<float>;
+    return {
+        .dt = splat(dtScalar),
+        .gravityStep = splat(gravity * dtScalar),
+        .windStepX = splat(windX * dtScalar),
+        .windStepY = splat(windY * dtScalar),
+        .windStepZ = splat(windZ * dtScalar),
+        .swayStep = splat(0.02f * dtScalar),
+        .swayScale = splat(0.1f),
+        .swayPhaseX = splat(time),
+        // cos(t) is evaluated as sin(t + pi / 2).
+        .swayPhaseZ = splat((time * 0.8f) + (pi * 0.5f)),
+        .ambientSway = sway,
+    };
+}
+
+// The whole step of four particles. Both the SoA kernel and the compute
+// reference go through here so their results stay bit-identical.
+inline void stepLanes(const StepLanes &c, Lanes &x, Lanes &y, Lanes &z,
+                      Lanes &vx, Lanes &vy, Lanes &vz, Lanes &life,
+                      Lanes maxLife, Lanes &alpha) {
+    life = sub(life, c.dt);
+    vy = add(vy, c.gravityStep);
+
+    if (c.ambientSway) {
+        vx = add(vx, mul(fastSin(add(c.swayPhaseX, mul(x, c.swayScale))),
+                         c.swayStep));
+        vz = add(vz, mul(fastSin(add(c.swayPhaseZ, mul(z, c.swayScale))),
+                         c.swayStep));
+    }
+
+    vx = add(vx, c.windStepX);
+    vy = add(vy, c.windStepY);
+    vz = add(vz, c.windStepZ);
+
+    x = add(x, mul(vx, c.dt));
+    y = add(y, mul(vy, c.dt));
+    z = add(z, mul(vz, c.dt));
+    alpha = divide(life, maxLife);
+}
+
+} // namespace
+
+void ParticleStore::reserve(size_t newCapacity) {
+    capacity = newCapacity;
+    count = 0;
+
+    const size_t padded = roundUpToLanes(newCapacity);
+    for (auto *array : {&positionX, &positionY, &positionZ, &velocityX,
+                        &velocityY, &velocityZ, &colorR, &colorG, &colorB,
+                        &colorA, &life, &size}) {
+        array->assign(padded, 0.0f);
+    }
+    // Unused slots still go through the kernel, keep their fade finite.
+    maxLife.assign(padded, 1.0f);
+}
+
+size_t ParticleStore::spawn() {
+    if (count >= capacity) {
+        return npos;
+    }
+    return count++;
+}
+
+void ParticleStore::remove(size_t index) {
+    if (index >= count) {
+        return;
+    }
+    const size_t last = --count;
+    if (index == last) {
+        return;
+    }
+    for (auto *array : {&positionX, &positionY, &positionZ, &velocityX,
+                        &velocityY, &velocityZ, &colorR, &colorG, &colorB,
+                        &colorA, &life, &maxLife, &size}) {
+        (*array)[index] = (*array)[last];
+    }
+}
+
+void integrateParticles(ParticleStore &store,
+                        const ParticleFrameConstants &constants, size_t begin,
+                        size_t end) {
+    constexpr size_t width = ParticleStore::LANE_WIDTH;
+
+    end = std::min(roundUpToLanes(end), store.life.size());
+    if (begin >= end) {
+        return;
+    }
+
+    const StepLanes step = makeStepLanes(
+        constants.deltaTime, constants.time, constants.gravity,
+        constants.windX, constants.windY, constants.windZ,
+        constants.ambientSway);
+
+    float *px = store.positionX.data();
+    float *py = store.positionY.data();
+    float *pz = store.positionZ.data();
+    float *vxs = store.velocityX.data();
+    float *vys = store.velocityY.data();
+    float *vzs = store.velocityZ.data();
+    float *lives = store.life.data();
+    float *alphas = store.colorA.data();
+    const float *maxLives = store.maxLife.data();
+
+    for (size_t i = begin; i < end; i += width) {
+        Lanes x = loadLanes(px + i);
+        Lanes y = loadLanes(py + i);
+        Lanes z = loadLanes(pz + i);
+        Lanes vx = loadLanes(vxs + i);
+        Lanes vy = loadLanes(vys + i);
+        Lanes vz = loadLanes(vzs + i);
+        Lanes life = loadLanes(lives + i);
+        Lanes alpha;
+        stepLanes(step, x, y, z, vx, vy, vz, life, loadLanes(maxLives + i),
+                  alpha);
+
+        storeLanes(px + i, x);
+        storeLanes(py + i, y);
+        storeLanes(pz + i, z);
+        storeLanes(vxs + i, vx);
+        storeLanes(vys + i, vy);
+        storeLanes(vzs + i, vz);
+        storeLanes(lives + i, life);
+        storeLanes(alphas + i, alpha);
+    }
+}
+
+void writeParticleInstances(const ParticleStore &store,
+                            ParticleInstanceData *out, size_t begin,
+                            size_t end) {
+    end = std::min(end, store.getCount());
+    for (size_t i = begin; i < end; i++) {
+        ParticleInstanceData &data = out[i - begin];
+        data.posX = store.positionX[i];
+        data.posY = store.positionY[i];
+        data.posZ = store.positionZ[i];
+        data.colorR = store.colorR[i];
+        data.colorG = store.colorG[i];
+        data.colorB = store.colorB[i];
+        data.colorA = store.colorA[i];
+        data.size = store.size[i];
+    }
+}
+
+size_t simulateParticleSlots(std::vector<ParticleSlot> &slots,
+                             const ParticleSlot *spawned,
+                             const ParticleComputeParams &params,
+                             ParticleInstanceData *instances) {
+    constexpr size_t width = ParticleStore::LANE_WIDTH;
+    const size_t capacity = std::min<size_t>(params.capacity, slots.size());
+    if (capacity == 0) {
+        return 0;
+    }
+
+    const size_t spawnCount = std::min<size_t>(params.spawnCount, capacity);
+    for (size_t i = 0; i < spawnCount && spawned != nullptr; i++) {
+        slots[(params.spawnCursor + i) % capacity] = spawned[i];
+    }
+
+    const StepLanes step =
+        makeStepLanes(params.deltaTime, params.time, params.gravity,
+                      params.windX, params.windY, params.windZ,
+                      params.ambient != 0);
+
+    // Gather live slots four at a time so they go through the same lane
+    // arithmetic as the SoA kernel.
+    size_t live[width];
+    size_t liveCount = 0;
+    size_t instanceCount = 0;
+    auto flush = [&]() {
+        float values[9][width] = {};
+        for (size_t lane = 0; lane < width; lane++) {
+            const ParticleSlot &p = slots[live[std::min(lane, liveCount - 1)]];
+            values[0][lane] = p.posX;
+            values[1][lane] = p.posY;
+            values[2][lane] = p.posZ;
+            values[3][lane] = p.velX;
+            values[4][lane] = p.velY;
+            values[5][lane] = p.velZ;
+            values[6][lane] = p.life;
+            values[7][lane] = p.maxLife;
+        }
+
+        Lanes x = loadLanes(values[0]);
+        Lanes y = loadLanes(values[1]);
+        Lanes z = loadLanes(values[2]);
+        Lanes vx = loadLanes(values[3]);
+        Lanes vy = loadLanes(values[4]);
+        Lanes vz = loadLanes(values[5]);
+        Lanes life = loadLanes(values[6]);
+        Lanes alpha;
+        stepLanes(step, x, y, z, vx, vy, vz, life, loadLanes(values[7]),
+                  alpha);
+        storeLanes(values[0], x);
+        storeLanes(values[1], y);
+        storeLanes(values[2], z);
+        storeLanes(values[3], vx);
+        storeLanes(values[4], vy);
+        storeLanes(values[5], vz);
+        storeLanes(values[6], life);
+        storeLanes(values[8], alpha);
+
+        for (size_t lane = 0; lane < liveCount; lane++) {
+            ParticleSlot &p = slots[live[lane]];
+            p.posX = values[0][lane];
+            p.posY = values[1][lane];
+            p.posZ = values[2][lane];
+            p.velX = values[3][lane];
+            p.velY = values[4][lane];
+            p.velZ = values[5][lane];
+            p.life = values[6][lane];
+            p.colorA = values[8][lane];
+
+            if (params.ambient != 0 &&
+                (p.posY < params.originY - 15.0f ||
+                 std::fabs(p.posX - params.originX) > 25.0f ||
+                 std::fabs(p.posZ - params.originZ) > 25.0f)) {
+                p.life = 0.0f;
+            }
+            if (p.life <= 0.0f) {
+                continue;
+            }
+
+            ParticleInstanceData &data = instances[instanceCount++];
+            data.posX = p.posX;
+            data.posY = p.posY;
+            data.posZ = p.posZ;
+            data.colorR = p.colorR;
+            data.colorG = p.colorG;
+            data.colorB = p.colorB;
+            data.colorA = p.colorA;
+            data.size = p.size;
+        }
+        liveCount = 0;
+    };
+
+    for (size_t i = 0; i < capacity; i++) {
+        if (slots[i].life <= 0.0f) {
+            continue;
+        }
+        live[liveCount++] = i;
+        if (liveCount == width) {
+            flush();
+        }
+    }
+    if (liveCount > 0) {
+        flush();
+    }
+    return instanceCount;
+}
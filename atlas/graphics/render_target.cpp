@@ -24,7 +24,7 @@
 #include "opal/opal.h"
 
 RenderTarget::RenderTarget(Window &window, RenderTargetType type,
-                           int resolution) {
+                           int resolution, float renderScale) {
     atlas_log("Creating render target (type: " +
               std::to_string(static_cast<int>(type)) + ")");
     int fbWidth, fbHeight;
@@ -34,6 +34,9 @@ RenderTarget::RenderTarget(Window &window, RenderTargetType type,
     if (type == RenderTargetType::SSAO || type == RenderTargetType::SSAOBlur) {
         targetScale = window.getSSAORenderScale();
     }
+    if (renderScale > 0.0f) {
+        targetScale = renderScale;
+    }
     targetScale = std::clamp(targetScale, 0.1f, 1.0f);
 
     int scaledWidth = std::max(1, static_cast<int>(fbWidth * targetScale));
@@ -29,6 +29,101 @@
 
 namespace {
 
+constexpr int MAX_BOUND_TEXTURES = 16;
+
+std::vector<opal::UniformHandle> makeNumberedUniforms(const std::string &prefix,
+                                                      int count) {
+    std::vector<opal::UniformHandle> handles;
+    handles.reserve(count);
+    for (int i = 1; i <= count; i++) {
+        handles.emplace_back(prefix + std::to_string(i));
+    }
+    return handles;
+}
+
+struct ShadowParamUniforms {
+    opal::UniformHandle textureIndex;
+    opal::UniformHandle lightView;
+    opal::UniformHandle lightProjection;
+    opal::UniformHandle bias;
+    opal::UniformHandle farPlane;
+    opal::UniformHandle lightPos;
+    opal::UniformHandle lightType;
+};
+
+std::vector<ShadowParamUniforms> makeShadowParamUniforms(int count) {
+    std::vector<ShadowParamUniforms> uniforms;
+    uniforms.reserve(count);
+    for (int i = 0; i < count; i++) {
+        const std::string base = "shadowParams[" + std::to_string(i) + "].";
+        uniforms.push_back({
+            opal::UniformHandle(base + "textureIndex"),
+            opal::UniformHandle(base + "lightView"),
+            opal::UniformHandle(base + "lightProjection"),
+#ifdef METAL
+            opal::UniformHandle(base + "bias0"),
+#else
+            opal::UniformHandle(base + "bias"),
+#endif
+            opal::UniformHandle(base + "farPlane"),
+            opal::UniformHandle(base + "lightPos"),
+            opal::UniformHandle(base + "lightType"),
+        });
+    }
+    return uniforms;
+}
+
+// Every uniform CoreObject::render sets, hashed once instead of per draw.
+struct ObjectUniforms {
+    opal::UniformHandle isInstanced{"isInstanced"};
+    opal::UniformHandle model{"model"};
+    opal::UniformHandle view{"view"};
+    opal::UniformHandle projection{"projection"};
+    opal::UniformHandle useColor{"useColor"};
+    opal::UniformHandle useTexture{"useTexture"};
+    opal::UniformHandle textureCount{"textureCount"};
+    opal::UniformHandle cubeMapCount{"cubeMapCount"};
+    opal::UniformHandle normalMapStrength{"normalMapStrength"};
+    opal::UniformHandle useNormalMap{"useNormalMap"};
+    opal::UniformHandle cameraPosition{"cameraPosition"};
+    opal::UniformHandle materialAlbedo{"material.albedo"};
+    opal::UniformHandle materialMetallic{"material.metallic"};
+    opal::UniformHandle materialRoughness{"material.roughness"};
+    opal::UniformHandle materialAo{"material.ao"};
+    opal::UniformHandle materialReflectivity{"material.reflectivity"};
+    opal::UniformHandle albedo{"albedo"};
+    opal::UniformHandle metallic{"metallic"};
+    opal::UniformHandle roughness{"roughness"};
+    opal::UniformHandle ao{"ao"};
+    opal::UniformHandle reflectivity{"reflectivity"};
+    opal::UniformHandle useIBL{"useIBL"};
+    opal::UniformHandle ambientColor{"ambientLight.color"};
+    opal::UniformHandle ambientIntensity{"ambientLight.intensity"};
+    opal::UniformHandle gPosition{"gPosition"};
+    opal::UniformHandle gNormal{"gNormal"};
+    opal::UniformHandle gAlbedoSpec{"gAlbedoSpec"};
+    opal::UniformHandle gMaterial{"gMaterial"};
+    opal::UniformHandle shadowParamCount{"shadowParamCount"};
+    opal::UniformHandle skybox{"skybox"};
+    opal::UniformHandle rimLightIntensity{"environment.rimLightIntensity"};
+    opal::UniformHandle rimLightColor{"environment.rimLightColor"};
+    std::vector<opal::UniformHandle> textureSlots =
+        makeNumberedUniforms("texture", 10);
+    std::vector<opal::UniformHandle> cubeMaps =
+        makeNumberedUniforms("cubeMap", 5);
+    std::vector<opal::UniformHandle> textureTypes =
+        opal::UniformHandle::array("textureTypes", MAX_BOUND_TEXTURES);
+    std::vector<opal::UniformHandle> textureArray =
+        opal::UniformHandle::array("textures", MAX_BOUND_TEXTURES);
+    std::vector<ShadowParamUniforms> shadowParams =
+        makeShadowParamUniforms(MAX_BOUND_TEXTURES);
+};
+
+const ObjectUniforms &objectUniforms() {
+    static const ObjectUniforms uniforms;
+    return uniforms;
+}
+
 std::vector<opal::VertexAttributeBinding>
 makeInstanceAttributeBindings(const std::shared_ptr<opal::Buffer> &buffer) {
     std::vector<opal::VertexAttributeBinding> bindings;
@@ -50,115 +145,6 @@ makeInstanceAttributeBindings(const std::shared_ptr<opal::Buffer> &buffer) {
     return bindings;
 }
 
-std::vector<GPUDirectionalLight>
-buildGPUDirectionalLights(const std::vector<DirectionalLight *> &lights,
-                          int maxCount) {
-    std::vector<GPUDirectionalLight> result;
-    int count = std::min(static_cast<int>(lights.size()), maxCount);
-    result.reserve(count);
-    for (int i = 0; i < count; i++) {
-        DirectionalLight *light = lights[i];
-        GPUDirectionalLight gpu;
-        gpu.direction = glm::vec3(light->direction.x, light->direction.y,
-                                  light->direction.z);
-        gpu.diffuse = glm::vec3(light->color.r, light->color.g, light->color.b);
-        gpu.specular = glm::vec3(light->shineColor.r, light->shineColor.g,
-                                 light->shineColor.b);
-        gpu._pad1 = 0.0f;
-        gpu._pad2 = 0.0f;
-        gpu.intensity = light->intensity;
-        result.push_back(gpu);
-    }
-    return result;
-}
-
-std::vector<GPUPointLight>
-buildGPUPointLights(const std::vector<Light *> &lights, int maxCount) {
-    std::vector<GPUPointLight> result;
-    int count = std::min(static_cast<int>(lights.size()), maxCount);
-    result.reserve(count);
-    for (int i = 0; i < count; i++) {
-        Light *light = lights[i];
-        PointLightConstants plc = light->calculateConstants();
-        GPUPointLight gpu;
-        gpu.position =
-            glm::vec3(light->position.x, light->position.y, light->position.z);
-        gpu.diffuse = glm::vec3(light->color.r, light->color.g, light->color.b);
-        gpu.specular = glm::vec3(light->shineColor.r, light->shineColor.g,
-                                 light->shineColor.b);
-        gpu.intensity = light->intensity;
-        gpu.constant = plc.constant;
-        gpu.linear = plc.linear;
-        gpu.quadratic = plc.quadratic;
-        gpu.radius = plc.radius;
-        gpu._pad1 = 0.0f;
-        gpu._pad2 = 0.0f;
-        gpu._pad3 = 0.0f;
-        result.push_back(gpu);
-    }
-    return result;
-}
-
-std::vector<GPUSpotLight>
-buildGPUSpotLights(const std::vector<Spotlight *> &lights, int maxCount) {
-    std::vector<GPUSpotLight> result;
-    int count = std::min(static_cast<int>(lights.size()), maxCount);
-    result.reserve(count);
-    for (int i = 0; i < count; i++) {
-        Spotlight *light = lights[i];
-        GPUSpotLight gpu;
-        gpu.position =
-            glm::vec3(light->position.x, light->position.y, light->position.z);
-        gpu.direction = glm::vec3(light->direction.x, light->direction.y,
-                                  light->direction.z);
-        gpu.cutOff = light->cutOff;
-        gpu.outerCutOff = light->outerCutoff;
-        gpu.diffuse = glm::vec3(light->color.r, light->color.g, light->color.b);
-        gpu.specular = glm::vec3(light->shineColor.r, light->shineColor.g,
-                                 light->shineColor.b);
-        gpu._pad1 = 0.0f;
-        gpu.intensity = light->intensity;
-        gpu.range = light->range;
-        gpu._pad4 = 0.0f;
-        gpu._pad5 = 0.0f;
-        gpu._pad6 = 0.0f;
-        result.push_back(gpu);
-    }
-    return result;
-}
-
-std::vector<GPUAreaLight>
-buildGPUAreaLights(const std::vector<AreaLight *> &lights, int maxCount) {
-    std::vector<GPUAreaLight> result;
-    int count = std::min(static_cast<int>(lights.size()), maxCount);
-    result.reserve(count);
-    for (int i = 0; i < count; i++) {
-        AreaLight *light = lights[i];
-        GPUAreaLight gpu;
-        gpu.position =
-            glm::vec3(light->position.x, light->position.y, light->position.z);
-        gpu.right = glm::vec3(light->right.x, light->right.y, light->right.z);
-        gpu.up = glm::vec3(light->up.x, light->up.y, light->up.z);
-        gpu.size = glm::vec2(light->size.width, light->size.height);
-        gpu.diffuse = glm::vec3(light->color.r, light->color.g, light->color.b);
-        gpu.specular = glm::vec3(light->shineColor.r, light->shineColor.g,
-                                 light->shineColor.b);
-        gpu.angle = light->angle;
-        gpu.castsBothSides = light->castsBothSides ? 1 : 0;
-        gpu._pad1 = 0.0f;
-        gpu._pad2 = 0.0f;
-        gpu._pad3 = 0.0f;
-        gpu._pad4 = 0.0f;
-        gpu._pad5 = 0.0f;
-        gpu._pad6 = 0.0f;
-        gpu.intensity = light->intensity;
-        gpu.range = light->range;
-        gpu._pad9 = 0.0f;
-        result.push_back(gpu);
-    }
-    return result;
-}
-
 } // namespace
 
 std::vector<LayoutDescriptor> CoreVertex::getLayoutDescriptors() {
@@ -240,6 +226,7 @@ void CoreObject::attachVertices(const std::vector<CoreVertex> &newVertices) {
     }
 
     vertices = newVertices;
+    localBoundsDirty = true;
 }
 
 void CoreObject::attachIndices(const std::vector<Index> &newIndices) {
@@ -379,6 +366,50 @@ void CoreObject::updateModelMatrix() {
         glm::translate(glm::mat4(1.0f), position.toGlm());
 
     model = translation_matrix * rotation_matrix * scale_matrix;
+    worldBoundsDirty = true;
+}
+
+std::optional<BoundingBox> CoreObject::getWorldBounds() {
+    if (vertices.empty()) {
+        return std::nullopt;
+    }
+
+    if (localBoundsDirty || localBoundsVertexCount != vertices.size()) {
+        glm::vec3 boundsMin = vertices[0].position.toGlm();
+        glm::vec3 boundsMax = boundsMin;
+        for (const auto &vertex : vertices) {
+            boundsMin = glm::min(boundsMin, vertex.position.toGlm());
+            boundsMax = glm::max(boundsMax, vertex.position.toGlm());
+        }
+        localBounds = {Position3d::fromGlm(boundsMin),
+                       Position3d::fromGlm(boundsMax)};
+        localBoundsVertexCount = vertices.size();
+        localBoundsDirty = false;
+        worldBoundsDirty = true;
+    }
+
+    // Instance transforms can be edited directly, so they are not cached.
+    if (!instances.empty()) {
+        BoundingBox bounds =
+            localBounds.transformed(instances[0].getModelMatrix());
+        for (std::size_t i = 1; i < instances.size(); i++) {
+            bounds = bounds.merged(
+                localBounds.transformed(instances[i].getModelMatrix()));
+        }
+        return bounds;
+    }
+
+    if (worldBoundsDirty) {
+        worldBounds = localBounds.transformed(model);
+        worldBoundsDirty = false;
+    }
+    return worldBounds;
+}
+
+void CoreObject::renderCulled(float dt) {
+    for (auto &component : components) {
+        component->update(dt);
+    }
 }
 
 void CoreObject::initialize() {
@@ -560,14 +591,15 @@ void CoreObject::render(float dt,
             "Pipeline not created - call refreshPipeline() first");
     }
 
-    this->pipeline->setUniform1i("isInstanced", 0);
-    this->pipeline->setUniformBool("isInstanced", false);
-    this->pipeline->setUniformMat4f("model", model);
-    this->pipeline->setUniformMat4f("view", view);
-    this->pipeline->setUniformMat4f("projection", projection);
+    const ObjectUniforms &uniforms = objectUniforms();
+    this->pipeline->setUniform1i(uniforms.isInstanced, 0);
+    this->pipeline->setUniformBool(uniforms.isInstanced, false);
+    this->pipeline->setUniformMat4f(uniforms.model, model);
+    this->pipeline->setUniformMat4f(uniforms.view, view);
+    this->pipeline->setUniformMat4f(uniforms.projection, projection);
 
-    this->pipeline->setUniform1i("useColor", useColor ? 1 : 0);
-    this->pipeline->setUniform1i("useTexture", useTexture ? 1 : 0);
+    this->pipeline->setUniform1i(uniforms.useColor, useColor ? 1 : 0);
+    this->pipeline->setUniform1i(uniforms.useTexture, useTexture ? 1 : 0);
 
     int boundTextures = 0;
     int boundCubemaps = 0;
@@ -579,46 +611,43 @@ void CoreObject::render(float dt,
         shaderProgram.capabilities.end();
 
     if (shaderSupportsTextures) {
-        this->pipeline->setUniform1i("textureCount", 0);
-        this->pipeline->setUniform1i("cubeMapCount", 0);
+        this->pipeline->setUniform1i(uniforms.textureCount, 0);
+        this->pipeline->setUniform1i(uniforms.cubeMapCount, 0);
     }
 
     if (!textures.empty() && useTexture && shaderSupportsTextures) {
         int count = std::min((int)textures.size(), 10);
-        this->pipeline->setUniform1i("textureCount", count);
+        this->pipeline->setUniform1i(uniforms.textureCount, count);
 
         for (int i = 0; i < count; i++) {
-            std::string uniformName = "texture" + std::to_string(i + 1) + "";
+            const opal::UniformHandle &slot = uniforms.textureSlots[i];
             if (textures[i].texture != nullptr) {
-                this->pipeline->bindTexture(uniformName, textures[i].texture, i,
-                                            id);
+                this->pipeline->bindTexture(slot, textures[i].texture, i, id);
             } else {
-                this->pipeline->bindTexture2D(uniformName, textures[i].id, i,
-                                              id);
+                this->pipeline->bindTexture2D(slot, textures[i].id, i, id);
             }
             boundTextures++;
         }
 
-        this->pipeline->setUniform1i("cubeMapCount", 5);
+        this->pipeline->setUniform1i(uniforms.cubeMapCount, 5);
         for (int i = 0; i < 5; i++) {
-            std::string uniformName = "cubeMap" + std::to_string(i + 1) + "";
-            this->pipeline->setUniform1i(uniformName, i + 10);
+            this->pipeline->setUniform1i(uniforms.cubeMaps[i], i + 10);
         }
 
         for (int i = 0; i < count; i++) {
-            std::string uniformName = "textureTypes[" + std::to_string(i) + "]";
-            this->pipeline->setUniform1i(uniformName,
+            this->pipeline->setUniform1i(uniforms.textureTypes[i],
                                          static_cast<int>(textures[i].type));
         }
     }
     if (shaderSupportsTextures) {
-        this->pipeline->setUniform1f("normalMapStrength",
+        this->pipeline->setUniform1f(uniforms.normalMapStrength,
                                      material.normalMapStrength);
-        this->pipeline->setUniform1i("useNormalMap",
+        this->pipeline->setUniform1i(uniforms.useNormalMap,
                                      material.useNormalMap ? 1 : 0);
         if (Window::mainWindow != nullptr && Window::mainWindow->getCamera() != nullptr) {
             this->pipeline->setUniform3f(
-                "cameraPosition", Window::mainWindow->getCamera()->position.x,
+                uniforms.cameraPosition,
+                Window::mainWindow->getCamera()->position.x,
                 Window::mainWindow->getCamera()->position.y,
                 Window::mainWindow->getCamera()->position.z);
         }
@@ -628,20 +657,24 @@ void CoreObject::render(float dt,
                   shaderProgram.capabilities.end(),
                   ShaderCapability::Material) !=
         shaderProgram.capabilities.end()) {
-        this->pipeline->setUniform3f("material.albedo", material.albedo.r,
-                                     material.albedo.g, material.albedo.b);
-        this->pipeline->setUniform1f("material.metallic", material.metallic);
-        this->pipeline->setUniform1f("material.roughness", material.roughness);
-        this->pipeline->setUniform1f("material.ao", material.ao);
-        this->pipeline->setUniform1f("material.reflectivity",
+        this->pipeline->setUniform3f(uniforms.materialAlbedo,
+                                     material.albedo.r, material.albedo.g,
+                                     material.albedo.b);
+        this->pipeline->setUniform1f(uniforms.materialMetallic,
+                                     material.metallic);
+        this->pipeline->setUniform1f(uniforms.materialRoughness,
+                                     material.roughness);
+        this->pipeline->setUniform1f(uniforms.materialAo, material.ao);
+        this->pipeline->setUniform1f(uniforms.materialReflectivity,
                                      material.reflectivity);
 
-        this->pipeline->setUniform3f("albedo", material.albedo.r,
+        this->pipeline->setUniform3f(uniforms.albedo, material.albedo.r,
                                      material.albedo.g, material.albedo.b);
-        this->pipeline->setUniform1f("metallic", material.metallic);
-        this->pipeline->setUniform1f("roughness", material.roughness);
-        this->pipeline->setUniform1f("ao", material.ao);
-        this->pipeline->setUniform1f("reflectivity", material.reflectivity);
+        this->pipeline->setUniform1f(uniforms.metallic, material.metallic);
+        this->pipeline->setUniform1f(uniforms.roughness, material.roughness);
+        this->pipeline->setUniform1f(uniforms.ao, material.ao);
+        this->pipeline->setUniform1f(uniforms.reflectivity,
+                                     material.reflectivity);
     }
 
     const bool shaderSupportsIbl =
@@ -655,7 +688,7 @@ void CoreObject::render(float dt,
         });
 
     const bool useIbl = shaderSupportsIbl && hasHdrEnvironment;
-    this->pipeline->setUniformBool("useIBL", useIbl);
+    this->pipeline->setUniformBool(uniforms.useIBL, useIbl);
 
     if (std::find(shaderProgram.capabilities.begin(),
                   shaderProgram.capabilities.end(),
@@ -671,50 +704,16 @@ void CoreObject::render(float dt,
             ambientColor = scene->getAutomaticAmbientColor();
             ambientIntensity = scene->getAutomaticAmbientIntensity();
         }
-        this->pipeline->setUniform4f("ambientLight.color", ambientColor.r,
+        this->pipeline->setUniform4f(uniforms.ambientColor, ambientColor.r,
                                      ambientColor.g, ambientColor.b, 1.0f);
-        this->pipeline->setUniform1f("ambientLight.intensity",
+        this->pipeline->setUniform1f(uniforms.ambientIntensity,
                                      ambientIntensity);
 
         this->pipeline->setUniform3f(
-            "cameraPosition", window->getCamera()->position.x,
+            uniforms.cameraPosition, window->getCamera()->position.x,
             window->getCamera()->position.y, window->getCamera()->position.z);
 
-        int dirLightCount = std::min((int)scene->directionalLights.size(), 256);
-        this->pipeline->setUniform1i("directionalLightCount", dirLightCount);
-
-        if (dirLightCount > 0) {
-            auto gpuDirLights = buildGPUDirectionalLights(
-                scene->directionalLights, dirLightCount);
-            this->pipeline->bindBuffer("DirectionalLights", gpuDirLights);
-        }
-
-        int pointLightCount = std::min((int)scene->pointLights.size(), 256);
-        this->pipeline->setUniform1i("pointLightCount", pointLightCount);
-
-        if (pointLightCount > 0) {
-            auto gpuPointLights =
-                buildGPUPointLights(scene->pointLights, pointLightCount);
-            this->pipeline->bindBuffer("PointLights", gpuPointLights);
-        }
-
-        int spotlightCount = std::min((int)scene->spotlights.size(), 256);
-        this->pipeline->setUniform1i("spotlightCount", spotlightCount);
-
-        if (spotlightCount > 0) {
-            auto gpuSpotLights =
-                buildGPUSpotLights(scene->spotlights, spotlightCount);
-            this->pipeline->bindBuffer("SpotLights", gpuSpotLights);
-        }
-
-        int areaLightCount = std::min((int)scene->areaLights.size(), 256);
-        this->pipeline->setUniform1i("areaLightCount", areaLightCount);
-
-        if (areaLightCount > 0) {
-            auto gpuAreaLights =
-                buildGPUAreaLights(scene->areaLights, areaLightCount);
-            this->pipeline->bindBuffer("AreaLights", gpuAreaLights);
-        }
+        window->lightFrameData.bind(*this->pipeline);
     }
 
     if (std::find(shaderProgram.capabilities.begin(),
@@ -723,30 +722,34 @@ void CoreObject::render(float dt,
         shaderProgram.capabilities.end()) {
         Window *window = Window::mainWindow;
         RenderTarget *gBuffer = window->gBuffer.get();
-        this->pipeline->bindTexture2D("gPosition", gBuffer->gPosition.id,
+        this->pipeline->bindTexture2D(uniforms.gPosition, gBuffer->gPosition.id,
                                       boundTextures, id);
         boundTextures++;
 
-        this->pipeline->bindTexture2D("gNormal", gBuffer->gNormal.id,
+        this->pipeline->bindTexture2D(uniforms.gNormal, gBuffer->gNormal.id,
                                       boundTextures, id);
         boundTextures++;
 
-        this->pipeline->bindTexture2D("gAlbedoSpec", gBuffer->gAlbedoSpec.id,
-                                      boundTextures, id);
+        this->pipeline->bindTexture2D(uniforms.gAlbedoSpec,
+                                      gBuffer->gAlbedoSpec.id, boundTextures,
+                                      id);
         boundTextures++;
 
-        this->pipeline->bindTexture2D("gMaterial", gBuffer->gMaterial.id,
+        this->pipeline->bindTexture2D(uniforms.gMaterial, gBuffer->gMaterial.id,
                                       boundTextures, id);
         boundTextures++;
     }
 
-    if (std::find(shaderProgram.capabilities.begin(),
+    const bool receivesShadows =
+        std::find(shaderProgram.capabilities.begin(),
                   shaderProgram.capabilities.end(),
                   ShaderCapability::Shadows) !=
-        shaderProgram.capabilities.end()) {
+        shaderProgram.capabilities.end();
+    if (receivesShadows && Window::mainWindow->suppressShadows) {
+        this->pipeline->setUniform1i(uniforms.shadowParamCount, 0);
+    } else if (receivesShadows) {
         for (int i = 0; i < 5; i++) {
-            std::string uniformName = "cubeMap" + std::to_string(i + 1);
-            this->pipeline->setUniform1i(uniformName, i + 10);
+            this->pipeline->setUniform1i(uniforms.cubeMaps[i], i + 10);
         }
         Scene *scene = Window::mainWindow->currentScene;
 
@@ -759,31 +762,45 @@ void CoreObject::render(float dt,
             if (light->shadowRenderTarget == nullptr) {
                 continue;
             }
-            if (boundTextures >= 16) {
-                break;
-            }
 
-            std::string baseName =
-                "shadowParams[" + std::to_string(boundParameters) + "]";
-            this->pipeline->bindTexture2D(baseName + ".textureIndex",
-                                          light->shadowRenderTarget->texture.id,
-                                          boundTextures, id);
-            this->pipeline->setUniform1i(baseName + ".textureIndex",
-                                         boundTextures);
-            ShadowParams shadowParams = light->lastShadowParams;
-            this->pipeline->setUniformMat4f(baseName + ".lightView",
-                                            shadowParams.lightView);
-            this->pipeline->setUniformMat4f(baseName + ".lightProjection",
-                                            shadowParams.lightProjection);
-#ifdef METAL
-            this->pipeline->setUniform1f(baseName + ".bias0",
-                                         shadowParams.bias);
-#else
-            this->pipeline->setUniform1f(baseName + ".bias", shadowParams.bias);
-#endif
-            this->pipeline->setUniform1i(baseName + ".lightType", 0);
+            const std::vector<ShadowCascade> &cascades =
+                light->getShadowCascades();
+            if (cascades.empty() || boundTextures >= 16 ||
+                boundParameters >= MAX_BOUND_TEXTURES) {
+                continue;
+            }
 
-            boundParameters++;
+            // The cascades share one shadow map. The first entry is a
+            // directional shadow and the rest of the cascades follow it with
+            // lightType 4, so the shader can pick one of them per fragment.
+            this->pipeline->bindTexture2D(
+                uniforms.shadowParams[boundParameters].textureIndex,
+                light->shadowRenderTarget->texture.id, boundTextures, id);
+            for (std::size_t i = 0; i < cascades.size(); i++) {
+                if (boundParameters >= MAX_BOUND_TEXTURES) {
+                    break;
+                }
+
+                const ShadowCascade &cascade = cascades[i];
+                const ShadowParamUniforms &param =
+                    uniforms.shadowParams[boundParameters];
+                this->pipeline->setUniform1i(param.textureIndex,
+                                             boundTextures);
+                const ShadowParams &shadowParams = cascade.params;
+                this->pipeline->setUniformMat4f(param.lightView,
+                                                shadowParams.lightView);
+                this->pipeline->setUniformMat4f(param.lightProjection,
+                                                shadowParams.lightProjection);
+                this->pipeline->setUniform1f(param.bias, shadowParams.bias);
+                this->pipeline->setUniform1f(param.farPlane,
+                                             shadowParams.farPlane);
+                this->pipeline->setUniform3f(
+                    param.lightPos, cascade.viewDirection.x,
+                    cascade.viewDirection.y, cascade.viewDirection.z);
+                this->pipeline->setUniform1i(param.lightType, i == 0 ? 0 : 4);
+
+                boundParameters++;
+            }
             boundTextures++;
         }
 
@@ -794,29 +811,24 @@ void CoreObject::render(float dt,
             if (light->shadowRenderTarget == nullptr) {
                 continue;
             }
-            if (boundTextures >= 16) {
+            if (boundTextures >= 16 ||
+                boundParameters >= MAX_BOUND_TEXTURES) {
                 break;
             }
 
-            std::string baseName =
-                "shadowParams[" + std::to_string(boundParameters) + "]";
-            this->pipeline->bindTexture2D(baseName + ".textureIndex",
+            const ShadowParamUniforms &param =
+                uniforms.shadowParams[boundParameters];
+            this->pipeline->bindTexture2D(param.textureIndex,
                                           light->shadowRenderTarget->texture.id,
                                           boundTextures, id);
-            this->pipeline->setUniform1i(baseName + ".textureIndex",
-                                         boundTextures);
-            ShadowParams shadowParams = light->lastShadowParams;
-            this->pipeline->setUniformMat4f(baseName + ".lightView",
+            this->pipeline->setUniform1i(param.textureIndex, boundTextures);
+            const ShadowParams &shadowParams = light->lastShadowParams;
+            this->pipeline->setUniformMat4f(param.lightView,
                                             shadowParams.lightView);
-            this->pipeline->setUniformMat4f(baseName + ".lightProjection",
+            this->pipeline->setUniformMat4f(param.lightProjection,
                                             shadowParams.lightProjection);
-#ifdef METAL
-            this->pipeline->setUniform1f(baseName + ".bias0",
-                                         shadowParams.bias);
-#else
-            this->pipeline->setUniform1f(baseName + ".bias", shadowParams.bias);
-#endif
-            this->pipeline->setUniform1i(baseName + ".lightType", 1);
+            this->pipeline->setUniform1f(param.bias, shadowParams.bias);
+            this->pipeline->setUniform1i(param.lightType, 1);
 
             boundParameters++;
             boundTextures++;
@@ -829,29 +841,24 @@ void CoreObject::render(float dt,
             if (light->shadowRenderTarget == nullptr) {
                 continue;
             }
-            if (boundTextures >= 16) {
+            if (boundTextures >= 16 ||
+                boundParameters >= MAX_BOUND_TEXTURES) {
                 break;
             }
 
-            std::string baseName =
-                "shadowParams[" + std::to_string(boundParameters) + "]";
-            this->pipeline->bindTexture2D(baseName + ".textureIndex",
+            const ShadowParamUniforms &param =
+                uniforms.shadowParams[boundParameters];
+            this->pipeline->bindTexture2D(param.textureIndex,
                                           light->shadowRenderTarget->texture.id,
                                           boundTextures, id);
-            this->pipeline->setUniform1i(baseName + ".textureIndex",
-                                         boundTextures);
-            ShadowParams shadowParams = light->lastShadowParams;
-            this->pipeline->setUniformMat4f(baseName + ".lightView",
+            this->pipeline->setUniform1i(param.textureIndex, boundTextures);
+            const ShadowParams &shadowParams = light->lastShadowParams;
+            this->pipeline->setUniformMat4f(param.lightView,
                                             shadowParams.lightView);
-            this->pipeline->setUniformMat4f(baseName + ".lightProjection",
+            this->pipeline->setUniformMat4f(param.lightProjection,
                                             shadowParams.lightProjection);
-#ifdef METAL
-            this->pipeline->setUniform1f(baseName + ".bias0",
-                                         shadowParams.bias);
-#else
-            this->pipeline->setUniform1f(baseName + ".bias", shadowParams.bias);
-#endif
-            this->pipeline->setUniform1i(baseName + ".lightType", 2);
+            this->pipeline->setUniform1f(param.bias, shadowParams.bias);
+            this->pipeline->setUniform1i(param.lightType, 2);
 
             boundParameters++;
             boundTextures++;
@@ -864,34 +871,32 @@ void CoreObject::render(float dt,
             if (light->shadowRenderTarget == nullptr) {
                 continue;
             }
-            if (boundTextures + 6 >= 16) {
+            if (boundTextures + 6 >= 16 ||
+                boundParameters >= MAX_BOUND_TEXTURES) {
                 break;
             }
 
-            std::string baseName =
-                "shadowParams[" + std::to_string(boundParameters) + "]";
+            const ShadowParamUniforms &param =
+                uniforms.shadowParams[boundParameters];
             this->pipeline->bindTextureCubemap(
-                baseName + ".textureIndex",
-                light->shadowRenderTarget->texture.id, 10 + boundCubemaps, id);
-            this->pipeline->setUniform1i(baseName + ".textureIndex",
-                                         boundCubemaps);
-            this->pipeline->setUniform1f(baseName + ".farPlane",
-                                         light->distance);
-            this->pipeline->setUniform3f(baseName + ".lightPos",
-                                         light->position.x, light->position.y,
-                                         light->position.z);
-            this->pipeline->setUniform1i(baseName + ".lightType", 3);
+                param.textureIndex, light->shadowRenderTarget->texture.id,
+                10 + boundCubemaps, id);
+            this->pipeline->setUniform1i(param.textureIndex, boundCubemaps);
+            this->pipeline->setUniform1f(param.farPlane, light->distance);
+            this->pipeline->setUniform3f(param.lightPos, light->position.x,
+                                         light->position.y, light->position.z);
+            this->pipeline->setUniform1i(param.lightType, 3);
 
             boundParameters++;
             boundCubemaps++;
             boundTextures += 6;
         }
 
-        this->pipeline->setUniform1i("shadowParamCount", boundParameters);
+        this->pipeline->setUniform1i(uniforms.shadowParamCount,
+                                     boundParameters);
 
-        for (int i = 0; i < boundTextures && i < 16; i++) {
-            std::string uniformName = "textures[" + std::to_string(i) + "]";
-            this->pipeline->setUniform1i(uniformName, i);
+        for (int i = 0; i < boundTextures && i < MAX_BOUND_TEXTURES; i++) {
+            this->pipeline->setUniform1i(uniforms.textureArray[i], i);
         }
     }
 
@@ -903,7 +908,7 @@ void CoreObject::render(float dt,
         Scene *scene = window->getCurrentScene();
         if (scene->skybox != nullptr) {
             this->pipeline->bindTextureCubemap(
-                "skybox", scene->skybox->cubemap.id, boundTextures, id);
+                uniforms.skybox, scene->skybox->cubemap.id, boundTextures, id);
             boundTextures++;
         }
     }
@@ -914,9 +919,9 @@ void CoreObject::render(float dt,
         shaderProgram.capabilities.end()) {
         Window *window = Window::mainWindow;
         Scene *scene = window->getCurrentScene();
-        this->pipeline->setUniform1f("environment.rimLightIntensity",
+        this->pipeline->setUniform1f(uniforms.rimLightIntensity,
                                      scene->environment.rimLight.intensity);
-        this->pipeline->setUniform3f("environment.rimLightColor",
+        this->pipeline->setUniform3f(uniforms.rimLightColor,
                                      scene->environment.rimLight.color.r,
                                      scene->environment.rimLight.color.g,
                                      scene->environment.rimLight.color.b);
@@ -931,8 +936,8 @@ void CoreObject::render(float dt,
             updateInstances();
             this->savedInstances = this->instances;
         }
-        this->pipeline->setUniform1i("isInstanced", 1);
-        this->pipeline->setUniformBool("isInstanced", true);
+        this->pipeline->setUniform1i(uniforms.isInstanced, 1);
+        this->pipeline->setUniformBool(uniforms.isInstanced, true);
 
         if (!indices.empty()) {
             commandBuffer->bindDrawingState(vao);
@@ -949,8 +954,8 @@ void CoreObject::render(float dt,
         return;
     }
 
-    this->pipeline->setUniform1i("isInstanced", 0);
-    this->pipeline->setUniformBool("isInstanced", false);
+    this->pipeline->setUniform1i(uniforms.isInstanced, 0);
+    this->pipeline->setUniformBool(uniforms.isInstanced, false);
     if (!indices.empty()) {
         commandBuffer->bindDrawingState(vao);
         commandBuffer->bindPipeline(this->pipeline);
@@ -1000,6 +1005,8 @@ void CoreObject::updateVertices() {
                                  "initialized or empty vertex list");
     }
 
+    localBoundsDirty = true;
+
     vbo->bind();
     vbo->updateData(0, vertices.size() * sizeof(CoreVertex), vertices.data());
     vbo->unbind();
@@ -265,6 +265,17 @@ ComputeShader ComputeShader::fromDefaultShader(AtlasComputeShader shader) {
 #else
         throw std::runtime_error(
             "AtlasComputeShader::PathTracer is only supported on Metal");
+#endif
+    }
+    case AtlasComputeShader::ParticleSimulation: {
+#ifdef METAL
+        computeShader = ComputeShader::fromSource(PARTICLE_SIMULATE);
+        computeShader.fromDefaultShaderType = shader;
+        ComputeShader::computeShaderCache[shader] = computeShader;
+        break;
+#else
+        throw std::runtime_error("AtlasComputeShader::ParticleSimulation is "
+                                 "only supported on Metal");
 #endif
     }
     default:
@@ -199,6 +199,29 @@ void Rigidbody::addMeshCollider() {
     }
 }
 
+void Rigidbody::addHeightFieldCollider(
+    const std::shared_ptr<bezel::HeightFieldCollider> &collider) {
+    if (collider == nullptr || collider->sampleCount == 0) {
+        atlas_warning("HeightFieldCollider has no samples.");
+        return;
+    }
+
+    if (!body) {
+        body = std::make_shared<bezel::Rigidbody>();
+        if (object) {
+            body->id.atlasId = object->getId();
+        }
+    }
+
+    body->motionType = MotionType::Static;
+    body->setCollider(collider);
+    if (object) {
+        body->position = object->getPosition();
+        body->rotation = object->getRotation();
+    }
+    body->create(Window::mainWindow->physicsWorld);
+}
+
 void Rigidbody::beforePhysics() {
     if (!body || !Window::mainWindow || !Window::mainWindow->physicsWorld) {
         return;
@@ -221,15 +244,36 @@ void Rigidbody::update(float dt) {
         return;
     }
 
-    body->refresh(Window::mainWindow->physicsWorld);
+    const auto &world = Window::mainWindow->physicsWorld;
+    body->refresh(world);
 
-    if (body->motionType == MotionType::Dynamic) {
+    if (body->motionType != MotionType::Dynamic) {
+        return;
+    }
+
+    if (!world->usesFixedTimeStep() || !body->hasPreviousTransform) {
         object->setPosition(body->position);
         if (auto *coreObject = dynamic_cast<CoreObject *>(object)) {
             coreObject->setRotationQuat(body->rotationQuat);
         } else {
             object->setRotation(body->rotation);
         }
+        return;
+    }
+
+    // Render between the last two fixed steps so motion stays smooth no
+    // matter how the frame rate lines up with the physics rate.
+    const float alpha = world->getInterpolationAlpha();
+    const glm::vec3 position = glm::mix(body->previousPosition.toGlm(),
+                                        body->position.toGlm(), alpha);
+    const glm::quat rotation = glm::normalize(
+        glm::slerp(body->previousRotationQuat, body->rotationQuat, alpha));
+
+    object->setPosition(Position3d::fromGlm(position));
+    if (auto *coreObject = dynamic_cast<CoreObject *>(object)) {
+        coreObject->setRotationQuat(rotation);
+    } else {
+        object->setRotation(Rotation3d::fromGlmQuat(rotation));
     }
 }
 
@@ -376,8 +420,7 @@ bool Rigidbody::hasTag(const std::string &tag) const {
     if (!body) {
         return false;
     }
-    return std::find(body->tags.begin(), body->tags.end(), tag) !=
-           body->tags.end();
+    return body->hasTag(tag);
 }
 
 void Rigidbody::addTag(const std::string &tag) {
@@ -387,17 +430,14 @@ void Rigidbody::addTag(const std::string &tag) {
             body->id.atlasId = object->getId();
         }
     }
-    if (!hasTag(tag)) {
-        body->tags.push_back(tag);
-    }
+    body->addTag(tag);
 }
 
 void Rigidbody::removeTag(const std::string &tag) const {
     if (!body) {
         return;
     }
-    body->tags.erase(std::remove(body->tags.begin(), body->tags.end(), tag),
-                     body->tags.end());
+    body->removeTag(tag);
 }
 
 void Rigidbody::raycast(const Position3d &direction, float maxDistance) {
@@ -589,8 +629,14 @@ void Rigidbody::raycastTagged(const std::vector<std::string> &tags,
 
     QueryResult result;
     result.operation = QueryOperation::RaycastTagged;
-    bezel::RaycastResult raycastResult =
-        body->raycast(direction, maxDistance, Window::mainWindow->physicsWorld);
+    const bezel::TagMask requiredTags = bezel::makeTagMask(tags);
+    bezel::RaycastResult raycastResult;
+    if (requiredTags != 0) {
+        raycastResult =
+            body->raycast(direction, maxDistance,
+                          Window::mainWindow->physicsWorld,
+                          bezel::INVALID_JOLT_ID, requiredTags);
+    }
 
     result.raycastResult.closestDistance = raycastResult.closestDistance;
     result.raycastResult.hits.reserve(raycastResult.hits.size());
@@ -600,25 +646,6 @@ void Rigidbody::raycastTagged(const std::vector<std::string> &tags,
         h.normal = hit.normal;
         h.distance = hit.distance;
         h.rigidbody = hit.rigidbody;
-        if (hit.rigidbody->tags.end() ==
-            std::find_first_of(hit.rigidbody->tags.begin(),
-                               hit.rigidbody->tags.end(), tags.begin(),
-                               tags.end())) {
-
-            for (size_t i = 0; i < hit.rigidbody->tags.size(); ++i) {
-                std::cout << "\"" << hit.rigidbody->tags[i] << "\"";
-                if (i < hit.rigidbody->tags.size() - 1)
-                    std::cout << ", ";
-            }
-            std::cout << "], required: [";
-            for (size_t i = 0; i < tags.size(); ++i) {
-                std::cout << "\"" << tags[i] << "\"";
-                if (i < tags.size() - 1)
-                    std::cout << ", ";
-            }
-            std::cout << "], skipping." << std::endl;
-            continue;
-        }
         h.didHit = hit.didHit;
         GameObject *hitObject = nullptr;
         if (hit.rigidbody) {
@@ -654,8 +681,14 @@ void Rigidbody::raycastTaggedAll(const std::vector<std::string> &tags,
 
     QueryResult result;
     result.operation = QueryOperation::RaycastTaggedAll;
-    bezel::RaycastResult raycastResult = body->raycastAll(
-        direction, maxDistance, Window::mainWindow->physicsWorld);
+    const bezel::TagMask requiredTags = bezel::makeTagMask(tags);
+    bezel::RaycastResult raycastResult;
+    if (requiredTags != 0) {
+        raycastResult =
+            body->raycastAll(direction, maxDistance,
+                             Window::mainWindow->physicsWorld,
+                             bezel::INVALID_JOLT_ID, requiredTags);
+    }
 
     result.raycastResult.closestDistance = raycastResult.closestDistance;
     result.raycastResult.hits.reserve(raycastResult.hits.size());
@@ -665,12 +698,6 @@ void Rigidbody::raycastTaggedAll(const std::vector<std::string> &tags,
         h.normal = hit.normal;
         h.distance = hit.distance;
         h.rigidbody = hit.rigidbody;
-        if (hit.rigidbody->tags.end() ==
-            std::find_first_of(hit.rigidbody->tags.begin(),
-                               hit.rigidbody->tags.end(), tags.begin(),
-                               tags.end())) {
-            continue;
-        }
         h.didHit = hit.didHit;
         GameObject *hitObject = nullptr;
         if (hit.rigidbody) {
@@ -9,22 +9,37 @@
 
 #include "atlas/tracer/data.h"
 #include "atlas/tracer/log.h"
-#include <json.hpp>
+#include "atlas/tracer/stream.h"
+#include <cstdint>
 
-using json = nlohmann::json;
+namespace {
+
+struct DrawCallPayload {
+    uint32_t callerId;
+    uint32_t type;
+    uint32_t frameNumber;
+};
+
+struct FrameDrawPayload {
+    uint32_t frameNumber;
+    uint32_t drawCallCount;
+    float frameTimeMs;
+    float fps;
+    uint32_t visibleObjects;
+    uint32_t culledObjects;
+};
+
+} // namespace
 
 void DrawCallInfo::send() {
     if (!TracerServices::getInstance().isOk()) {
         return;
     }
 
-    json data;
-    data["type"] = "draw_call";
-    data["caller_object"] = callerObject;
-    data["draw_call_type"] = static_cast<int>(type);
-    data["frame_number"] = frameNumber;
-
-    TracerServices::getInstance().tracerPipe->send(data.dump() + "\n");
+    auto &stream = TracerStream::getInstance();
+    stream.write(TracerRecordType::DrawCall,
+                 DrawCallPayload{stream.internString(callerObject),
+                                 static_cast<uint32_t>(type), frameNumber});
 }
 
 void FrameDrawInfo::send() {
@@ -32,12 +47,8 @@ void FrameDrawInfo::send() {
         return;
     }
 
-    json data;
-    data["type"] = "frame_draw_info";
-    data["frame_number"] = frameNumber;
-    data["draw_call_count"] = drawCallCount;
-    data["frame_time_ms"] = frameTimeMs;
-    data["fps"] = fps;
-
-    TracerServices::getInstance().tracerPipe->send(data.dump() + "\n");
+    TracerStream::getInstance().write(
+        TracerRecordType::FrameDraw,
+        FrameDrawPayload{frameNumber, drawCallCount, frameTimeMs, fps,
+                         visibleObjects, culledObjects});
 }
\ No newline at end of file
@@ -9,24 +9,40 @@
 
 #include "atlas/tracer/data.h"
 #include "atlas/tracer/log.h"
-#include <json.hpp>
+#include "atlas/tracer/stream.h"
+#include <cstdint>
 
-using json = nlohmann::json;
+namespace {
+
+struct FrameMemoryPayload {
+    uint32_t frameNumber;
+    float totalAllocatedMb;
+    float totalGPUMb;
+    float totalCPUMb;
+    int32_t allocationCount;
+    int32_t deallocationCount;
+};
+
+struct AllocationPayload {
+    uint32_t descriptionId;
+    uint32_t ownerId;
+    uint32_t domain;
+    uint32_t kind;
+    float sizeMb;
+    uint32_t frameNumber;
+};
+
+} // namespace
 
 void FrameMemoryPacket::send() {
     if (!TracerServices::getInstance().isOk()) {
         return;
     }
 
-    json object;
-    object["frame_number"] = frameNumber;
-    object["total_allocated_mb"] = totalAllocatedMb;
-    object["total_gpu_mb"] = totalGPUMb;
-    object["total_cpu_mb"] = totalCPUMb;
-    object["allocation_count"] = allocationCount;
-    object["deallocation_count"] = deallocationCount;
-    object["type"] = "frame_memory_info";
-    TracerServices::getInstance().tracerPipe->send(object.dump() + "\n");
+    TracerStream::getInstance().write(
+        TracerRecordType::FrameMemory,
+        FrameMemoryPayload{frameNumber, totalAllocatedMb, totalGPUMb,
+                           totalCPUMb, allocationCount, deallocationCount});
 }
 
 void AllocationPacket::send() {
@@ -34,13 +50,11 @@ void AllocationPacket::send() {
         return;
     }
 
-    json object;
-    object["description"] = description;
-    object["owner"] = owner;
-    object["domain"] = static_cast<int>(domain);
-    object["kind"] = static_cast<int>(kind);
-    object["size_mb"] = sizeMb;
-    object["frame_number"] = frameNumber;
-    object["type"] = "allocation_event";
-    TracerServices::getInstance().tracerPipe->send(object.dump() + "\n");
+    auto &stream = TracerStream::getInstance();
+    stream.write(TracerRecordType::Allocation,
+                 AllocationPayload{stream.internString(description),
+                                   stream.internString(owner),
+                                   static_cast<uint32_t>(domain),
+                                   static_cast<uint32_t>(kind), sizeMb,
+                                   frameNumber});
 }
\ No newline at end of file
@@ -9,27 +9,34 @@
 
 #include "atlas/tracer/data.h"
 #include "atlas/tracer/log.h"
-#include <json.hpp>
-#include <string>
+#include "atlas/tracer/stream.h"
+#include <cstdint>
 
-using json = nlohmann::json;
+namespace {
+
+struct DebugObjectPayload {
+    int32_t objectId;
+    uint32_t objectType;
+    int32_t triangleCount;
+    int32_t materialCount;
+    float vertexBufferSizeMb;
+    float indexBufferSizeMb;
+    float textureCount;
+    int32_t drawCallsForObject;
+    int32_t frameCount;
+};
+
+} // namespace
 
 void DebugObjectPacket::send() {
     if (!TracerServices::getInstance().isOk()) {
         return;
     }
 
-    json object;
-    object["type"] = "debug_object";
-    object["id"] = std::to_string(objectId);
-    object["draw_calls"] = drawCallsForObject;
-    object["object_type"] = static_cast<int>(objectType);
-    object["triangle_count"] = triangleCount;
-    object["material_count"] = materialCount;
-    object["vertex_buffer_mb"] = vertexBufferSizeMb;
-    object["index_buffer_mb"] = indexBufferSizeMb;
-    object["texture_count"] = textureCount;
-    object["frame_count"] = frameCount;
-
-    TracerServices::getInstance().tracerPipe->send(object.dump() + "\n");
+    TracerStream::getInstance().write(
+        TracerRecordType::DebugObject,
+        DebugObjectPayload{objectId, static_cast<uint32_t>(objectType),
+                           triangleCount, materialCount, vertexBufferSizeMb,
+                           indexBufferSizeMb, textureCount,
+                           drawCallsForObject, frameCount});
 }
\ No newline at end of file
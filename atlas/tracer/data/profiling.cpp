@@ -9,26 +9,41 @@
 
 #include "atlas/tracer/data.h"
 #include "atlas/tracer/log.h"
-#include <json.hpp>
+#include "atlas/tracer/stream.h"
+#include <cstdint>
 
-using json = nlohmann::json;
+namespace {
+
+struct FrameTimingPayload {
+    uint32_t frameNumber;
+    float cpuFrameTimeMs;
+    float gpuFrameTimeMs;
+    float mainThreadTimeMs;
+    float workerThreadTimeMs;
+    float memoryMb;
+    float cpuUsagePercent;
+    float gpuUsagePercent;
+};
+
+struct TimingEventPayload {
+    uint32_t nameId;
+    uint32_t subsystem;
+    float durationMs;
+    uint32_t frameNumber;
+};
+
+} // namespace
 
 void FrameTimingPacket::send() {
     if (!TracerServices::getInstance().isOk()) {
         return;
     }
 
-    json object;
-    object["type"] = "frame_timing_info";
-    object["frame_number"] = frameNumber;
-    object["cpu_frame_time_ms"] = cpuFrameTimeMs;
-    object["gpu_frame_time_ms"] = gpuFrameTimeMs;
-    object["main_thread_time_ms"] = mainThreadTimeMs;
-    object["worker_thread_time_ms"] = workerThreadTimeMs;
-    object["memory_mb"] = memoryMb;
-    object["cpu_usage_percent"] = cpuUsagePercent;
-    object["gpu_usage_percent"] = gpuUsagePercent;
-    TracerServices::getInstance().tracerPipe->send(object.dump() + "\n");
+    TracerStream::getInstance().write(
+        TracerRecordType::FrameTiming,
+        FrameTimingPayload{frameNumber, cpuFrameTimeMs, gpuFrameTimeMs,
+                           mainThreadTimeMs, workerThreadTimeMs, memoryMb,
+                           cpuUsagePercent, gpuUsagePercent});
 }
 
 void TimingEventPacket::send() {
@@ -36,11 +51,9 @@ void TimingEventPacket::send() {
         return;
     }
 
-    json object;
-    object["type"] = "timing_event";
-    object["name"] = name;
-    object["subsystem"] = static_cast<int>(subsystem);
-    object["duration_ms"] = durationMs;
-    object["frame_number"] = frameNumber;
-    TracerServices::getInstance().tracerPipe->send(object.dump() + "\n");
+    auto &stream = TracerStream::getInstance();
+    stream.write(TracerRecordType::TimingEvent,
+                 TimingEventPayload{stream.internString(name),
+                                    static_cast<uint32_t>(subsystem),
+                                    durationMs, frameNumber});
 }
\ No newline at end of file
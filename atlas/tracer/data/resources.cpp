@@ -9,24 +9,35 @@
 
 #include "atlas/tracer/data.h"
 #include "atlas/tracer/log.h"
+#include "atlas/tracer/stream.h"
 #include <algorithm>
-#include <json.hpp>
+#include <cstdint>
 
-using json = nlohmann::json;
+namespace {
+
+struct ResourceEventPayload {
+    uint32_t callerId;
+    uint32_t resourceType;
+    uint32_t operation;
+    uint32_t frameNumber;
+    float sizeMb;
+};
+
+struct FrameResourcesPayload {
+    uint32_t frameNumber;
+    int32_t resourcesCreated;
+    int32_t resourcesLoaded;
+    int32_t resourcesUnloaded;
+    float totalMemoryMb;
+};
+
+} // namespace
 
 void ResourceEventInfo::send() {
     if (!TracerServices::getInstance().isOk()) {
         return;
     }
 
-    json object;
-    object["caller_object"] = callerObject;
-    object["resource_type"] = static_cast<int>(resourceType);
-    object["operation"] = static_cast<int>(operation);
-    object["frame_number"] = frameNumber;
-    object["size_mb"] = sizeMb;
-    object["type"] = "resource_event";
-
     auto &tracker = ResourceTracker::getInstance();
 
     if (operation == DebugResourceOperation::Created) {
@@ -68,7 +79,12 @@ void ResourceEventInfo::send() {
         }
     }
 
-    TracerServices::getInstance().tracerPipe->send(object.dump() + "\n");
+    auto &stream = TracerStream::getInstance();
+    stream.write(TracerRecordType::ResourceEvent,
+                 ResourceEventPayload{stream.internString(callerObject),
+                                      static_cast<uint32_t>(resourceType),
+                                      static_cast<uint32_t>(operation),
+                                      frameNumber, sizeMb});
 }
 
 void FrameResourcesInfo::send() {
@@ -76,12 +92,8 @@ void FrameResourcesInfo::send() {
         return;
     }
 
-    json object;
-    object["frame_number"] = frameNumber;
-    object["resources_created"] = resourcesCreated;
-    object["resources_loaded"] = resourcesLoaded;
-    object["resources_unloaded"] = resourcesUnloaded;
-    object["total_memory_mb"] = totalMemoryMb;
-    object["type"] = "frame_resources_info";
-    TracerServices::getInstance().tracerPipe->send(object.dump() + "\n");
+    TracerStream::getInstance().write(
+        TracerRecordType::FrameResources,
+        FrameResourcesPayload{frameNumber, resourcesCreated, resourcesLoaded,
+                              resourcesUnloaded, totalMemoryMb});
 }
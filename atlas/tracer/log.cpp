@@ -8,12 +8,10 @@
 //
 
 #include "atlas/tracer/log.h"
-#include "json.hpp"
+#include "atlas/tracer/stream.h"
 #include <iostream>
 #include <string>
 
-using json = nlohmann::json;
-
 TracerServices::TracerServices() : tracerPipe(nullptr) {}
 
 void TracerServices::startTracing(int port) {
@@ -27,6 +25,8 @@ void TracerServices::startTracing(int port) {
     tracerPipe->onReceive([](const std::string &message) {
         std::cout << "Tracer received: " << message << std::endl;
     });
+
+    TracerStream::getInstance().start(tracerPipe);
 }
 
 Logger::Logger() {}
@@ -49,14 +49,8 @@ void Logger::log(const std::string &message, const std::string &file,
         return;
     }
 
-    json log;
-    log["type"] = "log";
-    log["severity"] = "info";
-    log["message"] = message;
-    log["file"] = file;
-    log["line"] = line;
-
-    TracerServices::getInstance().tracerPipe->send(log.dump() + "\n");
+    TracerStream::getInstance().writeLog(TracerLogSeverity::Info, message,
+                                         file, line);
 }
 
 void Logger::warning(const std::string &message, const std::string &file,
@@ -70,14 +64,8 @@ void Logger::warning(const std::string &message, const std::string &file,
         return;
     }
 
-    json log;
-    log["type"] = "log";
-    log["severity"] = "warning";
-    log["message"] = message;
-    log["file"] = file;
-    log["line"] = line;
-
-    TracerServices::getInstance().tracerPipe->send(log.dump() + "\n");
+    TracerStream::getInstance().writeLog(TracerLogSeverity::Warning, message,
+                                         file, line);
 }
 
 void Logger::error(const std::string &message, const std::string &file,
@@ -91,14 +79,8 @@ void Logger::error(const std::string &message, const std::string &file,
         return;
     }
 
-    json log;
-    log["type"] = "log";
-    log["severity"] = "error";
-    log["message"] = message;
-    log["file"] = file;
-    log["line"] = line;
-
-    TracerServices::getInstance().tracerPipe->send(log.dump() + "\n");
+    TracerStream::getInstance().writeLog(TracerLogSeverity::Error, message,
+                                         file, line);
 }
 
 DebugTimer::DebugTimer(const std::string &name) : name(name) {
@@ -0,0 +1,300 @@
+//
+// stream.cpp
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: Binary record stream implementation
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#include "atlas/tracer/stream.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t MAX_LOG_LENGTH = 4096;
+constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(5);
+
+struct LogPayload {
+    uint32_t severity;
+    uint32_t line;
+    uint32_t fileId;
+    uint32_t length;
+};
+
+struct StringDefinitionPayload {
+    uint32_t id;
+    uint16_t offset;
+    uint16_t length;
+    char text[TracerRecord::PAYLOAD_SIZE - 8];
+};
+
+struct RecordsDroppedPayload {
+    uint64_t count;
+};
+
+std::size_t nextPowerOfTwo(std::size_t value) {
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Records are mostly zero padding, so a zero run-length scheme recovers most
+// of the size without pulling in a compression library. A control byte with
+// the high bit set expands to (c & 0x7f) + 1 zero bytes; otherwise it is
+// followed by c + 1 literal bytes.
+void encodeZeroRuns(const uint8_t *data, std::size_t size, std::string &out) {
+    std::size_t i = 0;
+    while (i < size) {
+        if (data[i] == 0) {
+            std::size_t run = 1;
+            while (i + run < size && data[i + run] == 0 && run < 128) {
+                run++;
+            }
+            out.push_back(static_cast<char>(0x80 | (run - 1)));
+            i += run;
+            continue;
+        }
+
+        std::size_t start = i;
+        while (i < size && i - start < 128) {
+            // Keep short zero gaps inside the literal, a run costs as much.
+            if (data[i] == 0 && (i + 1 >= size || data[i + 1] == 0)) {
+                break;
+            }
+            i++;
+        }
+        out.push_back(static_cast<char>(i - start - 1));
+        out.append(reinterpret_cast<const char *>(data + start), i - start);
+    }
+}
+
+} // namespace
+
+TracerRing::TracerRing(std::size_t capacity)
+    : records(nextPowerOfTwo(std::max<std::size_t>(capacity, 2))),
+      mask(records.size() - 1) {}
+
+bool TracerRing::push(const TracerRecord *items, std::size_t count) {
+    const std::size_t currentHead = head.load(std::memory_order_relaxed);
+    const std::size_t currentTail = tail.load(std::memory_order_acquire);
+    if (records.size() - (currentHead - currentTail) < count) {
+        dropped.fetch_add(count, std::memory_order_relaxed);
+        return false;
+    }
+
+    for (std::size_t i = 0; i < count; i++) {
+        records[(currentHead + i) & mask] = items[i];
+    }
+    head.store(currentHead + count, std::memory_order_release);
+    return true;
+}
+
+std::size_t TracerRing::drain(std::vector<TracerRecord> &out) {
+    const std::size_t currentTail = tail.load(std::memory_order_relaxed);
+    const std::size_t currentHead = head.load(std::memory_order_acquire);
+    for (std::size_t i = currentTail; i != currentHead; i++) {
+        out.push_back(records[i & mask]);
+    }
+    tail.store(currentHead, std::memory_order_release);
+    return currentHead - currentTail;
+}
+
+namespace {
+
+// Retires the calling thread's ring when the thread exits, so threads that
+// come and go do not leave their rings behind.
+struct ThreadRingOwner {
+    TracerRing *ring = nullptr;
+
+    ~ThreadRingOwner() {
+        if (ring != nullptr) {
+            ring->retire();
+        }
+    }
+};
+
+} // namespace
+
+TracerStream::~TracerStream() { stop(); }
+
+TracerRing &TracerStream::getThreadRing() {
+    thread_local ThreadRingOwner owner;
+    if (owner.ring == nullptr) {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.push_back(std::make_unique<TracerRing>(ringCapacity));
+        owner.ring = rings.back().get();
+    }
+    return *owner.ring;
+}
+
+uint32_t TracerStream::internString(const std::string &text) {
+    // Each thread keeps its own view of the table so repeated names never
+    // touch the shared lock.
+    thread_local std::unordered_map<std::string, uint32_t> cache;
+    auto cached = cache.find(text);
+    if (cached != cache.end()) {
+        return cached->second;
+    }
+
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(stringsMutex);
+        auto it = stringIds.find(text);
+        if (it != stringIds.end()) {
+            id = it->second;
+        } else {
+            id = static_cast<uint32_t>(strings.size());
+            strings.push_back(text);
+            stringIds.emplace(text, id);
+        }
+    }
+    cache.emplace(text, id);
+    return id;
+}
+
+bool TracerStream::writeLog(TracerLogSeverity severity,
+                            const std::string &message,
+                            const std::string &file, int line) {
+    thread_local std::vector<TracerRecord> records;
+
+    const std::size_t length = std::min(message.size(), MAX_LOG_LENGTH);
+    const std::size_t textRecords =
+        (length + TracerRecord::PAYLOAD_SIZE - 1) / TracerRecord::PAYLOAD_SIZE;
+    records.assign(textRecords + 1, TracerRecord{});
+
+    LogPayload header{};
+    header.severity = static_cast<uint32_t>(severity);
+    header.line = static_cast<uint32_t>(line);
+    header.fileId = internString(file);
+    header.length = static_cast<uint32_t>(length);
+
+    records[0].type = static_cast<uint16_t>(TracerRecordType::Log);
+    records[0].size = sizeof(LogPayload);
+    std::memcpy(records[0].payload, &header, sizeof(LogPayload));
+
+    for (std::size_t i = 0; i < textRecords; i++) {
+        const std::size_t offset = i * TracerRecord::PAYLOAD_SIZE;
+        const std::size_t chunk =
+            std::min(TracerRecord::PAYLOAD_SIZE, length - offset);
+        TracerRecord &record = records[i + 1];
+        record.type = static_cast<uint16_t>(TracerRecordType::LogText);
+        record.size = static_cast<uint16_t>(chunk);
+        std::memcpy(record.payload, message.data() + offset, chunk);
+    }
+
+    return getThreadRing().push(records.data(), records.size());
+}
+
+void TracerStream::start(const std::shared_ptr<NetworkPipe> &newPipe) {
+    if (running.load()) {
+        return;
+    }
+    pipe = newPipe;
+    running.store(true);
+    sender = std::thread(&TracerStream::senderLoop, this);
+}
+
+void TracerStream::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    if (sender.joinable()) {
+        sender.join();
+    }
+    pipe.reset();
+}
+
+void TracerStream::senderLoop() {
+    while (running.load()) {
+        std::this_thread::sleep_for(FLUSH_INTERVAL);
+        flush();
+    }
+    flush();
+}
+
+void TracerStream::flush() {
+    batch.clear();
+
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        for (auto it = rings.begin(); it != rings.end();) {
+            // Checked before draining: a retired ring receives no more
+            // records, so this drain is its last one.
+            const bool retired = (*it)->isRetired();
+            (*it)->drain(batch);
+            dropped += (*it)->takeDropped();
+            if (retired) {
+                it = rings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Strings are snapshotted after draining, so every ID referenced by the
+    // drained records is already in the table and gets defined up front.
+    std::vector<TracerRecord> definitions;
+    {
+        std::lock_guard<std::mutex> lock(stringsMutex);
+        for (; sentStrings < strings.size(); sentStrings++) {
+            const std::string &text = strings[sentStrings];
+            std::size_t offset = 0;
+            do {
+                StringDefinitionPayload payload{};
+                const std::size_t chunk =
+                    std::min(sizeof(payload.text), text.size() - offset);
+                payload.id = static_cast<uint32_t>(sentStrings);
+                payload.offset = static_cast<uint16_t>(offset);
+                payload.length = static_cast<uint16_t>(chunk);
+                std::memcpy(payload.text, text.data() + offset, chunk);
+
+                TracerRecord record;
+                record.type =
+                    static_cast<uint16_t>(TracerRecordType::StringDefinition);
+                record.size = static_cast<uint16_t>(8 + chunk);
+                std::memcpy(record.payload, &payload, sizeof(payload));
+                definitions.push_back(record);
+                offset += chunk;
+            } while (offset < text.size() && offset <= UINT16_MAX);
+        }
+    }
+    batch.insert(batch.begin(), definitions.begin(), definitions.end());
+
+    if (dropped > 0) {
+        totalDropped.fetch_add(dropped);
+        TracerRecord record;
+        record.type = static_cast<uint16_t>(TracerRecordType::RecordsDropped);
+        record.size = sizeof(RecordsDroppedPayload);
+        const RecordsDroppedPayload payload{dropped};
+        std::memcpy(record.payload, &payload, sizeof(payload));
+        batch.push_back(record);
+    }
+
+    if (batch.empty() || pipe == nullptr) {
+        return;
+    }
+
+    TracerBatchHeader header;
+    header.flags = TRACER_BATCH_ZERO_RLE;
+    header.recordCount = static_cast<uint32_t>(batch.size());
+    header.rawSize = static_cast<uint32_t>(batch.size() * sizeof(TracerRecord));
+    header.droppedRecords = static_cast<uint32_t>(
+        std::min<uint64_t>(dropped, UINT32_MAX));
+
+    encoded.assign(sizeof(TracerBatchHeader), '\0');
+    encodeZeroRuns(reinterpret_cast<const uint8_t *>(batch.data()),
+                   header.rawSize, encoded);
+    header.encodedSize =
+        static_cast<uint32_t>(encoded.size() - sizeof(TracerBatchHeader));
+    std::memcpy(encoded.data(), &header, sizeof(TracerBatchHeader));
+
+    pipe->send(encoded);
+}
@@ -9,7 +9,7 @@
 #title[The Tracer Debugging and Profiling Protocol for the Atlas Game Engine Control Specification]
 
 #pad(top: 10pt, author[Atlas Team])
-#pad(bottom: 10pt, author[Version 1.0 (Release Alpha 6), December 2025])
+#pad(bottom: 10pt, author[Version 2.0 (Release Alpha 6), December 2025])
 #pad(y: 10pt, line(length: 100%))
 
 #set heading(numbering: "1.")
@@ -30,7 +30,7 @@ In the future, we have plans to integrate Tracer support directly into the Atlas
 
 == How can I implement my own Tracer Client?
 
-The Protocol is designed to be simple and easy to implement. The communication is done over TCP/IP sockets, and the messages are formatted in JSON for ease of parsing.
+The Protocol is designed to be simple and easy to implement. The communication is done over TCP/IP sockets. Messages sent by the engine use the binary format described in the Binary Wire Format section.
 
 This document is specifically made to help developers implement their own Tracer Clients, so they can create custom tools that fit their specific debugging and profiling needs.
 
@@ -85,6 +85,8 @@ Here are the data types that are used in the protocol and their JSON parameters,
   - `draw_call_count`: Total number of draw calls made in the frame.
   - `frame_time_ms`: Time taken to render the frame in milliseconds.
   - `fps`: Frames per second.
+  - `visible_objects`: Number of objects that passed frustum and distance culling.
+  - `culled_objects`: Number of objects skipped by frustum and distance culling.
 
 
 == Memory Trace Data
@@ -236,9 +238,49 @@ Here are the data types that are used in the protocol and their JSON parameters,
   - `resource_unloaded`: Number of resources unloaded in the frame.
   - `resources_created`: Number of resources created in the frame.
 
+= Binary Wire Format
+
+Starting with version 2 of the Protocol, the engine no longer sends one JSON object per event. Producers write fixed-size binary records into per-thread ring buffers, and a background sender thread ships them in batches. The data types above keep their meaning; only their encoding changes. All integers and floats are little-endian, and floats are IEEE 754 single precision.
+
+== Batches
+
+Every batch starts with a 24 byte header, followed by `encoded_size` bytes of body:
+
+- `magic` (4 bytes): always `ATRB`.
+- `version` (u16): currently `2`.
+- `flags` (u16): bit `1` means the body is zero run-length encoded.
+- `record_count` (u32): number of records in the batch.
+- `raw_size` (u32): size of the decoded body, always `record_count * 64`.
+- `encoded_size` (u32): size of the body on the wire.
+- `dropped_records` (u32): records the engine dropped since the previous batch because a ring buffer was full.
+
+When the body is zero run-length encoded, read a control byte `c`. If its high bit is set, it expands to `(c & 0x7f) + 1` zero bytes. Otherwise, copy the next `c + 1` bytes verbatim.
+
+== Records
+
+Each record is 64 bytes: a `type` (u16), a `size` (u16) telling how many payload bytes are meaningful, and a 60 byte payload. Strings are never stored inline. They are sent once as `string_definition` records, and records refer to them by ID. A batch always defines a string before any record in it uses that string.
+
+#table(
+  columns: 3,
+  [*Type*], [*Record*], [*Payload*],
+  [1], [`draw_call`], [`caller_object` (string ID u32), `draw_call_type` (u32), `frame_number` (u32)],
+  [2], [`frame_draw_info`], [`frame_number` (u32), `draw_call_count` (u32), `frame_time_ms` (f32), `fps` (f32), `visible_objects` (u32), `culled_objects` (u32)],
+  [3], [`resource_event`], [`caller_object` (string ID u32), `resource_type` (u32), `operation` (u32), `frame_number` (u32), `size_mb` (f32)],
+  [4], [`frame_resources_info`], [`frame_number` (u32), `resources_created` (i32), `resources_loaded` (i32), `resources_unloaded` (i32), `total_memory_mb` (f32)],
+  [5], [`debug_object`], [`id` (i32), `object_type` (u32), `triangle_count` (i32), `material_count` (i32), `vertex_buffer_mb` (f32), `index_buffer_mb` (f32), `texture_count` (f32), `draw_calls` (i32), `frame_count` (i32)],
+  [6], [`allocation_event`], [`description` (string ID u32), `owner` (string ID u32), `domain` (u32), `kind` (u32), `size_mb` (f32), `frame_number` (u32)],
+  [7], [`frame_memory_info`], [`frame_number` (u32), `total_allocated_mb` (f32), `total_gpu_mb` (f32), `total_cpu_mb` (f32), `allocation_count` (i32), `deallocation_count` (i32)],
+  [8], [`frame_timing_info`], [`frame_number` (u32), `cpu_frame_time_ms`, `gpu_frame_time_ms`, `main_thread_time_ms`, `worker_thread_time_ms`, `memory_mb`, `cpu_usage_percent`, `gpu_usage_percent` (all f32)],
+  [9], [`timing_event`], [`name` (string ID u32), `subsystem` (u32), `duration_ms` (f32), `frame_number` (u32)],
+  [10], [`log`], [`severity` (u32, 0 info, 1 warning, 2 error), `line` (u32), `file` (string ID u32), `length` (u32)],
+  [11], [`log_text`], [Up to 60 bytes of the message. A `log` record is followed by as many `log_text` records as needed to cover `length` bytes.],
+  [12], [`string_definition`], [`id` (u32), `offset` (u16), `length` (u16), then `length` bytes of text at `offset` within the string. Long strings span several records.],
+  [13], [`records_dropped`], [`count` (u64) of records dropped since the previous batch.],
+)
+
 = Establishing a Connection
 
-Just connect to the engine's IP address and port using a TCP socket. Once connectJust connect to the engine's IP address and port using a TCP socket. Once connected, you can start sending commands and receiving data. Encode your data in JSON format as specified in the following sections. The port used by default is `5123`, but it can be changed in the engine settings.
+Just connect to the engine's IP address and port using a TCP socket. Once connectJust connect to the engine's IP address and port using a TCP socket. Once connected, you can start sending commands and receiving data. Decode the engine's data as described in the Binary Wire Format section, and encode the data you send to the engine in JSON format as specified in the following sections. The port used by default is `5123`, but it can be changed in the engine settings.
 
 = Runtime Variables
 
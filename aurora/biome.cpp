@@ -7,10 +7,12 @@
 // Copyright (c) 2025 Max Van den Eynde
 //
 
+#include "atlas/core/job_system.h"
 #include "atlas/texture.h"
 #include "aurora/terrain.h"
 #include "opal/opal.h"
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <sys/types.h>
@@ -31,71 +33,95 @@ float aurora::computeSlope(const uint8_t *heightMap, int width, int height,
     return std::sqrt((dzdx * dzdx) + (dzdy * dzdy)) / 255.0f;
 }
 
-void Terrain::generateMaps(unsigned char *heightmapData, int width, int height,
-                           int generationParameter, int nChannels) {
-    const float maxHeight = 255.0f;
-
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            int idx = x + (y * width);
-
-            uint8_t heightValue;
-            if (nChannels == 1) {
-                heightValue = heightmapData[idx];
-            } else if (nChannels >= 3) {
-                int r = heightmapData[(idx * nChannels) + 0];
-                int g = heightmapData[(idx * nChannels) + 1];
-                int b = heightmapData[(idx * nChannels) + 2];
-                heightValue = static_cast<uint8_t>((r + g + b) / 3);
-            } else {
-                heightValue = 0;
-            }
+float aurora::computeSlope(const float *heightMap, int width, int height,
+                           int x, int y) {
+    int xm = std::max(x - 1, 0);
+    int xp = std::min(x + 1, width - 1);
+    int ym = std::max(y - 1, 0);
+    int yp = std::min(y + 1, height - 1);
 
-            if (generationParameter == 1) {
-                float temperature = std::max(
-                    0.0f, 1.0f - (float(heightValue) / float(maxHeight)));
-                uint8_t temperatureValue =
-                    static_cast<uint8_t>(temperature * 255.0f);
-                this->temperatureData.push_back(temperatureValue);
-            }
+    float dzdx = heightMap[xp + (y * width)] - heightMap[xm + (y * width)];
+    float dzdy = heightMap[x + (yp * width)] - heightMap[x + (ym * width)];
 
-            if (generationParameter == 2) {
-                float slope =
-                    aurora::computeSlope(heightmapData, width, height, x, y);
-                float moisture = (1.0f - slope) *
-                                 (1.0f - float(heightValue) / float(maxHeight));
-                moisture = std::clamp(moisture, 0.0f, 1.0f);
-                uint8_t moistureValue = static_cast<uint8_t>(moisture * 255.0f);
+    return std::sqrt((dzdx * dzdx) + (dzdy * dzdy));
+}
 
-                this->moistureData.push_back(moistureValue);
-            }
-        }
+namespace {
+
+// Rows handed to a worker at a time when deriving the biome maps.
+constexpr size_t MAP_TILE_ROWS = 32;
+
+} // namespace
+
+void Terrain::generateMaps(const float *heights, int width, int height,
+                           bool moisture, bool temperature) {
+    if (!moisture && !temperature) {
+        return;
+    }
+
+    const size_t texelCount = static_cast<size_t>(width) * height;
+    if (moisture) {
+        moistureData.assign(texelCount, 0);
+    }
+    if (temperature) {
+        temperatureData.assign(texelCount, 0);
     }
+
+    // Both maps derive from the same height texel, so they are filled in a
+    // single pass over the heightmap.
+    JobSystem::getInstance().parallelFor(
+        height, MAP_TILE_ROWS, [&](size_t begin, size_t end) {
+            for (int y = static_cast<int>(begin); y < static_cast<int>(end);
+                 ++y) {
+                for (int x = 0; x < width; ++x) {
+                    const size_t idx = x + (static_cast<size_t>(y) * width);
+                    const float heightValue = heights[idx];
+
+                    if (temperature) {
+                        float value = std::max(0.0f, 1.0f - heightValue);
+                        temperatureData[idx] =
+                            static_cast<uint8_t>(value * 255.0f);
+                    }
+
+                    if (moisture) {
+                        float slope = aurora::computeSlope(heights, width,
+                                                           height, x, y);
+                        float value = (1.0f - slope) * (1.0f - heightValue);
+                        value = std::clamp(value, 0.0f, 1.0f);
+                        moistureData[idx] =
+                            static_cast<uint8_t>(value * 255.0f);
+                    }
+                }
+            }
+        });
 }
 
-void Terrain::generateBiomes(unsigned char *heightmapData, int width,
-                             int height, int nChannels) {
-    if (moistureTexture.id == 0) {
-        generateMaps(heightmapData, width, height, 2, nChannels);
-    } else {
-        std::vector<uint8_t> data(width * height * 4);
+void Terrain::generateBiomes(const float *heights, int width, int height) {
+    const bool generateMoisture = moistureTexture.id == 0;
+    const bool generateTemperature = temperatureTexture.id == 0;
+    generateMaps(heights, width, height, generateMoisture,
+                 generateTemperature);
+
+    const size_t texelCount = static_cast<size_t>(width) * height;
+    if (!generateMoisture) {
+        std::vector<uint8_t> data(texelCount * 4);
         moistureTexture.texture->readData(data.data(),
                                           opal::TextureDataFormat::Rgba);
 
-        for (int i = 0; i < width * height; ++i) {
-            this->moistureData.push_back(data[i * 4]);
+        moistureData.resize(texelCount);
+        for (size_t i = 0; i < texelCount; ++i) {
+            moistureData[i] = data[i * 4];
         }
     }
 
-    if (temperatureTexture.id == 0) {
-        generateMaps(heightmapData, width, height, 1, nChannels);
-    } else {
-        std::vector<uint8_t> data(width * height * 4);
+    if (!generateTemperature) {
+        std::vector<uint8_t> data(texelCount * 4);
         temperatureTexture.texture->readData(data.data(),
                                              opal::TextureDataFormat::Rgba);
 
-        for (int i = 0; i < width * height; ++i) {
-            this->temperatureData.push_back(data[i * 4]);
+        temperatureData.resize(texelCount);
+        for (size_t i = 0; i < texelCount; ++i) {
+            temperatureData[i] = data[i * 4];
         }
     }
 
@@ -0,0 +1,493 @@
+//
+// chunked_terrain.cpp
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: Streamed chunk terrain implementation
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#include "aurora/chunked_terrain.h"
+#include "atlas/camera.h"
+#include "atlas/tracer/data.h"
+#include "atlas/tracer/log.h"
+#include "atlas/window.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// Frames the GPU may still be rendering after a chunk is evicted. Its
+// textures are only refilled once all of them have finished.
+constexpr long CHUNK_TEXTURE_REUSE_FRAMES = 3;
+
+Texture makeChunkTexture(opal::TextureFormat format, int resolution,
+                         const void *data) {
+    Texture texture;
+    texture.texture = opal::Texture::create(
+        opal::TextureType::Texture2D, format, resolution, resolution,
+        opal::TextureDataFormat::Red, data, 1);
+    // Neighbouring chunks share their border samples, so sampling must never
+    // wrap to the opposite edge.
+    texture.texture->setWrapMode(opal::TextureAxis::S,
+                                 opal::TextureWrapMode::ClampToEdge);
+    texture.texture->setWrapMode(opal::TextureAxis::T,
+                                 opal::TextureWrapMode::ClampToEdge);
+    texture.texture->setFilterMode(opal::TextureFilterMode::Linear,
+                                   opal::TextureFilterMode::Linear);
+    texture.id = texture.texture->textureID;
+    return texture;
+}
+
+} // namespace
+
+ChunkedTerrain::~ChunkedTerrain() {
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        stopping = true;
+    }
+    requestReady.notify_all();
+    if (streamer.joinable()) {
+        streamer.join();
+    }
+}
+
+int64_t ChunkedTerrain::chunkKey(int x, int z) {
+    return (static_cast<int64_t>(x) << 32) |
+           static_cast<int64_t>(static_cast<uint32_t>(z));
+}
+
+int ChunkedTerrain::lodResolution(int lod) const {
+    const int spans = std::max(1, (chunkResolution - 1) >> lod);
+    return spans + 1;
+}
+
+unsigned int ChunkedTerrain::patchVertexCount() const {
+    // Four vertices per surface patch plus one skirt patch per border span.
+    return (4 * patchesPerChunk * patchesPerChunk) + (16 * patchesPerChunk);
+}
+
+int ChunkedTerrain::lodForDistance(int rings) const {
+    const int coarsest = static_cast<int>(lodDrawingStates.size()) - 1;
+    return std::min(coarsest, rings / std::max(1, ringsPerLod));
+}
+
+void ChunkedTerrain::initialize() {
+    if (generator == nullptr) {
+        atlas_error("Chunked terrain requires a terrain generator");
+        throw std::runtime_error(
+            "Chunked terrain requires a terrain generator");
+    }
+    atlas_log("Initializing chunked terrain");
+
+    VertexShader vertexShader =
+        VertexShader::fromDefaultShader(AtlasVertexShader::Terrain);
+    FragmentShader fragmentShader =
+        FragmentShader::fromDefaultShader(AtlasFragmentShader::Terrain);
+    TessellationShader tescShader = TessellationShader::fromDefaultShader(
+        AtlasTessellationShader::TerrainControl);
+    TessellationShader teseShader = TessellationShader::fromDefaultShader(
+        AtlasTessellationShader::TerrainEvaluation);
+    vertexShader.compile();
+    fragmentShader.compile();
+    tescShader.compile();
+    teseShader.compile();
+    terrainShader = ShaderProgram(vertexShader, fragmentShader,
+                                  GeometryShader(), {tescShader, teseShader});
+    terrainShader.compile();
+    terrainPipeline = opal::Pipeline::create();
+
+    lodLevels = std::max(1, lodLevels);
+    chunkResolution = std::max(2, chunkResolution);
+    patchesPerChunk = std::max(1u, patchesPerChunk);
+    for (int lod = 0; lod < lodLevels; lod++) {
+        buildPatchGrid(lod);
+    }
+
+    for (auto &biome : biomes) {
+        biome.condition(biome);
+    }
+
+    // Let the generator set up shared state, such as the global noise seed,
+    // before it is sampled from the streaming thread.
+    generator->generateHeight(0.0f, 0.0f);
+
+    stopping = false;
+    streamer = std::thread(&ChunkedTerrain::streamLoop, this);
+    initialized = true;
+}
+
+void ChunkedTerrain::buildPatchGrid(int lod) {
+    const unsigned int rez = patchesPerChunk;
+    const float half = chunkSize / 2.0f;
+    // Texel centers of the chunk's border samples sit half a texel inside the
+    // texture, remap the patch coordinates onto them.
+    const int resolution = lodResolution(lod);
+    auto texCoord = [resolution](float t) {
+        return (0.5f + (t * static_cast<float>(resolution - 1))) /
+               static_cast<float>(resolution);
+    };
+
+    std::vector<float> vertices;
+    vertices.reserve(static_cast<size_t>(patchVertexCount()) * 5);
+    auto pushVertex = [&](unsigned int i, unsigned int j, float y = 0.0f) {
+        const float u = i / (float)rez;
+        const float v = j / (float)rez;
+        vertices.push_back(-half + (chunkSize * u)); // v.x
+        vertices.push_back(y);                       // v.y
+        vertices.push_back(-half + (chunkSize * v)); // v.z
+        vertices.push_back(texCoord(u));             // u
+        vertices.push_back(texCoord(v));             // v
+    };
+    for (unsigned int i = 0; i < rez; i++) {
+        for (unsigned int j = 0; j < rez; j++) {
+            pushVertex(i, j);
+            pushVertex(i + 1, j);
+            pushVertex(i, j + 1);
+            pushVertex(i + 1, j + 1);
+        }
+    }
+
+    // A chunk next to a coarser one interpolates its border between fewer
+    // samples, so the two edges disagree and leave cracks. Every border
+    // patch gets a skirt hanging below it that follows the border heights
+    // and fills those cracks. Skirts are wound to face out of the chunk.
+    const float depth = -std::max(0.0f, skirtDepth);
+    auto pushSkirt = [&](unsigned int i0, unsigned int j0, unsigned int i1,
+                         unsigned int j1) {
+        pushVertex(i0, j0);
+        pushVertex(i1, j1);
+        pushVertex(i0, j0, depth);
+        pushVertex(i1, j1, depth);
+    };
+    for (unsigned int k = 0; k < rez; k++) {
+        pushSkirt(rez - k, 0, rez - k - 1, 0);
+        pushSkirt(k, rez, k + 1, rez);
+        pushSkirt(0, k, 0, k + 1);
+        pushSkirt(rez, rez - k, rez, rez - k - 1);
+    }
+
+    auto vertexBuffer = opal::Buffer::create(
+        opal::BufferUsage::VertexBuffer, vertices.size() * sizeof(float),
+        vertices.data(), opal::MemoryUsageType::GPUOnly, id);
+    auto drawingState = opal::DrawingState::create(vertexBuffer, nullptr);
+
+    std::vector<opal::VertexAttributeBinding> attributeBindings = {
+        {opal::VertexAttribute{.name = "position",
+                               .type = opal::VertexAttributeType::Float,
+                               .offset = 0,
+                               .location = 0,
+                               .normalized = false,
+                               .size = 3,
+                               .stride = 5 * sizeof(float)},
+         vertexBuffer},
+        {opal::VertexAttribute{.name = "texCoord",
+                               .type = opal::VertexAttributeType::Float,
+                               .offset = 3 * sizeof(float),
+                               .location = 1,
+                               .normalized = false,
+                               .size = 2,
+                               .stride = 5 * sizeof(float)},
+         vertexBuffer}};
+    drawingState->configureAttributes(attributeBindings);
+
+    lodVertexBuffers.push_back(vertexBuffer);
+    lodDrawingStates.push_back(drawingState);
+}
+
+void ChunkedTerrain::streamLoop() {
+    while (true) {
+        ChunkRequest request;
+        {
+            std::unique_lock<std::mutex> lock(streamMutex);
+            requestReady.wait(
+                lock, [this]() { return stopping || !requests.empty(); });
+            if (stopping) {
+                return;
+            }
+            request = requests.front();
+            requests.pop_front();
+        }
+
+        ChunkData data = generateChunk(request);
+
+        std::lock_guard<std::mutex> lock(streamMutex);
+        completed.push_back(std::move(data));
+    }
+}
+
+ChunkedTerrain::ChunkData
+ChunkedTerrain::generateChunk(const ChunkRequest &request) {
+    ChunkData data;
+    data.request = request;
+    data.resolution = lodResolution(request.lod);
+
+    const int resolution = data.resolution;
+    const size_t texelCount = static_cast<size_t>(resolution) * resolution;
+    const float spacing = chunkSize / static_cast<float>(resolution - 1);
+    const float originX = static_cast<float>(request.x) * chunkSize;
+    const float originZ = static_cast<float>(request.z) * chunkSize;
+
+    data.heights.resize(texelCount);
+    for (int row = 0; row < resolution; row++) {
+        float *heights = data.heights.data() + (row * resolution);
+        generator->generateRow(heights, originX,
+                               originZ + (static_cast<float>(row) * spacing),
+                               spacing, resolution);
+        for (int column = 0; column < resolution; column++) {
+            heights[column] = std::clamp(heights[column], 0.0f, 1.0f);
+        }
+    }
+
+    // Coarser levels sample further apart. Scale their slopes to the finest
+    // spacing so biome maps agree across LOD seams.
+    const float slopeScale = static_cast<float>(lodResolution(0) - 1) /
+                             static_cast<float>(resolution - 1);
+    data.moisture.resize(texelCount);
+    data.temperature.resize(texelCount);
+    for (int y = 0; y < resolution; y++) {
+        for (int x = 0; x < resolution; x++) {
+            const size_t idx = x + (static_cast<size_t>(y) * resolution);
+            const float heightValue = data.heights[idx];
+
+            float temperature = std::max(0.0f, 1.0f - heightValue);
+            data.temperature[idx] = static_cast<uint8_t>(temperature * 255.0f);
+
+            float slope = aurora::computeSlope(data.heights.data(), resolution,
+                                               resolution, x, y) *
+                          slopeScale;
+            float moisture = (1.0f - slope) * (1.0f - heightValue);
+            moisture = std::clamp(moisture, 0.0f, 1.0f);
+            data.moisture[idx] = static_cast<uint8_t>(moisture * 255.0f);
+        }
+    }
+    return data;
+}
+
+void ChunkedTerrain::uploadChunk(ChunkData &data, long frame) {
+    Chunk chunk;
+    std::vector<Chunk> &free = freeChunks[data.request.lod];
+    if (!free.empty()) {
+        // Every chunk of a LOD has the same resolution, so the textures are
+        // refilled in place.
+        chunk = std::move(free.back());
+        free.pop_back();
+        chunk.heightMap.texture->updateData(data.heights.data(),
+                                            data.resolution, data.resolution,
+                                            opal::TextureDataFormat::Red);
+        chunk.moistureMap.texture->updateData(
+            data.moisture.data(), data.resolution, data.resolution,
+            opal::TextureDataFormat::Red);
+        chunk.temperatureMap.texture->updateData(
+            data.temperature.data(), data.resolution, data.resolution,
+            opal::TextureDataFormat::Red);
+    } else {
+        chunk.heightMap =
+            makeChunkTexture(opal::TextureFormat::Red16F, data.resolution,
+                             data.heights.data());
+        chunk.moistureMap =
+            makeChunkTexture(opal::TextureFormat::Red8, data.resolution,
+                             data.moisture.data());
+        chunk.temperatureMap =
+            makeChunkTexture(opal::TextureFormat::Red8, data.resolution,
+                             data.temperature.data());
+    }
+    chunk.x = data.request.x;
+    chunk.z = data.request.z;
+    chunk.lod = data.request.lod;
+
+    const int64_t key = chunkKey(chunk.x, chunk.z);
+    auto replaced = chunks.find(key);
+    if (replaced != chunks.end()) {
+        retireChunk(std::move(replaced->second), frame);
+        replaced->second = std::move(chunk);
+    } else {
+        chunks.emplace(key, std::move(chunk));
+    }
+}
+
+void ChunkedTerrain::retireChunk(Chunk &&chunk, long frame) {
+    retiredChunks.push_back({std::move(chunk), frame});
+}
+
+void ChunkedTerrain::recycleRetiredChunks(long frame) {
+    while (!retiredChunks.empty() &&
+           frame - retiredChunks.front().frame >= CHUNK_TEXTURE_REUSE_FRAMES) {
+        Chunk &chunk = retiredChunks.front().chunk;
+        freeChunks[chunk.lod].push_back(std::move(chunk));
+        retiredChunks.pop_front();
+    }
+}
+
+void ChunkedTerrain::update(Window &window) {
+    if (!initialized) {
+        return;
+    }
+    Camera *camera = window.getCamera();
+    if (camera == nullptr) {
+        return;
+    }
+
+    const glm::vec3 eye = camera->position.toGlm() - position.toGlm();
+    const int cameraX = static_cast<int>(std::floor(eye.x / chunkSize));
+    const int cameraZ = static_cast<int>(std::floor(eye.z / chunkSize));
+    auto ringsTo = [cameraX, cameraZ](int x, int z) {
+        return std::max(std::abs(x - cameraX), std::abs(z - cameraZ));
+    };
+
+    const long frame = window.device->frameCount;
+    recycleRetiredChunks(frame);
+
+    // Chunks are kept one ring past the radius so that a camera moving back
+    // and forth across a chunk border does not regenerate them.
+    for (auto it = chunks.begin(); it != chunks.end();) {
+        if (ringsTo(it->second.x, it->second.z) > viewRadius + 1) {
+            retireChunk(std::move(it->second), frame);
+            it = chunks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::vector<ChunkData> ready;
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        // Queued work the camera has moved away from is dropped before it
+        // reaches the streaming thread.
+        auto stale = std::remove_if(
+            requests.begin(), requests.end(), [&](const ChunkRequest &r) {
+                const int rings = ringsTo(r.x, r.z);
+                if (rings <= viewRadius && lodForDistance(rings) == r.lod) {
+                    return false;
+                }
+                auto requested = pending.find(chunkKey(r.x, r.z));
+                if (requested != pending.end() && requested->second == r.lod) {
+                    pending.erase(requested);
+                }
+                return true;
+            });
+        requests.erase(stale, requests.end());
+
+        const size_t uploads = std::min(
+            completed.size(),
+            static_cast<size_t>(std::max(1, maxUploadsPerFrame)));
+        std::move(completed.begin(), completed.begin() + uploads,
+                  std::back_inserter(ready));
+        completed.erase(completed.begin(), completed.begin() + uploads);
+    }
+
+    for (auto &data : ready) {
+        const ChunkRequest &request = data.request;
+        const int64_t key = chunkKey(request.x, request.z);
+        auto requested = pending.find(key);
+        if (requested != pending.end() && requested->second == request.lod) {
+            pending.erase(requested);
+        }
+        if (ringsTo(request.x, request.z) <= viewRadius + 1) {
+            uploadChunk(data, frame);
+        }
+    }
+
+    std::vector<ChunkRequest> wanted;
+    for (int dz = -viewRadius; dz <= viewRadius; dz++) {
+        for (int dx = -viewRadius; dx <= viewRadius; dx++) {
+            const int x = cameraX + dx;
+            const int z = cameraZ + dz;
+            const int lod = lodForDistance(ringsTo(x, z));
+            const int64_t key = chunkKey(x, z);
+
+            auto loaded = chunks.find(key);
+            if (loaded != chunks.end() && loaded->second.lod == lod) {
+                continue;
+            }
+            auto requested = pending.find(key);
+            if (requested != pending.end() && requested->second == lod) {
+                continue;
+            }
+            wanted.push_back({x, z, lod});
+        }
+    }
+    if (wanted.empty()) {
+        return;
+    }
+
+    // Closest chunks are generated first.
+    std::sort(wanted.begin(), wanted.end(),
+              [&](const ChunkRequest &a, const ChunkRequest &b) {
+                  return ringsTo(a.x, a.z) < ringsTo(b.x, b.z);
+              });
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        for (const auto &request : wanted) {
+            pending[chunkKey(request.x, request.z)] = request.lod;
+            requests.push_back(request);
+        }
+    }
+    requestReady.notify_one();
+}
+
+void ChunkedTerrain::render(float,
+                            std::shared_ptr<opal::CommandBuffer> commandBuffer,
+                            bool updatePipeline) {
+    (void)updatePipeline;
+    if (!isVisible || !initialized || chunks.empty()) {
+        return;
+    }
+
+    terrainPipeline = terrainShader.requestPipeline(terrainPipeline);
+    aurora::configureTerrainPipeline(terrainPipeline, 4);
+    terrainPipeline->bind();
+
+    terrainPipeline->setUniformMat4f("view", view);
+    terrainPipeline->setUniformMat4f("projection", projection);
+    terrainPipeline->setUniform1i("isFromMap", 0);
+    aurora::bindTerrainEnvironment(terrainPipeline, biomes, maxPeak, seaLevel,
+                                   id);
+
+    const glm::vec3 origin = position.toGlm();
+    const unsigned int vertexCount = patchVertexCount();
+    for (auto &[key, chunk] : chunks) {
+        (void)key;
+        const float centerX = (static_cast<float>(chunk.x) + 0.5f) * chunkSize;
+        const float centerZ = (static_cast<float>(chunk.z) + 0.5f) * chunkSize;
+        const glm::vec3 center = origin + glm::vec3(centerX, 0.0f, centerZ);
+        terrainPipeline->setUniformMat4f(
+            "model", glm::translate(glm::mat4(1.0f), center));
+        terrainPipeline->bindTexture2D("heightMap", chunk.heightMap.id, 0, id);
+        terrainPipeline->bindTexture2D("moistureMap", chunk.moistureMap.id, 1,
+                                       id);
+        terrainPipeline->bindTexture2D("temperatureMap",
+                                       chunk.temperatureMap.id, 2, id);
+
+        commandBuffer->bindDrawingState(lodDrawingStates[chunk.lod]);
+        commandBuffer->drawPatches(vertexCount, 0, id);
+        commandBuffer->unbindDrawingState();
+    }
+
+    terrainPipeline->setCullMode(opal::CullMode::Back);
+    terrainPipeline->setFrontFace(opal::FrontFace::CounterClockwise);
+    terrainPipeline->bind();
+
+    if (TracerServices::getInstance().isOk()) {
+        DebugObjectPacket debugPacket{};
+        debugPacket.drawCallsForObject = static_cast<uint32_t>(chunks.size());
+        debugPacket.frameCount = Window::mainWindow->device->frameCount;
+        debugPacket.triangleCount =
+            static_cast<uint32_t>(chunks.size() * vertexCount / 2);
+        debugPacket.vertexBufferSizeMb =
+            static_cast<float>(lodVertexBuffers.size() * vertexCount * 5 *
+                               sizeof(float)) /
+            (1024.0f * 1024.0f);
+        debugPacket.indexBufferSizeMb = 0.0f;
+        debugPacket.textureCount =
+            static_cast<uint32_t>((chunks.size() * 3) + biomes.size());
+        debugPacket.materialCount = 0;
+        debugPacket.objectType = DebugObjectType::Terrain;
+        debugPacket.objectId = this->id;
+        debugPacket.send();
+    }
+}
@@ -11,9 +11,301 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <limits>
+#include <mutex>
 #include <random>
+#include <unordered_map>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define AURORA_NOISE_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define AURORA_NOISE_NEON
+#endif
+
+namespace {
+
+// Four float and int lanes. The batch kernels perform the same operations in
+// the same order as the scalar noise() functions, so a grid sample equals the
+// matching single sample. This relies on noise.cpp being built without
+// floating-point contraction, see CMakeLists.txt.
+constexpr int LANES = 4;
+
+#if defined(AURORA_NOISE_SSE2)
+using FloatLanes = __m128;
+using IntLanes = __m128i;
+
+inline FloatLanes loadF(const float *p) { return _mm_loadu_ps(p); }
+inline void storeF(float *p, FloatLanes v) { _mm_storeu_ps(p, v); }
+inline FloatLanes splatF(float v) { return _mm_set1_ps(v); }
+inline FloatLanes add(FloatLanes a, FloatLanes b) { return _mm_add_ps(a, b); }
+inline FloatLanes sub(FloatLanes a, FloatLanes b) { return _mm_sub_ps(a, b); }
+inline FloatLanes mul(FloatLanes a, FloatLanes b) { return _mm_mul_ps(a, b); }
+inline FloatLanes minimum(FloatLanes a, FloatLanes b) {
+    return _mm_min_ps(a, b);
+}
+inline FloatLanes squareRoot(FloatLanes a) { return _mm_sqrt_ps(a); }
+inline FloatLanes select(IntLanes mask, FloatLanes a, FloatLanes b) {
+    FloatLanes m = _mm_castsi128_ps(mask);
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+}
+inline FloatLanes flipSign(FloatLanes v, IntLanes signBits) {
+    return _mm_xor_ps(v, _mm_castsi128_ps(signBits));
+}
+
+inline IntLanes loadI(const int *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+inline void storeI(int *p, IntLanes v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+}
+inline IntLanes splatI(int v) { return _mm_set1_epi32(v); }
+inline IntLanes add(IntLanes a, IntLanes b) { return _mm_add_epi32(a, b); }
+inline IntLanes sub(IntLanes a, IntLanes b) { return _mm_sub_epi32(a, b); }
+inline IntLanes bitAnd(IntLanes a, IntLanes b) {
+    return _mm_and_si128(a, b);
+}
+template <int N> inline IntLanes shiftLeft(IntLanes v) {
+    return _mm_slli_epi32(v, N);
+}
+inline IntLanes truncate(FloatLanes v) { return _mm_cvttps_epi32(v); }
+inline FloatLanes toFloat(IntLanes v) { return _mm_cvtepi32_ps(v); }
+inline IntLanes greater(FloatLanes a, FloatLanes b) {
+    return _mm_castps_si128(_mm_cmpgt_ps(a, b));
+}
+#elif defined(AURORA_NOISE_NEON)
+using FloatLanes = float32x4_t;
+using IntLanes = int32x4_t;
+
+inline FloatLanes loadF(const float *p) { return vld1q_f32(p); }
+inline void storeF(float *p, FloatLanes v) { vst1q_f32(p, v); }
+inline FloatLanes splatF(float v) { return vdupq_n_f32(v); }
+inline FloatLanes add(FloatLanes a, FloatLanes b) { return vaddq_f32(a, b); }
+inline FloatLanes sub(FloatLanes a, FloatLanes b) { return vsubq_f32(a, b); }
+inline FloatLanes mul(FloatLanes a, FloatLanes b) { return vmulq_f32(a, b); }
+inline FloatLanes minimum(FloatLanes a, FloatLanes b) {
+    return vminq_f32(a, b);
+}
+inline FloatLanes squareRoot(FloatLanes a) { return vsqrtq_f32(a); }
+inline FloatLanes select(IntLanes mask, FloatLanes a, FloatLanes b) {
+    return vbslq_f32(vreinterpretq_u32_s32(mask), a, b);
+}
+inline FloatLanes flipSign(FloatLanes v, IntLanes signBits) {
+    return vreinterpretq_f32_s32(
+        veorq_s32(vreinterpretq_s32_f32(v), signBits));
+}
+
+inline IntLanes loadI(const int *p) { return vld1q_s32(p); }
+inline void storeI(int *p, IntLanes v) { vst1q_s32(p, v); }
+inline IntLanes splatI(int v) { return vdupq_n_s32(v); }
+inline IntLanes add(IntLanes a, IntLanes b) { return vaddq_s32(a, b); }
+inline IntLanes sub(IntLanes a, IntLanes b) { return vsubq_s32(a, b); }
+inline IntLanes bitAnd(IntLanes a, IntLanes b) { return vandq_s32(a, b); }
+template <int N> inline IntLanes shiftLeft(IntLanes v) {
+    return vshlq_n_s32(v, N);
+}
+inline IntLanes truncate(FloatLanes v) { return vcvtq_s32_f32(v); }
+inline FloatLanes toFloat(IntLanes v) { return vcvtq_f32_s32(v); }
+inline IntLanes greater(FloatLanes a, FloatLanes b) {
+    return vreinterpretq_s32_u32(vcgtq_f32(a, b));
+}
+#else
+struct FloatLanes {
+    float v[LANES];
+};
+struct IntLanes {
+    int v[LANES];
+};
+
+template <typename Op> inline FloatLanes mapF(FloatLanes a, Op op) {
+    FloatLanes r;
+    for (int i = 0; i < LANES; i++) {
+        r.v[i] = op(a.v[i]);
+    }
+    return r;
+}
+template <typename Op>
+inline FloatLanes mapF(FloatLanes a, FloatLanes b, Op op) {
+    FloatLanes r;
+    for (int i = 0; i < LANES; i++) {
+        r.v[i] = op(a.v[i], b.v[i]);
+    }
+    return r;
+}
+template <typename Op> inline IntLanes mapI(IntLanes a, IntLanes b, Op op) {
+    IntLanes r;
+    for (int i = 0; i < LANES; i++) {
+        r.v[i] = op(a.v[i], b.v[i]);
+    }
+    return r;
+}
+
+inline FloatLanes loadF(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void storeF(float *p, FloatLanes v) { std::copy(v.v, v.v + LANES, p); }
+inline FloatLanes splatF(float v) { return {{v, v, v, v}}; }
+inline FloatLanes add(FloatLanes a, FloatLanes b) {
+    return mapF(a, b, [](float x, float y) { return x + y; });
+}
+inline FloatLanes sub(FloatLanes a, FloatLanes b) {
+    return mapF(a, b, [](float x, float y) { return x - y; });
+}
+inline FloatLanes mul(FloatLanes a, FloatLanes b) {
+    return mapF(a, b, [](float x, float y) { return x * y; });
+}
+inline FloatLanes minimum(FloatLanes a, FloatLanes b) {
+    return mapF(a, b, [](float x, float y) { return std::min(x, y); });
+}
+inline FloatLanes squareRoot(FloatLanes a) {
+    return mapF(a, [](float x) { return std::sqrt(x); });
+}
+inline FloatLanes select(IntLanes mask, FloatLanes a, FloatLanes b) {
+    FloatLanes r;
+    for (int i = 0; i < LANES; i++) {
+        r.v[i] = mask.v[i] != 0 ? a.v[i] : b.v[i];
+    }
+    return r;
+}
+inline FloatLanes flipSign(FloatLanes v, IntLanes signBits) {
+    FloatLanes r;
+    for (int i = 0; i < LANES; i++) {
+        r.v[i] = signBits.v[i] != 0 ? -v.v[i] : v.v[i];
+    }
+    return r;
+}
+
+inline IntLanes loadI(const int *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void storeI(int *p, IntLanes v) { std::copy(v.v, v.v + LANES, p); }
+inline IntLanes splatI(int v) { return {{v, v, v, v}}; }
+inline IntLanes add(IntLanes a, IntLanes b) {
+    return mapI(a, b, [](int x, int y) { return x + y; });
+}
+inline IntLanes sub(IntLanes a, IntLanes b) {
+    return mapI(a, b, [](int x, int y) { return x - y; });
+}
+inline IntLanes bitAnd(IntLanes a, IntLanes b) {
+    return mapI(a, b, [](int x, int y) { return x & y; });
+}
+template <int N> inline IntLanes shiftLeft(IntLanes v) {
+    return mapI(v, v, [](int x, int) {
+        return static_cast<int>(static_cast<unsigned int>(x) << N);
+    });
+}
+inline IntLanes truncate(FloatLanes v) {
+    return {{static_cast<int>(v.v[0]), static_cast<int>(v.v[1]),
+             static_cast<int>(v.v[2]), static_cast<int>(v.v[3])}};
+}
+inline FloatLanes toFloat(IntLanes v) {
+    return {{static_cast<float>(v.v[0]), static_cast<float>(v.v[1]),
+             static_cast<float>(v.v[2]), static_cast<float>(v.v[3])}};
+}
+inline IntLanes greater(FloatLanes a, FloatLanes b) {
+    IntLanes r;
+    for (int i = 0; i < LANES; i++) {
+        r.v[i] = a.v[i] > b.v[i] ? -1 : 0;
+    }
+    return r;
+}
+#endif
+
+inline FloatLanes floorLanes(FloatLanes x) {
+    FloatLanes truncated = toFloat(truncate(x));
+    return sub(truncated,
+               select(greater(truncated, x), splatF(1.0f), splatF(0.0f)));
+}
+
+inline FloatLanes fadeLanes(FloatLanes t) {
+    FloatLanes inner =
+        add(mul(t, sub(mul(t, splatF(6.0f)), splatF(15.0f))), splatF(10.0f));
+    return mul(mul(mul(t, t), t), inner);
+}
+
+inline FloatLanes lerpLanes(FloatLanes t, FloatLanes a, FloatLanes b) {
+    return add(a, mul(t, sub(b, a)));
+}
+
+// grad() of PerlinNoise: the low two hash bits negate x and y.
+inline FloatLanes gradLanes(IntLanes hash, FloatLanes x, FloatLanes y) {
+    IntLanes flipX = shiftLeft<31>(bitAnd(hash, splatI(1)));
+    IntLanes flipY = shiftLeft<30>(bitAnd(hash, splatI(2)));
+    return add(flipSign(x, flipX), flipSign(y, flipY));
+}
+
+// Column coordinates of the lanes starting at `column`.
+inline FloatLanes columnLanes(int column, float origin, float step) {
+    alignas(16) float columns[LANES];
+    for (int lane = 0; lane < LANES; lane++) {
+        columns[lane] = static_cast<float>(column + lane);
+    }
+    return add(splatF(origin), mul(loadF(columns), splatF(step)));
+}
+
+// Stores the lanes that fall inside the row.
+inline void storeRow(float *out, int column, int width, FloatLanes value) {
+    if (column + LANES <= width) {
+        storeF(out + column, value);
+        return;
+    }
+    alignas(16) float values[LANES];
+    storeF(values, value);
+    std::copy(values, values + (width - column), out + column);
+}
+
+// One row of Perlin noise, added to `out` scaled by `amplitude`. Sample
+// coordinates are `(x0 + i * dx) * frequency` and `y`.
+void perlinRow(const std::array<int, 512> &p, float *out, float x0, float dx,
+               float y, int width, float frequency, float amplitude,
+               bool accumulate) {
+    const float yFloor = std::floor(y);
+    const int Y = static_cast<int>(yFloor) & 255;
+    const float yf = y - yFloor;
+    const FloatLanes v = splatF(
+        yf * yf * yf * ((yf * ((yf * 6) - 15)) + 10));
+    const FloatLanes y0 = splatF(yf);
+    const FloatLanes y1 = splatF(yf - 1);
+    const FloatLanes frequencyLanes = splatF(frequency);
+    const FloatLanes amplitudeLanes = splatF(amplitude);
+
+    alignas(16) int xs[LANES];
+    alignas(16) int hashes[4][LANES];
+    for (int column = 0; column < width; column += LANES) {
+        FloatLanes x = mul(columnLanes(column, x0, dx), frequencyLanes);
+        FloatLanes xFloor = floorLanes(x);
+        storeI(xs, bitAnd(truncate(xFloor), splatI(255)));
+        FloatLanes xf = sub(x, xFloor);
+
+        // Permutation lookups have no vector form in SSE2 or NEON.
+        for (int lane = 0; lane < LANES; lane++) {
+            const int X = xs[lane];
+            const int A = p[X] + Y;
+            const int B = p[X + 1] + Y;
+            hashes[0][lane] = p[p[A]];
+            hashes[1][lane] = p[p[B]];
+            hashes[2][lane] = p[p[A + 1]];
+            hashes[3][lane] = p[p[B + 1]];
+        }
+
+        FloatLanes u = fadeLanes(xf);
+        FloatLanes x1 = sub(xf, splatF(1.0f));
+        FloatLanes bottom = lerpLanes(u, gradLanes(loadI(hashes[0]), xf, y0),
+                                      gradLanes(loadI(hashes[1]), x1, y0));
+        FloatLanes top = lerpLanes(u, gradLanes(loadI(hashes[2]), xf, y1),
+                                   gradLanes(loadI(hashes[3]), x1, y1));
+        FloatLanes value = mul(lerpLanes(v, bottom, top), amplitudeLanes);
+
+        if (accumulate) {
+            alignas(16) float previous[LANES] = {};
+            std::copy(out + column, out + std::min(width, column + LANES),
+                      previous);
+            value = add(loadF(previous), value);
+        }
+        storeRow(out, column, width, value);
+    }
+}
+
+} // namespace
+
 float PerlinNoise::fade(float t) { return t * t * t * (t * (t * 6 - 15) + 10); }
 
 float PerlinNoise::lerp(float t, float a, float b) { return a + (t * (b - a)); }
@@ -25,31 +317,43 @@ float PerlinNoise::grad(int hash, float x, float y) {
     return u + v;
 }
 
-std::vector<int> PerlinNoise::p;
-std::vector<int> PerlinNoise::permutation;
+std::shared_ptr<const std::array<int, 512>>
+PerlinNoise::permutationFor(unsigned int seed) {
+    static std::mutex cacheMutex;
+    static std::unordered_map<unsigned int,
+                              std::shared_ptr<const std::array<int, 512>>>
+        cache;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(seed);
+    if (it != cache.end()) {
+        return it->second;
+    }
 
-PerlinNoise::PerlinNoise(unsigned int seed) {
-    if (p.empty() && permutation.empty()) {
-        p.resize(512);
-        std::vector<int> perm(256);
-        for (int i = 0; i < 256; i++) {
-            perm[i] = i;
-        }
+    std::vector<int> perm(256);
+    for (int i = 0; i < 256; i++) {
+        perm[i] = i;
+    }
 
-        std::default_random_engine generator(seed);
-        std::uniform_int_distribution<int> distribution(0, 255);
-        for (int i = 255; i > 0; i--) {
-            int j = distribution(generator) % (i + 1);
-            std::swap(perm[i], perm[j]);
-        }
+    std::default_random_engine generator(seed);
+    std::uniform_int_distribution<int> distribution(0, 255);
+    for (int i = 255; i > 0; i--) {
+        int j = distribution(generator) % (i + 1);
+        std::swap(perm[i], perm[j]);
+    }
 
-        for (int i = 0; i < 512; i++) {
-            p[i] = perm[i % 256];
-        }
+    auto table = std::make_shared<std::array<int, 512>>();
+    for (int i = 0; i < 512; i++) {
+        (*table)[i] = perm[i % 256];
     }
+    cache.emplace(seed, table);
+    return table;
 }
 
+PerlinNoise::PerlinNoise(unsigned int seed) : p(permutationFor(seed)) {}
+
 float PerlinNoise::noise(float x, float y) const {
+    const std::array<int, 512> &p = *this->p;
     int X = (int)std::floor(x) & 255;
     int Y = (int)std::floor(y) & 255;
 
@@ -67,12 +371,21 @@ float PerlinNoise::noise(float x, float y) const {
     int BB = p[B + 1];
 
     float res =
-        lerp(lerp(grad(p[AA], x, y), grad(p[BA], x - 1, y), u),
-             lerp(grad(p[AB], x, y - 1), grad(p[BB], x - 1, y - 1), u), v);
+        lerp(v, lerp(u, grad(p[AA], x, y), grad(p[BA], x - 1, y)),
+             lerp(u, grad(p[AB], x, y - 1), grad(p[BB], x - 1, y - 1)));
 
     return res;
 }
 
+void PerlinNoise::fillGrid(float *out, float x0, float y0, float dx, float dy,
+                           int width, int height) const {
+    for (int row = 0; row < height; row++) {
+        const float y = y0 + (static_cast<float>(row) * dy);
+        perlinRow(*p, out + (static_cast<size_t>(row) * width), x0, dx, y,
+                  width, 1.0f, 1.0f, false);
+    }
+}
+
 const int SimplexNoise::grad3[12][3] = {
     {1, 1, 0},  {-1, 1, 0},  {1, -1, 0}, {-1, -1, 0}, {1, 0, 1},  {-1, 0, 1},
     {1, 0, -1}, {-1, 0, -1}, {0, 1, 1},  {0, -1, 1},  {0, 1, -1}, {0, -1, -1}};
@@ -113,18 +426,102 @@ float SimplexNoise::noise(float xin, float yin) {
 
     int ii = i & 255;
 
+    // t^4 as two multiplies, pow() would go through double precision.
     float t0 = 0.5f - (x0 * x0) - (y0 * y0);
-    float n0 = t0 < 0 ? 0.0f : pow(t0, 4) * dot(grad3[ii % 12], x0, y0);
+    float t0Squared = t0 * t0;
+    float n0 = t0 < 0 ? 0.0f
+                      : t0Squared * t0Squared * dot(grad3[ii % 12], x0, y0);
 
     float t1 = 0.5f - (x1 * x1) - (y1 * y1);
-    float n1 = t1 < 0 ? 0.0f : pow(t1, 4) * dot(grad3[(ii + i1) % 12], x1, y1);
+    float t1Squared = t1 * t1;
+    float n1 = t1 < 0 ? 0.0f
+                      : t1Squared * t1Squared *
+                            dot(grad3[(ii + i1) % 12], x1, y1);
 
     float t2 = 0.5f - (x2 * x2) - (y2 * y2);
-    float n2 = t2 < 0 ? 0.0f : pow(t2, 4) * dot(grad3[(ii + 1) % 12], x2, y2);
+    float t2Squared = t2 * t2;
+    float n2 = t2 < 0 ? 0.0f
+                      : t2Squared * t2Squared *
+                            dot(grad3[(ii + 1) % 12], x2, y2);
 
     return 70.0f * (n0 + n1 + n2);
 }
 
+void SimplexNoise::fillGrid(float *out, float x0, float y0, float dx,
+                            float dy, int width, int height) {
+    const float F2 = 0.5f * (sqrt(3.0f) - 1.0f);
+    const float G2 = (3.0f - sqrt(3.0f)) / 6.0f;
+    const FloatLanes f2 = splatF(F2);
+    const FloatLanes g2 = splatF(G2);
+    const FloatLanes g2Twice = splatF(2.0f * G2);
+    const FloatLanes zero = splatF(0.0f);
+    const FloatLanes half = splatF(0.5f);
+    const FloatLanes one = splatF(1.0f);
+
+    // Corner contribution: max(t, 0)^4 * dot(gradient, offset).
+    auto corner = [&](FloatLanes x, FloatLanes y, const int *gradients) {
+        alignas(16) float gx[LANES];
+        alignas(16) float gy[LANES];
+        for (int lane = 0; lane < LANES; lane++) {
+            gx[lane] = static_cast<float>(grad3[gradients[lane]][0]);
+            gy[lane] = static_cast<float>(grad3[gradients[lane]][1]);
+        }
+        FloatLanes t = sub(sub(half, mul(x, x)), mul(y, y));
+        FloatLanes tSquared = mul(t, t);
+        FloatLanes dotted = add(mul(loadF(gx), x), mul(loadF(gy), y));
+        FloatLanes n = mul(mul(tSquared, tSquared), dotted);
+        return select(greater(zero, t), zero, n);
+    };
+
+    alignas(16) int is[LANES];
+    alignas(16) int i1s[LANES];
+    alignas(16) int gradients[3][LANES];
+    for (int row = 0; row < height; row++) {
+        const FloatLanes yin =
+            splatF(y0 + (static_cast<float>(row) * dy));
+        float *rowOut = out + (static_cast<size_t>(row) * width);
+
+        for (int column = 0; column < width; column += LANES) {
+            FloatLanes xin = columnLanes(column, x0, dx);
+            FloatLanes s = mul(add(xin, yin), f2);
+
+            // fastfloor(): truncate, minus one unless positive.
+            FloatLanes xs = add(xin, s);
+            FloatLanes ys = add(yin, s);
+            IntLanes i = sub(truncate(xs), splatI(1));
+            i = add(i, bitAnd(greater(xs, zero), splatI(1)));
+            IntLanes j = sub(truncate(ys), splatI(1));
+            j = add(j, bitAnd(greater(ys, zero), splatI(1)));
+
+            FloatLanes t = mul(toFloat(add(i, j)), g2);
+            FloatLanes cx0 = sub(xin, sub(toFloat(i), t));
+            FloatLanes cy0 = sub(yin, sub(toFloat(j), t));
+
+            IntLanes upper = greater(cx0, cy0);
+            IntLanes i1 = bitAnd(upper, splatI(1));
+            FloatLanes cx1 = add(sub(cx0, toFloat(i1)), g2);
+            FloatLanes cy1 =
+                add(sub(cy0, toFloat(sub(splatI(1), i1))), g2);
+            FloatLanes cx2 = add(sub(cx0, one), g2Twice);
+            FloatLanes cy2 = add(sub(cy0, one), g2Twice);
+
+            storeI(is, bitAnd(i, splatI(255)));
+            storeI(i1s, i1);
+            for (int lane = 0; lane < LANES; lane++) {
+                gradients[0][lane] = is[lane] % 12;
+                gradients[1][lane] = (is[lane] + i1s[lane]) % 12;
+                gradients[2][lane] = (is[lane] + 1) % 12;
+            }
+
+            FloatLanes n0 = corner(cx0, cy0, gradients[0]);
+            FloatLanes n1 = corner(cx1, cy1, gradients[1]);
+            FloatLanes n2 = corner(cx2, cy2, gradients[2]);
+            storeRow(rowOut, column, width,
+                     mul(splatF(70.0f), add(add(n0, n1), n2)));
+        }
+    }
+}
+
 WorleyNoise::WorleyNoise(int numPoints, unsigned int seed)
     : numPoints(numPoints) {
     std::default_random_engine generator(seed);
@@ -133,18 +530,42 @@ WorleyNoise::WorleyNoise(int numPoints, unsigned int seed)
         float x = distribution(generator);
         float y = distribution(generator);
         featurePoints.emplace_back(x, y);
+        featureX.push_back(x);
+        featureY.push_back(y);
     }
 }
 
 float WorleyNoise::noise(float x, float y) const {
-    float minDist = std::numeric_limits<float>::max();
+    // sqrt is monotonic, so only the closest distance needs one.
+    float minDistSquared = std::numeric_limits<float>::max();
     for (const auto &point : featurePoints) {
         float dx = x - point.first;
         float dy = y - point.second;
-        float dist = sqrt((dx * dx) + (dy * dy));
-        minDist = std::min(dist, minDist);
+        minDistSquared = std::min((dx * dx) + (dy * dy), minDistSquared);
+    }
+    return std::sqrt(minDistSquared);
+}
+
+void WorleyNoise::fillGrid(float *out, float x0, float y0, float dx, float dy,
+                           int width, int height) const {
+    const size_t pointCount = featureX.size();
+    for (int row = 0; row < height; row++) {
+        const float y = y0 + (static_cast<float>(row) * dy);
+        float *rowOut = out + (static_cast<size_t>(row) * width);
+
+        for (int column = 0; column < width; column += LANES) {
+            FloatLanes x = columnLanes(column, x0, dx);
+            FloatLanes closest = splatF(std::numeric_limits<float>::max());
+            for (size_t i = 0; i < pointCount; i++) {
+                FloatLanes offsetX = sub(x, splatF(featureX[i]));
+                FloatLanes offsetY = splatF(y - featureY[i]);
+                closest = minimum(add(mul(offsetX, offsetX),
+                                      mul(offsetY, offsetY)),
+                                  closest);
+            }
+            storeRow(rowOut, column, width, squareRoot(closest));
+        }
     }
-    return minDist;
 }
 
 FractalNoise::FractalNoise(int o, float p)
@@ -165,42 +586,121 @@ float FractalNoise::noise(float x, float y) const {
     return total / maxValue;
 }
 
+void FractalNoise::fillGrid(float *out, float x0, float y0, float dx,
+                            float dy, int width, int height) const {
+    float maxValue = 0.0f;
+    float amplitude = 1.0f;
+    for (int i = 0; i < octaves; i++) {
+        maxValue += amplitude;
+        amplitude *= persistence;
+    }
+
+    for (int row = 0; row < height; row++) {
+        const float y = y0 + (static_cast<float>(row) * dy);
+        float *rowOut = out + (static_cast<size_t>(row) * width);
+        std::fill(rowOut, rowOut + width, 0.0f);
+
+        float frequency = 1.0f;
+        amplitude = 1.0f;
+        for (int i = 0; i < octaves; i++) {
+            perlinRow(*base.p, rowOut, x0, dx, y * frequency, width,
+                      frequency, amplitude, true);
+            amplitude *= persistence;
+            frequency *= 2.0f;
+        }
+
+        for (int column = 0; column < width; column++) {
+            rowOut[column] = rowOut[column] / maxValue;
+        }
+    }
+}
+
 bool Noise::useSeed = false;
 bool Noise::initializedSeed = false;
 float Noise::seed = 0.0f;
 
-float Noise::perlin(float x, float y) {
-    if (useSeed) {
-        return PerlinNoise(static_cast<unsigned int>(seed)).noise(x, y);
-    } else if (!initializedSeed) {
+namespace {
+
+unsigned int resolveNoiseSeed() {
+    if (!Noise::useSeed && !Noise::initializedSeed) {
         std::random_device rd;
         std::default_random_engine generator(rd());
         std::uniform_int_distribution<unsigned int> distribution(0, 10000);
-        seed = static_cast<float>(distribution(generator));
+        Noise::seed = static_cast<float>(distribution(generator));
         Noise::initializedSeed = true;
-        return PerlinNoise(static_cast<unsigned int>(seed)).noise(x, y);
-    } else {
-        return PerlinNoise(static_cast<unsigned int>(seed)).noise(x, y);
     }
+    return static_cast<unsigned int>(Noise::seed);
 }
 
+// Looking a permutation up takes the cache lock, so every thread keeps the
+// generator of the last seed instead of building one per sample.
+const PerlinNoise &seededPerlin() {
+    thread_local std::unique_ptr<PerlinNoise> cached;
+    thread_local unsigned int cachedSeed = 0;
+
+    const unsigned int currentSeed = resolveNoiseSeed();
+    if (cached == nullptr || cachedSeed != currentSeed) {
+        cached = std::make_unique<PerlinNoise>(currentSeed);
+        cachedSeed = currentSeed;
+    }
+    return *cached;
+}
+
+// Same for fractal noise, whose base generator always uses seed 0.
+const FractalNoise &cachedFractal(int octaves, float persistence) {
+    thread_local std::unique_ptr<FractalNoise> cached;
+    thread_local int cachedOctaves = 0;
+    thread_local float cachedPersistence = 0.0f;
+
+    if (cached == nullptr || cachedOctaves != octaves ||
+        cachedPersistence != persistence) {
+        cached = std::make_unique<FractalNoise>(octaves, persistence);
+        cachedOctaves = octaves;
+        cachedPersistence = persistence;
+    }
+    return *cached;
+}
+
+} // namespace
+
+float Noise::perlin(float x, float y) { return seededPerlin().noise(x, y); }
+
 float Noise::simplex(float x, float y) { return SimplexNoise::noise(x, y); }
 
-float Noise::worley(float x, float y) {
-    if (useSeed) {
-        return WorleyNoise(16, static_cast<unsigned int>(seed)).noise(x, y);
-    } else if (!initializedSeed) {
-        std::random_device rd;
-        std::default_random_engine generator(rd());
-        std::uniform_int_distribution<unsigned int> distribution(0, 10000);
-        seed = static_cast<float>(distribution(generator));
-        return WorleyNoise(16, static_cast<unsigned int>(seed)).noise(x, y);
-    } else {
-        return WorleyNoise(16, static_cast<unsigned int>(seed)).noise(x, y);
+namespace {
+
+// Scattering the feature points is far more expensive than a sample, keep the
+// generator of the last seed around.
+const WorleyNoise &seededWorley() {
+    thread_local std::unique_ptr<WorleyNoise> cached;
+    thread_local unsigned int cachedSeed = 0;
+
+    const unsigned int currentSeed = resolveNoiseSeed();
+    if (cached == nullptr || cachedSeed != currentSeed) {
+        cached = std::make_unique<WorleyNoise>(16, currentSeed);
+        cachedSeed = currentSeed;
     }
+    return *cached;
 }
 
+} // namespace
+
+float Noise::worley(float x, float y) { return seededWorley().noise(x, y); }
+
 float Noise::fractal(float x, float y, int octaves, float persistence) {
-    FractalNoise fractalNoise(octaves, persistence);
-    return fractalNoise.noise(x, y);
+    return cachedFractal(octaves, persistence).noise(x, y);
+}
+
+void Noise::perlinRow(float *out, float x0, float y, float dx, int count) {
+    seededPerlin().fillGrid(out, x0, y, dx, 0.0f, count, 1);
+}
+
+void Noise::worleyRow(float *out, float x0, float y, float dx, int count) {
+    seededWorley().fillGrid(out, x0, y, dx, 0.0f, count, 1);
+}
+
+void Noise::fractalRow(float *out, float x0, float y, float dx, int count,
+                       int octaves, float persistence) {
+    cachedFractal(octaves, persistence)
+        .fillGrid(out, x0, y, dx, 0.0f, count, 1);
 }
@@ -6,12 +6,14 @@
 // Description: Terrain functions implementation
 // Copyright (c) 2025 Max Van den Eynde
 //
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cmath>
 #include "atlas/tracer/data.h"
 #include "opal/opal.h"
 #include "atlas/camera.h"
+#include "atlas/core/job_system.h"
 #include "atlas/core/shader.h"
 #include "atlas/light.h"
 #include "atlas/tracer/log.h"
@@ -19,11 +21,120 @@
 #include "atlas/workspace.h"
 #include <aurora/terrain.h>
 #include <iostream>
+#include <string>
 #include <vector>
 #include "stb/stb_image.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/string_cast.hpp>
 
+namespace {
+
+struct BiomeUniforms {
+    opal::UniformHandle id;
+    opal::UniformHandle useTexture;
+    opal::UniformHandle textureId;
+    opal::UniformHandle texture;
+    opal::UniformHandle tintColor;
+    opal::UniformHandle minHeight;
+    opal::UniformHandle maxHeight;
+    opal::UniformHandle minMoisture;
+    opal::UniformHandle maxMoisture;
+    opal::UniformHandle minTemperature;
+    opal::UniformHandle maxTemperature;
+};
+
+// Biome uniform names are built once per index and reused on every frame.
+const BiomeUniforms &biomeUniforms(size_t index) {
+    static std::vector<BiomeUniforms> uniforms;
+    while (uniforms.size() <= index) {
+        const std::string i = std::to_string(uniforms.size());
+        const std::string base = "biomes[" + i + "].";
+        uniforms.push_back({
+            opal::UniformHandle(base + "id"),
+            opal::UniformHandle(base + "useTexture"),
+            opal::UniformHandle(base + "textureId"),
+            opal::UniformHandle("biomeTexture" + i),
+            opal::UniformHandle(base + "tintColor"),
+            opal::UniformHandle(base + "minHeight"),
+            opal::UniformHandle(base + "maxHeight"),
+            opal::UniformHandle(base + "minMoisture"),
+            opal::UniformHandle(base + "maxMoisture"),
+            opal::UniformHandle(base + "minTemperature"),
+            opal::UniformHandle(base + "maxTemperature"),
+        });
+    }
+    return uniforms[index];
+}
+
+const std::vector<opal::UniformHandle> &terrainTextureUniforms() {
+    static const std::vector<opal::UniformHandle> uniforms = [] {
+        std::vector<opal::UniformHandle> handles;
+        for (int i = 0; i < 12; i++) {
+            handles.emplace_back("texture" + std::to_string(i));
+        }
+        return handles;
+    }();
+    return uniforms;
+}
+
+// Rows handed to a worker at a time when sampling a terrain generator.
+constexpr size_t HEIGHT_TILE_ROWS = 8;
+
+// Largest value of a quantized heightfield sample.
+constexpr float HEIGHTFIELD_MAX = 65535.0f;
+// Points handed to a worker at a time by the batch surface queries.
+constexpr size_t SAMPLE_BATCH = 1024;
+// Jolt splits height fields into blocks, so the side must be a multiple.
+constexpr uint32_t COLLIDER_BLOCK = 4;
+
+// Samples the generator into a single-channel heightmap normalized to [0, 1].
+std::vector<float> generateHeights(TerrainGenerator &generator, int width,
+                                   int height) {
+    std::vector<float> heights(static_cast<size_t>(width) * height);
+
+    // Generators may set up shared state, such as the global noise seed, on
+    // their first sample. Take it here before rows run concurrently.
+    generator.generateHeight(0.0f, 0.0f);
+
+    JobSystem::getInstance().parallelFor(
+        height, HEIGHT_TILE_ROWS, [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; y++) {
+                float *row = heights.data() + (y * width);
+                generator.generateRow(row, 0.0f, static_cast<float>(y), 1.0f,
+                                      width);
+                for (int x = 0; x < width; x++) {
+                    row[x] = glm::clamp(row[x], 0.0f, 1.0f);
+                }
+            }
+        });
+    return heights;
+}
+
+// Averages the color channels of a loaded heightmap into [0, 1] heights.
+std::vector<float> decodeHeights(const unsigned char *data, int width,
+                                 int height, int nChannels) {
+    std::vector<float> heights(static_cast<size_t>(width) * height, 0.0f);
+    if (nChannels != 1 && nChannels < 3) {
+        return heights;
+    }
+
+    JobSystem::getInstance().parallelFor(
+        heights.size(), HEIGHT_TILE_ROWS * width,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const unsigned char *texel = data + (i * nChannels);
+                int value = texel[0];
+                if (nChannels >= 3) {
+                    value = (texel[0] + texel[1] + texel[2]) / 3;
+                }
+                heights[i] = static_cast<float>(value) / 255.0f;
+            }
+        });
+    return heights;
+}
+
+} // namespace
+
 void Terrain::initialize() {
     atlas_log("Initializing terrain");
     VertexShader vertexShader =
@@ -44,7 +155,7 @@ void Terrain::initialize() {
 
     int width, height, nChannels;
     unsigned char *data = nullptr;
-    std::vector<uint8_t> heightData = {};
+    std::vector<float> heights;
     if (createdWithMap) {
         if (heightmap.type != ResourceType::Image) {
             atlas_error("Heightmap resource is not an image");
@@ -59,49 +170,43 @@ void Terrain::initialize() {
             std::cerr << "Failed to load heightmap!" << std::endl;
             return;
         }
+        heights = decodeHeights(data, width, height, nChannels);
     } else if (!createdWithMap && generator != nullptr) {
         width = this->width;
         height = this->height;
-        heightData.resize(width * height * 4);
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                float heightValue = generator->generateHeight(x, y);
-                uint8_t heightByte = static_cast<uint8_t>(
-                    glm::clamp(heightValue * 255.f, 0.0f, 255.0f));
-
-                int index = (y * width + x) * 4;
-                heightData[index + 0] = heightByte; // R
-                heightData[index + 1] = heightByte; // G
-                heightData[index + 2] = heightByte; // B
-                heightData[index + 3] = 255;        // A
-            }
-        }
-        data = heightData.data();
-        nChannels = 4;
+        heights = generateHeights(*generator, width, height);
+        nChannels = 1;
     } else {
         atlas_error("No heightmap resource or terrain generator provided");
         throw std::runtime_error(
             "No heightmap resource or terrain generator provided");
     }
 
-    this->generateBiomes(data, width, height, nChannels);
-
-    opal::TextureFormat texFormat;
-    opal::TextureDataFormat dataFormat;
+    this->storeHeightfield(heights, width, height);
+    this->generateBiomes(heights.data(), width, height);
 
-    if (nChannels == 4) {
-        texFormat = opal::TextureFormat::Rgba8;
-        dataFormat = opal::TextureDataFormat::Rgba;
-    } else if (nChannels == 3) {
-        texFormat = opal::TextureFormat::Rgb8;
-        dataFormat = opal::TextureDataFormat::Rgb;
+    if (createdWithMap) {
+        opal::TextureFormat texFormat;
+        opal::TextureDataFormat dataFormat;
+
+        if (nChannels == 4) {
+            texFormat = opal::TextureFormat::Rgba8;
+            dataFormat = opal::TextureDataFormat::Rgba;
+        } else if (nChannels == 3) {
+            texFormat = opal::TextureFormat::Rgb8;
+            dataFormat = opal::TextureDataFormat::Rgb;
+        } else {
+            texFormat = opal::TextureFormat::Rgb16F;
+            dataFormat = opal::TextureDataFormat::Red;
+        }
+        terrainTexture.texture =
+            opal::Texture::create(opal::TextureType::Texture2D, texFormat,
+                                  width, height, dataFormat, data, 1);
     } else {
-        texFormat = opal::TextureFormat::Rgb16F;
-        dataFormat = opal::TextureDataFormat::Red;
+        terrainTexture.texture = opal::Texture::create(
+            opal::TextureType::Texture2D, opal::TextureFormat::Red16F, width,
+            height, opal::TextureDataFormat::Red, heights.data(), 1);
     }
-    terrainTexture.texture =
-        opal::Texture::create(opal::TextureType::Texture2D, texFormat, width,
-                              height, dataFormat, data, 1);
     terrainTexture.texture->setWrapMode(opal::TextureAxis::S,
                                         opal::TextureWrapMode::Repeat);
     terrainTexture.texture->setWrapMode(opal::TextureAxis::T,
@@ -150,10 +255,8 @@ void Terrain::initialize() {
         }
     }
 
-    if (generator == nullptr) {
+    if (data != nullptr) {
         stbi_image_free(data);
-    } else {
-        data = nullptr;
     }
 
     vertexBuffer = opal::Buffer::create(
@@ -185,122 +288,133 @@ void Terrain::initialize() {
     updateModelMatrix();
 }
 
-void Terrain::render(float, std::shared_ptr<opal::CommandBuffer> commandBuffer,
-                     bool updatePipeline) {
-    (void)updatePipeline;
-    if (!isVisible) {
-        return;
-    }
-    updateModelMatrix();
-
-    static std::shared_ptr<opal::Pipeline> terrainPipeline = nullptr;
-    if (terrainPipeline == nullptr) {
-        terrainPipeline = opal::Pipeline::create();
-    }
-    terrainPipeline = terrainShader.requestPipeline(terrainPipeline);
-
-    terrainPipeline->enableDepthTest(true);
-    terrainPipeline->setDepthCompareOp(opal::CompareOp::Less);
-    terrainPipeline->enableDepthWrite(true);
-    terrainPipeline->setCullMode(opal::CullMode::Back);
-    terrainPipeline->setFrontFace(opal::FrontFace::Clockwise);
-    terrainPipeline->setPrimitiveStyle(opal::PrimitiveStyle::Patches);
-    terrainPipeline->setPatchVertices(patch_count);
-    terrainPipeline->bind();
-
-    commandBuffer->bindDrawingState(drawingState);
-
-    terrainPipeline->setUniformMat4f("model", model);
-    terrainPipeline->setUniformMat4f("view", view);
-    terrainPipeline->setUniformMat4f("projection", projection);
+void aurora::configureTerrainPipeline(
+    const std::shared_ptr<opal::Pipeline> &pipeline,
+    unsigned int patchVertices) {
+    pipeline->enableDepthTest(true);
+    pipeline->setDepthCompareOp(opal::CompareOp::Less);
+    pipeline->enableDepthWrite(true);
+    pipeline->setCullMode(opal::CullMode::Back);
+    pipeline->setFrontFace(opal::FrontFace::Clockwise);
+    pipeline->setPrimitiveStyle(opal::PrimitiveStyle::Patches);
+    pipeline->setPatchVertices(patchVertices);
+}
 
-    terrainPipeline->setUniform1f("maxPeak", maxPeak);
-    terrainPipeline->setUniform1f("seaLevel", seaLevel);
-    terrainPipeline->setUniform1i("isFromMap", createdWithMap ? 1 : 0);
-
-    terrainPipeline->bindTexture2D("heightMap", terrainTexture.id, 0, id);
-    terrainPipeline->bindTexture2D("moistureMap", moistureMapTexture.id, 1, id);
-    terrainPipeline->bindTexture2D("temperatureMap", temperatureMapTexture.id,
-                                   2, id);
+void aurora::bindTerrainEnvironment(
+    const std::shared_ptr<opal::Pipeline> &pipeline, std::vector<Biome> &biomes,
+    float maxPeak, float seaLevel, int objectId) {
+    pipeline->setUniform1f("maxPeak", maxPeak);
+    pipeline->setUniform1f("seaLevel", seaLevel);
 
+    const auto &textureUniforms = terrainTextureUniforms();
     for (int i = 0; i < 12; i++) {
-        terrainPipeline->setUniform1i("texture" + std::to_string(i), i + 4);
+        pipeline->setUniform1i(textureUniforms[i], i + 4);
     }
 
     for (size_t i = 0; i < biomes.size(); i++) {
         Biome &biome = biomes[i];
+        const BiomeUniforms &uniforms = biomeUniforms(i);
         if (biome.useTexture) {
-            terrainPipeline->setUniform1i(
-                "biomes[" + std::to_string(i) + "].useTexture", 1);
-            terrainPipeline->setUniform1i(
-                "biomes[" + std::to_string(i) + "].textureId", i + 4);
-            terrainPipeline->bindTexture2D("biomeTexture" + std::to_string(i),
-                                           biome.texture.id, 3 + i, id);
+            pipeline->setUniform1i(uniforms.useTexture, 1);
+            pipeline->setUniform1i(uniforms.textureId, i + 4);
+            pipeline->bindTexture2D(uniforms.texture, biome.texture.id, 3 + i,
+                                    objectId);
         } else {
-            terrainPipeline->setUniform1i(
-                "biomes[" + std::to_string(i) + "].useTexture", 0);
+            pipeline->setUniform1i(uniforms.useTexture, 0);
         }
-        std::string baseName = "biomes[" + std::to_string(i) + "]";
-        terrainPipeline->setUniform1i(baseName + ".id", i);
-        terrainPipeline->setUniform4f(baseName + ".tintColor",
-                                      biomes[i].color.r, biomes[i].color.g,
-                                      biomes[i].color.b, biomes[i].color.a);
-        terrainPipeline->setUniform1f(baseName + ".minHeight",
-                                      biomes[i].minHeight);
-        terrainPipeline->setUniform1f(baseName + ".maxHeight",
-                                      biomes[i].maxHeight);
-        terrainPipeline->setUniform1f(baseName + ".minMoisture",
-                                      biomes[i].minMoisture);
-        terrainPipeline->setUniform1f(baseName + ".maxMoisture",
-                                      biomes[i].maxMoisture);
-        terrainPipeline->setUniform1f(baseName + ".minTemperature",
-                                      biomes[i].minTemperature);
-        terrainPipeline->setUniform1f(baseName + ".maxTemperature",
-                                      biomes[i].maxTemperature);
+        pipeline->setUniform1i(uniforms.id, i);
+        pipeline->setUniform4f(uniforms.tintColor, biome.color.r,
+                               biome.color.g, biome.color.b, biome.color.a);
+        pipeline->setUniform1f(uniforms.minHeight, biome.minHeight);
+        pipeline->setUniform1f(uniforms.maxHeight, biome.maxHeight);
+        pipeline->setUniform1f(uniforms.minMoisture, biome.minMoisture);
+        pipeline->setUniform1f(uniforms.maxMoisture, biome.maxMoisture);
+        pipeline->setUniform1f(uniforms.minTemperature, biome.minTemperature);
+        pipeline->setUniform1f(uniforms.maxTemperature, biome.maxTemperature);
     }
-    terrainPipeline->setUniform1i("biomesCount", biomes.size());
+    pipeline->setUniform1i("biomesCount", biomes.size());
     bool hasShadow = false;
     Window *mainWindow = Window::mainWindow;
     for (auto *dirLight : mainWindow->getCurrentScene()->directionalLights) {
-        terrainPipeline->setUniform3f("lightDir", dirLight->direction.x,
-                                      dirLight->direction.y,
-                                      dirLight->direction.z);
-        terrainPipeline->setUniform4f("directionalColor", dirLight->color.r,
-                                      dirLight->color.g, dirLight->color.b,
-                                      dirLight->color.a);
-        terrainPipeline->setUniform1f("directionalIntensity",
-                                      dirLight->color.a);
+        pipeline->setUniform3f("lightDir", dirLight->direction.x,
+                               dirLight->direction.y, dirLight->direction.z);
+        pipeline->setUniform4f("directionalColor", dirLight->color.r,
+                               dirLight->color.g, dirLight->color.b,
+                               dirLight->color.a);
+        pipeline->setUniform1f("directionalIntensity", dirLight->color.a);
         if (!dirLight->doesCastShadows)
             continue;
+        const auto &cascades = dirLight->getShadowCascades();
+        if (cascades.empty()) {
+            continue;
+        }
         hasShadow = true;
-        terrainPipeline->bindTexture2D(
-            "shadowMap", dirLight->shadowRenderTarget->texture.id, 3, id);
-        ShadowParams shadowParams =
-            dirLight->calculateLightSpaceMatrix(mainWindow->renderables);
-        terrainPipeline->setUniformMat4f("lightViewProj",
-                                         shadowParams.lightProjection *
-                                             shadowParams.lightView);
-        terrainPipeline->setUniform1f("shadowBias", shadowParams.bias);
+        // The terrain samples a single cascade, so it uses the widest one.
+        // Its matrices are the ones its area of the map was rendered with.
+        const ShadowCascade &cascade = cascades.back();
+        pipeline->bindTexture2D("shadowMap", cascade.renderTarget->texture.id,
+                                3, objectId);
+        const ShadowParams &shadowParams = cascade.params;
+        pipeline->setUniformMat4f("lightViewProj",
+                                  shadowParams.lightProjection *
+                                      shadowParams.lightView);
+        pipeline->setUniform1f("shadowBias", shadowParams.bias);
+        pipeline->setUniform4f("shadowAtlasRect", cascade.atlasRect.x,
+                               cascade.atlasRect.y, cascade.atlasRect.z,
+                               cascade.atlasRect.w);
     }
 
     if (mainWindow->getCurrentScene()->directionalLights.size() > 0) {
-        terrainPipeline->setUniform1i("hasLight", 1);
+        pipeline->setUniform1i("hasLight", 1);
     } else {
-        terrainPipeline->setUniform1i("hasLight", 0);
+        pipeline->setUniform1i("hasLight", 0);
     }
 
     if (!hasShadow) {
-        terrainPipeline->setUniform1i("useShadowMap", 0);
+        pipeline->setUniform1i("useShadowMap", 0);
     } else {
-        terrainPipeline->setUniform1i("useShadowMap", 1);
+        pipeline->setUniform1i("useShadowMap", 1);
     }
 
     Camera *camera = mainWindow->getCamera();
-    terrainPipeline->setUniform3f("viewDir", camera->getFrontVector().x,
-                                  camera->getFrontVector().y,
-                                  camera->getFrontVector().z);
+    pipeline->setUniform3f("viewDir", camera->getFrontVector().x,
+                           camera->getFrontVector().y,
+                           camera->getFrontVector().z);
     AmbientLight ambient = mainWindow->getCurrentScene()->ambientLight;
-    terrainPipeline->setUniform1f("ambientStrength", ambient.intensity * 4.0);
+    pipeline->setUniform1f("ambientStrength", ambient.intensity * 4.0);
+}
+
+void Terrain::render(float, std::shared_ptr<opal::CommandBuffer> commandBuffer,
+                     bool updatePipeline) {
+    (void)updatePipeline;
+    if (!isVisible) {
+        return;
+    }
+    updateModelMatrix();
+
+    static std::shared_ptr<opal::Pipeline> terrainPipeline = nullptr;
+    if (terrainPipeline == nullptr) {
+        terrainPipeline = opal::Pipeline::create();
+    }
+    terrainPipeline = terrainShader.requestPipeline(terrainPipeline);
+
+    aurora::configureTerrainPipeline(terrainPipeline, patch_count);
+    terrainPipeline->bind();
+
+    commandBuffer->bindDrawingState(drawingState);
+
+    terrainPipeline->setUniformMat4f("model", model);
+    terrainPipeline->setUniformMat4f("view", view);
+    terrainPipeline->setUniformMat4f("projection", projection);
+    terrainPipeline->setUniform1i("isFromMap", createdWithMap ? 1 : 0);
+
+    terrainPipeline->bindTexture2D("heightMap", terrainTexture.id, 0, id);
+    terrainPipeline->bindTexture2D("moistureMap", moistureMapTexture.id, 1, id);
+    terrainPipeline->bindTexture2D("temperatureMap", temperatureMapTexture.id,
+                                   2, id);
+
+    aurora::bindTerrainEnvironment(terrainPipeline, biomes, maxPeak, seaLevel,
+                                   id);
 
     commandBuffer->drawPatches(patch_count * rez * rez, 0, id);
     commandBuffer->unbindDrawingState();
@@ -372,3 +486,154 @@ void Terrain::updateModelMatrix() {
 
     this->model = translation_matrix * rotation_matrix * scale_matrix;
 }
+
+void Terrain::storeHeightfield(const std::vector<float> &heights, int width,
+                               int height) {
+    heightfieldWidth = width;
+    heightfieldDepth = height;
+    heightfield.resize(heights.size());
+
+    JobSystem::getInstance().parallelFor(
+        heights.size(), HEIGHT_TILE_ROWS * width,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const float value = glm::clamp(heights[i], 0.0f, 1.0f);
+                heightfield[i] =
+                    static_cast<uint16_t>(std::lround(value * HEIGHTFIELD_MAX));
+            }
+        });
+}
+
+Position2d Terrain::toHeightfield(float x, float z) const {
+    // Vertices span [-size / 2, size / 2] in model space and the corner
+    // samples sit on the edges.
+    const float width = static_cast<float>(heightfieldWidth);
+    const float depth = static_cast<float>(heightfieldDepth);
+    const float localX = (x - position.x) / scale.x;
+    const float localZ = (z - position.z) / scale.z;
+    return {((localX / width) + 0.5f) * (width - 1.0f),
+            ((localZ / depth) + 0.5f) * (depth - 1.0f)};
+}
+
+float Terrain::heightfieldAt(float column, float row) const {
+    column = glm::clamp(column, 0.0f, static_cast<float>(heightfieldWidth - 1));
+    row = glm::clamp(row, 0.0f, static_cast<float>(heightfieldDepth - 1));
+
+    const int x0 = static_cast<int>(column);
+    const int z0 = static_cast<int>(row);
+    const int x1 = std::min(x0 + 1, heightfieldWidth - 1);
+    const int z1 = std::min(z0 + 1, heightfieldDepth - 1);
+    const float fx = column - static_cast<float>(x0);
+    const float fz = row - static_cast<float>(z0);
+
+    const uint16_t *current = heightfield.data() + (z0 * heightfieldWidth);
+    const uint16_t *next = heightfield.data() + (z1 * heightfieldWidth);
+    const float top = glm::mix(static_cast<float>(current[x0]),
+                               static_cast<float>(current[x1]), fx);
+    const float bottom = glm::mix(static_cast<float>(next[x0]),
+                                  static_cast<float>(next[x1]), fx);
+    return glm::mix(top, bottom, fz) / HEIGHTFIELD_MAX;
+}
+
+float Terrain::sampleHeight(float x, float z) const {
+    if (heightfield.empty()) {
+        return position.y;
+    }
+    const Position2d cell = toHeightfield(x, z);
+    const float height = heightfieldAt(cell.x, cell.y);
+    return position.y + (scale.y * ((height * maxPeak) - seaLevel));
+}
+
+Normal3d Terrain::sampleNormal(float x, float z) const {
+    if (heightfield.empty()) {
+        return Normal3d::up();
+    }
+
+    const Position2d cell = toHeightfield(x, z);
+    const float column =
+        glm::clamp(cell.x, 0.0f, static_cast<float>(heightfieldWidth - 1));
+    const float row =
+        glm::clamp(cell.y, 0.0f, static_cast<float>(heightfieldDepth - 1));
+
+    // Central differences, one-sided on the edges of the grid.
+    const float left = std::max(column - 1.0f, 0.0f);
+    const float right =
+        std::min(column + 1.0f, static_cast<float>(heightfieldWidth - 1));
+    const float back = std::max(row - 1.0f, 0.0f);
+    const float front =
+        std::min(row + 1.0f, static_cast<float>(heightfieldDepth - 1));
+
+    const float spacingX = scale.x * static_cast<float>(heightfieldWidth) /
+                           static_cast<float>(heightfieldWidth - 1);
+    const float spacingZ = scale.z * static_cast<float>(heightfieldDepth) /
+                           static_cast<float>(heightfieldDepth - 1);
+    const float rise = scale.y * maxPeak;
+
+    float slopeX = 0.0f;
+    if (right > left) {
+        slopeX = (heightfieldAt(right, row) - heightfieldAt(left, row)) *
+                 rise / ((right - left) * spacingX);
+    }
+    float slopeZ = 0.0f;
+    if (front > back) {
+        slopeZ = (heightfieldAt(column, front) - heightfieldAt(column, back)) *
+                 rise / ((front - back) * spacingZ);
+    }
+    return Normal3d(-slopeX, 1.0f, -slopeZ).normalized();
+}
+
+void Terrain::sampleHeights(const Position2d *points, float *heights,
+                            size_t count) const {
+    JobSystem::getInstance().parallelFor(
+        count, SAMPLE_BATCH, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                heights[i] = sampleHeight(points[i].x, points[i].y);
+            }
+        });
+}
+
+void Terrain::sampleNormals(const Position2d *points, Normal3d *normals,
+                            size_t count) const {
+    JobSystem::getInstance().parallelFor(
+        count, SAMPLE_BATCH, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                normals[i] = sampleNormal(points[i].x, points[i].y);
+            }
+        });
+}
+
+std::shared_ptr<bezel::HeightFieldCollider> Terrain::createCollider() const {
+    if (heightfield.empty()) {
+        atlas_warning("Terrain must be initialized before creating a collider");
+        return nullptr;
+    }
+
+    // Resample onto a square grid covering the same area, so non-square
+    // terrains only change the spacing between samples.
+    const uint32_t side = static_cast<uint32_t>(
+        std::max({heightfieldWidth, heightfieldDepth, 2}));
+    const uint32_t sampleCount =
+        (side + COLLIDER_BLOCK - 1) / COLLIDER_BLOCK * COLLIDER_BLOCK;
+    const float last = static_cast<float>(sampleCount - 1);
+    const float columnStep = static_cast<float>(heightfieldWidth - 1) / last;
+    const float rowStep = static_cast<float>(heightfieldDepth - 1) / last;
+
+    std::vector<float> samples(static_cast<size_t>(sampleCount) * sampleCount);
+    JobSystem::getInstance().parallelFor(
+        sampleCount, HEIGHT_TILE_ROWS, [&](size_t begin, size_t end) {
+            for (size_t z = begin; z < end; z++) {
+                float *row = samples.data() + (z * sampleCount);
+                for (uint32_t x = 0; x < sampleCount; x++) {
+                    row[x] = heightfieldAt(static_cast<float>(x) * columnStep,
+                                           static_cast<float>(z) * rowStep);
+                }
+            }
+        });
+
+    const float width = static_cast<float>(heightfieldWidth) * scale.x;
+    const float depth = static_cast<float>(heightfieldDepth) * scale.z;
+    const Position3d offset(-width / 2.0f, -seaLevel * scale.y, -depth / 2.0f);
+    const Position3d spacing(width / last, maxPeak * scale.y, depth / last);
+    return std::make_shared<bezel::HeightFieldCollider>(samples, sampleCount,
+                                                        offset, spacing);
+}
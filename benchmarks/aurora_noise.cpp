@@ -0,0 +1,119 @@
+/*
+ aurora_noise.cpp
+ As part of the Atlas project
+ Created by Max Van den Eynde in 2025
+ --------------------------------------------------
+ Description: Noise sampling microbenchmark for Aurora
+ Copyright (c) 2025 maxvdec
+*/
+
+#include "aurora/procedural.h"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+namespace {
+
+constexpr int GRID_SIZE = 4096;
+constexpr float ORIGIN = -37.5f;
+constexpr float STEP = 0.013f;
+
+double measure(const std::function<void(std::vector<float> &)> &fill,
+               std::vector<float> &values) {
+    auto start = std::chrono::steady_clock::now();
+    fill(values);
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+template <typename Sample>
+void fillScalar(std::vector<float> &values, float scale,
+                const Sample &sample) {
+    for (int row = 0; row < GRID_SIZE; row++) {
+        const float y = ORIGIN + (static_cast<float>(row) * STEP * scale);
+        for (int column = 0; column < GRID_SIZE; column++) {
+            const float x =
+                ORIGIN + (static_cast<float>(column) * STEP * scale);
+            values[(static_cast<size_t>(row) * GRID_SIZE) + column] =
+                sample(x, y);
+        }
+    }
+}
+
+void report(const char *name, double scalarMs, double gridMs) {
+    std::printf("%8s | %12.1f %13.1f | %7.2fx\n", name, scalarMs, gridMs,
+                scalarMs / gridMs);
+}
+
+} // namespace
+
+int main() {
+    std::vector<float> values(static_cast<size_t>(GRID_SIZE) * GRID_SIZE);
+    std::printf("%8s | %12s %13s | %8s\n", "noise", "noise() ms",
+                "fillGrid() ms", "speedup");
+
+    PerlinNoise perlin(1234);
+    report("perlin", measure(
+                         [&](std::vector<float> &out) {
+                             fillScalar(out, 1.0f, [&](float x, float y) {
+                                 return perlin.noise(x, y);
+                             });
+                         },
+                         values),
+           measure(
+               [&](std::vector<float> &out) {
+                   perlin.fillGrid(out.data(), ORIGIN, ORIGIN, STEP, STEP,
+                                   GRID_SIZE, GRID_SIZE);
+               },
+               values));
+
+    report("simplex", measure(
+                          [&](std::vector<float> &out) {
+                              fillScalar(out, 1.0f, [](float x, float y) {
+                                  return SimplexNoise::noise(x, y);
+                              });
+                          },
+                          values),
+           measure(
+               [&](std::vector<float> &out) {
+                   SimplexNoise::fillGrid(out.data(), ORIGIN, ORIGIN, STEP,
+                                          STEP, GRID_SIZE, GRID_SIZE);
+               },
+               values));
+
+    WorleyNoise worley(16, 1234);
+    const float worleyScale = 0.01f;
+    report("worley", measure(
+                         [&](std::vector<float> &out) {
+                             fillScalar(out, worleyScale,
+                                        [&](float x, float y) {
+                                            return worley.noise(x, y);
+                                        });
+                         },
+                         values),
+           measure(
+               [&](std::vector<float> &out) {
+                   worley.fillGrid(out.data(), ORIGIN, ORIGIN,
+                                   STEP * worleyScale, STEP * worleyScale,
+                                   GRID_SIZE, GRID_SIZE);
+               },
+               values));
+
+    FractalNoise fractal(6, 0.5f);
+    report("fbm", measure(
+                      [&](std::vector<float> &out) {
+                          fillScalar(out, 1.0f, [&](float x, float y) {
+                              return fractal.noise(x, y);
+                          });
+                      },
+                      values),
+           measure(
+               [&](std::vector<float> &out) {
+                   fractal.fillGrid(out.data(), ORIGIN, ORIGIN, STEP, STEP,
+                                    GRID_SIZE, GRID_SIZE);
+               },
+               values));
+    return 0;
+}
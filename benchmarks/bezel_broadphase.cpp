@@ -0,0 +1,135 @@
+/*
+ bezel_broadphase.cpp
+ As part of the Atlas project
+ Created by Max Van den Eynde in 2025
+ --------------------------------------------------
+ Description: Broadphase microbenchmark for Bezel Native
+ Copyright (c) 2025 maxvdec
+*/
+
+#include "bezel/native/body.h"
+#include "bezel/native/bounds.h"
+#include "bezel/native/shape.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr float FRAME_TIME = 1.0f / 60.0f;
+constexpr int FRAME_COUNT = 120;
+
+std::vector<std::shared_ptr<Body>> makeScene(int count, std::mt19937 &rng) {
+    const float extent = std::cbrt(static_cast<float>(count)) * 2.0f;
+    std::uniform_real_distribution<float> position(-extent, extent);
+    std::uniform_real_distribution<float> velocity(-2.0f, 2.0f);
+    std::uniform_real_distribution<float> radius(0.25f, 0.75f);
+
+    std::vector<std::shared_ptr<Body>> bodies;
+    bodies.reserve(count);
+    for (int i = 0; i < count; i++) {
+        auto body = std::make_shared<Body>();
+        body->shape = std::make_shared<Sphere>(radius(rng));
+        body->position = {position(rng), position(rng), position(rng)};
+        body->orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        body->linearVelocity = {velocity(rng), velocity(rng), velocity(rng)};
+        body->applyMass(1.0f);
+        bodies.push_back(body);
+    }
+    return bodies;
+}
+
+Bounds sweptBounds(const Body &body, float dt) {
+    Bounds bounds =
+        body.shape->getBounds(body.position.toGlm(), body.orientation);
+    bounds.expand(bounds.mins + body.linearVelocity * dt);
+    bounds.expand(bounds.maxs + body.linearVelocity * dt);
+    return bounds;
+}
+
+void advance(std::vector<std::shared_ptr<Body>> &bodies, float dt) {
+    for (auto &body : bodies) {
+        body->position = Position3d::fromGlm(body->position.toGlm() +
+                                             body->linearVelocity * dt);
+    }
+}
+
+struct Measurement {
+    double pairsPerFrame = 0.0;
+    double nsPerBody = 0.0;
+};
+
+Measurement measureLegacy(int count) {
+    std::mt19937 rng(1234);
+    auto bodies = makeScene(count, rng);
+    std::vector<CollisionPair> pairs;
+
+    std::size_t totalPairs = 0;
+    std::chrono::nanoseconds elapsed{0};
+    for (int frame = 0; frame < FRAME_COUNT; frame++) {
+        auto start = std::chrono::steady_clock::now();
+        bezel::broadPhase(bodies, pairs, FRAME_TIME);
+        elapsed += std::chrono::steady_clock::now() - start;
+        totalPairs += pairs.size();
+        advance(bodies, FRAME_TIME);
+    }
+
+    Measurement result;
+    result.pairsPerFrame = static_cast<double>(totalPairs) / FRAME_COUNT;
+    result.nsPerBody = static_cast<double>(elapsed.count()) /
+                       (static_cast<double>(FRAME_COUNT) * count);
+    return result;
+}
+
+Measurement measureSweepAndPrune(int count) {
+    std::mt19937 rng(1234);
+    auto bodies = makeScene(count, rng);
+    std::vector<CollisionPair> pairs;
+
+    bezel::SweepAndPrune broadphase;
+    std::vector<int> proxies;
+    proxies.reserve(count);
+    for (int i = 0; i < count; i++) {
+        proxies.push_back(
+            broadphase.addProxy(sweptBounds(*bodies[i], FRAME_TIME), i));
+    }
+
+    std::size_t totalPairs = 0;
+    std::chrono::nanoseconds elapsed{0};
+    for (int frame = 0; frame < FRAME_COUNT; frame++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            broadphase.moveProxy(proxies[i],
+                                 sweptBounds(*bodies[i], FRAME_TIME), i);
+        }
+        broadphase.buildPairs(pairs);
+        elapsed += std::chrono::steady_clock::now() - start;
+        totalPairs += pairs.size();
+        advance(bodies, FRAME_TIME);
+    }
+
+    Measurement result;
+    result.pairsPerFrame = static_cast<double>(totalPairs) / FRAME_COUNT;
+    result.nsPerBody = static_cast<double>(elapsed.count()) /
+                       (static_cast<double>(FRAME_COUNT) * count);
+    return result;
+}
+
+} // namespace
+
+int main() {
+    std::printf("%8s | %14s %12s | %14s %12s\n", "bodies", "1d pairs/frame",
+                "1d ns/body", "3d pairs/frame", "3d ns/body");
+
+    for (int count : {250, 1000, 2000, 5000}) {
+        Measurement legacy = measureLegacy(count);
+        Measurement sap = measureSweepAndPrune(count);
+        std::printf("%8d | %14.1f %12.1f | %14.1f %12.1f\n", count,
+                    legacy.pairsPerFrame, legacy.nsPerBody, sap.pairsPerFrame,
+                    sap.nsPerBody);
+    }
+    return 0;
+}
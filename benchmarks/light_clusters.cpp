@@ -0,0 +1,82 @@
+/*
+ light_clusters.cpp
+ As part of the Atlas project
+ Created by Max Van den Eynde in 2025
+ --------------------------------------------------
+ Description: Clustered light binning microbenchmark and reference check
+ Copyright (c) 2025 maxvdec
+*/
+
+#include "atlas/light_clusters.h"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int FRAME_COUNT = 30;
+
+std::vector<ClusterLight> makeLights(int count, const LightClusters &grid,
+                                     std::mt19937 &rng) {
+    std::uniform_real_distribution<float> unit(-1.1f, 1.1f);
+    std::uniform_real_distribution<float> depth(1.0f, grid.farPlane);
+    std::uniform_real_distribution<float> radius(0.5f, 4.0f);
+
+    std::vector<ClusterLight> lights;
+    lights.reserve(count);
+    for (int i = 0; i < count; i++) {
+        const float z = depth(rng);
+        const auto type = static_cast<ClusterLightType>(i % 3);
+        lights.push_back(
+            {.center = {unit(rng) * grid.tanHalfFovX * z,
+                        unit(rng) * grid.tanHalfFovY * z, -z},
+             .radius = radius(rng),
+             .entry = LightClusters::encode(type, static_cast<uint32_t>(i))});
+    }
+    return lights;
+}
+
+double measure(const std::function<void()> &run, int frames) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / frames;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(1234);
+    LightClusters clusters;
+    clusters.configure(1.0471976f, 16.0f / 9.0f, 0.1f, 300.0f);
+    LightClusters reference = clusters;
+
+    std::printf("%7s | %12s %12s | %8s | %10s\n", "lights", "build() ms",
+                "reference ms", "speedup", "entries");
+    bool matches = true;
+    for (int count : {64, 1024, 8192}) {
+        const std::vector<ClusterLight> lights =
+            makeLights(count, clusters, rng);
+        const double buildMs =
+            measure([&]() { clusters.build(lights); }, FRAME_COUNT);
+        const double referenceMs =
+            measure([&]() { reference.buildReference(lights); }, 1);
+
+        if (clusters.getRanges() != reference.getRanges() ||
+            clusters.getIndices() != reference.getIndices()) {
+            std::printf("%7d | cluster lists differ from the reference\n",
+                        count);
+            matches = false;
+            continue;
+        }
+        std::printf("%7d | %12.3f %12.3f | %7.1fx | %10zu\n", count, buildMs,
+                    referenceMs, referenceMs / buildMs,
+                    clusters.getIndices().size());
+    }
+    return matches ? 0 : 1;
+}
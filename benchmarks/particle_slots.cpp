@@ -0,0 +1,187 @@
+/*
+ particle_slots.cpp
+ As part of the Atlas project
+ Created by Max Van den Eynde in 2025
+ --------------------------------------------------
+ Description: Particle compute reference check against the SoA kernel
+ Copyright (c) 2025 maxvdec
+*/
+
+#include "atlas/particle_simulation.h"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int STEP_COUNT = 120;
+constexpr float DELTA_TIME = 1.0f / 60.0f;
+
+// Particles stay well inside the ambient bounds for the whole run, so the
+// compute reference never kills one the SoA kernel keeps alive.
+std::vector<ParticleSlot> makeParticles(int count, std::mt19937 &rng) {
+    std::uniform_real_distribution<float> position(-5.0f, 5.0f);
+    std::uniform_real_distribution<float> velocity(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> life(0.2f, 3.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<ParticleSlot> particles(count);
+    for (ParticleSlot &p : particles) {
+        p.posX = position(rng);
+        p.posY = position(rng);
+        p.posZ = position(rng);
+        p.velX = velocity(rng);
+        p.velY = velocity(rng);
+        p.velZ = velocity(rng);
+        p.life = life(rng);
+        p.maxLife = p.life + unit(rng);
+        p.colorR = unit(rng);
+        p.colorG = unit(rng);
+        p.colorB = unit(rng);
+        p.colorA = 1.0f;
+        p.size = unit(rng);
+    }
+    return particles;
+}
+
+ParticleStore makeStore(const std::vector<ParticleSlot> &particles) {
+    ParticleStore store;
+    store.reserve(particles.size());
+    for (const ParticleSlot &p : particles) {
+        const size_t i = store.spawn();
+        store.positionX[i] = p.posX;
+        store.positionY[i] = p.posY;
+        store.positionZ[i] = p.posZ;
+        store.velocityX[i] = p.velX;
+        store.velocityY[i] = p.velY;
+        store.velocityZ[i] = p.velZ;
+        store.colorR[i] = p.colorR;
+        store.colorG[i] = p.colorG;
+        store.colorB[i] = p.colorB;
+        store.colorA[i] = p.colorA;
+        store.life[i] = p.life;
+        store.maxLife[i] = p.maxLife;
+        store.size[i] = p.size;
+    }
+    return store;
+}
+
+// The SoA kernel keeps integrating dead particles until the emitter removes
+// them, the compute reference stops touching them. Live particles must match
+// exactly and both sides must agree on which ones are dead.
+bool matches(const ParticleStore &store, const std::vector<ParticleSlot> &slots,
+             const std::vector<ParticleInstanceData> &instances,
+             size_t instanceCount) {
+    size_t instance = 0;
+    for (size_t i = 0; i < store.getCount(); i++) {
+        const ParticleSlot &p = slots[i];
+        if (store.life[i] <= 0.0f) {
+            if (p.life > 0.0f) {
+                return false;
+            }
+            continue;
+        }
+        if (p.posX != store.positionX[i] || p.posY != store.positionY[i] ||
+            p.posZ != store.positionZ[i] || p.velX != store.velocityX[i] ||
+            p.velY != store.velocityY[i] || p.velZ != store.velocityZ[i] ||
+            p.life != store.life[i] || p.colorA != store.colorA[i]) {
+            return false;
+        }
+        if (instance >= instanceCount) {
+            return false;
+        }
+        const ParticleInstanceData &data = instances[instance++];
+        if (data.posX != p.posX || data.posY != p.posY ||
+            data.posZ != p.posZ || data.colorA != p.colorA ||
+            data.size != p.size) {
+            return false;
+        }
+    }
+    return instance == instanceCount;
+}
+
+double measure(const std::function<void()> &run, int frames) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / frames;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(1234);
+
+    std::printf("%7s %7s | %12s %12s | %9s\n", "count", "sway", "SoA ms",
+                "slots ms", "instances");
+    bool allMatch = true;
+    for (int count : {1, 7, 1000, 16384}) {
+        for (bool sway : {false, true}) {
+            const std::vector<ParticleSlot> particles =
+                makeParticles(count, rng);
+            ParticleStore store = makeStore(particles);
+
+            // Every particle reaches the compute state through a spawn, the
+            // same way ParticleEmitter feeds the kernel.
+            std::vector<ParticleSlot> slots(count);
+            std::vector<ParticleInstanceData> instances(count);
+            ParticleComputeParams params;
+            params.gravity = -0.5f;
+            params.windX = 0.25f;
+            params.windZ = -0.1f;
+            params.ambient = sway ? 1 : 0;
+            params.capacity = static_cast<unsigned int>(count);
+            params.spawnCount = static_cast<unsigned int>(count);
+
+            ParticleFrameConstants constants;
+            constants.deltaTime = DELTA_TIME;
+            constants.gravity = params.gravity;
+            constants.windX = params.windX;
+            constants.windZ = params.windZ;
+            constants.ambientSway = sway;
+
+            double storeMs = 0.0;
+            double slotsMs = 0.0;
+            size_t instanceCount = 0;
+            bool stepsMatch = true;
+            for (int step = 0; step < STEP_COUNT && stepsMatch; step++) {
+                constants.time = static_cast<float>(step) * DELTA_TIME;
+                params.deltaTime = DELTA_TIME;
+                params.time = constants.time;
+
+                storeMs += measure(
+                    [&]() {
+                        integrateParticles(store, constants, 0,
+                                           store.getCount());
+                    },
+                    1);
+                slotsMs += measure(
+                    [&]() {
+                        instanceCount = simulateParticleSlots(
+                            slots, particles.data(), params,
+                            instances.data());
+                    },
+                    1);
+                params.spawnCount = 0;
+                stepsMatch = matches(store, slots, instances, instanceCount);
+            }
+
+            if (!stepsMatch) {
+                std::printf("%7d %7s | compute reference differs from the "
+                            "SoA kernel\n",
+                            count, sway ? "on" : "off");
+                allMatch = false;
+                continue;
+            }
+            std::printf("%7d %7s | %12.3f %12.3f | %9zu\n", count,
+                        sway ? "on" : "off", storeMs / STEP_COUNT,
+                        slotsMs / STEP_COUNT, instanceCount);
+        }
+    }
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+/*
+ wave_field.cpp
+ As part of the Atlas project
+ Created by Max Van den Eynde in 2025
+ --------------------------------------------------
+ Description: Water heightfield microbenchmark and reference check
+ Copyright (c) 2025 maxvdec
+*/
+
+#include "hydra/wave_field.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int FRAME_COUNT = 120;
+constexpr float FRAME_TIME = 1.0f / 60.0f;
+constexpr float TOLERANCE = 1e-4f;
+
+double measure(const std::function<void()> &run, int frames) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / frames;
+}
+
+float largestDifference(const WaveField &a, const WaveField &b) {
+    const std::vector<float> heightsA = a.getHeights();
+    const std::vector<float> heightsB = b.getHeights();
+    float largest = 0.0f;
+    for (size_t i = 0; i < heightsA.size(); i++) {
+        largest = std::max(largest, std::abs(heightsA[i] - heightsB[i]));
+    }
+    return largest;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+
+    std::printf("%6s | %10s %12s | %8s | %10s\n", "cells", "step() ms",
+                "reference ms", "speedup", "difference");
+    bool matches = true;
+    for (int resolution : {64, 255, 512}) {
+        WaveField field;
+        field.create(resolution, {50.0f, 50.0f});
+        for (int i = 0; i < 8; i++) {
+            field.disturb({position(rng), position(rng)}, 3.0f, -2.0f);
+        }
+        WaveField reference = field;
+
+        const double stepMs =
+            measure([&]() { field.step(FRAME_TIME); }, FRAME_COUNT);
+        const double referenceMs =
+            measure([&]() { reference.stepReference(FRAME_TIME); },
+                    FRAME_COUNT);
+
+        const float difference = largestDifference(field, reference);
+        if (difference > TOLERANCE || std::isnan(difference)) {
+            matches = false;
+        }
+        std::printf("%6d | %10.3f %12.3f | %7.1fx | %10.2e\n", resolution,
+                    stepMs, referenceMs, referenceMs / stepMs, difference);
+    }
+
+    // Batched queries are what buoyancy runs every physics step.
+    WaveField field;
+    field.create(256, {50.0f, 50.0f});
+    field.disturb({0.0f, 0.0f}, 4.0f, -2.0f);
+    field.step(FRAME_TIME);
+    std::vector<glm::vec2> points(100000);
+    for (glm::vec2 &point : points) {
+        point = {position(rng), position(rng)};
+    }
+    std::vector<float> heights;
+    std::vector<glm::vec3> velocities;
+    const double sampleMs = measure(
+        [&]() {
+            field.sampleHeight(points, heights);
+            field.sampleVelocity(points, velocities);
+        },
+        10);
+    std::printf("%zu height and velocity samples: %.3f ms\n", points.size(),
+                sampleMs);
+    return matches ? 0 : 1;
+}
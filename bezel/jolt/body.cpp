@@ -33,6 +33,7 @@ void bezel::Rigidbody::create(
 
     glm::quat glmRotation = glm::normalize(rotation.toGlmQuat());
     rotationQuat = glmRotation;
+    previousRotationQuat = glmRotation;
     JPH::Quat joltRotation(glmRotation.x, glmRotation.y, glmRotation.z,
                            glmRotation.w);
 
@@ -69,6 +70,9 @@ void bezel::Rigidbody::create(
     bodySettings.mLinearDamping = linearDamping;
     bodySettings.mAngularDamping = angularDamping;
     bodySettings.mIsSensor = isSensor;
+    // Tagged queries read the mask straight from the body's user data.
+    bodySettings.mUserData = tagMask;
+    tagsDirty = false;
     if (mass > 0.0f) {
         bodySettings.mOverrideMassProperties =
             JPH::EOverrideMassProperties::CalculateInertia;
@@ -137,11 +141,11 @@ void bezel::Rigidbody::refresh(
 
 void bezel::Rigidbody::setPosition(const Position3d &position,
                                    const std::shared_ptr<PhysicsWorld> &world) {
+    this->position = position;
+    this->previousPosition = position;
     if (id.joltId == INVALID_JOLT_ID) {
-        this->position = position;
         return;
     }
-    this->position = position;
 
     auto joltBodyId = JPH::BodyID(id.joltId);
     JPH::BodyInterface &bodyInterface = world->physicsSystem.GetBodyInterface();
@@ -164,6 +168,7 @@ void bezel::Rigidbody::setRotation(const Rotation3d &rotation,
 
     glm::quat glmRotation = glm::normalize(rotation.toGlmQuat());
     rotationQuat = glmRotation;
+    previousRotationQuat = glmRotation;
     JPH::Quat joltRotation(glmRotation.x, glmRotation.y, glmRotation.z,
                            glmRotation.w);
     bodyInterface.SetRotation(joltBodyId, joltRotation,
@@ -266,6 +271,11 @@ void bezel::Rigidbody::applyProperties(
         bodyInterface.SetMaxAngularVelocity(joltBodyId, maxAngularVelocity);
         maxAngularVelocity = -1.0f;
     }
+
+    if (tagsDirty) {
+        bodyInterface.SetUserData(joltBodyId, tagMask);
+        tagsDirty = false;
+    }
 }
 
 void bezel::Rigidbody::setMaximumAngularVelocity(float maxAngularVelocity) {
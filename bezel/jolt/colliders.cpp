@@ -52,3 +52,20 @@ JPH::RefConst<JPH::Shape> bezel::MeshCollider::getJoltShape() const {
 
     return result.Get();
 }
+
+JPH::RefConst<JPH::Shape> bezel::HeightFieldCollider::getJoltShape() const {
+    if (heights.size() != static_cast<size_t>(sampleCount) * sampleCount)
+        return nullptr;
+
+    JPH::HeightFieldShapeSettings settings(
+        heights.data(),
+        JPH::Vec3((float)offset.x, (float)offset.y, (float)offset.z),
+        JPH::Vec3((float)scale.x, (float)scale.y, (float)scale.z),
+        sampleCount);
+
+    JPH::ShapeSettings::ShapeResult result = settings.Create();
+    if (result.HasError())
+        return nullptr;
+
+    return result.Get();
+}
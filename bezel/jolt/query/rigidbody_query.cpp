@@ -377,63 +377,67 @@ void JoltCollisionDispatcher::update(bezel::PhysicsWorld *world) {
 bezel::RaycastResult
 bezel::Rigidbody::raycast(const Position3d &direction, float maxDistance,
                           const std::shared_ptr<bezel::PhysicsWorld> &world,
-                          uint32_t ignoreBodyId) const {
+                          uint32_t ignoreBodyId, TagMask requiredTags) const {
     Position3d origin = position;
 
     if (ignoreBodyId == bezel::INVALID_JOLT_ID) {
         ignoreBodyId = id.joltId;
     }
 
-    return world->raycast(origin, direction, maxDistance, ignoreBodyId);
+    return world->raycast(origin, direction, maxDistance, ignoreBodyId,
+                          requiredTags);
 }
 
 bezel::RaycastResult
 bezel::Rigidbody::raycastAll(const Position3d &direction, float maxDistance,
                              const std::shared_ptr<bezel::PhysicsWorld> &world,
-                             uint32_t ignoreBodyId) const {
+                             uint32_t ignoreBodyId,
+                             TagMask requiredTags) const {
     Position3d origin = position;
 
     if (ignoreBodyId == bezel::INVALID_JOLT_ID) {
         ignoreBodyId = id.joltId;
     }
 
-    return world->raycastAll(origin, direction, maxDistance, ignoreBodyId);
+    return world->raycastAll(origin, direction, maxDistance, ignoreBodyId,
+                             requiredTags);
 }
 
 bezel::OverlapResult bezel::Rigidbody::overlap(
     const std::shared_ptr<bezel::PhysicsWorld> &world,
     std::shared_ptr<bezel::Collider> collider, const Position3d &position,
-    const Rotation3d &rotation, uint32_t ignoreBodyId) const {
+    const Rotation3d &rotation, uint32_t ignoreBodyId,
+    TagMask requiredTags) const {
     if (ignoreBodyId == bezel::INVALID_JOLT_ID) {
         ignoreBodyId = id.joltId;
     }
 
     return world->overlap(world, std::move(collider), position, rotation,
-                          ignoreBodyId);
+                          ignoreBodyId, requiredTags);
 }
 
 bezel::SweepResult
 bezel::Rigidbody::sweep(const std::shared_ptr<bezel::PhysicsWorld> &world,
                         std::shared_ptr<bezel::Collider> collider,
                         const Position3d &direction, Position3d &endPosition,
-                        uint32_t ignoreBodyId) const {
+                        uint32_t ignoreBodyId, TagMask requiredTags) const {
     if (ignoreBodyId == bezel::INVALID_JOLT_ID) {
         ignoreBodyId = id.joltId;
     }
 
     return world->sweep(world, std::move(collider), position, rotation,
-                        direction, endPosition, ignoreBodyId);
+                        direction, endPosition, ignoreBodyId, requiredTags);
 }
 
 bezel::SweepResult
 bezel::Rigidbody::sweepAll(const std::shared_ptr<bezel::PhysicsWorld> &world,
                            std::shared_ptr<bezel::Collider> collider,
                            const Position3d &direction, Position3d &endPosition,
-                           uint32_t ignoreBodyId) const {
+                           uint32_t ignoreBodyId, TagMask requiredTags) const {
     if (ignoreBodyId == bezel::INVALID_JOLT_ID) {
         ignoreBodyId = id.joltId;
     }
 
     return world->sweepAll(world, std::move(collider), position, rotation,
-                           direction, endPosition, ignoreBodyId);
+                           direction, endPosition, ignoreBodyId, requiredTags);
 }
@@ -0,0 +1,105 @@
+//
+// tags.cpp
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: Tag interning and per-body tag masks
+// Copyright (c) 2025 maxvdec
+//
+
+#include "atlas/tracer/log.h"
+#include <algorithm>
+#include <bezel/bezel.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct TagRegistry {
+    std::mutex mutex;
+    std::unordered_map<std::string, uint32_t> ids;
+    bool warnedFull = false;
+};
+
+TagRegistry &getTagRegistry() {
+    static TagRegistry registry;
+    return registry;
+}
+
+} // namespace
+
+uint32_t bezel::internTag(const std::string &tag) {
+    TagRegistry &registry = getTagRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    auto it = registry.ids.find(tag);
+    if (it != registry.ids.end()) {
+        return it->second;
+    }
+
+    if (registry.ids.size() >= MAX_TAGS) {
+        if (!registry.warnedFull) {
+            atlas_warning("[Bezel] Tag limit of " + std::to_string(MAX_TAGS) +
+                          " reached, tag \"" + tag +
+                          "\" will be ignored by tagged queries");
+            registry.warnedFull = true;
+        }
+        return INVALID_TAG;
+    }
+
+    const auto id = static_cast<uint32_t>(registry.ids.size());
+    registry.ids.emplace(tag, id);
+    return id;
+}
+
+uint32_t bezel::findTag(const std::string &tag) {
+    TagRegistry &registry = getTagRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    auto it = registry.ids.find(tag);
+    return it != registry.ids.end() ? it->second : INVALID_TAG;
+}
+
+bezel::TagMask bezel::makeTagMask(const std::vector<std::string> &tags) {
+    TagMask mask = 0;
+    for (const auto &tag : tags) {
+        const uint32_t id = internTag(tag);
+        if (id != INVALID_TAG) {
+            mask |= TagMask{1} << id;
+        }
+    }
+    return mask;
+}
+
+bool bezel::Rigidbody::hasTag(const std::string &tag) const {
+    return std::find(tags.begin(), tags.end(), tag) != tags.end();
+}
+
+void bezel::Rigidbody::addTag(const std::string &tag) {
+    if (hasTag(tag)) {
+        return;
+    }
+    tags.push_back(tag);
+
+    const uint32_t id = internTag(tag);
+    if (id != INVALID_TAG) {
+        tagMask |= TagMask{1} << id;
+        tagsDirty = true;
+    }
+}
+
+void bezel::Rigidbody::removeTag(const std::string &tag) {
+    auto it = std::find(tags.begin(), tags.end(), tag);
+    if (it == tags.end()) {
+        return;
+    }
+    tags.erase(it);
+
+    const uint32_t id = findTag(tag);
+    if (id != INVALID_TAG) {
+        tagMask &= ~(TagMask{1} << id);
+        tagsDirty = true;
+    }
+}
@@ -13,27 +13,43 @@
 #include "Jolt/Core/JobSystemThreadPool.h"
 #include "Jolt/Core/Memory.h"
 #include "Jolt/Core/TempAllocator.h"
+#include "Jolt/Physics/Body/BodyLock.h"
+#include "Jolt/Physics/Collision/CastResult.h"
+#include "Jolt/Physics/Collision/CollisionCollectorImpl.h"
 #include "Jolt/Physics/Collision/ContactListener.h"
 #include "Jolt/Physics/Collision/CollideShape.h"
+#include "Jolt/Physics/Collision/RayCast.h"
 #include "Jolt/Physics/Collision/ShapeCast.h"
 #include "Jolt/Physics/EPhysicsUpdateError.h"
 #include "Jolt/RegisterTypes.h"
 #include "bezel/bezel.h"
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <span>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 #include "atlas/tracer/log.h"
 #include "bezel/jolt/query.h"
 
 namespace {
 
-class IgnoreBodyFilter final : public JPH::BodyFilter {
+class QueryBodyFilter final : public JPH::BodyFilter {
   public:
     uint32_t ignoreId;
+    bezel::TagMask requiredTags;
 
-    explicit IgnoreBodyFilter(uint32_t id) : ignoreId(id) {}
+    QueryBodyFilter(uint32_t id, bezel::TagMask tags)
+        : ignoreId(id), requiredTags(tags) {}
 
     bool ShouldCollide(const JPH::BodyID &inBodyID) const override {
         if (ignoreId == bezel::INVALID_JOLT_ID) {
@@ -41,14 +57,166 @@ class IgnoreBodyFilter final : public JPH::BodyFilter {
         }
         return inBodyID.GetIndexAndSequenceNumber() != ignoreId;
     }
+
+    // Bodies carry their tag mask in the Jolt user data, so rejecting an
+    // untagged body costs one AND before any narrow-phase work is done.
+    bool ShouldCollideLocked(const JPH::Body &inBody) const override {
+        return requiredTags == 0 || (inBody.GetUserData() & requiredTags) != 0;
+    }
 };
 
+// Queries per job when a batch is split across the job system. Smaller
+// batches run inline on the calling thread.
+constexpr std::size_t QUERY_BATCH_CHUNK = 32;
+
+bezel::Rigidbody *findRigidbody(const JPH::BodyID &bodyId) {
+    auto it = bezel_jolt::bodyIdToRigidbodyMap.find(bodyId);
+    return (it != bezel_jolt::bodyIdToRigidbodyMap.end()) ? it->second
+                                                           : nullptr;
+}
+
+// Batched queries go through the no-lock interfaces: the batch contract
+// forbids running concurrently with an update, so taking a body lock per
+// candidate would only add contention between the query workers.
+void castRay(const JPH::PhysicsSystem &system, const bezel::RayQuery &query,
+             bezel::RaycastHit &out) {
+    out = {};
+
+    const JPH::Vec3 direction(query.direction.x, query.direction.y,
+                              query.direction.z);
+    if (direction.LengthSq() <= 0.0f || query.maxDistance <= 0.0f) {
+        return;
+    }
+
+    const JPH::RRayCast ray(
+        JPH::RVec3(query.origin.x, query.origin.y, query.origin.z),
+        direction.Normalized() * query.maxDistance);
+
+    JPH::RayCastResult hit;
+    QueryBodyFilter bodyFilter(query.ignoreBodyId, query.requiredTags);
+    if (!system.GetNarrowPhaseQueryNoLock().CastRay(ray, hit, {}, {},
+                                                     bodyFilter)) {
+        return;
+    }
+
+    const JPH::RVec3 point = ray.GetPointOnRay(hit.mFraction);
+    out.didHit = true;
+    out.distance = hit.mFraction * query.maxDistance;
+    out.position = Position3d(point.GetX(), point.GetY(), point.GetZ());
+    out.rigidbody = findRigidbody(hit.mBodyID);
+
+    JPH::BodyLockRead lock(system.GetBodyLockInterfaceNoLock(), hit.mBodyID);
+    if (lock.Succeeded()) {
+        const JPH::Vec3 normal = lock.GetBody().GetWorldSpaceSurfaceNormal(
+            hit.mSubShapeID2, point);
+        out.normal = Normal3d(normal.GetX(), normal.GetY(), normal.GetZ());
+    }
+}
+
+void castShape(const JPH::PhysicsSystem &system,
+               const bezel::ShapeCastQuery &query, const JPH::Shape *shape,
+               bezel::SweepHit &out) {
+    out = {};
+    if (shape == nullptr) {
+        return;
+    }
+
+    const JPH::Vec3 castDirection(query.direction.x, query.direction.y,
+                                  query.direction.z);
+    const float length = castDirection.Length();
+    if (length <= 0.0f) {
+        return;
+    }
+
+    const glm::quat rotation = glm::normalize(query.startRotation.toGlmQuat());
+    const JPH::RMat44 startTransform = JPH::RMat44::sRotationTranslation(
+        JPH::Quat(rotation.x, rotation.y, rotation.z, rotation.w),
+        JPH::RVec3(query.startPosition.x, query.startPosition.y,
+                   query.startPosition.z));
+    const JPH::RShapeCast cast = JPH::RShapeCast::sFromWorldTransform(
+        shape, JPH::Vec3::sReplicate(1.0f), startTransform,
+        castDirection);
+
+    JPH::ClosestHitCollisionCollector<JPH::CastShapeCollector> collector;
+    QueryBodyFilter bodyFilter(query.ignoreBodyId, query.requiredTags);
+    system.GetNarrowPhaseQueryNoLock().CastShape(
+        cast, JPH::ShapeCastSettings(), JPH::RVec3::sZero(), collector, {}, {},
+        bodyFilter);
+    if (!collector.HadHit()) {
+        return;
+    }
+
+    const JPH::ShapeCastResult &best = collector.mHit;
+    out.didHit = true;
+    out.percentage = best.mFraction;
+    out.distance = best.mFraction * length;
+    out.position =
+        Position3d(best.mContactPointOn2.GetX(), best.mContactPointOn2.GetY(),
+                   best.mContactPointOn2.GetZ());
+
+    JPH::Vec3 axis = best.mPenetrationAxis;
+    if (axis.LengthSq() > 0.0f) {
+        axis = -axis.Normalized();
+    }
+    out.normal = Normal3d(axis.GetX(), axis.GetY(), axis.GetZ());
+    out.rigidbody = findRigidbody(best.mBodyID2);
+}
+
+void pinCurrentThread(uint32_t core) {
+#if defined(__linux__)
+    const uint32_t coreCount =
+        std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(core % coreCount, &cpuSet);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0) {
+        atlas_warning("[Jolt] Failed to pin physics worker to core " +
+                      std::to_string(core % coreCount));
+    }
+#else
+    (void)core;
+    static bool warned = false;
+    if (!warned) {
+        warned = true;
+        atlas_warning("[Jolt] Physics worker pinning is not supported on "
+                      "this platform");
+    }
+#endif
+}
+
 } // namespace
 
 namespace bezel_jolt {
 std::map<JPH::BodyID, bezel::Rigidbody *> bodyIdToRigidbodyMap;
 }
 
+void *bezel_jolt::PooledTempAllocator::Allocate(JPH::uint inSize) {
+    if (inSize == 0) {
+        return nullptr;
+    }
+
+    if (!pool.CanAllocate(inSize)) {
+        fallbackAllocations++;
+        return JPH::AlignedAllocate(inSize, JPH_RVECTOR_ALIGNMENT);
+    }
+
+    void *address = pool.Allocate(inSize);
+    highWaterMark = std::max<std::size_t>(highWaterMark, pool.GetUsage());
+    return address;
+}
+
+void bezel_jolt::PooledTempAllocator::Free(void *inAddress, JPH::uint inSize) {
+    if (inAddress == nullptr) {
+        return;
+    }
+
+    if (pool.OwnsMemory(inAddress)) {
+        pool.Free(inAddress, inSize);
+    } else {
+        JPH::AlignedFree(inAddress);
+    }
+}
+
 BroadPhaseLayerImpl::BroadPhaseLayerImpl() {
     mObjectToBroadPhase[bezel::jolt::layers::NON_MOVING] =
         bezel::jolt::broad_phase_layers::NON_MOVING;
@@ -183,7 +351,13 @@ bool bezel_jolt::AssertFailedImpl(const char *expr, const char *msg,
     return true;
 }
 
-void bezel::PhysicsWorld::init() {
+void bezel::PhysicsWorld::init(const PhysicsWorldSettings &settings) {
+    this->settings = settings;
+    this->settings.fixedTimeStep = std::max(settings.fixedTimeStep, 1e-4f);
+    this->settings.maxSubSteps = std::max(settings.maxSubSteps, 1);
+    accumulator = 0.0f;
+    interpolationAlpha = 1.0f;
+
     JPH::RegisterDefaultAllocator();
 
     JPH::Trace = bezel_jolt::TraceImpl;
@@ -197,16 +371,25 @@ void bezel::PhysicsWorld::init() {
 
     initialized = true;
 
-    tempAllocator = std::make_unique<JPH::TempAllocatorMalloc>();
-
-    uint32_t hw = std::max(1u, std::thread::hardware_concurrency());
-    uint32_t num_worker_threads = std::max(1u, hw > 1 ? (hw - 1) : 1);
+    const uint32_t tempAllocatorSize =
+        std::max(1u, this->settings.tempAllocatorSizeMB) * 1024u * 1024u;
+    tempAllocator = std::make_unique<PooledTempAllocator>(tempAllocatorSize);
 
-    constexpr uint32_t MAX_JOBS = 4096;
-    constexpr uint32_t MAX_BARRIERS = 64;
+    int numWorkerThreads = this->settings.workerThreads;
+    if (numWorkerThreads < 0) {
+        uint32_t hw = std::max(1u, std::thread::hardware_concurrency());
+        numWorkerThreads = static_cast<int>(std::max(1u, hw - 1));
+    }
 
-    jobSystem = std::make_unique<JPH::JobSystemThreadPool>(
-        MAX_JOBS, MAX_BARRIERS, num_worker_threads);
+    jobSystem = std::make_unique<JPH::JobSystemThreadPool>();
+    if (this->settings.pinWorkerThreads) {
+        const uint32_t firstCore = this->settings.firstPinnedCore;
+        jobSystem->SetThreadInitFunction([firstCore](int threadIndex) {
+            pinCurrentThread(firstCore + static_cast<uint32_t>(threadIndex));
+        });
+    }
+    jobSystem->Init(std::max(1u, this->settings.maxJobs),
+                    std::max(1u, this->settings.maxBarriers), numWorkerThreads);
 
     constexpr uint32_t MAX_BODIES = 65536;
     constexpr uint32_t NUM_BODY_MUTEXES = 1024;
@@ -225,6 +408,54 @@ void bezel::PhysicsWorld::init() {
 }
 
 void bezel::PhysicsWorld::update(float dt) {
+    if (!settings.useFixedTimeStep) {
+        step(dt);
+        lastStepCount = 1;
+        interpolationAlpha = 1.0f;
+        return;
+    }
+
+    accumulator += std::max(dt, 0.0f);
+
+    int steps = 0;
+    while (accumulator >= settings.fixedTimeStep &&
+           steps < settings.maxSubSteps) {
+        storePreviousTransforms();
+        step(settings.fixedTimeStep);
+        accumulator -= settings.fixedTimeStep;
+        steps++;
+    }
+
+    if (accumulator >= settings.fixedTimeStep) {
+        accumulator = std::fmod(accumulator, settings.fixedTimeStep);
+    }
+
+    lastStepCount = steps;
+    interpolationAlpha = accumulator / settings.fixedTimeStep;
+}
+
+void bezel::PhysicsWorld::storePreviousTransforms() {
+    const JPH::BodyInterface &bodyInterface =
+        physicsSystem.GetBodyInterfaceNoLock();
+
+    for (auto &[bodyId, body] : bezel_jolt::bodyIdToRigidbodyMap) {
+        if (body == nullptr || body->motionType != MotionType::Dynamic) {
+            continue;
+        }
+
+        JPH::RVec3 position;
+        JPH::Quat rotation;
+        bodyInterface.GetPositionAndRotation(bodyId, position, rotation);
+
+        body->previousPosition =
+            Position3d(position.GetX(), position.GetY(), position.GetZ());
+        body->previousRotationQuat = glm::quat(
+            rotation.GetW(), rotation.GetX(), rotation.GetY(), rotation.GetZ());
+        body->hasPreviousTransform = true;
+    }
+}
+
+void bezel::PhysicsWorld::step(float dt) {
     constexpr int COLLISION_STEPS = 1;
     JPH::EPhysicsUpdateError error = physicsSystem.Update(
         dt, COLLISION_STEPS, tempAllocator.get(), jobSystem.get());
@@ -334,6 +565,18 @@ void bezel::PhysicsWorld::update(float dt) {
     collisionDispatcher->update(this);
 }
 
+bezel::TempAllocatorStats bezel::PhysicsWorld::getTempAllocatorStats() const {
+    TempAllocatorStats stats;
+    if (tempAllocator == nullptr) {
+        return stats;
+    }
+
+    stats.capacity = tempAllocator->getCapacity();
+    stats.highWaterMark = tempAllocator->getHighWaterMark();
+    stats.fallbackAllocations = tempAllocator->getFallbackCount();
+    return stats;
+}
+
 bezel::PhysicsWorld::~PhysicsWorld() {
     jobSystem.reset();
     tempAllocator.reset();
@@ -351,7 +594,8 @@ bezel::PhysicsWorld::~PhysicsWorld() {
 bezel::RaycastResult bezel::PhysicsWorld::raycast(const Position3d &origin,
                                                   const Position3d &direction,
                                                   float maxDistance,
-                                                  uint32_t ignoreBodyId) const {
+                                                  uint32_t ignoreBodyId,
+                                                  TagMask requiredTags) const {
     RaycastResult out;
 
     JPH::RVec3Arg originJolt(origin.x, origin.y, origin.z);
@@ -362,7 +606,7 @@ bezel::RaycastResult bezel::PhysicsWorld::raycast(const Position3d &origin,
 
     JPH::RayCastResult hit;
 
-    IgnoreBodyFilter bodyFilter(ignoreBodyId);
+    QueryBodyFilter bodyFilter(ignoreBodyId, requiredTags);
 
     const bool didHit = physicsSystem.GetNarrowPhaseQuery().CastRay(
         ray, hit, {}, {}, bodyFilter);
@@ -399,7 +643,8 @@ bezel::RaycastResult bezel::PhysicsWorld::raycast(const Position3d &origin,
 bezel::RaycastResult
 bezel::PhysicsWorld::raycastAll(const Position3d &origin,
                                 const Position3d &direction, float maxDistance,
-                                uint32_t ignoreBodyId) const {
+                                uint32_t ignoreBodyId,
+                                TagMask requiredTags) const {
     RaycastResult out;
 
     JPH::RVec3Arg originJolt(origin.x, origin.y, origin.z);
@@ -419,7 +664,7 @@ bezel::PhysicsWorld::raycastAll(const Position3d &origin,
     };
 
     AllHitsCollector collector;
-    IgnoreBodyFilter bodyFilter(ignoreBodyId);
+    QueryBodyFilter bodyFilter(ignoreBodyId, requiredTags);
     JPH::RayCastSettings settings;
     physicsSystem.GetNarrowPhaseQuery().CastRay(ray, settings, collector, {},
                                                 {}, bodyFilter);
@@ -468,7 +713,8 @@ bezel::PhysicsWorld::overlap(const std::shared_ptr<bezel::PhysicsWorld> &world,
                              const std::shared_ptr<bezel::Collider> &collider,
                              const Position3d &position,
                              const Rotation3d &rotation,
-                             uint32_t ignoreBodyId) const {
+                             uint32_t ignoreBodyId,
+                             TagMask requiredTags) const {
     (void)world;
 
     OverlapResult out;
@@ -500,7 +746,7 @@ bezel::PhysicsWorld::overlap(const std::shared_ptr<bezel::PhysicsWorld> &world,
     };
 
     AllHitsCollector collector;
-    IgnoreBodyFilter bodyFilter(ignoreBodyId);
+    QueryBodyFilter bodyFilter(ignoreBodyId, requiredTags);
 
     JPH::CollideShapeSettings settings;
     physicsSystem.GetNarrowPhaseQuery().CollideShape(
@@ -536,7 +782,8 @@ bezel::PhysicsWorld::sweep(const std::shared_ptr<bezel::PhysicsWorld> &world,
                            const Position3d &startPosition,
                            const Rotation3d &startRotation,
                            const Position3d &direction, Position3d &endPosition,
-                           uint32_t ignoreBodyId) const {
+                           uint32_t ignoreBodyId,
+                           TagMask requiredTags) const {
     (void)world;
 
     SweepResult out;
@@ -593,7 +840,7 @@ bezel::PhysicsWorld::sweep(const std::shared_ptr<bezel::PhysicsWorld> &world,
     };
 
     ClosestHitCollector collector;
-    IgnoreBodyFilter bodyFilter(ignoreBodyId);
+    QueryBodyFilter bodyFilter(ignoreBodyId, requiredTags);
     JPH::ShapeCastSettings settings;
     physicsSystem.GetNarrowPhaseQuery().CastShape(
         cast, settings, JPH::RVec3::sZero(), collector, {}, {}, bodyFilter);
@@ -611,6 +858,7 @@ bezel::PhysicsWorld::sweep(const std::shared_ptr<bezel::PhysicsWorld> &world,
     const float dist = fraction * dirLen;
 
     SweepHit hit;
+    hit.didHit = true;
     hit.distance = dist;
     hit.percentage = fraction;
     hit.position = Position3d(collector.best.mContactPointOn2.GetX(),
@@ -640,7 +888,8 @@ bezel::SweepResult bezel::PhysicsWorld::sweepAll(
     const std::shared_ptr<bezel::Collider> &collider,
     const Position3d &startPosition, const Rotation3d &startRotation,
     const Position3d &direction, Position3d &endPosition,
-    uint32_t ignoreBodyId) const {
+    uint32_t ignoreBodyId,
+    TagMask requiredTags) const {
     (void)world;
 
     SweepResult out;
@@ -691,7 +940,7 @@ bezel::SweepResult bezel::PhysicsWorld::sweepAll(
     };
 
     AllHitsCollector collector;
-    IgnoreBodyFilter bodyFilter(ignoreBodyId);
+    QueryBodyFilter bodyFilter(ignoreBodyId, requiredTags);
     JPH::ShapeCastSettings settings;
     physicsSystem.GetNarrowPhaseQuery().CastShape(
         cast, settings, JPH::RVec3::sZero(), collector, {}, {}, bodyFilter);
@@ -715,6 +964,7 @@ bezel::SweepResult bezel::PhysicsWorld::sweepAll(
         const float dist = fraction * dirLen;
 
         SweepHit hit;
+        hit.didHit = true;
         hit.distance = dist;
         hit.percentage = fraction;
         hit.position =
@@ -749,3 +999,92 @@ bezel::SweepResult bezel::PhysicsWorld::sweepAll(
 
     return out;
 }
+
+void bezel::PhysicsWorld::parallelFor(
+    std::size_t count, std::size_t minChunkSize,
+    const std::function<void(std::size_t, std::size_t)> &fn) const {
+    if (count == 0) {
+        return;
+    }
+    if (jobSystem == nullptr || count <= minChunkSize) {
+        fn(0, count);
+        return;
+    }
+
+    JPH::JobSystem::Barrier *barrier = jobSystem->CreateBarrier();
+    if (barrier == nullptr) {
+        fn(0, count);
+        return;
+    }
+
+    // A few jobs per worker keeps the load balanced without flooding the
+    // job queue on very large batches.
+    const std::size_t maxJobs =
+        static_cast<std::size_t>(std::max(1, jobSystem->GetMaxConcurrency())) *
+        4;
+    const std::size_t jobCount =
+        std::min(maxJobs, (count + minChunkSize - 1) / minChunkSize);
+    const std::size_t perJob = (count + jobCount - 1) / jobCount;
+
+    std::vector<JPH::JobHandle> handles;
+    handles.reserve(jobCount);
+    for (std::size_t begin = 0; begin < count; begin += perJob) {
+        const std::size_t end = std::min(count, begin + perJob);
+        handles.push_back(jobSystem->CreateJob(
+            "Bezel Query Batch", JPH::Color::sGreen,
+            [&fn, begin, end]() { fn(begin, end); }));
+    }
+
+    barrier->AddJobs(handles.data(), static_cast<JPH::uint>(handles.size()));
+    jobSystem->WaitForJobs(barrier);
+    jobSystem->DestroyBarrier(barrier);
+}
+
+void bezel::PhysicsWorld::raycastBatch(std::span<const RayQuery> rays,
+                                       std::span<RaycastHit> results) const {
+    if (results.size() < rays.size()) {
+        atlas_warning("raycastBatch: result buffer is smaller than the batch");
+        return;
+    }
+
+    parallelFor(rays.size(), QUERY_BATCH_CHUNK,
+                [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; i++) {
+                        castRay(physicsSystem, rays[i], results[i]);
+                    }
+                });
+}
+
+void bezel::PhysicsWorld::sweepBatch(std::span<const ShapeCastQuery> casts,
+                                     std::span<SweepHit> results) const {
+    if (results.size() < casts.size()) {
+        atlas_warning("sweepBatch: result buffer is smaller than the batch");
+        return;
+    }
+
+    // Building a Jolt shape can mean rebuilding a whole mesh or heightfield,
+    // so every distinct collider is resolved once before the casts run.
+    std::unordered_map<const Collider *, JPH::RefConst<JPH::Shape>>
+        shapesByCollider;
+    std::vector<const JPH::Shape *> shapes(casts.size(), nullptr);
+    for (std::size_t i = 0; i < casts.size(); i++) {
+        const Collider *collider = casts[i].collider;
+        if (collider == nullptr) {
+            continue;
+        }
+        auto it = shapesByCollider.find(collider);
+        if (it == shapesByCollider.end()) {
+            it = shapesByCollider.emplace(collider, collider->getJoltShape())
+                     .first;
+        }
+        shapes[i] = it->second.GetPtr();
+    }
+
+    parallelFor(casts.size(), QUERY_BATCH_CHUNK,
+                [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; i++) {
+                        castShape(physicsSystem, casts[i], shapes[i],
+                                  results[i]);
+                    }
+                });
+}
@@ -9,7 +9,6 @@
 
 #include "bezel/body.h"
 #include "atlas/units.h"
-#include "atlas/window.h"
 #include "bezel/bounds.h"
 #include "bezel/shape.h"
 #include <algorithm>
@@ -50,187 +49,6 @@ glm::vec3 Body::modelSpaceToWorldSpace(const glm::vec3 &point) const {
     return rotated + position.toGlm();
 }
 
-void Body::update(Window &window) {
-    if (thisShared == nullptr) {
-        for (const auto &body : window.getAllBodies()) {
-            if (body.get() == this) {
-                thisShared = body;
-                break;
-            }
-        }
-    }
-
-    float dt = window.getDeltaTime();
-    dt = std::min(dt, 0.0333f);
-
-    if (isSleeping && invMass == 0.0f) {
-        return;
-    }
-
-    std::vector<std::shared_ptr<Body>> bodies = window.getAllBodies();
-
-    std::vector<CollisionPair> pairs;
-    bezel::broadPhase(bodies, pairs, dt);
-
-    if (isSleeping && invMass > 0.0f) {
-        for (const auto &pair : pairs) {
-            auto bodyA = bodies[pair.a];
-            auto bodyB = bodies[pair.b];
-            if ((bodyA.get() == this || bodyB.get() == this)) {
-                auto other = (bodyA.get() == this) ? bodyB : bodyA;
-                if (glm::length(other->linearVelocity) >
-                        SLEEP_LINEAR_THRESHOLD ||
-                    glm::length(other->angularVelocity) >
-                        SLEEP_ANGULAR_THRESHOLD) {
-                    isSleeping = false;
-                    sleepTimer = 0.0f;
-                    break;
-                }
-            }
-        }
-    }
-
-    if (isSleeping) {
-        return;
-    }
-
-    int numContacts = 0;
-    const int maxContacts = bodies.size() * bodies.size();
-    std::vector<Contact> contacts(maxContacts);
-
-    for (size_t i = 0; i < pairs.size(); i++) {
-        CollisionPair pair = pairs[i];
-        std::shared_ptr<Body> bodyA = bodies[pair.a];
-        std::shared_ptr<Body> bodyB = bodies[pair.b];
-
-        Contact contact;
-        if (intersects(bodyA, bodyB, contact, dt)) {
-            std::cout << "Contact between bodies at t=" << contact.timeOfImpact
-                      << "s, separation=" << contact.separationDistance
-                      << "m\n";
-            glm::vec3 velA = bodyA->linearVelocity;
-            glm::vec3 velB = bodyB->linearVelocity;
-            glm::vec3 relVel = velA - velB;
-            float normalVel = glm::dot(relVel, contact.normal);
-
-            bool isPenetrating = contact.separationDistance <= 0.0f;
-            bool isApproaching = normalVel < -0.01f;
-            bool isNearContact =
-                contact.separationDistance < 0.05f; // Within 5cm
-
-            if (isPenetrating || isApproaching || isNearContact) {
-                std::cout << "Adding contact: penetration=" << isPenetrating
-                          << ", approaching=" << isApproaching
-                          << ", near=" << isNearContact << "\n";
-                contacts[numContacts] = contact;
-                numContacts++;
-            }
-        }
-    }
-
-    if (numContacts >= 1) {
-        std::sort(contacts.begin(), contacts.begin() + numContacts,
-                  [](const Contact &a, const Contact &b) {
-                      return a.timeOfImpact < b.timeOfImpact;
-                  });
-    }
-
-    bool isResting = false;
-    int restingContactCount = 0;
-
-    if (invMass > 0.0f) {
-        for (int i = 0; i < numContacts; i++) {
-            Contact &contact = contacts[i];
-            if (contact.bodyA.get() == this || contact.bodyB.get() == this) {
-                glm::vec3 normal = contact.normal;
-
-                bool isSupporting = false;
-                const float verticalThreshold = 0.8f;
-
-                if (contact.bodyA.get() == this &&
-                    normal.y < -verticalThreshold) {
-                    isSupporting = true;
-                } else if (contact.bodyB.get() == this &&
-                           normal.y > verticalThreshold) {
-                    isSupporting = true;
-                }
-
-                if (isSupporting) {
-                    float speed = glm::length(this->linearVelocity);
-                    float angularSpeed = glm::length(this->angularVelocity);
-
-                    bool isStable = contact.separationDistance > -0.02f;
-                    bool isSlowEnough = speed < SLEEP_LINEAR_THRESHOLD &&
-                                        angularSpeed < SLEEP_ANGULAR_THRESHOLD;
-
-                    if (isStable && isSlowEnough) {
-                        isResting = true;
-                        restingContactCount++;
-
-                        if (contact.separationDistance < -0.005f) {
-                            glm::vec3 correction =
-                                -normal * contact.separationDistance * 0.8f;
-                            if (contact.bodyA.get() == this) {
-                                this->position =
-                                    this->position +
-                                    Position3d::fromGlm(correction);
-                            } else {
-                                this->position =
-                                    this->position -
-                                    Position3d::fromGlm(correction);
-                            }
-                        }
-
-                        this->linearVelocity *= 0.5f;
-                        this->angularVelocity *= 0.5f;
-
-                        if (glm::length2(this->linearVelocity) < 1e-4f) {
-                            this->linearVelocity = glm::vec3(0.0f);
-                        }
-                        if (glm::length2(this->angularVelocity) < 1e-4f) {
-                            this->angularVelocity = glm::vec3(0.0f);
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    if (isResting && restingContactCount > 0) {
-        sleepTimer += dt;
-        if (sleepTimer > SLEEP_TIME_THRESHOLD) {
-            isSleeping = true;
-            linearVelocity = glm::vec3(0.0f);
-            angularVelocity = glm::vec3(0.0f);
-            return;
-        }
-    } else {
-        sleepTimer = 0.0f;
-    }
-
-    if (!isResting && invMass > 0.0f) {
-        float mass = 1.0 / invMass;
-        glm::vec3 impulseGravity =
-            glm::vec3(0.0f, -window.gravity, 0.0f) * mass * dt;
-        applyLinearImpulse(impulseGravity);
-    }
-
-    float accumulatedTime = 0.0f;
-    for (int i = 0; i < numContacts; i++) {
-        Contact &contact = contacts[i];
-        float dtContact = contact.timeOfImpact - accumulatedTime;
-
-        updatePhysics(dtContact);
-        resolveContact(contact);
-        accumulatedTime += dtContact;
-    }
-
-    const float remainingTime = dt - accumulatedTime;
-    if (remainingTime > 0.0f) {
-        updatePhysics(remainingTime);
-    }
-}
-
 void Body::applyLinearImpulse(const glm::vec3 &impulse) {
     if (invMass == 0.0f) {
         return; // Infinite mass, do nothing
@@ -30,7 +30,7 @@ void Bounds::clear() {
     maxs = glm::vec3(std::numeric_limits<float>::lowest());
 }
 
-bool Bounds::doesIntersect(const Bounds &other) {
+bool Bounds::doesIntersect(const Bounds &other) const {
     if (maxs.x < other.mins.x || maxs.y < other.mins.y ||
         maxs.z < other.mins.z) {
         return false;
@@ -42,6 +42,12 @@ bool Bounds::doesIntersect(const Bounds &other) {
     return true;
 }
 
+bool Bounds::contains(const Bounds &other) const {
+    return mins.x <= other.mins.x && mins.y <= other.mins.y &&
+           mins.z <= other.mins.z && maxs.x >= other.maxs.x &&
+           maxs.y >= other.maxs.y && maxs.z >= other.maxs.z;
+}
+
 void Bounds::expand(std::vector<glm::vec3> pts, const int number) {
     for (int i = 0; i < number; ++i) {
         expand(pts[i]);
@@ -72,9 +78,9 @@ int bezel::compareSAP(void *a, void *b) {
     return 1;
 }
 
-void bezel::sortBodiesForBounds(std::vector<std::shared_ptr<Body>> bodies,
-                                std::vector<PseudoBody> &sortedArray,
-                                float dt) {
+void bezel::sortBodiesForBounds(
+    const std::vector<std::shared_ptr<Body>> &bodies,
+    std::vector<PseudoBody> &sortedArray, float dt) {
     glm::vec3 axis = glm::vec3(1.0f, 1.0f, 1.0f);
     axis = glm::normalize(axis);
 
@@ -133,16 +139,159 @@ void bezel::buildPairs(std::vector<CollisionPair> &pairs,
     }
 }
 
-void bezel::sweepAndPrune1d(std::vector<std::shared_ptr<Body>> bodies,
+void bezel::sweepAndPrune1d(const std::vector<std::shared_ptr<Body>> &bodies,
                             std::vector<CollisionPair> &pairs, float dt) {
     std::vector<PseudoBody> sortedArray(bodies.size() * 2);
     sortBodiesForBounds(bodies, sortedArray, dt);
     buildPairs(pairs, sortedArray);
 }
 
-void bezel::broadPhase(std::vector<std::shared_ptr<Body>> bodies,
+void bezel::broadPhase(const std::vector<std::shared_ptr<Body>> &bodies,
                        std::vector<CollisionPair> &pairs, float dt) {
     pairs.clear();
 
     sweepAndPrune1d(bodies, pairs, dt);
 }
+
+int bezel::SweepAndPrune::addProxy(const Bounds &bounds, int userIndex) {
+    int id;
+    if (!freeProxies.empty()) {
+        id = freeProxies.back();
+        freeProxies.pop_back();
+    } else {
+        id = static_cast<int>(proxies.size());
+        proxies.emplace_back();
+    }
+
+    Proxy &proxy = proxies[id];
+    proxy.bounds = bounds;
+    proxy.bounds.expand(bounds.mins - glm::vec3(margin));
+    proxy.bounds.expand(bounds.maxs + glm::vec3(margin));
+    proxy.userIndex = userIndex;
+    proxy.active = true;
+
+    // New proxies are appended and moved into place by the next insertion
+    // sort, so adding a batch of bodies costs a single repair pass.
+    for (auto &axis : axes) {
+        axis.push_back(id);
+    }
+    return id;
+}
+
+void bezel::SweepAndPrune::removeProxy(int proxy) {
+    if (proxy < 0 || proxy >= static_cast<int>(proxies.size()) ||
+        !proxies[proxy].active) {
+        return;
+    }
+
+    proxies[proxy].active = false;
+    proxies[proxy].userIndex = -1;
+    freeProxies.push_back(proxy);
+
+    for (auto &axis : axes) {
+        auto it = std::find(axis.begin(), axis.end(), proxy);
+        if (it != axis.end()) {
+            axis.erase(it);
+        }
+    }
+}
+
+bool bezel::SweepAndPrune::moveProxy(int proxy, const Bounds &bounds,
+                                     int userIndex) {
+    if (proxy < 0 || proxy >= static_cast<int>(proxies.size()) ||
+        !proxies[proxy].active) {
+        return false;
+    }
+
+    Proxy &entry = proxies[proxy];
+    entry.userIndex = userIndex;
+    if (entry.bounds.contains(bounds)) {
+        // A body that slowed down after a fast sweep would otherwise keep
+        // its huge box and the false pairs that come with it.
+        const glm::vec3 slack = (entry.bounds.maxs - entry.bounds.mins) -
+                                (bounds.maxs - bounds.mins);
+        const float shrinkLimit = 4.0f * margin;
+        if (slack.x <= shrinkLimit && slack.y <= shrinkLimit &&
+            slack.z <= shrinkLimit) {
+            return false;
+        }
+    }
+
+    entry.bounds = bounds;
+    entry.bounds.expand(bounds.mins - glm::vec3(margin));
+    entry.bounds.expand(bounds.maxs + glm::vec3(margin));
+    return true;
+}
+
+void bezel::SweepAndPrune::sortAxis(int axis) {
+    std::vector<int> &order = axes[axis];
+    for (size_t i = 1; i < order.size(); i++) {
+        const int id = order[i];
+        const float value = proxies[id].bounds.mins[axis];
+        size_t j = i;
+        while (j > 0 && proxies[order[j - 1]].bounds.mins[axis] > value) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = id;
+    }
+}
+
+int bezel::SweepAndPrune::chooseSweepAxis() const {
+    // Sweep along the axis where the proxies are spread the most, which is
+    // the one that rejects the most pairs before the full overlap test.
+    glm::vec3 sum(0.0f);
+    glm::vec3 sumSquared(0.0f);
+    const std::vector<int> &order = axes[0];
+    for (const int id : order) {
+        const Bounds &bounds = proxies[id].bounds;
+        glm::vec3 center = (bounds.mins + bounds.maxs) * 0.5f;
+        sum += center;
+        sumSquared += center * center;
+    }
+
+    if (order.empty()) {
+        return 0;
+    }
+
+    const float count = static_cast<float>(order.size());
+    glm::vec3 variance = sumSquared / count - (sum / count) * (sum / count);
+    if (variance.y > variance.x && variance.y >= variance.z) {
+        return 1;
+    }
+    if (variance.z > variance.x && variance.z > variance.y) {
+        return 2;
+    }
+    return 0;
+}
+
+void bezel::SweepAndPrune::buildPairs(std::vector<CollisionPair> &pairs) {
+    pairs.clear();
+
+    for (int axis = 0; axis < 3; axis++) {
+        sortAxis(axis);
+    }
+
+    const int axis = chooseSweepAxis();
+    const std::vector<int> &order = axes[axis];
+
+    for (size_t i = 0; i < order.size(); i++) {
+        const Proxy &a = proxies[order[i]];
+        const float maxOnAxis = a.bounds.maxs[axis];
+
+        for (size_t j = i + 1; j < order.size(); j++) {
+            const Proxy &b = proxies[order[j]];
+            if (b.bounds.mins[axis] > maxOnAxis) {
+                break;
+            }
+            if (!a.bounds.doesIntersect(b.bounds)) {
+                continue;
+            }
+
+            CollisionPair pair;
+            pair.a = a.userIndex;
+            pair.b = b.userIndex;
+            pairs.push_back(pair);
+        }
+    }
+}
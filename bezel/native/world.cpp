@@ -0,0 +1,265 @@
+/*
+ world.cpp
+ As part of the Atlas project
+ Created by Max Van den Eynde in 2025
+ --------------------------------------------------
+ Description: World-level stepping for Bezel Native
+ Copyright (c) 2025 maxvdec
+*/
+
+#include "bezel/native/world.h"
+#include "bezel/native/body.h"
+#include "bezel/native/bounds.h"
+#include "bezel/native/shape.h"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <vector>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/norm.hpp>
+
+namespace {
+
+Bounds sweptBounds(const Body &body, float dt) {
+    Bounds bounds =
+        body.shape->getBounds(body.position.toGlm(), body.orientation);
+    bounds.expand(bounds.mins + body.linearVelocity * dt);
+    bounds.expand(bounds.maxs + body.linearVelocity * dt);
+    return bounds;
+}
+
+} // namespace
+
+void bezel::NativeWorld::addBody(const std::shared_ptr<Body> &body) {
+    if (body == nullptr) {
+        return;
+    }
+    if (std::find(bodies.begin(), bodies.end(), body) != bodies.end()) {
+        return;
+    }
+    body->proxyId = broadphase.addProxy(sweptBounds(*body, 0.0f),
+                                        static_cast<int>(bodies.size()));
+    bodies.push_back(body);
+}
+
+void bezel::NativeWorld::removeBody(const std::shared_ptr<Body> &body) {
+    auto it = std::find(bodies.begin(), bodies.end(), body);
+    if (it == bodies.end()) {
+        return;
+    }
+    broadphase.removeProxy(body->proxyId);
+    body->proxyId = -1;
+    bodies.erase(it);
+    contacts.clear();
+}
+
+void bezel::NativeWorld::wake(const std::shared_ptr<Body> &body) {
+    if (body == nullptr) {
+        return;
+    }
+
+    auto it = std::find(bodies.begin(), bodies.end(), body);
+    if (it == bodies.end() || islandOf.size() != bodies.size()) {
+        body->isSleeping = false;
+        body->sleepTimer = 0.0f;
+        return;
+    }
+
+    const int island = islandOf[it - bodies.begin()];
+    for (std::size_t i = 0; i < bodies.size(); i++) {
+        if (islandOf[i] == island) {
+            bodies[i]->isSleeping = false;
+            bodies[i]->sleepTimer = 0.0f;
+        }
+    }
+}
+
+int bezel::NativeWorld::findIsland(int index) {
+    while (islandParent[index] != index) {
+        islandParent[index] = islandParent[islandParent[index]];
+        index = islandParent[index];
+    }
+    return index;
+}
+
+void bezel::NativeWorld::mergeIslands(int a, int b) {
+    int rootA = findIsland(a);
+    int rootB = findIsland(b);
+    if (rootA != rootB) {
+        islandParent[std::max(rootA, rootB)] = std::min(rootA, rootB);
+    }
+}
+
+void bezel::NativeWorld::buildIslands() {
+    const std::size_t count = bodies.size();
+    islandParent.resize(count);
+    std::iota(islandParent.begin(), islandParent.end(), 0);
+
+    // Static bodies never join islands, otherwise everything resting on the
+    // ground would end up in one island and could never sleep independently.
+    for (const Contact &contact : contacts) {
+        if (contact.bodyA->invMass == 0.0f || contact.bodyB->invMass == 0.0f) {
+            continue;
+        }
+        mergeIslands(contact.bodyA->worldIndex, contact.bodyB->worldIndex);
+    }
+
+    islandOf.resize(count);
+    islandAwake.assign(count, 0);
+    islandCount = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        islandOf[i] = findIsland(static_cast<int>(i));
+        if (bodies[i]->invMass == 0.0f) {
+            continue;
+        }
+        if (islandOf[i] == static_cast<int>(i)) {
+            islandCount++;
+        }
+        if (!bodies[i]->isSleeping) {
+            islandAwake[islandOf[i]] = 1;
+        }
+    }
+
+    // A sleeping body touched by an awake one wakes its whole island.
+    for (std::size_t i = 0; i < count; i++) {
+        Body &body = *bodies[i];
+        if (body.isSleeping && islandAwake[islandOf[i]]) {
+            body.isSleeping = false;
+            body.sleepTimer = 0.0f;
+        }
+    }
+}
+
+void bezel::NativeWorld::updateSleeping(float dt) {
+    const std::size_t count = bodies.size();
+    islandRestless.assign(count, 0);
+
+    for (std::size_t i = 0; i < count; i++) {
+        const Body &body = *bodies[i];
+        if (body.invMass == 0.0f || body.isSleeping) {
+            continue;
+        }
+        if (glm::length(body.linearVelocity) > Body::SLEEP_LINEAR_THRESHOLD ||
+            glm::length(body.angularVelocity) > Body::SLEEP_ANGULAR_THRESHOLD) {
+            islandRestless[islandOf[i]] = 1;
+        }
+    }
+
+    for (std::size_t i = 0; i < count; i++) {
+        Body &body = *bodies[i];
+        if (body.invMass == 0.0f || body.isSleeping) {
+            continue;
+        }
+        if (islandRestless[islandOf[i]]) {
+            body.sleepTimer = 0.0f;
+        } else {
+            body.sleepTimer += dt;
+        }
+    }
+
+    // An island only sleeps once every body in it has been still long enough.
+    for (std::size_t i = 0; i < count; i++) {
+        const Body &body = *bodies[i];
+        if (body.invMass == 0.0f || body.isSleeping) {
+            continue;
+        }
+        if (body.sleepTimer <= Body::SLEEP_TIME_THRESHOLD) {
+            islandRestless[islandOf[i]] = 1;
+        }
+    }
+
+    for (std::size_t i = 0; i < count; i++) {
+        Body &body = *bodies[i];
+        if (body.invMass == 0.0f || body.isSleeping ||
+            islandRestless[islandOf[i]]) {
+            continue;
+        }
+        body.isSleeping = true;
+        body.linearVelocity = glm::vec3(0.0f);
+        body.angularVelocity = glm::vec3(0.0f);
+    }
+}
+
+void bezel::NativeWorld::step(float dt) {
+    dt = std::min(dt, maxTimeStep);
+    if (dt <= 0.0f || bodies.empty()) {
+        return;
+    }
+
+    for (const auto &body : bodies) {
+        if (body->invMass > 0.0f && !body->isSleeping) {
+            body->applyLinearImpulse(gravity * body->getMass() * dt);
+        }
+    }
+
+    for (std::size_t i = 0; i < bodies.size(); i++) {
+        Body &body = *bodies[i];
+        body.worldIndex = static_cast<int>(i);
+        broadphase.moveProxy(body.proxyId, sweptBounds(body, dt),
+                             body.worldIndex);
+    }
+
+    broadphase.buildPairs(pairs);
+
+    contacts.clear();
+    for (const CollisionPair &pair : pairs) {
+        const std::shared_ptr<Body> &bodyA = bodies[pair.a];
+        const std::shared_ptr<Body> &bodyB = bodies[pair.b];
+
+        const bool activeA = bodyA->invMass > 0.0f && !bodyA->isSleeping;
+        const bool activeB = bodyB->invMass > 0.0f && !bodyB->isSleeping;
+        if (!activeA && !activeB) {
+            continue;
+        }
+
+        Contact contact;
+        if (!Body::intersects(bodyA, bodyB, contact, dt)) {
+            continue;
+        }
+
+        glm::vec3 relVel = bodyA->linearVelocity - bodyB->linearVelocity;
+        float normalVel = glm::dot(relVel, contact.normal);
+
+        bool isPenetrating = contact.separationDistance <= 0.0f;
+        bool isApproaching = normalVel < -0.01f;
+        bool isNearContact = contact.separationDistance < 0.05f; // Within 5cm
+
+        if (isPenetrating || isApproaching || isNearContact) {
+            contacts.push_back(contact);
+        }
+    }
+
+    std::sort(contacts.begin(), contacts.end(),
+              [](const Contact &a, const Contact &b) {
+                  return a.timeOfImpact < b.timeOfImpact;
+              });
+
+    buildIslands();
+
+    // Every body keeps its own clock so a contact only advances the two
+    // bodies it touches instead of the whole world.
+    for (const auto &body : bodies) {
+        body->localTime = 0.0f;
+    }
+
+    for (Contact &contact : contacts) {
+        const float toi = std::clamp(contact.timeOfImpact, 0.0f, dt);
+        for (Body *body : {contact.bodyA.get(), contact.bodyB.get()}) {
+            if (!body->isSleeping && toi > body->localTime) {
+                body->updatePhysics(toi - body->localTime);
+                body->localTime = toi;
+            }
+        }
+        contact.bodyA->resolveContact(contact);
+    }
+
+    for (const auto &body : bodies) {
+        if (!body->isSleeping && dt > body->localTime) {
+            body->updatePhysics(dt - body->localTime);
+        }
+        body->localTime = 0.0f;
+    }
+
+    updateSleeping(dt);
+}
@@ -0,0 +1,270 @@
+//
+// glyph_cache.cpp
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: Shared glyph atlas cache implementation
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#include "graphite/glyph_cache.h"
+#include "atlas/tracer/log.h"
+#include "ft2build.h" // IWYU pragma: keep
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include FT_FREETYPE_H
+
+namespace {
+
+// Empty pixels left around every glyph so linear filtering never bleeds
+// into a neighbour.
+constexpr int GLYPH_PADDING = 1;
+// Glyph metrics are computed at this resolution, as fonts always were.
+constexpr unsigned int FONT_DPI = 96;
+
+uint64_t glyphKey(int face, int size, uint32_t codepoint) {
+    return (static_cast<uint64_t>(face & 0xFFFF) << 48) |
+           (static_cast<uint64_t>(size & 0xFFFF) << 32) | codepoint;
+}
+
+} // namespace
+
+namespace graphite {
+
+uint32_t decodeUtf8(const std::string &text, size_t &index) {
+    constexpr uint32_t replacement = 0xFFFD;
+    const auto lead = static_cast<unsigned char>(text[index]);
+    size_t length = 0;
+    uint32_t codepoint = 0;
+    if (lead < 0x80) {
+        index++;
+        return lead;
+    } else if ((lead & 0xE0) == 0xC0) {
+        length = 2;
+        codepoint = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3;
+        codepoint = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4;
+        codepoint = lead & 0x07;
+    } else {
+        index++;
+        return replacement;
+    }
+
+    if (index + length > text.size()) {
+        index++;
+        return replacement;
+    }
+    for (size_t i = 1; i < length; i++) {
+        const auto next = static_cast<unsigned char>(text[index + i]);
+        if ((next & 0xC0) != 0x80) {
+            index++;
+            return replacement;
+        }
+        codepoint = (codepoint << 6) | (next & 0x3F);
+    }
+    index += length;
+    return codepoint;
+}
+
+GlyphCache::~GlyphCache() {
+    for (auto &face : faces) {
+        FT_Done_Face(face.handle);
+    }
+    if (library != nullptr) {
+        FT_Done_FreeType(library);
+    }
+}
+
+int GlyphCache::loadFace(const std::string &path) {
+    for (size_t i = 0; i < faces.size(); i++) {
+        if (faces[i].path == path) {
+            return static_cast<int>(i);
+        }
+    }
+
+    if (library == nullptr && FT_Init_FreeType(&library)) {
+        atlas_error("Could not initialize FreeType Library");
+        library = nullptr;
+        return -1;
+    }
+
+    FT_Face handle = nullptr;
+    if (FT_New_Face(library, path.c_str(), 0, &handle)) {
+        atlas_error("Failed to load font: " + path);
+        return -1;
+    }
+    faces.push_back({.path = path, .handle = handle, .activeSize = 0});
+    return static_cast<int>(faces.size() - 1);
+}
+
+const Character *GlyphCache::getGlyph(int face, int size, uint32_t codepoint) {
+    if (face < 0 || face >= static_cast<int>(faces.size()) || size <= 0) {
+        return nullptr;
+    }
+
+    const uint64_t key = glyphKey(face, size, codepoint);
+    auto it = glyphs.find(key);
+    if (it != glyphs.end()) {
+        if (it->second.page < pages.size()) {
+            pages[it->second.page].lastUsed = ++useCounter;
+        }
+        return &it->second;
+    }
+
+    Face &entry = faces[face];
+    if (entry.activeSize != size) {
+        FT_Set_Char_Size(entry.handle, 0, size * 64, FONT_DPI, FONT_DPI);
+        entry.activeSize = size;
+    }
+    if (FT_Load_Char(entry.handle, codepoint, FT_LOAD_RENDER)) {
+        atlas_warning("Failed to load Glyph: " + std::to_string(codepoint));
+        return nullptr;
+    }
+
+    const FT_GlyphSlot slot = entry.handle->glyph;
+    const int width = static_cast<int>(slot->bitmap.width);
+    const int height = static_cast<int>(slot->bitmap.rows);
+
+    Character character = {
+        .size = Size2d(width, height),
+        .bearing = Position2d(slot->bitmap_left, slot->bitmap_top),
+        .advance = static_cast<unsigned int>(slot->advance.x),
+        .uvMin = Position2d(0.0f, 0.0f),
+        .uvMax = Position2d(0.0f, 0.0f)};
+
+    // Blank glyphs such as spaces only carry metrics.
+    if (width > 0 && height > 0) {
+        unsigned int pageIndex = 0;
+        int x = 0;
+        int y = 0;
+        if (!allocate(width, height, pageIndex, x, y)) {
+            atlas_warning("Glyph too large for the glyph cache: " +
+                          std::to_string(codepoint));
+            character.size = Size2d(0, 0);
+            return &glyphs.emplace(key, character).first->second;
+        }
+
+        Page &page = pages[pageIndex];
+        const int pitch = std::abs(slot->bitmap.pitch);
+        for (int row = 0; row < height; row++) {
+            uint8_t *target = page.pixels.data() +
+                              (static_cast<size_t>(y + row) * PAGE_SIZE) + x;
+            std::memcpy(target, slot->bitmap.buffer + (row * pitch), width);
+        }
+        page.glyphs.push_back(key);
+        page.lastUsed = ++useCounter;
+        page.dirty = true;
+
+        const auto atlasSize = static_cast<float>(PAGE_SIZE);
+        character.page = pageIndex;
+        // UV Min (Top-Left)
+        character.uvMin = Position2d(static_cast<float>(x) / atlasSize,
+                                     static_cast<float>(y) / atlasSize);
+        // UV Max (Bottom-Right)
+        character.uvMax =
+            Position2d(static_cast<float>(x + width) / atlasSize,
+                       static_cast<float>(y + height) / atlasSize);
+    }
+
+    return &glyphs.emplace(key, character).first->second;
+}
+
+void GlyphCache::upload() {
+    for (auto &page : pages) {
+        if (!page.dirty) {
+            continue;
+        }
+        page.texture->updateData(page.pixels.data(), PAGE_SIZE, PAGE_SIZE,
+                                 opal::TextureDataFormat::Red);
+        page.dirty = false;
+    }
+}
+
+std::shared_ptr<opal::Texture>
+GlyphCache::getPageTexture(unsigned int page) const {
+    if (page >= pages.size()) {
+        return nullptr;
+    }
+    return pages[page].texture;
+}
+
+bool GlyphCache::place(Page &page, int width, int height, int &x, int &y) {
+    // Use the shortest shelf the glyph fits on to keep wasted rows small.
+    Shelf *best = nullptr;
+    for (auto &shelf : page.shelves) {
+        if (shelf.height >= height && shelf.cursor + width <= PAGE_SIZE &&
+            (best == nullptr || shelf.height < best->height)) {
+            best = &shelf;
+        }
+    }
+
+    if (best == nullptr) {
+        if (page.nextShelf + height > PAGE_SIZE) {
+            return false;
+        }
+        page.shelves.push_back({.y = page.nextShelf, .height = height});
+        page.nextShelf += height + GLYPH_PADDING;
+        best = &page.shelves.back();
+    }
+
+    x = best->cursor;
+    y = best->y;
+    best->cursor += width + GLYPH_PADDING;
+    return true;
+}
+
+bool GlyphCache::allocate(int width, int height, unsigned int &page, int &x,
+                          int &y) {
+    if (width > PAGE_SIZE || height > PAGE_SIZE) {
+        return false;
+    }
+
+    for (size_t i = 0; i < pages.size(); i++) {
+        if (place(pages[i], width, height, x, y)) {
+            page = static_cast<unsigned int>(i);
+            return true;
+        }
+    }
+
+    if (pages.size() < std::max<size_t>(maxPages, 1)) {
+        Page created;
+        created.pixels.assign(static_cast<size_t>(PAGE_SIZE) * PAGE_SIZE, 0);
+        created.texture = opal::Texture::create(
+            opal::TextureType::Texture2D, opal::TextureFormat::Red8, PAGE_SIZE,
+            PAGE_SIZE, opal::TextureDataFormat::Red, created.pixels.data(), 1);
+        created.texture->setParameters(opal::TextureWrapMode::ClampToEdge,
+                                       opal::TextureWrapMode::ClampToEdge,
+                                       opal::TextureFilterMode::Linear,
+                                       opal::TextureFilterMode::Linear);
+        pages.push_back(std::move(created));
+        page = static_cast<unsigned int>(pages.size() - 1);
+        return place(pages.back(), width, height, x, y);
+    }
+
+    auto oldest = std::min_element(pages.begin(), pages.end(),
+                                   [](const Page &a, const Page &b) {
+                                       return a.lastUsed < b.lastUsed;
+                                   });
+    page = static_cast<unsigned int>(std::distance(pages.begin(), oldest));
+    recycle(page);
+    return place(pages[page], width, height, x, y);
+}
+
+void GlyphCache::recycle(unsigned int page) {
+    Page &target = pages[page];
+    for (uint64_t key : target.glyphs) {
+        glyphs.erase(key);
+    }
+    target.glyphs.clear();
+    target.shelves.clear();
+    target.nextShelf = 0;
+    std::fill(target.pixels.begin(), target.pixels.end(), 0);
+    target.dirty = true;
+    generation++;
+}
+
+} // namespace graphite
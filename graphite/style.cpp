@@ -542,8 +542,17 @@ float measureTextWidth(const Font &font, const std::string &text,
                        std::size_t start, std::size_t end, float fontSize) {
     float width = 0.0f;
     const std::size_t clampedEnd = std::min(end, text.size());
-    for (std::size_t index = start; index < clampedEnd; ++index) {
-        width += measureCharacterWidth(font, text[index], fontSize);
+    for (std::size_t index = start; index < clampedEnd;) {
+        if (static_cast<unsigned char>(text[index]) < 0x80) {
+            width += measureCharacterWidth(font, text[index], fontSize);
+            index++;
+            continue;
+        }
+        const Character *glyph = font.glyph(decodeUtf8(text, index));
+        if (glyph != nullptr) {
+            width += static_cast<float>(glyph->advance >> 6) *
+                     resolveTextScale(font, fontSize);
+        }
     }
     return width;
 }
@@ -12,14 +12,19 @@
 #include "atlas/tracer/log.h"
 #include "atlas/window.h"
 #include "opal/opal.h"
-#include "ft2build.h" // IWYU pragma: keep
 #include <algorithm>
-#include <iostream>
-#include FT_FREETYPE_H
+#include <iterator>
 #include <vector>
 
 namespace {
 
+// Four floats per vertex and six vertices per glyph quad.
+constexpr size_t FLOATS_PER_VERTEX = 4;
+constexpr size_t FLOATS_PER_GLYPH = FLOATS_PER_VERTEX * 6;
+// Text with more glyphs than the cache holds recycles a page on every pass,
+// so stop retrying and lay it out again on the next frame.
+constexpr int MAX_GLYPH_COPY_ATTEMPTS = 3;
+
 graphite::UIStyle makeFallbackStyle(const Text &text) {
     graphite::UIStyle style;
     style.normal().foreground(text.color).font(text.font);
@@ -35,93 +40,28 @@ Font Font::fromResource(const std::string &fontName, const Resource &resource,
                         int fontSize) {
     atlas_log("Loading font: " + fontName +
               " (size: " + std::to_string(fontSize) + ")");
-    FT_Library ft;
-    if (FT_Init_FreeType(&ft)) {
-        atlas_error("Could not initialize FreeType Library");
+    auto &cache = graphite::GlyphCache::getInstance();
+    const int face = cache.loadFace(resource.path.string());
+    if (face < 0) {
         return Font();
     }
 
-    FT_Face face;
-    if (FT_New_Face(ft, resource.path.c_str(), 0, &face)) {
-        atlas_error("Failed to load font: " + std::string(resource.path));
-        return Font();
-    }
-
-    int dpi = 96;
-    FT_Set_Char_Size(face, 0, fontSize * 64, dpi, dpi);
-
     Font font;
+    font.face = face;
 
-    const int atlasWidth = 1024;
-    const int atlasHeight = 1024;
-    std::vector<unsigned char> atlasData(atlasWidth * atlasHeight, 0);
-
-    int currentX = 0;
-    int currentY = 0;
-    int rowHeight = 0;
-    const int padding = 1;
-
+    // The ASCII range is rasterized up front so measuring text does not
+    // depend on what has been drawn so far.
     for (unsigned char c = 0; c < 128; c++) {
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
-            atlas_warning("Failed to load Glyph: " +
-                          std::to_string(static_cast<int>(c)));
-            std::cerr << "Failed to load Glyph: " << c << std::endl;
+        const Character *character = cache.getGlyph(face, fontSize, c);
+        if (character == nullptr) {
             continue;
         }
-
-        int width = face->glyph->bitmap.width;
-        int height = face->glyph->bitmap.rows;
-
-        if (currentX + width + padding > atlasWidth) {
-            currentX = 0;
-            currentY += rowHeight + padding;
-            rowHeight = 0;
-        }
-
-        if (currentY + height + padding > atlasHeight) {
-            atlas_warning("Font atlas full for font: " + fontName);
-            std::cerr << "Font atlas full for font: " << fontName << std::endl;
-            break;
-        }
-
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                atlasData[((currentY + y) * atlasWidth) + (currentX + x)] =
-                    face->glyph->bitmap.buffer[(y * width) + x];
-            }
+        font.atlas.insert(std::pair<char, Character>(c, *character));
+        if (font.texture == nullptr && character->size.width > 0) {
+            font.texture = cache.getPageTexture(character->page);
         }
-
-        Character character = {
-            .size = Size2d(width, height),
-            .bearing =
-                Position2d(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            .advance = static_cast<unsigned int>(face->glyph->advance.x),
-            // UV Min (Top-Left)
-            .uvMin = Position2d(static_cast<float>(currentX) / atlasWidth,
-                                static_cast<float>(currentY) / atlasHeight),
-            // UV Max (Bottom-Right)
-            .uvMax = Position2d(
-                static_cast<float>(currentX + width) / atlasWidth,
-                static_cast<float>(currentY + height) / atlasHeight)};
-
-        font.atlas.insert(std::pair<char, Character>(c, character));
-
-        currentX += width + padding;
-        rowHeight = std::max(rowHeight, height);
     }
-
-    auto opalTexture = opal::Texture::create(
-        opal::TextureType::Texture2D, opal::TextureFormat::Red8, atlasWidth,
-        atlasHeight, opal::TextureDataFormat::Red, atlasData.data(), 1);
-
-    opalTexture->setParameters(
-        opal::TextureWrapMode::ClampToEdge, opal::TextureWrapMode::ClampToEdge,
-        opal::TextureFilterMode::Linear, opal::TextureFilterMode::Linear);
-
-    font.texture = opalTexture;
-
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+    cache.upload();
 
     font.name = fontName;
     font.size = fontSize;
@@ -131,6 +71,10 @@ Font Font::fromResource(const std::string &fontName, const Resource &resource,
     return font;
 }
 
+const Character *Font::glyph(uint32_t codepoint) const {
+    return graphite::GlyphCache::getInstance().getGlyph(face, size, codepoint);
+}
+
 Font &Font::getFont(const std::string &fontName) {
     for (auto &font : fonts) {
         if (font.name == fontName) {
@@ -148,6 +92,7 @@ void Font::changeSize(int newSize) {
     Font newFont = Font::fromResource(name, resource, newSize);
     atlas = newFont.atlas;
     texture = newFont.texture;
+    face = newFont.face;
     size = newSize;
 }
 
@@ -190,11 +135,125 @@ void Text::initialize() {
     std::vector<opal::VertexAttributeBinding> bindings = {
         {textAttribute, vertexBuffer}};
     vao->configureAttributes(bindings);
+    layoutDirty = true;
 
     shader = ShaderProgram::fromDefaultShaders(AtlasVertexShader::Text,
                                                AtlasFragmentShader::Text);
 }
 
+void Text::layoutGlyphs(const Font &font, float scale,
+                        const Size2d &padding) {
+    graphite::GlyphCache &cache = graphite::GlyphCache::getInstance();
+    uint64_t generation = cache.getGeneration();
+    if (!layoutDirty && layoutContent == content && layoutFace == font.face &&
+        layoutFontSize == font.size && layoutGeneration == generation &&
+        layoutScale == scale && layoutPadding.width == padding.width &&
+        layoutPadding.height == padding.height) {
+        return;
+    }
+
+    // Copy the glyphs out first: looking up a new glyph may recycle a cache
+    // page and invalidate pointers returned earlier. A recycled page can also
+    // evict glyphs copied before it, so the copy is redone until a pass
+    // leaves the cache generation untouched.
+    std::vector<Character> glyphs;
+    glyphs.reserve(content.size());
+    float maxBearingY = 0.0f;
+    for (int attempt = 0; attempt < MAX_GLYPH_COPY_ATTEMPTS; attempt++) {
+        generation = cache.getGeneration();
+        glyphs.clear();
+        maxBearingY = 0.0f;
+        for (size_t index = 0; index < content.size();) {
+            const Character *ch =
+                font.glyph(graphite::decodeUtf8(content, index));
+            if (ch == nullptr) {
+                continue;
+            }
+            glyphs.push_back(*ch);
+            maxBearingY = std::max(ch->bearing.y, maxBearingY);
+        }
+        if (cache.getGeneration() == generation) {
+            break;
+        }
+    }
+
+    // Quads are placed relative to the text origin so moving the text only
+    // changes the projection, not the vertex stream.
+    float x = padding.width;
+    const float y = padding.height + (maxBearingY * scale);
+
+    struct GlyphQuad {
+        unsigned int page;
+        float vertices[FLOATS_PER_GLYPH];
+    };
+    std::vector<GlyphQuad> quads;
+    quads.reserve(glyphs.size());
+    for (const Character &ch : glyphs) {
+        const float w = ch.size.width * scale;
+        const float h = ch.size.height * scale;
+        if (w > 0.0f && h > 0.0f) {
+            const float xpos = x + (ch.bearing.x * scale);
+            const float ypos = y - (ch.bearing.y * scale);
+
+            const float u0 = ch.uvMin.x;
+            const float v0 = ch.uvMin.y;
+            const float u1 = ch.uvMax.x;
+            const float v1 = ch.uvMax.y;
+
+            quads.push_back(
+                {ch.page,
+                 {xpos,     ypos,     u0, v0, xpos,     ypos + h, u0, v1,
+                  xpos + w, ypos + h, u1, v1, xpos,     ypos,     u0, v0,
+                  xpos + w, ypos + h, u1, v1, xpos + w, ypos,     u1, v0}});
+        }
+
+        x += (ch.advance >> 6) * scale;
+    }
+
+    // Group quads by cache page so each page is bound and drawn once.
+    std::stable_sort(quads.begin(), quads.end(),
+                     [](const GlyphQuad &a, const GlyphQuad &b) {
+                         return a.page < b.page;
+                     });
+    glyphVertices.clear();
+    glyphVertices.reserve(quads.size() * FLOATS_PER_GLYPH);
+    glyphRanges.clear();
+    for (const GlyphQuad &quad : quads) {
+        const size_t vertex = glyphVertices.size() / FLOATS_PER_VERTEX;
+        if (glyphRanges.empty() || glyphRanges.back().page != quad.page) {
+            glyphRanges.push_back({quad.page, vertex, 0});
+        }
+        glyphRanges.back().vertexCount += FLOATS_PER_GLYPH / FLOATS_PER_VERTEX;
+        glyphVertices.insert(glyphVertices.end(), std::begin(quad.vertices),
+                             std::end(quad.vertices));
+    }
+
+    const size_t requiredBytes = glyphVertices.size() * sizeof(float);
+    if (requiredBytes > vertexBufferCapacity) {
+        vertexBufferCapacity =
+            std::max(requiredBytes, vertexBufferCapacity * 2);
+        vertexBuffer = opal::Buffer::create(
+            opal::BufferUsage::VertexBuffer, vertexBufferCapacity, nullptr,
+            opal::MemoryUsageType::CPUToGPU, id);
+        vao->setBuffers(vertexBuffer, nullptr);
+    }
+    if (requiredBytes > 0) {
+        vertexBuffer->bind();
+        vertexBuffer->updateData(0, requiredBytes, glyphVertices.data());
+        vertexBuffer->unbind();
+    }
+
+    layoutContent = content;
+    layoutFace = font.face;
+    layoutFontSize = font.size;
+    // When every pass recycled a page this is older than the cache, and the
+    // next call lays the text out again.
+    layoutGeneration = generation;
+    layoutScale = scale;
+    layoutPadding = padding;
+    layoutDirty = false;
+}
+
 void Text::render(float dt, std::shared_ptr<opal::CommandBuffer> commandBuffer,
                   bool updatePipeline) {
     (void)updatePipeline;
@@ -283,78 +342,32 @@ void Text::render(float dt, std::shared_ptr<opal::CommandBuffer> commandBuffer,
                             static_cast<float>(fbHeight));
 #endif
 
+    const float scale =
+        graphite::resolveTextScale(resolvedFont, style.fontSize);
+    layoutGlyphs(resolvedFont, scale, style.padding);
+    const size_t vertexCount = glyphVertices.size() / FLOATS_PER_VERTEX;
+
     textPipeline->setUniform3f("textColor", style.foregroundColor.r,
                                style.foregroundColor.g,
                                style.foregroundColor.b);
-    textPipeline->setUniformMat4f("projection", projection);
+    textPipeline->setUniformMat4f(
+        "projection",
+        projection * glm::translate(glm::mat4(1.0f),
+                                    glm::vec3(position.x, position.y, 0.0f)));
 
-    if (resolvedFont.texture) {
-        textPipeline->bindTexture2D("text", resolvedFont.texture->textureID, 0,
-                                    id);
-    }
+    auto &glyphCache = graphite::GlyphCache::getInstance();
+    glyphCache.upload();
 
     commandBuffer->bindDrawingState(vao);
-
-    float scale = graphite::resolveTextScale(resolvedFont, style.fontSize);
-
-    float maxBearingY = 0.0f;
-    for (const char &ch : content) {
-        const auto it = resolvedFont.atlas.find(ch);
-        if (it == resolvedFont.atlas.end()) {
+    for (const GlyphRange &range : glyphRanges) {
+        const std::shared_ptr<opal::Texture> page =
+            glyphCache.getPageTexture(range.page);
+        if (page == nullptr) {
             continue;
         }
-        maxBearingY = std::max(it->second.bearing.y, maxBearingY);
-    }
-
-    float x = position.x + style.padding.width;
-    float y = position.y + style.padding.height + (maxBearingY * scale);
-
-    std::string::const_iterator c;
-    const size_t glyphCount = content.size();
-    const size_t bytesPerGlyph = sizeof(float) * 6 * 4;
-    const size_t requiredBytes = glyphCount * bytesPerGlyph;
-    if (requiredBytes > vertexBufferCapacity) {
-        vertexBufferCapacity = requiredBytes;
-        vertexBuffer = opal::Buffer::create(
-            opal::BufferUsage::VertexBuffer, vertexBufferCapacity, nullptr,
-            opal::MemoryUsageType::CPUToGPU, id);
-        vao->setBuffers(vertexBuffer, nullptr);
-    }
-
-    size_t glyphIndex = 0;
-    for (c = content.begin(); c != content.end(); c++, ++glyphIndex) {
-        const auto it = resolvedFont.atlas.find(*c);
-        if (it == resolvedFont.atlas.end()) {
-            continue;
-        }
-        Character ch = it->second;
-
-        float xpos = x + (ch.bearing.x * scale);
-        float ypos = y - (ch.bearing.y * scale);
-
-        float w = ch.size.width * scale;
-        float h = ch.size.height * scale;
-
-        float u0 = ch.uvMin.x;
-        float v0 = ch.uvMin.y;
-        float u1 = ch.uvMax.x;
-        float v1 = ch.uvMax.y;
-
-        float vertices[6][4] = {
-            {xpos, ypos, u0, v0},         {xpos, ypos + h, u0, v1},
-            {xpos + w, ypos + h, u1, v1},
-
-            {xpos, ypos, u0, v0},         {xpos + w, ypos + h, u1, v1},
-            {xpos + w, ypos, u1, v0}};
-
-        vertexBuffer->bind();
-        const size_t offset = glyphIndex * bytesPerGlyph;
-        vertexBuffer->updateData(offset, sizeof(vertices), vertices);
-        vertexBuffer->unbind();
-        commandBuffer->draw(
-            6, 1, static_cast<uint>(offset / (4 * sizeof(float))), 0, id);
-
-        x += (ch.advance >> 6) * scale;
+        textPipeline->bindTexture2D("text", page->textureID, 0, id);
+        commandBuffer->draw(static_cast<uint>(range.vertexCount), 1,
+                            static_cast<uint>(range.firstVertex), 0, id);
     }
 
     commandBuffer->unbindDrawingState();
@@ -364,13 +377,15 @@ void Text::render(float dt, std::shared_ptr<opal::CommandBuffer> commandBuffer,
 
     if (TracerServices::getInstance().isOk()) {
         DebugObjectPacket debugPacket{};
-        debugPacket.drawCallsForObject = 1;
+        debugPacket.drawCallsForObject =
+            static_cast<unsigned int>(glyphRanges.size());
         debugPacket.frameCount = Window::mainWindow->device->frameCount;
-        debugPacket.triangleCount = static_cast<unsigned int>(glyphCount) * 2;
+        debugPacket.triangleCount = static_cast<unsigned int>(vertexCount / 3);
         debugPacket.vertexBufferSizeMb =
-            static_cast<float>(requiredBytes) / (1024.0f * 1024.0f);
+            static_cast<float>(vertexBufferCapacity) / (1024.0f * 1024.0f);
         debugPacket.indexBufferSizeMb = 0.0f;
-        debugPacket.textureCount = (resolvedFont.texture ? 1 : 0);
+        debugPacket.textureCount =
+            static_cast<unsigned int>(glyphRanges.size());
         debugPacket.materialCount = 0;
         debugPacket.objectType = DebugObjectType::Other;
         debugPacket.objectId = this->id;
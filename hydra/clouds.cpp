@@ -7,15 +7,168 @@
 // Copyright (c) 2025 Max Van den Eynde
 //
 
+#include "atlas/tracer/log.h"
 #include "atlas/units.h"
 #include <hydra/atmosphere.h>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <glm/gtc/packing.hpp>
+#include <system_error>
+
+namespace {
+
+constexpr uint32_t CACHE_MAGIC = 0x31574C43; // "CLW1"
+// Bump whenever the noise or the file layout changes so older volumes stop
+// matching.
+constexpr uint32_t CACHE_VERSION = 1;
+constexpr size_t CHANNEL_COUNT = 4;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t resolution;
+    uint32_t channels;
+};
+
+uint64_t hashValues(const std::array<uint32_t, 5> &values) {
+    // FNV-1a over the little-endian bytes of every value.
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (uint32_t value : values) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            hash ^= (value >> shift) & 0xFFu;
+            hash *= 0x100000001B3ull;
+        }
+    }
+    return hash;
+}
+
+std::filesystem::path cachePath(const std::filesystem::path &directory,
+                                const WorleyNoise3D &noise, int resolution) {
+    const uint64_t hash =
+        hashValues({CACHE_MAGIC, CACHE_VERSION,
+                    static_cast<uint32_t>(noise.getFrequency()),
+                    static_cast<uint32_t>(noise.getDivisions()),
+                    static_cast<uint32_t>(resolution)});
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.clouds",
+                  static_cast<unsigned long long>(hash));
+    return directory / name;
+}
+
+size_t voxelValueCount(int resolution) {
+    return static_cast<size_t>(resolution) * resolution * resolution *
+           CHANNEL_COUNT;
+}
+
+bool loadVolume(const std::filesystem::path &path, int resolution,
+                std::vector<float> &data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    CacheHeader header{};
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || header.magic != CACHE_MAGIC ||
+        header.version != CACHE_VERSION ||
+        header.resolution != static_cast<uint32_t>(resolution) ||
+        header.channels != CHANNEL_COUNT) {
+        return false;
+    }
+
+    std::vector<uint16_t> halves(voxelValueCount(resolution));
+    file.read(reinterpret_cast<char *>(halves.data()),
+              static_cast<std::streamsize>(halves.size() * sizeof(uint16_t)));
+    if (!file) {
+        return false;
+    }
+
+    data.resize(halves.size());
+    for (size_t i = 0; i < halves.size(); i++) {
+        data[i] = glm::unpackHalf1x16(halves[i]);
+    }
+    return true;
+}
+
+void storeVolume(const std::filesystem::path &path, int resolution,
+                 const std::vector<float> &data) {
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    if (error) {
+        atlas_warning("Could not create cloud cache directory: " +
+                      error.message());
+        return;
+    }
+
+    std::vector<uint16_t> halves(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        halves[i] = glm::packHalf1x16(data[i]);
+    }
+
+    // Write next to the final file and rename it into place, so another
+    // process never reads a half written volume.
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        const CacheHeader header = {.magic = CACHE_MAGIC,
+                                    .version = CACHE_VERSION,
+                                    .resolution =
+                                        static_cast<uint32_t>(resolution),
+                                    .channels = static_cast<uint32_t>(
+                                        CHANNEL_COUNT)};
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(
+            reinterpret_cast<const char *>(halves.data()),
+            static_cast<std::streamsize>(halves.size() * sizeof(uint16_t)));
+        if (!file) {
+            atlas_warning("Could not write cloud cache: " + temporary.string());
+            file.close();
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+    }
+}
+
+} // namespace
+
+std::filesystem::path Clouds::getDefaultCacheDirectory() {
+    std::error_code error;
+    std::filesystem::path temporary =
+        std::filesystem::temp_directory_path(error);
+    if (error) {
+        return {};
+    }
+    return temporary / "atlas" / "clouds";
+}
+
 Id Clouds::getCloudTexture(int res) const {
     if (cachedTextureId != 0 && cachedResolution == res) {
         return cachedTextureId;
     }
 
-    Id textureId = worleyNoise.getDetailTexture(res);
+    const int resolution = std::max(1, res);
+    std::vector<float> data;
+    if (cacheDirectory.empty()) {
+        data = worleyNoise.getDetailData(resolution);
+    } else {
+        const std::filesystem::path path =
+            cachePath(cacheDirectory, worleyNoise, resolution);
+        if (!loadVolume(path, resolution, data)) {
+            data = worleyNoise.getDetailData(resolution);
+            storeVolume(path, resolution, data);
+        }
+    }
+
+    Id textureId = worleyNoise.createTexture3d(data, resolution);
     cachedTextureId = textureId;
     cachedResolution = res;
     return cachedTextureId;
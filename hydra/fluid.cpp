@@ -9,6 +9,7 @@
 
 #include "hydra/fluid.h"
 #include "atlas/light.h"
+#include "atlas/physics.h"
 #include "atlas/texture.h"
 #include "atlas/tracer/data.h"
 #include "atlas/tracer/log.h"
@@ -24,9 +25,15 @@
 #include <glad/glad.h>
 #include <glm/gtc/matrix_transform.hpp>
 
+namespace {
+// Past this the vertex grid costs more than the detail it adds, so larger
+// heightfields are sampled between vertices.
+constexpr int MAX_SURFACE_SUBDIVISIONS = 256;
+} // namespace
+
 Fluid::Fluid() {
     renderLateForward = true;
-    buildPlaneGeometry();
+    buildPlaneGeometry(1);
     updateModelMatrix();
 }
 
@@ -51,13 +58,17 @@ void Fluid::initialize() {
     }
 
     atlas_log("Initializing fluid");
+    uploadGeometry();
+    isInitialized = true;
+}
 
-    vertexBuffer = opal::Buffer::create(opal::BufferUsage::VertexBuffer,
-                                        sizeof(vertices), vertices.data(),
-                                        opal::MemoryUsageType::GPUOnly, id);
-    indexBuffer = opal::Buffer::create(opal::BufferUsage::IndexArray,
-                                       sizeof(indices), indices.data(),
-                                       opal::MemoryUsageType::GPUOnly, id);
+void Fluid::uploadGeometry() {
+    vertexBuffer = opal::Buffer::create(
+        opal::BufferUsage::VertexBuffer, vertices.size() * sizeof(FluidVertex),
+        vertices.data(), opal::MemoryUsageType::GPUOnly, id);
+    indexBuffer = opal::Buffer::create(
+        opal::BufferUsage::IndexArray, indices.size() * sizeof(unsigned int),
+        indices.data(), opal::MemoryUsageType::GPUOnly, id);
 
     drawingState = opal::DrawingState::create(vertexBuffer, indexBuffer);
     drawingState->setBuffers(vertexBuffer, indexBuffer);
@@ -88,8 +99,6 @@ void Fluid::initialize() {
     makeBinding("bitangent", 4, 3, offsetof(FluidVertex, bitangent));
 
     drawingState->configureAttributes(bindings);
-
-    isInitialized = true;
 }
 
 void Fluid::render(float dt, std::shared_ptr<opal::CommandBuffer> commandBuffer,
@@ -103,16 +112,8 @@ void Fluid::render(float dt, std::shared_ptr<opal::CommandBuffer> commandBuffer,
         throw std::runtime_error(
             "Fluid::render requires a valid command buffer");
     }
-    if (captureDirty) {
-        Window *window = Window::mainWindow;
-        if (window) {
-            ensureTargets(*window);
-            if (reflectionTarget && refractionTarget) {
-                window->captureFluidReflection(*this, commandBuffer);
-                window->captureFluidRefraction(*this, commandBuffer);
-                captureDirty = false;
-            }
-        }
+    if (hasPendingCapture() && Window::mainWindow != nullptr) {
+        updateCapture(*Window::mainWindow, commandBuffer);
     }
 
     static std::shared_ptr<opal::Pipeline> fluidPipeline = nullptr;
@@ -126,6 +127,7 @@ void Fluid::render(float dt, std::shared_ptr<opal::CommandBuffer> commandBuffer,
     fluidPipeline->setUniformMat4f("model", modelMatrix);
     fluidPipeline->setUniformMat4f("view", viewMatrix);
     fluidPipeline->setUniformMat4f("projection", projectionMatrix);
+    fluidPipeline->setUniform1i("hasWaveTexture", waveTexture != nullptr);
     fluidPipeline->setUniform4f("waterColor", color.r, color.g, color.b,
                                 color.a);
 
@@ -163,6 +165,9 @@ void Fluid::render(float dt, std::shared_ptr<opal::CommandBuffer> commandBuffer,
     fluidPipeline->bindTexture2D("normalTexture", normalTexture.id, 6, id);
     fluidPipeline->setUniform1i("hasNormalTexture", normalTexture.id != 0);
 
+    fluidPipeline->bindTexture2D(
+        "waveTexture", waveTexture ? waveTexture->textureID : 0, 7, id);
+
     fluidPipeline->setUniform3f("cameraPos",
                                 Window::mainWindow->getCamera()->position.x,
                                 Window::mainWindow->getCamera()->position.y,
@@ -192,6 +197,18 @@ void Fluid::render(float dt, std::shared_ptr<opal::CommandBuffer> commandBuffer,
                                    glm::inverse(projectionMatrix));
     fluidPipeline->setUniformMat4f("invView", glm::inverse(viewMatrix));
 
+    // Each capture is reprojected with the camera it was taken from. Until
+    // the first one exists the current camera is used.
+    const glm::mat4 viewProjection = projectionMatrix * viewMatrix;
+    fluidPipeline->setUniformMat4f("reflectionViewProjection",
+                                   hasReflectionCapture
+                                       ? reflectionViewProjection
+                                       : viewProjection);
+    fluidPipeline->setUniformMat4f("refractionViewProjection",
+                                   hasRefractionCapture
+                                       ? refractionViewProjection
+                                       : viewProjection);
+
     commandBuffer->bindDrawingState(drawingState);
     commandBuffer->bindPipeline(fluidPipeline);
     commandBuffer->drawIndexed(static_cast<unsigned int>(indices.size()), 1, 0,
@@ -211,7 +228,8 @@ void Fluid::render(float dt, std::shared_ptr<opal::CommandBuffer> commandBuffer,
             (1024.0f * 1024.0f);
         debugPacket.textureCount =
             (reflectionTarget ? 1 : 0) + (refractionTarget ? 1 : 0) +
-            (movementTexture.id != 0 ? 1 : 0) + (normalTexture.id != 0 ? 1 : 0);
+            (movementTexture.id != 0 ? 1 : 0) +
+            (normalTexture.id != 0 ? 1 : 0) + (waveTexture ? 1 : 0);
         debugPacket.materialCount = 0;
         debugPacket.objectType = DebugObjectType::SkeletalMesh;
         debugPacket.objectId = this->id;
@@ -220,7 +238,12 @@ void Fluid::render(float dt, std::shared_ptr<opal::CommandBuffer> commandBuffer,
 }
 
 void Fluid::update(Window &window) {
-    if (captureDirty) {
+    if (waveField.isCreated()) {
+        waveField.step(window.getDeltaTime());
+        updateWaveTexture();
+    }
+
+    if (hasPendingCapture()) {
         captureUpdateTimer = 0.0f;
         return;
     }
@@ -251,7 +274,8 @@ void Fluid::update(Window &window) {
     }
 
     if (cameraMoved) {
-        captureDirty = true;
+        reflectionDirty = true;
+        refractionDirty = true;
         lastCaptureCameraPosition = cameraPosition;
         lastCaptureCameraDirection = cameraDirection;
         hasCaptureCameraState = true;
@@ -264,14 +288,46 @@ void Fluid::updateCapture(
     Window &window, const std::shared_ptr<opal::CommandBuffer> &commandBuffer) {
     ensureTargets(window);
 
-    if (!reflectionTarget || !refractionTarget) {
+    if (!reflectionTarget || !refractionTarget || !hasPendingCapture()) {
         return;
     }
 
-    window.captureFluidReflection(*this, commandBuffer);
-    window.captureFluidRefraction(*this, commandBuffer);
+    if (!amortizeCaptures) {
+        if (reflectionDirty) {
+            window.captureFluidReflection(*this, commandBuffer);
+        }
+        if (refractionDirty) {
+            window.captureFluidRefraction(*this, commandBuffer);
+        }
+        reflectionDirty = false;
+        refractionDirty = false;
+        return;
+    }
 
-    captureDirty = false;
+    // Both window passes and the fluid itself ask for captures, so keep
+    // track of the frame to render a single one.
+    const long frame = window.device->frameCount;
+    if (frame == lastCaptureFrame) {
+        return;
+    }
+    lastCaptureFrame = frame;
+
+    if (reflectionDirty && (!refractionDirty || captureReflectionNext)) {
+        window.captureFluidReflection(*this, commandBuffer);
+        reflectionDirty = false;
+        captureReflectionNext = false;
+    } else {
+        window.captureFluidRefraction(*this, commandBuffer);
+        refractionDirty = false;
+        captureReflectionNext = true;
+    }
+}
+
+void Fluid::markCapturesDirty() {
+    reflectionDirty = true;
+    refractionDirty = true;
+    hasCaptureCameraState = false;
+    captureUpdateTimer = 0.0f;
 }
 
 void Fluid::setViewMatrix(const glm::mat4 &view) { viewMatrix = view; }
@@ -312,14 +368,103 @@ void Fluid::setExtent(const Size2d &ext) {
 
 void Fluid::setWaterColor(const Color &newColor) { color = newColor; }
 
+void Fluid::enableSimulation(int resolution) {
+    const glm::vec3 size = getFinalScale();
+    waveField.create(resolution, {size.x, size.z});
+    buildPlaneGeometry(
+        std::min(waveField.getResolution(), MAX_SURFACE_SUBDIVISIONS));
+    if (isInitialized) {
+        uploadGeometry();
+    }
+    waveTexture = nullptr;
+}
+
+void Fluid::disableSimulation() {
+    waveField.destroy();
+    waveTexture = nullptr;
+    waveTexels.clear();
+    buildPlaneGeometry(1);
+    if (isInitialized) {
+        uploadGeometry();
+    }
+}
+
+void Fluid::updateWaveTexture() {
+    const int size = waveField.getResolution();
+    waveField.fillTexture(waveTexels);
+    if (waveTexture == nullptr) {
+        waveTexture = opal::Texture::create(
+            opal::TextureType::Texture2D, opal::TextureFormat::Rgba16F, size,
+            size, opal::TextureDataFormat::Rgba, waveTexels.data());
+        waveTexture->setParameters(opal::TextureWrapMode::ClampToEdge,
+                                   opal::TextureWrapMode::ClampToEdge,
+                                   opal::TextureFilterMode::Linear,
+                                   opal::TextureFilterMode::Linear);
+        return;
+    }
+    waveTexture->updateData(waveTexels.data(), size, size,
+                            opal::TextureDataFormat::Rgba);
+}
+
+void Fluid::toSurface(const std::vector<Position3d> &points,
+                      std::vector<glm::vec2> &surfacePoints) const {
+    const glm::mat4 worldToLocal = glm::inverse(modelMatrix);
+    const glm::vec3 size = getFinalScale();
+    surfacePoints.resize(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        const glm::vec4 local =
+            worldToLocal * glm::vec4(points[i].toGlm(), 1.0f);
+        surfacePoints[i] = {local.x * size.x, local.z * size.z};
+    }
+}
+
+void Fluid::disturb(const Position3d &point, float radius, float strength) {
+    std::vector<glm::vec2> surfacePoints;
+    toSurface({point}, surfacePoints);
+    waveField.disturb(surfacePoints[0], radius, strength);
+}
+
+void Fluid::sampleHeight(const std::vector<Position3d> &points,
+                         std::vector<float> &heights) const {
+    std::vector<glm::vec2> surfacePoints;
+    toSurface(points, surfacePoints);
+    waveField.sampleHeight(surfacePoints, heights);
+
+    const float restHeight =
+        glm::dot(calculatePlaneNormal(), calculatePlanePoint());
+    for (float &height : heights) {
+        height += restHeight;
+    }
+}
+
+void Fluid::sampleVelocity(const std::vector<Position3d> &points,
+                           std::vector<Velocity3d> &velocities) const {
+    std::vector<glm::vec2> surfacePoints;
+    toSurface(points, surfacePoints);
+    std::vector<glm::vec3> surfaceVelocities;
+    waveField.sampleVelocity(surfacePoints, surfaceVelocities);
+
+    const glm::mat3 axes(modelMatrix);
+    const glm::vec3 tangent = glm::normalize(axes[0]);
+    const glm::vec3 bitangent = glm::normalize(axes[2]);
+    const glm::vec3 normal = calculatePlaneNormal();
+    velocities.resize(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        const glm::vec3 &flow = surfaceVelocities[i];
+        velocities[i] = Velocity3d::fromGlm((tangent * flow.x) +
+                                            (normal * flow.y) +
+                                            (bitangent * flow.z));
+    }
+}
+
 void Fluid::ensureTargets(Window &window) {
     auto refreshTarget = [this,
                           &window](std::shared_ptr<RenderTarget> &target) {
         int fbWidth = 0;
         int fbHeight = 0;
         atlasGetWindowSizeInPixels(window.windowRef, &fbWidth, &fbHeight);
-        float scale = window.getRenderScale();
-        scale = std::clamp(scale, 0.1f, 1.0f);
+        const float scale = std::clamp(
+            window.getRenderScale() * captureRenderScale, 0.1f, 1.0f);
         int desiredWidth =
             std::max(1, static_cast<int>(static_cast<float>(fbWidth) * scale));
         int desiredHeight =
@@ -334,11 +479,14 @@ void Fluid::ensureTargets(Window &window) {
         };
 
         if (needsResize(target)) {
-            target =
-                std::make_unique<RenderTarget>(window, RenderTargetType::Scene);
-            captureDirty = true;
-            hasCaptureCameraState = false;
-            captureUpdateTimer = 0.0f;
+            target = std::make_unique<RenderTarget>(
+                window, RenderTargetType::Scene, 1024, scale);
+            markCapturesDirty();
+            if (&target == &reflectionTarget) {
+                hasReflectionCapture = false;
+            } else {
+                hasRefractionCapture = false;
+            }
 
             auto commandBuffer =
                 Window::mainWindow->device->acquireCommandBuffer();
@@ -374,29 +522,33 @@ glm::vec4 Fluid::calculateClipPlane() const {
     return glm::vec4(normal, d);
 }
 
-void Fluid::buildPlaneGeometry() {
-    vertices = {FluidVertex{{-0.5f, 0.0f, -0.5f},
-                            {0.0f, 0.0f},
-                            {0.0f, 1.0f, 0.0f},
-                            {1.0f, 0.0f, 0.0f},
-                            {0.0f, 0.0f, 1.0f}},
-                FluidVertex{{0.5f, 0.0f, -0.5f},
-                            {1.0f, 0.0f},
-                            {0.0f, 1.0f, 0.0f},
-                            {1.0f, 0.0f, 0.0f},
-                            {0.0f, 0.0f, 1.0f}},
-                FluidVertex{{0.5f, 0.0f, 0.5f},
-                            {1.0f, 1.0f},
-                            {0.0f, 1.0f, 0.0f},
-                            {1.0f, 0.0f, 0.0f},
-                            {0.0f, 0.0f, 1.0f}},
-                FluidVertex{{-0.5f, 0.0f, 0.5f},
-                            {0.0f, 1.0f},
-                            {0.0f, 1.0f, 0.0f},
-                            {1.0f, 0.0f, 0.0f},
-                            {0.0f, 0.0f, 1.0f}}};
-
-    indices = {0, 1, 2, 0, 2, 3};
+void Fluid::buildPlaneGeometry(int subdivisions) {
+    const int cells = std::max(1, subdivisions);
+    const int side = cells + 1;
+    vertices.clear();
+    vertices.reserve(static_cast<size_t>(side) * side);
+    for (int z = 0; z < side; z++) {
+        for (int x = 0; x < side; x++) {
+            const glm::vec2 uv(static_cast<float>(x) / cells,
+                               static_cast<float>(z) / cells);
+            vertices.push_back(FluidVertex{{uv.x - 0.5f, 0.0f, uv.y - 0.5f},
+                                           uv,
+                                           {0.0f, 1.0f, 0.0f},
+                                           {1.0f, 0.0f, 0.0f},
+                                           {0.0f, 0.0f, 1.0f}});
+        }
+    }
+
+    indices.clear();
+    indices.reserve(static_cast<size_t>(cells) * cells * 6);
+    for (int z = 0; z < cells; z++) {
+        for (int x = 0; x < cells; x++) {
+            const auto corner = static_cast<unsigned int>((z * side) + x);
+            const auto next = corner + static_cast<unsigned int>(side);
+            indices.insert(indices.end(), {corner, corner + 1, next + 1,
+                                           corner, next + 1, next});
+        }
+    }
 }
 
 glm::vec3 Fluid::getFinalScale() const {
@@ -422,7 +574,78 @@ void Fluid::updateModelMatrix() {
         glm::translate(glm::mat4(1.0f), position.toGlm());
 
     modelMatrix = translationMatrix * rotationMatrix * scaleMatrix;
-    captureDirty = true;
-    hasCaptureCameraState = false;
-    captureUpdateTimer = 0.0f;
+    const glm::vec3 size = getFinalScale();
+    waveField.setExtent({size.x, size.z});
+    markCapturesDirty();
+}
+
+void Buoyancy::beforePhysics() {
+    if (fluid == nullptr || !fluid->isSimulated() || object == nullptr ||
+        object->rigidbody == nullptr || !object->rigidbody->body) {
+        return;
+    }
+
+    Rigidbody *rigidbody = object->rigidbody;
+    const bezel::Rigidbody &body = *rigidbody->body;
+    if (body.motionType != MotionType::Dynamic) {
+        return;
+    }
+
+    const glm::vec3 origin = body.position.toGlm();
+    const size_t count = samplePoints.empty() ? 1 : samplePoints.size();
+    worldPoints.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const glm::vec3 offset =
+            samplePoints.empty() ? glm::vec3(0.0f) : samplePoints[i].toGlm();
+        worldPoints[i] =
+            Position3d::fromGlm(origin + (body.rotationQuat * offset));
+    }
+    fluid->sampleHeight(worldPoints, heights);
+    fluid->sampleVelocity(worldPoints, waterVelocities);
+
+    const glm::vec3 normal = fluid->getSurfaceNormal();
+    const glm::vec3 linearVelocity = rigidbody->getLinearVelocity().toGlm();
+    const glm::vec3 angularVelocity = rigidbody->getAngularVelocity().toGlm();
+    const float share = volume / static_cast<float>(count);
+    const float depthScale = 1.0f / std::max(sampleDepth, 1e-3f);
+
+    glm::vec3 force(0.0f);
+    glm::vec3 center(0.0f);
+    float totalLift = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        const glm::vec3 point = worldPoints[i].toGlm();
+        const float depth = heights[i] - glm::dot(normal, point);
+        const float submerged = std::clamp(depth * depthScale, 0.0f, 1.0f);
+        if (submerged <= 0.0f) {
+            continue;
+        }
+
+        const float lift = fluidDensity * gravity * share * submerged;
+        const glm::vec3 pointVelocity =
+            linearVelocity + glm::cross(angularVelocity, point - origin);
+        const glm::vec3 relative = waterVelocities[i].toGlm() - pointVelocity;
+        force += (normal * lift) + (relative * (drag * share * submerged));
+        center += point * lift;
+        totalLift += lift;
+    }
+
+    if (totalLift <= 0.0f) {
+        return;
+    }
+    // Lift is parallel at every point, so applying the sum at the lift
+    // weighted center gives the same torque. Drag rides along with it.
+    rigidbody->applyForceAtPoint(Position3d::fromGlm(force),
+                                 Position3d::fromGlm(center / totalLift));
+}
+
+std::shared_ptr<Component> Buoyancy::clone() const {
+    auto cloned = std::make_shared<Buoyancy>();
+    cloned->fluid = fluid;
+    cloned->samplePoints = samplePoints;
+    cloned->volume = volume;
+    cloned->sampleDepth = sampleDepth;
+    cloned->fluidDensity = fluidDensity;
+    cloned->drag = drag;
+    cloned->gravity = gravity;
+    return cloned;
 }
@@ -0,0 +1,397 @@
+//
+// wave_field.cpp
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: Parallel shallow-water heightfield for fluid surfaces
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#include "hydra/wave_field.h"
+#include "atlas/core/job_system.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HYDRA_WAVE_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define HYDRA_WAVE_NEON
+#endif
+
+namespace {
+constexpr int LANE_WIDTH = 4;
+// Rows handed to a worker at once, enough to amortize the scheduling.
+constexpr size_t ROW_GRAIN = 16;
+constexpr size_t SAMPLE_GRAIN = 256;
+// Substeps are capped so a tiny cell size cannot stall the frame. Past the
+// cap the simulation runs slower than real time instead of blowing up.
+constexpr int MAX_SUBSTEPS = 16;
+constexpr float COURANT_LIMIT = 0.9f;
+
+#if defined(HYDRA_WAVE_SSE2)
+using Lanes = __m128;
+
+inline Lanes loadLanes(const float *p) { return _mm_loadu_ps(p); }
+inline void storeLanes(float *p, Lanes v) { _mm_storeu_ps(p, v); }
+inline Lanes splat(float v) { return _mm_set1_ps(v); }
+inline Lanes add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+inline Lanes sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+inline Lanes mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+#elif defined(HYDRA_WAVE_NEON)
+using Lanes = float32x4_t;
+
+inline Lanes loadLanes(const float *p) { return vld1q_f32(p); }
+inline void storeLanes(float *p, Lanes v) { vst1q_f32(p, v); }
+inline Lanes splat(float v) { return vdupq_n_f32(v); }
+inline Lanes add(Lanes a, Lanes b) { return vaddq_f32(a, b); }
+inline Lanes sub(Lanes a, Lanes b) { return vsubq_f32(a, b); }
+inline Lanes mul(Lanes a, Lanes b) { return vmulq_f32(a, b); }
+#else
+struct Lanes {
+    float v[LANE_WIDTH];
+};
+
+template <typename Op> inline Lanes apply(Lanes a, Lanes b, Op op) {
+    return {{op(a.v[0], b.v[0]), op(a.v[1], b.v[1]), op(a.v[2], b.v[2]),
+             op(a.v[3], b.v[3])}};
+}
+
+inline Lanes loadLanes(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void storeLanes(float *p, Lanes v) {
+    std::copy(v.v, v.v + LANE_WIDTH, p);
+}
+inline Lanes splat(float v) { return {{v, v, v, v}}; }
+inline Lanes add(Lanes a, Lanes b) {
+    return apply(a, b, [](float x, float y) { return x + y; });
+}
+inline Lanes sub(Lanes a, Lanes b) {
+    return apply(a, b, [](float x, float y) { return x - y; });
+}
+inline Lanes mul(Lanes a, Lanes b) {
+    return apply(a, b, [](float x, float y) { return x * y; });
+}
+#endif
+} // namespace
+
+void WaveField::create(int resolution, glm::vec2 extent) {
+    this->resolution = std::max(2, resolution);
+    stride = this->resolution + 2;
+    setExtent(extent);
+
+    const size_t cells = static_cast<size_t>(stride) * stride;
+    height.assign(cells, 0.0f);
+    nextHeight.assign(cells, 0.0f);
+    velocity.assign(cells, 0.0f);
+    flowX.assign(cells, 0.0f);
+    flowZ.assign(cells, 0.0f);
+}
+
+void WaveField::setExtent(glm::vec2 extent) {
+    this->extent = glm::max(extent, glm::vec2(1e-3f));
+}
+
+void WaveField::reset() {
+    std::fill(height.begin(), height.end(), 0.0f);
+    std::fill(nextHeight.begin(), nextHeight.end(), 0.0f);
+    std::fill(velocity.begin(), velocity.end(), 0.0f);
+    std::fill(flowX.begin(), flowX.end(), 0.0f);
+    std::fill(flowZ.begin(), flowZ.end(), 0.0f);
+}
+
+void WaveField::destroy() {
+    resolution = 0;
+    stride = 0;
+    height.clear();
+    nextHeight.clear();
+    velocity.clear();
+    flowX.clear();
+    flowZ.clear();
+}
+
+void WaveField::disturb(glm::vec2 center, float radius, float strength) {
+    if (!isCreated() || radius <= 0.0f) {
+        return;
+    }
+
+    const glm::vec2 cellSize = extent / static_cast<float>(resolution);
+    const glm::vec2 first =
+        glm::floor((center - radius) / cellSize + (extent / cellSize) * 0.5f);
+    const glm::vec2 last =
+        glm::ceil((center + radius) / cellSize + (extent / cellSize) * 0.5f);
+    const int firstX = std::max(0, static_cast<int>(first.x));
+    const int firstZ = std::max(0, static_cast<int>(first.y));
+    const int lastX = std::min(resolution - 1, static_cast<int>(last.x));
+    const int lastZ = std::min(resolution - 1, static_cast<int>(last.y));
+
+    float added = 0.0f;
+    for (int z = firstZ; z <= lastZ; z++) {
+        for (int x = firstX; x <= lastX; x++) {
+            const glm::vec2 cell =
+                (glm::vec2(x, z) + 0.5f) * cellSize - (extent * 0.5f);
+            const float distance = glm::length(cell - center) / radius;
+            if (distance >= 1.0f) {
+                continue;
+            }
+            // Cosine falloff keeps the impulse smooth, so it does not ring.
+            const float falloff =
+                0.5f + (0.5f * std::cos(distance * 3.14159265f));
+            velocity[cellIndex(x, z)] += strength * falloff;
+            added += strength * falloff;
+        }
+    }
+
+    // Spread the opposite impulse over the whole surface, so pushing the
+    // water down raises the rest of it instead of draining the volume.
+    const float correction =
+        added / static_cast<float>(resolution * resolution);
+    for (int z = 0; z < resolution; z++) {
+        float *row = &velocity[cellIndex(0, z)];
+        for (int x = 0; x < resolution; x++) {
+            row[x] -= correction;
+        }
+    }
+}
+
+int WaveField::substepCount(float dt, float &substep) const {
+    const glm::vec2 cellSize = extent / static_cast<float>(resolution);
+    const float inverseSpacing =
+        std::sqrt((1.0f / (cellSize.x * cellSize.x)) +
+                  (1.0f / (cellSize.y * cellSize.y)));
+    const float stableStep =
+        COURANT_LIMIT / (std::max(waveSpeed, 1e-4f) * inverseSpacing);
+
+    dt = std::clamp(dt, 0.0f, maxFrameTime);
+    const int count = std::clamp(static_cast<int>(std::ceil(dt / stableStep)),
+                                 1, MAX_SUBSTEPS);
+    substep = std::min(dt / static_cast<float>(count), stableStep);
+    return count;
+}
+
+WaveField::StepConstants WaveField::makeConstants(float substep) const {
+    const glm::vec2 cellSize = extent / static_cast<float>(resolution);
+    const float speedSquared = waveSpeed * waveSpeed;
+    return {.dt = substep,
+            .waveX = speedSquared * substep / (cellSize.x * cellSize.x),
+            .waveZ = speedSquared * substep / (cellSize.y * cellSize.y),
+            .decay = std::max(0.0f, 1.0f - (damping * substep)),
+            .pushX = gravity * substep / (2.0f * cellSize.x),
+            .pushZ = gravity * substep / (2.0f * cellSize.y)};
+}
+
+void WaveField::mirrorEdges() {
+    // Copying the border into the ghost ring makes the slope across every
+    // edge zero, so waves reflect off the sides of the surface.
+    for (int x = 0; x < resolution; x++) {
+        height[cellIndex(x, -1)] = height[cellIndex(x, 0)];
+        height[cellIndex(x, resolution)] = height[cellIndex(x, resolution - 1)];
+    }
+    for (int z = -1; z <= resolution; z++) {
+        const size_t row = static_cast<size_t>(z + 1) * stride;
+        height[row] = height[row + 1];
+        height[row + stride - 1] = height[row + stride - 2];
+    }
+}
+
+void WaveField::swapHeights() {
+    height.swap(nextHeight);
+    mirrorEdges();
+}
+
+void WaveField::stepCells(const StepConstants &constants, int row,
+                          int firstColumn) {
+    const size_t rowStart = cellIndex(0, row);
+    const auto up = static_cast<size_t>(stride);
+    for (int x = firstColumn; x < resolution; x++) {
+        const size_t i = rowStart + x;
+        const float h = height[i];
+        const float lapX = (height[i - 1] + height[i + 1]) - (h + h);
+        const float lapZ = (height[i - up] + height[i + up]) - (h + h);
+        const float v = ((velocity[i] + (constants.waveX * lapX)) +
+                         (constants.waveZ * lapZ)) *
+                        constants.decay;
+        velocity[i] = v;
+        nextHeight[i] = h + (v * constants.dt);
+
+        const float slopeX = height[i + 1] - height[i - 1];
+        const float slopeZ = height[i + up] - height[i - up];
+        flowX[i] = (flowX[i] - (constants.pushX * slopeX)) * constants.decay;
+        flowZ[i] = (flowZ[i] - (constants.pushZ * slopeZ)) * constants.decay;
+    }
+}
+
+void WaveField::stepRows(const StepConstants &constants, int firstRow,
+                         int lastRow) {
+    const Lanes waveX = splat(constants.waveX);
+    const Lanes waveZ = splat(constants.waveZ);
+    const Lanes decay = splat(constants.decay);
+    const Lanes pushX = splat(constants.pushX);
+    const Lanes pushZ = splat(constants.pushZ);
+    const Lanes dt = splat(constants.dt);
+    const auto up = static_cast<size_t>(stride);
+    const int laneEnd = resolution - (resolution % LANE_WIDTH);
+
+    for (int z = firstRow; z < lastRow; z++) {
+        const size_t rowStart = cellIndex(0, z);
+        for (int x = 0; x < laneEnd; x += LANE_WIDTH) {
+            const size_t i = rowStart + x;
+            const Lanes h = loadLanes(&height[i]);
+            const Lanes left = loadLanes(&height[i - 1]);
+            const Lanes right = loadLanes(&height[i + 1]);
+            const Lanes back = loadLanes(&height[i - up]);
+            const Lanes front = loadLanes(&height[i + up]);
+
+            const Lanes twice = add(h, h);
+            const Lanes lapX = sub(add(left, right), twice);
+            const Lanes lapZ = sub(add(back, front), twice);
+            const Lanes v = mul(add(add(loadLanes(&velocity[i]),
+                                        mul(waveX, lapX)),
+                                    mul(waveZ, lapZ)),
+                                decay);
+            storeLanes(&velocity[i], v);
+            storeLanes(&nextHeight[i], add(h, mul(v, dt)));
+
+            const Lanes slopeX = sub(right, left);
+            const Lanes slopeZ = sub(front, back);
+            storeLanes(&flowX[i],
+                       mul(sub(loadLanes(&flowX[i]), mul(pushX, slopeX)),
+                           decay));
+            storeLanes(&flowZ[i],
+                       mul(sub(loadLanes(&flowZ[i]), mul(pushZ, slopeZ)),
+                           decay));
+        }
+        stepCells(constants, z, laneEnd);
+    }
+}
+
+void WaveField::step(float dt) {
+    if (!isCreated()) {
+        return;
+    }
+
+    float substep = 0.0f;
+    const int count = substepCount(dt, substep);
+    if (substep <= 0.0f) {
+        return;
+    }
+    const StepConstants constants = makeConstants(substep);
+    mirrorEdges();
+    for (int i = 0; i < count; i++) {
+        JobSystem::getInstance().parallelFor(
+            static_cast<size_t>(resolution), ROW_GRAIN,
+            [&](size_t begin, size_t end) {
+                stepRows(constants, static_cast<int>(begin),
+                         static_cast<int>(end));
+            });
+        swapHeights();
+    }
+}
+
+void WaveField::stepReference(float dt) {
+    if (!isCreated()) {
+        return;
+    }
+
+    float substep = 0.0f;
+    const int count = substepCount(dt, substep);
+    if (substep <= 0.0f) {
+        return;
+    }
+    const StepConstants constants = makeConstants(substep);
+    mirrorEdges();
+    for (int i = 0; i < count; i++) {
+        for (int z = 0; z < resolution; z++) {
+            stepCells(constants, z, 0);
+        }
+        swapHeights();
+    }
+}
+
+float WaveField::sampleGrid(const std::vector<float> &grid,
+                            glm::vec2 point) const {
+    const auto cells = static_cast<float>(resolution);
+    const glm::vec2 cell = glm::clamp(
+        ((point / extent) + 0.5f) * cells - 0.5f, glm::vec2(0.0f),
+        glm::vec2(cells - 1.0f));
+    const int x = std::min(static_cast<int>(cell.x), resolution - 2);
+    const int z = std::min(static_cast<int>(cell.y), resolution - 2);
+    const glm::vec2 t = cell - glm::vec2(x, z);
+
+    const size_t i = cellIndex(x, z);
+    const auto up = static_cast<size_t>(stride);
+    const float back = glm::mix(grid[i], grid[i + 1], t.x);
+    const float front = glm::mix(grid[i + up], grid[i + up + 1], t.x);
+    return glm::mix(back, front, t.y);
+}
+
+void WaveField::sampleHeight(const std::vector<glm::vec2> &points,
+                             std::vector<float> &heights) const {
+    heights.resize(points.size());
+    if (!isCreated()) {
+        std::fill(heights.begin(), heights.end(), 0.0f);
+        return;
+    }
+    JobSystem::getInstance().parallelFor(
+        points.size(), SAMPLE_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                heights[i] = sampleGrid(height, points[i]);
+            }
+        });
+}
+
+void WaveField::sampleVelocity(const std::vector<glm::vec2> &points,
+                               std::vector<glm::vec3> &velocities) const {
+    velocities.resize(points.size());
+    if (!isCreated()) {
+        std::fill(velocities.begin(), velocities.end(), glm::vec3(0.0f));
+        return;
+    }
+    JobSystem::getInstance().parallelFor(
+        points.size(), SAMPLE_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                velocities[i] = {sampleGrid(flowX, points[i]),
+                                 sampleGrid(velocity, points[i]),
+                                 sampleGrid(flowZ, points[i])};
+            }
+        });
+}
+
+void WaveField::fillTexture(std::vector<float> &texels) const {
+    const auto cells = static_cast<size_t>(resolution);
+    texels.resize(cells * cells * 4);
+    if (!isCreated()) {
+        return;
+    }
+
+    const glm::vec2 cellSize = extent / static_cast<float>(resolution);
+    const float slopeScaleX = 0.5f / cellSize.x;
+    const float slopeScaleZ = 0.5f / cellSize.y;
+    const auto up = static_cast<size_t>(stride);
+    JobSystem::getInstance().parallelFor(
+        cells, ROW_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t z = begin; z < end; z++) {
+                float *texel = &texels[z * cells * 4];
+                for (int x = 0; x < resolution; x++) {
+                    const size_t i = cellIndex(x, static_cast<int>(z));
+                    texel[0] = height[i];
+                    texel[1] = (height[i + 1] - height[i - 1]) * slopeScaleX;
+                    texel[2] = (height[i + up] - height[i - up]) * slopeScaleZ;
+                    texel[3] = velocity[i];
+                    texel += 4;
+                }
+            }
+        });
+}
+
+std::vector<float> WaveField::getHeights() const {
+    std::vector<float> result;
+    result.reserve(static_cast<size_t>(resolution) * resolution);
+    for (int z = 0; z < resolution; z++) {
+        const auto row =
+            height.begin() + static_cast<std::ptrdiff_t>(cellIndex(0, z));
+        result.insert(result.end(), row, row + resolution);
+    }
+    return result;
+}
@@ -11,15 +11,76 @@
 
 #include <opal/opal.h>
 
+#include "atlas/core/job_system.h"
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <limits>
-#include <thread>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HYDRA_WORLEY_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define HYDRA_WORLEY_NEON
+#endif
+
 namespace {
 constexpr float SQRT3 = 1.7320508075688772f;
+constexpr int LANE_WIDTH = 4;
+// Coordinate of the padding feature points, far outside any 3x3x3 block.
+constexpr float UNREACHABLE = 1.0e6f;
+constexpr size_t CHANNEL_COUNT = 4;
+
+#if defined(HYDRA_WORLEY_SSE2)
+using Lanes = __m128;
+
+inline Lanes loadLanes(const float *p) { return _mm_loadu_ps(p); }
+inline void storeLanes(float *p, Lanes v) { _mm_storeu_ps(p, v); }
+inline Lanes splat(float v) { return _mm_set1_ps(v); }
+inline Lanes add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+inline Lanes mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+inline Lanes minimum(Lanes a, Lanes b) { return _mm_min_ps(a, b); }
+inline Lanes maximum(Lanes a, Lanes b) { return _mm_max_ps(a, b); }
+#elif defined(HYDRA_WORLEY_NEON)
+using Lanes = float32x4_t;
+
+inline Lanes loadLanes(const float *p) { return vld1q_f32(p); }
+inline void storeLanes(float *p, Lanes v) { vst1q_f32(p, v); }
+inline Lanes splat(float v) { return vdupq_n_f32(v); }
+inline Lanes add(Lanes a, Lanes b) { return vaddq_f32(a, b); }
+inline Lanes mul(Lanes a, Lanes b) { return vmulq_f32(a, b); }
+inline Lanes minimum(Lanes a, Lanes b) { return vminq_f32(a, b); }
+inline Lanes maximum(Lanes a, Lanes b) { return vmaxq_f32(a, b); }
+#else
+struct Lanes {
+    float v[LANE_WIDTH];
+};
+
+template <typename Op> inline Lanes apply(Lanes a, Lanes b, Op op) {
+    return {{op(a.v[0], b.v[0]), op(a.v[1], b.v[1]), op(a.v[2], b.v[2]),
+             op(a.v[3], b.v[3])}};
+}
+
+inline Lanes loadLanes(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void storeLanes(float *p, Lanes v) {
+    std::copy(v.v, v.v + LANE_WIDTH, p);
+}
+inline Lanes splat(float v) { return {{v, v, v, v}}; }
+inline Lanes add(Lanes a, Lanes b) {
+    return apply(a, b, [](float x, float y) { return x + y; });
+}
+inline Lanes mul(Lanes a, Lanes b) {
+    return apply(a, b, [](float x, float y) { return x * y; });
+}
+inline Lanes minimum(Lanes a, Lanes b) {
+    return apply(a, b, [](float x, float y) { return std::min(x, y); });
+}
+inline Lanes maximum(Lanes a, Lanes b) {
+    return apply(a, b, [](float x, float y) { return std::max(x, y); });
+}
+#endif
 
 inline uint32_t hash3d(int x, int y, int z, uint32_t seed) {
     uint32_t h = seed;
@@ -48,41 +109,39 @@ inline float wrapFloat(float value) {
     return wrapped;
 }
 
-template <typename Func> void parallelForRange(int begin, int end, Func func) {
-    const int total = end - begin;
-    if (total <= 0) {
-        return;
-    }
-
-    unsigned int hardwareThreads = std::thread::hardware_concurrency();
-    if (hardwareThreads == 0) {
-        hardwareThreads = 4;
-    }
-
-    unsigned int threadCount = std::max(
-        1u, std::min(hardwareThreads, static_cast<unsigned int>(total)));
-    const int chunkSize = (total + static_cast<int>(threadCount) - 1) /
-                          static_cast<int>(threadCount);
-
-    std::vector<std::thread> workers;
-    workers.reserve(threadCount > 0 ? threadCount - 1 : 0);
-
-    int next = begin;
-    for (unsigned int i = 0; i + 1 < threadCount && next < end; ++i) {
-        int blockStart = next;
-        int blockEnd = std::min(end, blockStart + chunkSize);
-        workers.emplace_back(
-            [blockStart, blockEnd, &func]() { func(blockStart, blockEnd); });
-        next = blockEnd;
-    }
+inline int wrapCell(int value, int divisions) {
+    int wrapped = value % divisions;
+    return wrapped < 0 ? wrapped + divisions : wrapped;
+}
 
-    if (next < end) {
-        func(next, end);
-    }
+// Fills an RGBA volume on the job system, one z slice per task. `texel`
+// receives the voxel center in [0, 1) and writes four channels.
+template <typename Func>
+std::vector<float> fillVolume(int resolution, const Func &texel) {
+    std::vector<float> data(static_cast<size_t>(resolution) * resolution *
+                                resolution * CHANNEL_COUNT,
+                            0.0f);
+    const float invResolution = 1.0f / static_cast<float>(resolution);
 
-    for (auto &worker : workers) {
-        worker.join();
-    }
+    JobSystem::getInstance().parallelFor(
+        static_cast<size_t>(resolution), 1, [&](size_t begin, size_t end) {
+            for (size_t z = begin; z < end; ++z) {
+                const float fz = (static_cast<float>(z) + 0.5f) * invResolution;
+                float *out = data.data() + (z * resolution * resolution *
+                                            CHANNEL_COUNT);
+                for (int y = 0; y < resolution; ++y) {
+                    const float fy =
+                        (static_cast<float>(y) + 0.5f) * invResolution;
+                    for (int x = 0; x < resolution; ++x) {
+                        const float fx =
+                            (static_cast<float>(x) + 0.5f) * invResolution;
+                        texel(fx, fy, fz, out);
+                        out += CHANNEL_COUNT;
+                    }
+                }
+            }
+        });
+    return data;
 }
 } // namespace
 
@@ -117,126 +176,58 @@ float WorleyNoise3D::getValue(float x, float y, float z) const {
 }
 
 Id WorleyNoise3D::get3dTexture(int res) const {
-    int resolution = std::max(1, res);
-    constexpr size_t channelCount = 4;
-    std::vector<float> data(static_cast<size_t>(resolution) * resolution *
-                                resolution * channelCount,
-                            0.0f);
-
-    const float invResolution = 1.0f / static_cast<float>(resolution);
-
-    parallelForRange(0, resolution, [&](int zStart, int zEnd) {
-        for (int z = zStart; z < zEnd; ++z) {
-            size_t sliceIndex =
-                static_cast<size_t>(z) * resolution * resolution * channelCount;
-            for (int y = 0; y < resolution; ++y) {
-                size_t rowIndex = sliceIndex + (static_cast<size_t>(y) *
-                                                resolution * channelCount);
-                for (int x = 0; x < resolution; ++x) {
-                    float fx = (static_cast<float>(x) + 0.5f) * invResolution;
-                    float fy = (static_cast<float>(y) + 0.5f) * invResolution;
-                    float fz = (static_cast<float>(z) + 0.5f) * invResolution;
-
-                    float low = getWorleyNoise(fx, fy, fz, 0);
-                    float mid = getWorleyNoise(fx, fy, fz, 1);
-                    float high = getWorleyNoise(fx, fy, fz, 2);
-                    float combined = getValue(fx, fy, fz);
-
-                    size_t index =
-                        rowIndex + (static_cast<size_t>(x) * channelCount);
-                    data[index + 0] = low;
-                    data[index + 1] = mid;
-                    data[index + 2] = high;
-                    data[index + 3] = combined;
+    const int resolution = std::max(1, res);
+    // Every octave is evaluated once and feeds both the three layers and
+    // the combined value, which averages the same octaves as getValue.
+    const int octaveCount = std::max(frequency, 3);
+    std::vector<float> data = fillVolume(
+        resolution, [&](float fx, float fy, float fz, float *out) {
+            float amplitude = 1.0f;
+            float sum = 0.0f;
+            float normalization = 0.0f;
+            for (int octave = 0; octave < octaveCount; ++octave) {
+                const float value = getWorleyNoise(fx, fy, fz, octave);
+                if (octave < 3) {
+                    out[octave] = value;
+                }
+                if (octave < frequency) {
+                    sum += value * amplitude;
+                    normalization += amplitude;
+                    amplitude *= 0.5f;
                 }
             }
-        }
-    });
+            out[3] = normalization > 0.0f
+                         ? std::clamp(sum / normalization, 0.0f, 1.0f)
+                         : 0.0f;
+        });
 
     return createTexture3d(data, resolution);
 }
 
-Id WorleyNoise3D::getDetailTexture(int res) const {
-    int resolution = std::max(1, res);
-    constexpr size_t channelCount = 4;
-    std::vector<float> data(static_cast<size_t>(resolution) * resolution *
-                                resolution * channelCount,
-                            0.0f);
-
-    const float invResolution = 1.0f / static_cast<float>(resolution);
-
-    parallelForRange(0, resolution, [&](int zStart, int zEnd) {
-        for (int z = zStart; z < zEnd; ++z) {
-            size_t sliceIndex =
-                static_cast<size_t>(z) * resolution * resolution * channelCount;
-            for (int y = 0; y < resolution; ++y) {
-                size_t rowIndex = sliceIndex + (static_cast<size_t>(y) *
-                                                resolution * channelCount);
-                for (int x = 0; x < resolution; ++x) {
-                    float fx = (static_cast<float>(x) + 0.5f) * invResolution;
-                    float fy = (static_cast<float>(y) + 0.5f) * invResolution;
-                    float fz = (static_cast<float>(z) + 0.5f) * invResolution;
-
-                    auto distances = getClosestDistances(
-                        fx * numberOfDivisions, fy * numberOfDivisions,
-                        fz * numberOfDivisions, 3);
-
-                    float f1 = distances.size() > 0 ? distances[0] : 0.0f;
-                    float f2 = distances.size() > 1 ? distances[1] : f1;
-                    float f3 = distances.size() > 2 ? distances[2] : f2;
-
-                    float difference =
-                        std::clamp((f2 - f1) / SQRT3, 0.0f, 1.0f);
-                    float ridge = 1.0f - (f1 / SQRT3);
-                    float turbulence =
-                        std::clamp((f3 - f1) / SQRT3, 0.0f, 1.0f);
-
-                    size_t index =
-                        rowIndex + (static_cast<size_t>(x) * channelCount);
-                    data[index + 0] = difference;
-                    data[index + 1] = ridge;
-                    data[index + 2] = turbulence;
-                    data[index + 3] = 1.0f;
-                }
-            }
-        }
-    });
+std::vector<float> WorleyNoise3D::getDetailData(int res) const {
+    const auto div = static_cast<float>(numberOfDivisions);
+    return fillVolume(
+        std::max(1, res), [&](float fx, float fy, float fz, float *out) {
+            const Distances d =
+                getClosestDistances(fx * div, fy * div, fz * div);
+
+            out[0] = std::clamp((d.f2 - d.f1) / SQRT3, 0.0f, 1.0f);
+            out[1] = 1.0f - (d.f1 / SQRT3);
+            out[2] = std::clamp((d.f3 - d.f1) / SQRT3, 0.0f, 1.0f);
+            out[3] = 1.0f;
+        });
+}
 
-    return createTexture3d(data, resolution);
+Id WorleyNoise3D::getDetailTexture(int res) const {
+    return createTexture3d(getDetailData(res), std::max(1, res));
 }
 
 Id WorleyNoise3D::get3dTextureAtAllChannels(int res) const {
-    int resolution = std::max(1, res);
-    constexpr size_t channelCount = 4;
-    std::vector<float> data(static_cast<size_t>(resolution) * resolution *
-                                resolution * channelCount,
-                            0.0f);
-
-    const float invResolution = 1.0f / static_cast<float>(resolution);
-
-    parallelForRange(0, resolution, [&](int zStart, int zEnd) {
-        for (int z = zStart; z < zEnd; ++z) {
-            size_t sliceIndex =
-                static_cast<size_t>(z) * resolution * resolution * channelCount;
-            for (int y = 0; y < resolution; ++y) {
-                size_t rowIndex = sliceIndex + (static_cast<size_t>(y) *
-                                                resolution * channelCount);
-                for (int x = 0; x < resolution; ++x) {
-                    float fx = (static_cast<float>(x) + 0.5f) * invResolution;
-                    float fy = (static_cast<float>(y) + 0.5f) * invResolution;
-                    float fz = (static_cast<float>(z) + 0.5f) * invResolution;
-                    float value = getValue(fx, fy, fz);
-
-                    size_t index =
-                        rowIndex + (static_cast<size_t>(x) * channelCount);
-                    data[index + 0] = value;
-                    data[index + 1] = value;
-                    data[index + 2] = value;
-                    data[index + 3] = value;
-                }
-            }
-        }
-    });
+    const int resolution = std::max(1, res);
+    std::vector<float> data = fillVolume(
+        resolution, [&](float fx, float fy, float fz, float *out) {
+            std::fill(out, out + CHANNEL_COUNT, getValue(fx, fy, fz));
+        });
 
     return createTexture3d(data, resolution);
 }
@@ -244,18 +235,19 @@ Id WorleyNoise3D::get3dTextureAtAllChannels(int res) const {
 void WorleyNoise3D::generateFeaturePoints() {
     size_t cells = static_cast<size_t>(numberOfDivisions) * numberOfDivisions *
                    numberOfDivisions;
-    featurePoints.resize(cells * static_cast<size_t>(frequency));
+    featureStride = (frequency + LANE_WIDTH - 1) / LANE_WIDTH * LANE_WIDTH;
+    const size_t pointCount = cells * static_cast<size_t>(featureStride);
+    featureX.assign(pointCount, UNREACHABLE);
+    featureY.assign(pointCount, UNREACHABLE);
+    featureZ.assign(pointCount, UNREACHABLE);
 
     for (int z = 0; z < numberOfDivisions; ++z) {
         for (int y = 0; y < numberOfDivisions; ++y) {
             for (int x = 0; x < numberOfDivisions; ++x) {
                 uint32_t baseHash = hash3d(x, y, z, 0x1F123BB5u);
-                size_t cellIndex =
-                    (static_cast<size_t>(z) * numberOfDivisions *
-                     numberOfDivisions) +
-                    (static_cast<size_t>(y) * numberOfDivisions) +
-                    static_cast<size_t>(x);
-                size_t featureBase = cellIndex * static_cast<size_t>(frequency);
+                size_t featureBase =
+                    static_cast<size_t>(getCellIndex(x, y, z)) *
+                    static_cast<size_t>(featureStride);
 
                 for (int i = 0; i < frequency; ++i) {
                     uint32_t state =
@@ -264,10 +256,10 @@ void WorleyNoise3D::generateFeaturePoints() {
                     float ry = randomFloat(state);
                     float rz = randomFloat(state);
 
-                    featurePoints[featureBase + static_cast<size_t>(i)] =
-                        glm::vec3(static_cast<float>(x) + rx,
-                                  static_cast<float>(y) + ry,
-                                  static_cast<float>(z) + rz);
+                    const size_t index = featureBase + static_cast<size_t>(i);
+                    featureX[index] = static_cast<float>(x) + rx;
+                    featureY[index] = static_cast<float>(y) + ry;
+                    featureZ[index] = static_cast<float>(z) + rz;
                 }
             }
         }
@@ -285,79 +277,93 @@ float WorleyNoise3D::getWorleyNoise(float x, float y, float z,
     float div = static_cast<float>(numberOfDivisions);
 
     glm::vec3 scaled = glm::vec3(x, y, z) * scale * div;
-    auto distances = getClosestDistances(scaled.x, scaled.y, scaled.z, 1);
-
-    if (distances.empty()) {
-        return 0.0f;
-    }
+    const Distances distances =
+        getClosestDistances(scaled.x, scaled.y, scaled.z);
 
-    float normalized = 1.0f - std::clamp(distances[0] / SQRT3, 0.0f, 1.0f);
-    return normalized;
+    return 1.0f - std::clamp(distances.f1 / SQRT3, 0.0f, 1.0f);
 }
 
-std::vector<float> WorleyNoise3D::getClosestDistances(float x, float y, float z,
-                                                      int count) const {
-    if (featurePoints.empty() || count <= 0) {
-        return {};
-    }
-
-    const int sampleCount = std::min(count, frequency * 27);
-    std::vector<float> distances(static_cast<size_t>(sampleCount),
-                                 std::numeric_limits<float>::max());
+WorleyNoise3D::Distances WorleyNoise3D::getClosestDistances(float x, float y,
+                                                            float z) const {
+    constexpr float farthest = std::numeric_limits<float>::max();
+    // Each lane keeps the three smallest squared distances it has seen, so
+    // the overall three smallest are among the twelve kept values.
+    Lanes best1 = splat(farthest);
+    Lanes best2 = splat(farthest);
+    Lanes best3 = splat(farthest);
 
-    glm::vec3 p(x, y, z);
-    glm::ivec3 baseCell(static_cast<int>(std::floor(p.x)),
-                        static_cast<int>(std::floor(p.y)),
-                        static_cast<int>(std::floor(p.z)));
-
-    auto wrapIndex = [this](int value) {
-        int wrapped = value % numberOfDivisions;
-        return wrapped < 0 ? wrapped + numberOfDivisions : wrapped;
-    };
+    const int baseX = static_cast<int>(std::floor(x));
+    const int baseY = static_cast<int>(std::floor(y));
+    const int baseZ = static_cast<int>(std::floor(z));
 
     for (int dz = -1; dz <= 1; ++dz) {
-        int cellZ = baseCell.z + dz;
-        int wrappedZ = wrapIndex(cellZ);
-        int offsetZ = cellZ - wrappedZ;
+        const int cellZ = baseZ + dz;
+        const int wrappedZ = wrapCell(cellZ, numberOfDivisions);
+        const Lanes relativeZ =
+            splat(static_cast<float>(cellZ - wrappedZ) - z);
 
         for (int dy = -1; dy <= 1; ++dy) {
-            int cellY = baseCell.y + dy;
-            int wrappedY = wrapIndex(cellY);
-            int offsetY = cellY - wrappedY;
+            const int cellY = baseY + dy;
+            const int wrappedY = wrapCell(cellY, numberOfDivisions);
+            const Lanes relativeY =
+                splat(static_cast<float>(cellY - wrappedY) - y);
 
             for (int dx = -1; dx <= 1; ++dx) {
-                int cellX = baseCell.x + dx;
-                int wrappedX = wrapIndex(cellX);
-                int offsetX = cellX - wrappedX;
-
-                int baseIndex = getCellIndex(wrappedX, wrappedY, wrappedZ);
-                size_t featureStart = static_cast<size_t>(baseIndex) *
-                                      static_cast<size_t>(frequency);
-
-                for (int i = 0; i < frequency; ++i) {
-                    const glm::vec3 &feature =
-                        featurePoints[featureStart + static_cast<size_t>(i)];
-                    glm::vec3 featurePos =
-                        feature + glm::vec3(static_cast<float>(offsetX),
-                                            static_cast<float>(offsetY),
-                                            static_cast<float>(offsetZ));
-                    glm::vec3 diff = featurePos - p;
-                    float distSq = glm::dot(diff, diff);
-
-                    auto worstIt =
-                        std::max_element(distances.begin(), distances.end());
-                    *worstIt = std::min(distSq, *worstIt);
+                const int cellX = baseX + dx;
+                const int wrappedX = wrapCell(cellX, numberOfDivisions);
+                const Lanes relativeX =
+                    splat(static_cast<float>(cellX - wrappedX) - x);
+
+                const size_t start =
+                    static_cast<size_t>(
+                        getCellIndex(wrappedX, wrappedY, wrappedZ)) *
+                    static_cast<size_t>(featureStride);
+                for (int i = 0; i < featureStride; i += LANE_WIDTH) {
+                    const size_t index = start + static_cast<size_t>(i);
+                    const Lanes diffX =
+                        add(loadLanes(featureX.data() + index), relativeX);
+                    const Lanes diffY =
+                        add(loadLanes(featureY.data() + index), relativeY);
+                    const Lanes diffZ =
+                        add(loadLanes(featureZ.data() + index), relativeZ);
+                    const Lanes distSq =
+                        add(add(mul(diffX, diffX), mul(diffY, diffY)),
+                            mul(diffZ, diffZ));
+
+                    const Lanes carry1 = maximum(best1, distSq);
+                    best1 = minimum(best1, distSq);
+                    const Lanes carry2 = maximum(best2, carry1);
+                    best2 = minimum(best2, carry1);
+                    best3 = minimum(best3, carry2);
                 }
             }
         }
     }
 
-    for (float &d : distances) {
-        d = std::sqrt(std::max(d, 0.0f));
+    float kept[3 * LANE_WIDTH];
+    storeLanes(kept, best1);
+    storeLanes(kept + LANE_WIDTH, best2);
+    storeLanes(kept + (2 * LANE_WIDTH), best3);
+
+    float f1 = farthest;
+    float f2 = farthest;
+    float f3 = farthest;
+    for (float value : kept) {
+        if (value < f1) {
+            f3 = f2;
+            f2 = f1;
+            f1 = value;
+        } else if (value < f2) {
+            f3 = f2;
+            f2 = value;
+        } else if (value < f3) {
+            f3 = value;
+        }
     }
 
-    std::sort(distances.begin(), distances.end());
-    return distances;
+    return {.f1 = std::sqrt(std::max(f1, 0.0f)),
+            .f2 = std::sqrt(std::max(f2, 0.0f)),
+            .f3 = std::sqrt(std::max(f3, 0.0f))};
 }
 
 glm::ivec3 WorleyNoise3D::getGridCell(float x, float y, float z) const {
@@ -11,11 +11,50 @@
 #define CAMERA_H
 
 #include "atlas/units.h"
+#include <array>
 #include <glm/glm.hpp>
 #include <string>
 
 class Window;
 
+/**
+ * @brief View volume described by six inward-facing planes. Used to discard
+ * objects whose bounds lie completely outside of what a camera or a light
+ * can see.
+ *
+ * \subsection frustum-example Example
+ * ```cpp
+ * Frustum frustum = Frustum::fromMatrix(projection * view);
+ * if (!frustum.intersects(object.getWorldBounds().value())) {
+ *     // The object is not visible
+ * }
+ * ```
+ */
+struct Frustum {
+    /**
+     * @brief Plane equations stored as (normal, distance), in the order left,
+     * right, bottom, top, near, far.
+     */
+    std::array<glm::vec4, 6> planes{};
+
+    /**
+     * @brief Extracts the frustum planes from a combined view-projection
+     * matrix.
+     *
+     * @param viewProjection The projection matrix multiplied by the view
+     * matrix.
+     * @return (Frustum) The frustum in world space.
+     */
+    static Frustum fromMatrix(const glm::mat4 &viewProjection);
+
+    /**
+     * @brief Checks whether an axis-aligned box is at least partially inside
+     * the frustum. The test is conservative: a box near a corner may be
+     * reported as visible even when it is not.
+     */
+    bool intersects(const BoundingBox &box) const;
+};
+
 /**
  * @brief Class representing a camera in 3D space, capable of generating view
  * and projection matrices. It also has built-in controls for moving and looking
@@ -184,6 +223,14 @@ class Camera {
      */
     glm::mat4 calculateViewMatrix() const;
 
+    /**
+     * @brief Calculates the view frustum of the camera for a given projection.
+     *
+     * @param projection The projection matrix used to render with the camera.
+     * @return (Frustum) The world-space view frustum.
+     */
+    Frustum calculateFrustum(const glm::mat4 &projection) const;
+
     /**
      * @brief Get the front vector of the camera, representing the direction it
      * is facing.
@@ -6313,6 +6313,121 @@ fragment main0_out main0(main0_in in [[stage_in]], constant Params& _9 [[buffer(
 };
 static const AtlasPackedShaderSource PARTICLE_FRAG = {PARTICLE_FRAG_PARTS, 1};
 
+static const char* const PARTICLE_SIMULATE_PARTS[] = {
+R"(#include <metal_stdlib>
+using namespace metal;
+
+// Mirrors ParticleSlot in atlas/particle_simulation.h.
+struct ParticleSlot {
+    packed_float3 position;
+    float life;
+    packed_float3 velocity;
+    float maxLife;
+    float4 color;
+    float size;
+    float _pad0;
+    float _pad1;
+    float _pad2;
+};
+
+// Mirrors ParticleInstanceData in atlas/particle_simulation.h.
+struct ParticleInstance {
+    packed_float3 position;
+    packed_float4 color;
+    float size;
+};
+
+// Mirrors ParticleComputeParams in atlas/particle_simulation.h.
+struct ParticleComputeParams {
+    float deltaTime;
+    float time;
+    float gravity;
+    uint ambient;
+
+    packed_float3 wind;
+    float _pad0;
+
+    packed_float3 origin;
+    float _pad1;
+
+    uint capacity;
+    uint spawnCursor;
+    uint spawnCount;
+    uint _pad2;
+};
+
+// Same operations, in the same order, as fastSin in particle_simulation.cpp.
+static inline float fastSin(float x) {
+    const float pi = 3.14159265358979f;
+    x = x - (2.0f * pi) * rint(x * (0.5f / pi));
+    float y = (4.0f / pi) * x + ((-4.0f / (pi * pi)) * x) * abs(x);
+    return 0.225f * (y * abs(y) - y) + y;
+}
+
+kernel void main0(device ParticleSlot *slots [[buffer(0)]],
+                  const device ParticleSlot *spawned [[buffer(1)]],
+                  device ParticleInstance *instances [[buffer(2)]],
+                  device atomic_uint *drawArguments [[buffer(3)]],
+                  constant ParticleComputeParams &params [[buffer(4)]],
+                  uint id [[thread_position_in_grid]]) {
+    if (id >= params.capacity) {
+        return;
+    }
+
+    ParticleSlot p = slots[id];
+    uint ring = (id + params.capacity - params.spawnCursor) % params.capacity;
+    if (ring < params.spawnCount) {
+        p = spawned[ring];
+    }
+    if (p.life <= 0.0f) {
+        slots[id] = p;
+        return;
+    }
+
+    const float pi = 3.14159265358979f;
+    const float dt = params.deltaTime;
+    float3 position = float3(p.position);
+    float3 velocity = float3(p.velocity);
+
+    p.life = p.life - dt;
+    velocity.y = velocity.y + params.gravity * dt;
+    if (params.ambient != 0u) {
+        velocity.x = velocity.x +
+                     fastSin(params.time + position.x * 0.1f) * (0.02f * dt);
+        velocity.z = velocity.z +
+                     fastSin((params.time * 0.8f + pi * 0.5f) +
+                             position.z * 0.1f) *
+                         (0.02f * dt);
+    }
+    velocity = velocity + float3(params.wind) * dt;
+    position = position + velocity * dt;
+    p.position = position;
+    p.velocity = velocity;
+    p.color.a = p.life / p.maxLife;
+
+    if (params.ambient != 0u &&
+        (position.y < params.origin.y - 15.0f ||
+         abs(position.x - params.origin.x) > 25.0f ||
+         abs(position.z - params.origin.z) > 25.0f)) {
+        p.life = 0.0f;
+    }
+    slots[id] = p;
+    if (p.life <= 0.0f) {
+        return;
+    }
+
+    // drawArguments holds MTLDrawIndexedPrimitivesIndirectArguments, the
+    // second word is the instance count.
+    uint index = atomic_fetch_add_explicit(&drawArguments[1], 1u,
+                                           memory_order_relaxed);
+    instances[index].position = position;
+    instances[index].color = p.color;
+    instances[index].size = p.size;
+}
+)",
+};
+static const AtlasPackedShaderSource PARTICLE_SIMULATE = {PARTICLE_SIMULATE_PARTS, 1};
+
 static const char* const PARTICLE_VERT_PARTS[] = {
 R"(#include <metal_stdlib>
 #include <simd/simd.h>
@@ -0,0 +1,97 @@
+//
+// job_system.h
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: Shared worker pool for data-parallel engine work
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#ifndef ATLAS_JOB_SYSTEM_H
+#define ATLAS_JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file atlas/core/job_system.h
+ * @brief Engine-wide pool of worker threads.
+ *
+ * Systems that split their work into independent ranges hand them to the
+ * shared pool instead of spawning threads of their own. The calling thread
+ * always takes part in the work, so a parallel loop never waits on a busy
+ * pool and may be nested inside another one.
+ *
+ * \note This is an alpha API and may change.
+ */
+
+/**
+ * @brief Singleton pool of worker threads running parallel loops.
+ *
+ * \subsection jobsystem-example Example
+ * ```cpp
+ * std::vector<float> values(100000);
+ * JobSystem::getInstance().parallelFor(
+ *     values.size(), 4096, [&](size_t begin, size_t end) {
+ *         for (size_t i = begin; i < end; i++) {
+ *             values[i] *= 2.0f;
+ *         }
+ *     });
+ * ```
+ */
+class JobSystem {
+  private:
+    JobSystem();
+
+  public:
+    ~JobSystem();
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    static JobSystem &getInstance() {
+        static JobSystem instance;
+        return instance;
+    }
+
+    /**
+     * @brief Runs `func` over `[0, count)` split into ranges of at most
+     * `grainSize` items and returns once every range has finished. Ranges
+     * may run on any worker and in any order.
+     */
+    void parallelFor(size_t count, size_t grainSize,
+                     const std::function<void(size_t, size_t)> &func);
+
+    /** @brief Number of worker threads, not counting the caller. */
+    size_t getWorkerCount() const { return workers.size(); }
+
+  private:
+    struct Job {
+        const std::function<void(size_t, size_t)> *func = nullptr;
+        size_t count = 0;
+        size_t grainSize = 1;
+        size_t chunkCount = 0;
+        std::atomic<size_t> nextChunk{0};
+        std::atomic<size_t> finishedChunks{0};
+        std::mutex doneMutex;
+        std::condition_variable done;
+    };
+
+    std::vector<std::thread> workers;
+    std::deque<std::shared_ptr<Job>> jobs;
+    std::mutex jobsMutex;
+    std::condition_variable jobAvailable;
+    bool stopping = false;
+
+    void workerLoop();
+    static void runChunks(Job &job);
+    void retireJob(const std::shared_ptr<Job> &job);
+};
+
+#endif // ATLAS_JOB_SYSTEM_H
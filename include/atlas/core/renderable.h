@@ -169,6 +169,33 @@ class Renderable {
     virtual bool canUseDeferredRendering() { return true; };
     virtual void beforePhysics() {}
 
+    /**
+     * @brief Function to get the world-space bounds of the object, used by
+     * the Window to cull objects that are out of view.
+     *
+     * @return The bounds of the object, or std::nullopt when the object must
+     * never be culled.
+     */
+    virtual std::optional<BoundingBox> getWorldBounds() {
+        return std::nullopt;
+    };
+
+    /**
+     * @brief Function called once per frame instead of render() when the
+     * object has been culled. Derived classes can use it to keep per-frame
+     * logic that normally runs while rendering up to date.
+     *
+     * @param dt Delta time since the last frame.
+     */
+    virtual void renderCulled([[maybe_unused]] float dt) {};
+
+    /**
+     * @brief Distance from the camera past which the object is culled. A
+     * value of zero disables distance culling for the object.
+     *
+     */
+    float maxDrawDistance = 0.0f;
+
     /**
      * @brief Whether the object should be included in depth of field
      * calculations. When true, contributes to blur effects.
@@ -117,6 +117,8 @@ enum class AtlasComputeShader {
     DDGI_WRITE,
     /** @brief Compute shader used for path tracing output generation. */
     PathTracer,
+    /** @brief Compute shader that steps GPU-simulated particle emitters. */
+    ParticleSimulation,
 };
 
 /**
@@ -12,15 +12,19 @@
 
 #include "atlas/camera.h"
 #include "atlas/core/renderable.h"
+#include "atlas/light_clusters.h"
 #include "atlas/object.h"
 #include "atlas/texture.h"
 #include "atlas/units.h"
+#include <array>
 #include <glm/gtc/matrix_transform.hpp>
 #include <memory>
+#include <optional>
 #include <tuple>
 #include <vector>
 
 class Window;
+class Scene;
 
 // ============================================================================
 // GPU Buffer Structures - must match shader buffer layouts exactly
@@ -116,6 +120,126 @@ struct alignas(16) GPUShadowParams {
     int lightType;
 };
 
+/**
+ * @brief Scene lights packed once per frame into GPU buffers that every
+ * lighting pass binds.
+ *
+ * The window calls `update` once per frame. Each light is packed and
+ * compared with the copy already on the GPU, and only the span of lights
+ * that changed is uploaded, so static lights cost no upload. Forward,
+ * deferred and global illumination passes then call `bind` or the buffer
+ * getters to attach the shared buffers instead of packing their own.
+ *
+ * \note On OpenGL the light buffers are not created and `bind` only sets the
+ * light counts.
+ */
+class LightFrameData {
+  public:
+    /**
+     * @brief Maximum number of lights of each kind that are packed.
+     */
+    static constexpr int MAX_LIGHTS = 256;
+    /**
+     * @brief Maximum number of point, spot and area lights of each kind
+     * that are packed when clustered lighting is used.
+     */
+    static constexpr int MAX_CLUSTERED_LIGHTS = 16384;
+
+    /**
+     * @brief Packs the lights of a scene and uploads the ones that changed.
+     *
+     * @param scene The scene whose lights are packed.
+     * @param clusterCamera When set, point, spot and area lights are also
+     * binned into the froxel grid of this perspective camera, and the
+     * LightClusters and LightClusterIndices buffers are uploaded.
+     * @param aspectRatio Aspect ratio of the camera projection.
+     */
+    void update(Scene &scene, const Camera *clusterCamera = nullptr,
+                float aspectRatio = 1.0f);
+
+    /**
+     * @brief Sets the light counts of a pipeline and binds the
+     * DirectionalLights, PointLights, SpotLights and AreaLights buffers,
+     * along with the cluster buffers once they exist.
+     *
+     * @param pipeline The pipeline to bind the lights to.
+     * @param includeSun Whether the atmosphere sun stands in for the
+     * directional lights when the scene has none.
+     */
+    void bind(opal::Pipeline &pipeline, bool includeSun = false) const;
+
+    /**
+     * @brief Number of packed directional lights.
+     *
+     * @param includeSun Whether the atmosphere sun is counted when the
+     * scene has no directional lights.
+     */
+    int getDirectionalLightCount(bool includeSun = false) const;
+    int getPointLightCount() const {
+        return static_cast<int>(pointLights.packed.size());
+    }
+    int getSpotlightCount() const {
+        return static_cast<int>(spotlights.packed.size());
+    }
+    int getAreaLightCount() const {
+        return static_cast<int>(areaLights.packed.size());
+    }
+
+    /**
+     * @brief Buffers holding the packed lights. The directional buffer ends
+     * with the atmosphere sun when the scene has no directional lights.
+     * Every buffer holds at least one element once `update` has run.
+     */
+    std::shared_ptr<opal::Buffer> getDirectionalLightBuffer() const {
+        return directionalLights.buffer;
+    }
+    std::shared_ptr<opal::Buffer> getPointLightBuffer() const {
+        return pointLights.buffer;
+    }
+    std::shared_ptr<opal::Buffer> getSpotlightBuffer() const {
+        return spotlights.buffer;
+    }
+    std::shared_ptr<opal::Buffer> getAreaLightBuffer() const {
+        return areaLights.buffer;
+    }
+
+    /** @brief Whether the lights were binned into clusters this frame. */
+    bool usesClusters() const { return clustersEnabled; }
+    /** @brief Froxel grid built during the last clustered update. */
+    const LightClusters &getLightClusters() const { return clusters; }
+
+  private:
+    template <typename T> struct LightList {
+        /** @brief Lights packed this frame. */
+        std::vector<T> packed;
+        /** @brief Contents of the GPU buffer, compared to find changes. */
+        std::vector<T> uploaded;
+        std::shared_ptr<opal::Buffer> buffer;
+        size_t capacity = 0;
+    };
+
+    LightList<GPUDirectionalLight> directionalLights;
+    LightList<GPUPointLight> pointLights;
+    LightList<GPUSpotLight> spotlights;
+    LightList<GPUAreaLight> areaLights;
+    /** @brief Number of scene directional lights, without the sun. */
+    int sceneDirectionalCount = 0;
+
+    LightClusters clusters;
+    std::vector<ClusterLight> clusterLights;
+    /** @brief Grid header followed by the range of every cluster. */
+    std::vector<uint8_t> clusterData;
+    std::shared_ptr<opal::Buffer> clusterBuffer;
+    size_t clusterCapacity = 0;
+    std::shared_ptr<opal::Buffer> clusterIndexBuffer;
+    size_t clusterIndexCapacity = 0;
+    bool clustersEnabled = false;
+
+    template <typename T> static void upload(LightList<T> &list);
+    void updateClusters(const Camera &camera, float aspectRatio);
+    void disableClusters();
+};
+
 // ============================================================================
 // Original Light Structures
 // ============================================================================
@@ -200,6 +324,43 @@ struct ShadowParams {
     float farPlane;
 };
 
+/**
+ * @brief Maximum number of cascades a directional light can split its shadow
+ * map into.
+ */
+constexpr int MAX_SHADOW_CASCADES = 4;
+
+/**
+ * @brief A single shadow map covering one slice of the camera frustum. All
+ * cascades of a light are drawn into the same shadow map, which is split into
+ * a 2x2 grid when there is more than one: cascade i takes column i % 2 and
+ * row i / 2.
+ */
+struct ShadowCascade {
+    /**
+     * @brief Render target holding the shadow map shared by the cascades.
+     *
+     */
+    RenderTarget *renderTarget = nullptr;
+    /**
+     * @brief Matrices the cascade was last rendered with. farPlane holds the
+     * view depth at which the cascade ends.
+     *
+     */
+    ShadowParams params;
+    /**
+     * @brief Area of the shadow map covered by the cascade, as an offset (xy)
+     * and a size (zw) in texture coordinates.
+     *
+     */
+    glm::vec4 atlasRect = {0.0f, 0.0f, 1.0f, 1.0f};
+    /**
+     * @brief Camera forward axis the split depths are measured along.
+     *
+     */
+    glm::vec3 viewDirection = {0.0f, 0.0f, -1.0f};
+};
+
 /**
  * @brief Structure representing a point light in a scene. A point light emits
  * light in all directions from a single point in space.
@@ -406,11 +567,49 @@ class DirectionalLight {
      */
     void castShadows(Window &window, int resolution = 4096);
 
+    /**
+     * @brief Number of cascades the shadow map is split into, up to
+     * MAX_SHADOW_CASCADES. With a single cascade the shadow map is fitted to
+     * every shadow caster; with more, each cascade is fitted to a slice of
+     * the camera frustum so nearby shadows get more resolution.
+     *
+     */
+    int cascadeCount = 1;
+    /**
+     * @brief Blend between uniform (0) and logarithmic (1) cascade splits.
+     *
+     */
+    float cascadeSplitLambda = 0.75f;
+    /**
+     * @brief Distance from the camera covered by the cascades. Geometry
+     * further away receives no directional shadows when cascades are used.
+     *
+     */
+    float cascadeDistance = 150.0f;
+
+    /**
+     * @brief Gets the cascades rendered during the last shadow pass. Every
+     * cascade is drawn into its own area of shadowRenderTarget.
+     *
+     * @return (const std::vector<ShadowCascade>&) The shadow cascades.
+     */
+    const std::vector<ShadowCascade> &getShadowCascades() const {
+        return shadowCascades;
+    }
+
   private:
     bool doesCastShadows = false;
+    std::vector<ShadowCascade> shadowCascades;
 
     ShadowParams calculateLightSpaceMatrix(
         const std::vector<Renderable *> &renderable) const;
+    std::vector<ShadowParams>
+    calculateCascadeMatrices(const std::vector<Renderable *> &renderable,
+                             const Camera &camera, float aspectRatio,
+                             int resolution) const;
+    ShadowParams fitShadowVolume(const std::array<glm::vec3, 8> &volume,
+                                 const BoundingBox &casterBounds,
+                                 int resolution) const;
 
     friend class Window;
     friend class CoreObject;
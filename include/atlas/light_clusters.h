@@ -0,0 +1,168 @@
+//
+// light_clusters.h
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: View-space froxel grid used for clustered lighting
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#ifndef ATLAS_LIGHT_CLUSTERS_H
+#define ATLAS_LIGHT_CLUSTERS_H
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+/**
+ * @brief Kind of light referenced by a cluster index entry.
+ */
+enum class ClusterLightType : uint32_t { Point = 0, Spot = 1, Area = 2 };
+
+/**
+ * @brief Bounding sphere of a light in view space, where the camera looks
+ * down -Z.
+ */
+struct ClusterLight {
+    glm::vec3 center;
+    float radius;
+    /** @brief Entry written to the index list, see `LightClusters::encode`. */
+    uint32_t entry;
+};
+
+/**
+ * @brief Froxel grid that bins lights into view-space clusters.
+ *
+ * The view frustum is split into `tilesX` x `tilesY` tiles in normalized
+ * device coordinates and `slices` exponential depth slices between
+ * `nearPlane` and `farPlane`. After `build`, every cluster holds an
+ * (offset, count) range into a shared list of encoded light entries, so a
+ * shader only visits the lights that can reach the cluster it shades.
+ *
+ * Binning only depends on the view-space bounds of the lights and runs on
+ * the job system, one depth slice per task. `buildReference` produces the
+ * same result with a brute-force loop over every cluster and light.
+ *
+ * \subsection light-clusters-example Example
+ * ```cpp
+ * LightClusters clusters;
+ * clusters.configure(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+ * std::vector<ClusterLight> lights = {
+ *     {{0.0f, 0.0f, -10.0f}, 2.0f,
+ *      LightClusters::encode(ClusterLightType::Point, 0)}};
+ * clusters.build(lights);
+ * glm::uvec2 range = clusters.getRanges()[clusters.clusterIndex(8, 4, 12)];
+ * ```
+ *
+ * \note This is an alpha API and may change.
+ */
+class LightClusters {
+  public:
+    /** @brief Bit where the light type starts in an index entry. */
+    static constexpr uint32_t TYPE_SHIFT = 30;
+    /** @brief Mask selecting the light index of an index entry. */
+    static constexpr uint32_t INDEX_MASK = (1u << TYPE_SHIFT) - 1u;
+
+    uint32_t tilesX = 16;
+    uint32_t tilesY = 9;
+    uint32_t slices = 24;
+    float nearPlane = 0.1f;
+    float farPlane = 1000.0f;
+    /** @brief Tangent of half the horizontal field of view. */
+    float tanHalfFovX = 1.0f;
+    /** @brief Tangent of half the vertical field of view. */
+    float tanHalfFovY = 1.0f;
+
+    /**
+     * @brief Fits the grid to a symmetric perspective projection.
+     *
+     * @param fovY Vertical field of view in radians.
+     * @param aspectRatio Width divided by height.
+     * @param nearClip Distance to the near plane.
+     * @param farClip Distance to the far plane.
+     */
+    void configure(float fovY, float aspectRatio, float nearClip,
+                   float farClip);
+
+    /**
+     * @brief Encodes a light as an index list entry.
+     */
+    static uint32_t encode(ClusterLightType type, uint32_t index) {
+        return (static_cast<uint32_t>(type) << TYPE_SHIFT) |
+               (index & INDEX_MASK);
+    }
+
+    /**
+     * @brief Bins lights into the grid using the job system.
+     */
+    void build(const std::vector<ClusterLight> &lights);
+
+    /**
+     * @brief Bins lights by testing every light against every cluster.
+     * Produces exactly the ranges and indices of `build`.
+     */
+    void buildReference(const std::vector<ClusterLight> &lights);
+
+    uint32_t getClusterCount() const { return tilesX * tilesY * slices; }
+
+    uint32_t clusterIndex(uint32_t x, uint32_t y, uint32_t z) const {
+        return (((z * tilesY) + y) * tilesX) + x;
+    }
+
+    /**
+     * @brief View-space distance where a depth slice starts. Slice `slices`
+     * starts at the far plane.
+     */
+    float getSliceDepth(uint32_t slice) const;
+
+    /**
+     * @brief Scale and bias mapping `log(depth)` to a slice index, as used
+     * by the shaders.
+     */
+    float getSliceScale() const;
+    float getSliceBias() const;
+
+    /**
+     * @brief Whether a view-space sphere touches the bounding box of a
+     * cluster. Both build paths use this test.
+     */
+    bool overlaps(const ClusterLight &light, uint32_t x, uint32_t y,
+                  uint32_t z) const;
+
+    /** @brief (offset, count) into `getIndices()` for every cluster. */
+    const std::vector<glm::uvec2> &getRanges() const { return ranges; }
+    /** @brief Encoded light entries referenced by the cluster ranges. */
+    const std::vector<uint32_t> &getIndices() const { return indices; }
+
+  private:
+    struct Slice {
+        /** @brief (tile, entry) pairs in light order. */
+        std::vector<glm::uvec2> hits;
+        std::vector<uint32_t> counts;
+        std::vector<uint32_t> offsets;
+        /** @brief Hits sorted by tile. */
+        std::vector<uint32_t> entries;
+    };
+
+    std::vector<glm::uvec2> ranges;
+    std::vector<uint32_t> indices;
+    std::vector<Slice> sliceData;
+    /** @brief Start depth of every slice, plus the far plane. */
+    std::vector<float> depths;
+
+    // Structure of arrays copy of the light bounds, so the rejection loops
+    // stream through contiguous floats.
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> minDepth;
+    std::vector<float> maxDepth;
+    std::vector<float> paddedRadii;
+
+    void updateDepths();
+    bool overlapsBox(const ClusterLight &light, uint32_t x, uint32_t y,
+                     float sliceNear, float sliceFar) const;
+    void binSlice(const std::vector<ClusterLight> &lights, uint32_t z);
+    void gather();
+};
+
+#endif // ATLAS_LIGHT_CLUSTERS_H
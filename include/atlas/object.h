@@ -584,6 +584,12 @@ class CoreObject : public GameObject {
 
     bool hasPhysics = false;
 
+    BoundingBox localBounds;
+    BoundingBox worldBounds;
+    std::size_t localBoundsVertexCount = 0;
+    bool localBoundsDirty = true;
+    bool worldBoundsDirty = true;
+
     friend class Window;
     friend class RenderTarget;
     friend class Skybox;
@@ -630,6 +636,18 @@ class CoreObject : public GameObject {
      */
     bool canCastShadows() const override { return castsShadows; }
 
+    /**
+     * @brief Gets the world-space bounds of the object. The bounds are cached
+     * and only recomputed when the vertices or the transform change. For
+     * instanced objects the bounds enclose every instance.
+     */
+    std::optional<BoundingBox> getWorldBounds() override;
+
+    /**
+     * @brief Keeps the object's components ticking while it is culled.
+     */
+    void renderCulled(float dt) override;
+
     /**
      * @brief Returns the current Euler rotation (pitch, yaw, roll).
      */
@@ -888,6 +906,40 @@ class Model : public GameObject {
         }
     }
 
+    /**
+     * @brief Gets the bounds enclosing every mesh of the model.
+     */
+    std::optional<BoundingBox> getWorldBounds() override {
+        std::optional<BoundingBox> bounds;
+        for (auto &obj : objects) {
+            if (obj == nullptr) {
+                continue;
+            }
+            std::optional<BoundingBox> meshBounds = obj->getWorldBounds();
+            if (!meshBounds.has_value()) {
+                return std::nullopt;
+            }
+            bounds = bounds.has_value() ? bounds->merged(*meshBounds)
+                                        : *meshBounds;
+        }
+        return bounds;
+    }
+
+    /**
+     * @brief Keeps the components of the model and its meshes ticking while
+     * the model is culled.
+     */
+    void renderCulled(float dt) override {
+        for (auto &component : components) {
+            component->update(dt);
+        }
+        for (auto &obj : objects) {
+            if (obj != nullptr) {
+                obj->renderCulled(dt);
+            }
+        }
+    }
+
     /**
      * @brief Updates all underlying CoreObjects to keep transforms and
      * animations synchronized.
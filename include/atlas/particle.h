@@ -12,9 +12,13 @@
 
 #include "atlas/component.h"
 #include "atlas/core/shader.h"
+#include "atlas/particle_simulation.h"
 #include "atlas/texture.h"
 #include "opal/opal.h"
+#include <array>
 #include <optional>
+#include <random>
+#include <vector>
 
 /**
  * @brief Type that describes how particles are emitted.
@@ -83,6 +87,8 @@ struct ParticleSettings {
 
 /**
  * @brief Structure representing a single particle in a particle system.
+ * Particles are stored internally as a ParticleStore; this is the snapshot
+ * returned by ParticleEmitter::getParticle.
  *
  */
 struct Particle {
@@ -175,9 +181,20 @@ class ParticleEmitter : public GameObject {
                 bool updatePipeline = false) override;
     /**
      * @brief Updates particle lifetimes, spawns new particles, and applies
-     * forces.
+     * forces. Does nothing if the emitter was already stepped this frame
+     * through updateEmitters().
      */
     void update(Window &window) override;
+    /**
+     * @brief Steps several emitters at once. Spawning and the GPU uploads
+     * run on the calling thread, while integration and the instance writes
+     * are split into chunks and spread over the JobSystem workers.
+     *
+     * @param window Window providing the time step, camera and scene.
+     * @param emitters Emitters to step. Each one is stepped once per frame.
+     */
+    static void updateEmitters(Window &window,
+                               const std::vector<ParticleEmitter *> &emitters);
     /**
      * @brief Updates the projection matrix used to align particles to the
      * camera frustum.
@@ -296,6 +313,40 @@ class ParticleEmitter : public GameObject {
      */
     void setSpawnRate(int rate) { setSpawnRate(static_cast<float>(rate)); }
 
+    /**
+     * @brief Moves the simulation to a compute shader. Particle state stays
+     * in GPU buffers and the kernel writes the instance count of an
+     * indirect draw, so nothing is read back. Falls back to the CPU
+     * simulation when the backend has no compute support.
+     *
+     * Ambient particles leaving their bounds are killed instead of
+     * respawned, and spawns beyond the capacity replace the oldest
+     * particles.
+     */
+    void enableComputeSimulation();
+    /**
+     * @brief Goes back to simulating particles on the CPU.
+     */
+    void disableComputeSimulation();
+    /**
+     * @brief Whether the emitter currently simulates on the GPU.
+     */
+    bool isUsingComputeSimulation() const { return computeActive; }
+
+    /**
+     * @brief Returns the number of particles that are currently alive. The
+     * count is only known on the CPU, so it is zero while the emitter uses
+     * the compute simulation.
+     */
+    unsigned int getActiveParticleCount() const { return activeParticleCount; }
+
+    /**
+     * @brief Returns a copy of a live particle.
+     *
+     * @param index Index between zero and getActiveParticleCount().
+     */
+    Particle getParticle(unsigned int index) const;
+
     /**
      * @brief The settings used for particle behavior and appearance.
      *
@@ -304,7 +355,7 @@ class ParticleEmitter : public GameObject {
 
   private:
     /** @brief Particle pool reused across emissions. */
-    std::vector<Particle> particles;
+    ParticleStore particles;
     /** @brief Maximum capacity of the particle pool. */
     unsigned int maxParticles;
     /** @brief Number of currently active particles in the pool. */
@@ -342,12 +393,55 @@ class ParticleEmitter : public GameObject {
     Position3d position = {0.0, 0.0, 0.0};
     std::optional<Position3d> firstCameraPosition = std::nullopt;
 
+    std::default_random_engine rng;
+    std::uniform_real_distribution<float> rand01{0.0f, 1.0f};
+    /** @brief Fallback upload storage when the buffer cannot be mapped. */
+    std::vector<ParticleInstanceData> instanceData;
+    /** @brief Destination of the instance writes during an upload. */
+    ParticleInstanceData *uploadTarget = nullptr;
+    bool uploadMapped = false;
+    /** @brief Constants of the step currently being simulated. */
+    ParticleFrameConstants frameConstants;
+    /** @brief Device frame in which the emitter was last stepped. */
+    long lastSimulatedFrame = -1;
+
+    bool computeRequested = false;
+    bool computeActive = false;
+    /** @brief Persistent ParticleSlot state read and written by the kernel. */
+    std::shared_ptr<opal::Buffer> computeSlots = nullptr;
+    /**
+     * @brief Copies of the buffers rewritten by the CPU every frame, one per
+     * frame that can be in flight, so a frame never overwrites data an
+     * earlier one is still reading.
+     */
+    static constexpr size_t COMPUTE_FRAME_COUNT = 3;
+    /** @brief Particles spawned this frame, copied in by the kernel. */
+    std::array<std::shared_ptr<opal::Buffer>, COMPUTE_FRAME_COUNT>
+        computeSpawns{};
+    std::shared_ptr<opal::Buffer> computeInstances = nullptr;
+    /** @brief DrawIndexedIndirectArguments counted by the kernel. */
+    std::array<std::shared_ptr<opal::Buffer>, COMPUTE_FRAME_COUNT>
+        computeArguments{};
+    /** @brief Copy of the per-frame buffers used by the last dispatch. */
+    size_t computeFrame = 0;
+    std::shared_ptr<opal::DrawingState> computeVao = nullptr;
+    std::shared_ptr<opal::Pipeline> computePipeline = nullptr;
+    std::vector<ParticleSlot> pendingSpawns;
+    unsigned int spawnCursor = 0;
+
     void spawnParticle();
-    void updateParticle(Particle &p, float deltaTime);
+    ParticleSlot makeParticle();
+    bool initializeCompute();
+    void dispatchCompute(Window &window);
+    void prepareStep(Window &window);
+    ParticleFrameConstants makeFrameConstants(Window &window, float dt) const;
+    void retireParticles();
+    void beginUpload();
+    void finishUpload();
     Magnitude3d generateRandomVelocity();
     Position3d generateSpawnPosition();
-    int findInactiveParticle();
-    void activateParticle(int index);
+    void activateParticle(size_t index);
+    void respawnParticle(size_t index);
 };
 
 #endif // ATLAS_PARTICLE_H
@@ -0,0 +1,195 @@
+//
+// particle_simulation.h
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: Structure-of-arrays particle storage and integration
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#ifndef ATLAS_PARTICLE_SIMULATION_H
+#define ATLAS_PARTICLE_SIMULATION_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @file atlas/particle_simulation.h
+ * @brief Particle storage and the integration kernel used by
+ * ParticleEmitter.
+ *
+ * Particles are stored as a structure of arrays so the kernel can update
+ * four particles per instruction with SSE2 or NEON. Live particles are kept
+ * packed at the start of the arrays, which makes spawning O(1) and lets
+ * dead particles be removed by swapping in the last live one.
+ *
+ * Emitters can also run on the GPU through a compute kernel. Its state lives
+ * in ParticleSlot records and simulateParticleSlots() is the CPU reference
+ * of that kernel, sharing the exact arithmetic of integrateParticles().
+ *
+ * \note This is an alpha API and may change.
+ */
+
+/**
+ * @brief Per-instance data consumed by the particle vertex shader.
+ */
+struct ParticleInstanceData {
+    float posX, posY, posZ;
+    float colorR, colorG, colorB, colorA;
+    float size;
+};
+
+/**
+ * @brief Values shared by every particle in a simulation step. They are
+ * computed once per frame instead of once per particle.
+ */
+struct ParticleFrameConstants {
+    /** @brief Time step in seconds. */
+    float deltaTime = 0.0f;
+    /** @brief Time in seconds used to animate the ambient sway. */
+    float time = 0.0f;
+    /** @brief Vertical acceleration applied to every particle. */
+    float gravity = 0.0f;
+    /** @brief Wind acceleration applied to every particle. */
+    float windX = 0.0f;
+    float windY = 0.0f;
+    float windZ = 0.0f;
+    /** @brief Whether particles sway sideways like falling snow. */
+    bool ambientSway = false;
+};
+
+/**
+ * @brief Structure-of-arrays particle pool with a fixed capacity.
+ *
+ * \subsection particlestore-example Example
+ * ```cpp
+ * ParticleStore store;
+ * store.reserve(1000);
+ * size_t index = store.spawn();
+ * store.life[index] = store.maxLife[index] = 2.0f;
+ * integrateParticles(store, constants, 0, store.getCount());
+ * ```
+ */
+class ParticleStore {
+  public:
+    /** @brief Returned by spawn() when the store is full. */
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    /** @brief Number of particles processed together by the kernel. */
+    static constexpr size_t LANE_WIDTH = 4;
+
+    std::vector<float> positionX, positionY, positionZ;
+    std::vector<float> velocityX, velocityY, velocityZ;
+    std::vector<float> colorR, colorG, colorB, colorA;
+    std::vector<float> life, maxLife, size;
+
+    /**
+     * @brief Sets the maximum number of particles and removes every live
+     * particle. The arrays are padded to a multiple of LANE_WIDTH.
+     */
+    void reserve(size_t newCapacity);
+    /**
+     * @brief Claims the slot right after the last live particle.
+     *
+     * @return (size_t) Index of the new particle, or npos when full.
+     */
+    size_t spawn();
+    /**
+     * @brief Removes a particle by moving the last live particle into its
+     * slot. The order of the particles is not kept.
+     */
+    void remove(size_t index);
+    /** @brief Removes every live particle. */
+    void clear() { count = 0; }
+
+    size_t getCount() const { return count; }
+    size_t getCapacity() const { return capacity; }
+
+  private:
+    size_t capacity = 0;
+    size_t count = 0;
+};
+
+/**
+ * @brief Advances the particles in `[begin, end)` by one time step. Applies
+ * gravity, wind and the ambient sway, moves the particles, counts their
+ * life down and fades them out.
+ *
+ * `begin` must be a multiple of ParticleStore::LANE_WIDTH. `end` is rounded
+ * up to the next multiple, which always stays inside the padded arrays.
+ * Dead particles are not removed; the caller does that afterwards.
+ */
+void integrateParticles(ParticleStore &store,
+                        const ParticleFrameConstants &constants, size_t begin,
+                        size_t end);
+
+/**
+ * @brief Writes the particles in `[begin, end)` to `out` in the layout the
+ * particle shader expects. `out` points to the instance of `begin`.
+ */
+void writeParticleInstances(const ParticleStore &store,
+                            ParticleInstanceData *out, size_t begin,
+                            size_t end);
+
+/**
+ * @brief Persistent state of one particle in the compute simulation. The
+ * layout matches the `ParticleSlot` struct of the compute kernel.
+ */
+struct ParticleSlot {
+    float posX = 0.0f, posY = 0.0f, posZ = 0.0f;
+    float life = 0.0f;
+    float velX = 0.0f, velY = 0.0f, velZ = 0.0f;
+    float maxLife = 1.0f;
+    float colorR = 1.0f, colorG = 1.0f, colorB = 1.0f, colorA = 1.0f;
+    float size = 0.0f;
+    float padding[3] = {0.0f, 0.0f, 0.0f};
+};
+
+static_assert(sizeof(ParticleSlot) == 64,
+              "ParticleSlot must match the compute kernel layout");
+
+/**
+ * @brief Parameters of one compute simulation step. The layout matches the
+ * `ParticleComputeParams` struct of the compute kernel.
+ */
+struct ParticleComputeParams {
+    float deltaTime = 0.0f;
+    float time = 0.0f;
+    float gravity = 0.0f;
+    /** @brief Non-zero to sway the particles and kill them once they leave
+     * the ambient bounds around the origin. */
+    unsigned int ambient = 0;
+    float windX = 0.0f, windY = 0.0f, windZ = 0.0f;
+    float padding0 = 0.0f;
+    float originX = 0.0f, originY = 0.0f, originZ = 0.0f;
+    float padding1 = 0.0f;
+    /** @brief Number of slots in the state buffer. */
+    unsigned int capacity = 0;
+    /** @brief Slot receiving the first spawned particle. Spawns fill the
+     * slots after it, wrapping around and replacing the oldest ones. */
+    unsigned int spawnCursor = 0;
+    /** @brief Number of particles spawned this step. */
+    unsigned int spawnCount = 0;
+    unsigned int padding2 = 0;
+};
+
+static_assert(sizeof(ParticleComputeParams) == 64,
+              "ParticleComputeParams must match the compute kernel layout");
+
+/**
+ * @brief CPU reference of the particle compute kernel.
+ *
+ * Copies `spawned[i]` into slot `(spawnCursor + i) % capacity`, advances
+ * every live slot with the same arithmetic as integrateParticles(), kills
+ * ambient particles that leave their bounds and writes the live particles
+ * to `instances`. The kernel appends instances in any order; here they are
+ * written in slot order.
+ *
+ * @return (size_t) Number of instances written, which is the instance count
+ * of the indirect draw.
+ */
+size_t simulateParticleSlots(std::vector<ParticleSlot> &slots,
+                             const ParticleSlot *spawned,
+                             const ParticleComputeParams &params,
+                             ParticleInstanceData *instances);
+
+#endif // ATLAS_PARTICLE_SIMULATION_H
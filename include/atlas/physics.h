@@ -401,6 +401,12 @@ class Rigidbody : public Component {
     void addSphereCollider(float radius);
     /** @brief Adds a mesh collider from the owning object's mesh (if any). */
     void addMeshCollider();
+    /**
+     * @brief Adds a height field collider, such as the one built by
+     * `Terrain::createCollider()`. The body is made static.
+     */
+    void addHeightFieldCollider(
+        const std::shared_ptr<bezel::HeightFieldCollider> &collider);
     /** @brief Sets friction coefficient for contact resolution. */
     void setFriction(float friction);
 
@@ -493,10 +493,12 @@ class RenderTarget : public Renderable {
      * @param type The type of render target to create.
      * @param resolution The resolution of the render target (it will be created
      * with this resolution).
+     * @param renderScale Fraction of the window size used for screen-sized
+     * targets. Zero uses the window render scale.
      */
     RenderTarget(Window &window,
                  RenderTargetType type = RenderTargetType::Scene,
-                 int resolution = 1024);
+                 int resolution = 1024, float renderScale = 0.0f);
 
     /**
      * @brief Displays the render target in the window.
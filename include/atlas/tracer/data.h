@@ -17,7 +17,9 @@
  * @brief Packet types and enums used by the Tracer Protocol.
  *
  * Each `*Info` / `*Packet` type describes a payload that can be sent to an
- * external tracer/visualizer via its `send()` method.
+ * external tracer/visualizer via its `send()` method. Sending only queues a
+ * binary record on the calling thread (see atlas/tracer/stream.h); the
+ * network write happens on the tracer sender thread.
  *
  * \note This is an alpha API and may change.
  */
@@ -56,6 +58,10 @@ struct FrameDrawInfo {
     float frameTimeMs;
     /** @brief Frames per second derived from frame time. */
     float fps;
+    /** @brief Objects that passed the culling pass. */
+    unsigned int visibleObjects;
+    /** @brief Objects discarded by the culling pass. */
+    unsigned int culledObjects;
 
     /** @brief Sends this event to the tracer sink. */
     void send();
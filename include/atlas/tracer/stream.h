@@ -0,0 +1,242 @@
+//
+// stream.h
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: Binary record stream for the Tracer Protocol
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#ifndef TRACER_STREAM_H
+#define TRACER_STREAM_H
+
+#include <atlas/network/pipe.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @file atlas/tracer/stream.h
+ * @brief Lock-free record stream that decouples tracer producers from the
+ * network.
+ *
+ * Hot paths write fixed-size binary records into a per-thread ring buffer.
+ * A background sender thread drains every ring, batches the records,
+ * compresses them and flushes them to the tracer pipe. When a ring is full
+ * the record is dropped and counted instead of stalling the producer.
+ *
+ * \note This is an alpha API and may change.
+ */
+
+/**
+ * @brief Identifies the payload stored in a TracerRecord.
+ */
+enum class TracerRecordType : uint16_t {
+    DrawCall = 1,
+    FrameDraw = 2,
+    ResourceEvent = 3,
+    FrameResources = 4,
+    DebugObject = 5,
+    Allocation = 6,
+    FrameMemory = 7,
+    FrameTiming = 8,
+    TimingEvent = 9,
+    Log = 10,
+    LogText = 11,
+    StringDefinition = 12,
+    RecordsDropped = 13,
+};
+
+/**
+ * @brief Severity carried by Log records.
+ */
+enum class TracerLogSeverity : uint8_t { Info = 0, Warning = 1, Error = 2 };
+
+/**
+ * @brief Fixed-size record exchanged between producers and the sender.
+ */
+struct TracerRecord {
+    /** @brief Bytes available for the payload of a single record. */
+    static constexpr std::size_t PAYLOAD_SIZE = 60;
+
+    /** @brief Payload type, one of TracerRecordType. */
+    uint16_t type = 0;
+    /** @brief Number of meaningful payload bytes. */
+    uint16_t size = 0;
+    /** @brief Raw payload bytes. */
+    uint8_t payload[PAYLOAD_SIZE] = {};
+};
+
+static_assert(sizeof(TracerRecord) == 64, "TracerRecord must be 64 bytes");
+
+/**
+ * @brief Header written in front of every batch sent over the pipe.
+ */
+struct TracerBatchHeader {
+    /** @brief Always "ATRB". */
+    char magic[4] = {'A', 'T', 'R', 'B'};
+    /** @brief Wire format version. */
+    uint16_t version = 2;
+    /** @brief Encoding flags, see TRACER_BATCH_ZERO_RLE. */
+    uint16_t flags = 0;
+    /** @brief Number of records in the batch. */
+    uint32_t recordCount = 0;
+    /** @brief Size of the records once decoded, in bytes. */
+    uint32_t rawSize = 0;
+    /** @brief Size of the encoded body that follows, in bytes. */
+    uint32_t encodedSize = 0;
+    /** @brief Records dropped by producers since the previous batch. */
+    uint32_t droppedRecords = 0;
+};
+
+/** @brief Batch body is compressed with zero run-length encoding. */
+constexpr uint16_t TRACER_BATCH_ZERO_RLE = 1;
+
+/**
+ * @brief Single-producer single-consumer ring of tracer records.
+ */
+class TracerRing {
+  public:
+    /**
+     * @brief Creates a ring holding `capacity` records, rounded up to the
+     * next power of two.
+     */
+    explicit TracerRing(std::size_t capacity);
+
+    /**
+     * @brief Pushes a contiguous group of records. Either every record is
+     * pushed or none is, in which case the group is counted as dropped.
+     *
+     * @return (bool) Whether the records were pushed.
+     */
+    bool push(const TracerRecord *records, std::size_t count);
+
+    /**
+     * @brief Moves every pending record to the end of `out`. Only the
+     * sender thread may call this.
+     *
+     * @return (std::size_t) Number of records moved.
+     */
+    std::size_t drain(std::vector<TracerRecord> &out);
+
+    /** @brief Returns and resets the number of records dropped. */
+    uint64_t takeDropped() { return dropped.exchange(0); }
+
+    /**
+     * @brief Marks the ring as abandoned by its producer thread. The sender
+     * frees it once it has drained the remaining records.
+     */
+    void retire() { retired.store(true, std::memory_order_release); }
+
+    /** @brief Whether the producer thread has exited. */
+    bool isRetired() const { return retired.load(std::memory_order_acquire); }
+
+  private:
+    std::vector<TracerRecord> records;
+    std::size_t mask;
+    std::atomic<bool> retired{false};
+
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+    alignas(64) std::atomic<uint64_t> dropped{0};
+};
+
+/**
+ * @brief Singleton that owns the per-thread rings and the sender thread.
+ *
+ * \subsection tracerstream-example Example
+ * ```cpp
+ * struct Payload {
+ *     uint32_t frameNumber;
+ *     float value;
+ * };
+ * TracerStream::getInstance().write(TracerRecordType::FrameTiming,
+ *                                   Payload{frame, 1.0f});
+ * ```
+ */
+class TracerStream {
+  private:
+    TracerStream() = default;
+
+  public:
+    ~TracerStream();
+
+    static TracerStream &getInstance() {
+        static TracerStream instance;
+        return instance;
+    }
+
+    /** @brief Records each thread's ring can hold before dropping. */
+    std::size_t ringCapacity = 8192;
+
+    /**
+     * @brief Writes a single record carrying `payload` into the calling
+     * thread's ring. Never blocks.
+     *
+     * @return (bool) Whether the record was queued.
+     */
+    template <typename T> bool write(TracerRecordType type, const T &payload) {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "Tracer payloads must be trivially copyable");
+        static_assert(sizeof(T) <= TracerRecord::PAYLOAD_SIZE,
+                      "Tracer payload does not fit in a record");
+
+        TracerRecord record;
+        record.type = static_cast<uint16_t>(type);
+        record.size = static_cast<uint16_t>(sizeof(T));
+        std::memcpy(record.payload, &payload, sizeof(T));
+        return getThreadRing().push(&record, 1);
+    }
+
+    /**
+     * @brief Writes a log line as a Log record followed by LogText records
+     * carrying the message text.
+     */
+    bool writeLog(TracerLogSeverity severity, const std::string &message,
+                  const std::string &file, int line);
+
+    /**
+     * @brief Maps a string to a stable ID. New strings are sent to the
+     * client as StringDefinition records ahead of any batch using them.
+     */
+    uint32_t internString(const std::string &text);
+
+    /** @brief Starts the sender thread flushing to the given pipe. */
+    void start(const std::shared_ptr<NetworkPipe> &pipe);
+    /** @brief Flushes pending records and stops the sender thread. */
+    void stop();
+
+    /** @brief Total records dropped because a ring was full. */
+    uint64_t getDroppedRecords() const { return totalDropped.load(); }
+
+  private:
+    std::mutex ringsMutex;
+    std::vector<std::unique_ptr<TracerRing>> rings;
+
+    std::mutex stringsMutex;
+    std::unordered_map<std::string, uint32_t> stringIds;
+    std::vector<std::string> strings;
+    std::size_t sentStrings = 0;
+
+    std::shared_ptr<NetworkPipe> pipe;
+    std::thread sender;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> totalDropped{0};
+
+    std::vector<TracerRecord> batch;
+    std::string encoded;
+
+    TracerRing &getThreadRing();
+    void senderLoop();
+    void flush();
+};
+
+#endif // TRACER_STREAM_H
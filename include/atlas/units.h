@@ -171,6 +171,28 @@ struct BoundingBox {
                (min.y <= other.max.y && max.y >= other.min.y) &&
                (min.z <= other.max.z && max.z >= other.min.z);
     }
+
+    /** @brief Returns the smallest box enclosing both boxes. */
+    BoundingBox merged(const BoundingBox &other) const {
+        return {Position3d::fromGlm(glm::min(min.toGlm(), other.min.toGlm())),
+                Position3d::fromGlm(glm::max(max.toGlm(), other.max.toGlm()))};
+    }
+
+    /**
+     * @brief Returns the axis-aligned box enclosing this box once transformed
+     * by an affine matrix.
+     */
+    BoundingBox transformed(const glm::mat4 &matrix) const {
+        const glm::vec3 center = (min.toGlm() + max.toGlm()) * 0.5f;
+        const glm::vec3 extent = (max.toGlm() - min.toGlm()) * 0.5f;
+        const glm::vec3 newCenter = glm::vec3(matrix * glm::vec4(center, 1.0f));
+        const glm::vec3 newExtent =
+            glm::abs(glm::vec3(matrix[0])) * extent.x +
+            glm::abs(glm::vec3(matrix[1])) * extent.y +
+            glm::abs(glm::vec3(matrix[2])) * extent.z;
+        return {Position3d::fromGlm(newCenter - newExtent),
+                Position3d::fromGlm(newCenter + newExtent)};
+    }
 };
 
 /**
@@ -25,6 +25,7 @@
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -338,6 +339,7 @@ struct ControllerID {
 
 struct ShaderProgram;
 struct Fluid;
+class ParticleEmitter;
 
 /**
  * @brief Structure representing a window in the application. This contains the
@@ -743,6 +745,11 @@ class Window {
 
     /** @brief Physics world bound to this window's simulation step. */
     std::shared_ptr<bezel::PhysicsWorld> physicsWorld;
+    /**
+     * @brief Settings used every time the physics world is (re)created. Set
+     * them before running the window or switching scenes.
+     */
+    bezel::PhysicsWorldSettings physicsSettings;
 
     /** @brief True only during the very first rendered frame. */
     bool firstFrame = true;
@@ -760,6 +767,37 @@ class Window {
      */
     BoundingBox getSceneBoundingBox();
 
+    /**
+     * @brief Whether objects outside of the camera frustum, or further away
+     * than their maxDrawDistance, are skipped while rendering.
+     *
+     */
+    bool useFrustumCulling = true;
+
+    /**
+     * @brief Whether point, spot and area lights are binned into a
+     * view-space cluster grid every frame, so each pixel only shades the
+     * lights that can reach it. Raises the per-type light limit to
+     * `LightFrameData::MAX_CLUSTERED_LIGHTS`. Only used by the Vulkan
+     * backend with a perspective camera.
+     */
+    bool useClusteredLighting = false;
+
+    /**
+     * @brief Gets the number of objects that passed the culling pass during
+     * the last frame.
+     */
+    std::size_t getVisibleObjectCount() const {
+        return this->visibleObjectCount;
+    }
+    /**
+     * @brief Gets the number of objects discarded by the culling pass during
+     * the last frame.
+     */
+    std::size_t getCulledObjectCount() const {
+        return this->culledObjectCount;
+    }
+
     void addInputAction(const std::shared_ptr<InputAction> &action) {
         inputActions.push_back(action);
     }
@@ -795,7 +833,12 @@ class Window {
     std::vector<Renderable *> firstRenderables;
     std::vector<Renderable *> uiRenderables;
     std::vector<Renderable *> lateForwardRenderables;
+    std::vector<Renderable *> visibleFirstRenderables;
+    std::vector<Renderable *> visibleRenderables;
+    std::vector<Renderable *> visibleLateForwardRenderables;
     std::vector<Fluid *> lateFluids;
+    std::vector<Renderable *> fluidCaptureQueue;
+    std::vector<ParticleEmitter *> particleEmitters;
     std::vector<RenderTarget *> renderTargets;
     std::shared_ptr<RenderTarget> screenRenderTarget;
 
@@ -824,6 +867,13 @@ class Window {
     Scene *pendingScene = nullptr;
     bool hasPendingSceneChange = false;
 
+    Frustum viewFrustum;
+    std::size_t visibleObjectCount = 0;
+    std::size_t culledObjectCount = 0;
+
+    void cullRenderables();
+    bool isInView(Renderable *renderable) const;
+
     void renderLightsToShadowMaps(
         std::shared_ptr<opal::CommandBuffer> commandBuffer = nullptr);
     Size2d getFurthestPositions();
@@ -844,6 +894,10 @@ class Window {
     void captureFluidRefraction(
         Fluid &fluid,
         std::shared_ptr<opal::CommandBuffer> commandBuffer = nullptr);
+    void renderFluidCaptureQueue(
+        Fluid &fluid, bool aboveSurface, const glm::mat4 &view,
+        const glm::mat4 &projection,
+        const std::shared_ptr<opal::CommandBuffer> &commandBuffer);
     void markPipelineStateDirty();
     bool shouldRefreshPipeline(Renderable *renderable);
     void setViewportState(int x, int y, int newViewportWidth,
@@ -895,6 +949,11 @@ class Window {
 
     bool clipPlaneEnabled = false;
     glm::vec4 clipPlaneEquation{0.0f};
+    /**
+     * @brief Set while drawing passes that skip shadow maps, such as fluid
+     * captures.
+     */
+    bool suppressShadows = false;
 
     std::array<std::shared_ptr<opal::Framebuffer>, 2> pingpongFramebuffers;
     std::array<std::shared_ptr<opal::Texture>, 2> pingpongTextures;
@@ -920,6 +979,10 @@ class Window {
     bool shadowMapsDirty = true;
     std::optional<Position3d> lastShadowCameraPosition;
     std::optional<Normal3d> lastShadowCameraDirection;
+    /**
+     * @brief Scene lights packed once per frame and shared by every pass.
+     */
+    LightFrameData lightFrameData;
     std::vector<glm::vec3> cachedDirectionalLightDirections;
     std::vector<glm::vec3> cachedPointLightPositions;
     std::vector<glm::vec3> cachedSpotlightPositions;
@@ -944,6 +1007,7 @@ class Window {
     friend class photon::GlobalIllumination;
     friend class photon::PathTracing;
     friend struct Fluid;
+    friend class ParticleEmitter;
 };
 
 #endif // WINDOW_H
@@ -0,0 +1,252 @@
+//
+// chunked_terrain.h
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: Streamed terrain built from camera-paged chunks
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#ifndef AURORA_CHUNKED_TERRAIN_H
+#define AURORA_CHUNKED_TERRAIN_H
+
+#include "atlas/core/shader.h"
+#include "atlas/object.h"
+#include "atlas/texture.h"
+#include "atlas/units.h"
+#include "aurora/procedural.h"
+#include "aurora/terrain.h"
+#include "opal/opal.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Terrain of fixed-size chunks streamed in around the camera.
+ *
+ * Chunks inside `viewRadius` of the camera are generated on a background
+ * thread and uploaded a few per frame. Chunks further than one ring past
+ * the radius are evicted, so memory stays bounded however far the camera
+ * travels. Each chunk picks a level of detail from its distance: every LOD
+ * halves the number of height samples, and a chunk is regenerated when it
+ * moves between levels.
+ *
+ * \subsection chunked-terrain-example Example
+ * ```cpp
+ * CompoundGenerator generator;
+ * generator.addGenerator(HillGenerator(0.02f, 6.0f));
+ * generator.addGenerator(MountainGenerator(0.004f, 0.6f));
+ *
+ * ChunkedTerrain terrain(generator);
+ * terrain.chunkSize = 128.0f;
+ * terrain.viewRadius = 8;
+ * terrain.addBiome(Biome("Grass", Color(0.3, 0.6, 0.2, 1.0)));
+ * window.addObject(&terrain);
+ * ```
+ *
+ * \note This is an alpha API and may change.
+ */
+class ChunkedTerrain : public GameObject {
+  public:
+    /**
+     * @brief Generator sampled in world units to build each chunk.
+     */
+    std::shared_ptr<TerrainGenerator> generator;
+
+    /**
+     * @brief World-space side length of a chunk.
+     */
+    float chunkSize = 128.0f;
+    /**
+     * @brief Height samples per side of a chunk at the finest LOD. Each LOD
+     * keeps the corner samples and halves the spans between them.
+     */
+    int chunkResolution = 129;
+    /**
+     * @brief Number of patches per side of a chunk. The tessellation stage
+     * refines every patch by its distance to the camera.
+     */
+    unsigned int patchesPerChunk = 8;
+    /**
+     * @brief Depth, in world units, of the skirts hanging from every chunk
+     * border. They hide the cracks between chunks of different LOD. Read
+     * when the terrain is initialized.
+     */
+    float skirtDepth = 8.0f;
+    /**
+     * @brief Radius, in chunks, that is kept loaded around the camera.
+     */
+    int viewRadius = 6;
+    /**
+     * @brief Number of detail levels chunks may use.
+     */
+    int lodLevels = 4;
+    /**
+     * @brief Chunk rings around the camera that share a detail level.
+     */
+    int ringsPerLod = 2;
+    /**
+     * @brief Generated chunks uploaded to the GPU at most per frame.
+     */
+    int maxUploadsPerFrame = 2;
+
+    /**
+     * @brief Maximum elevation (in world units) used when normalizing heights.
+     */
+    float maxPeak = 48.f;
+    /**
+     * @brief Elevation at which water begins to cover the terrain.
+     */
+    float seaLevel = 16.f;
+
+    /**
+     * @brief World-space offset of the chunk grid.
+     */
+    Position3d position;
+    bool isVisible = true;
+
+    /**
+     * @brief Collection of biomes available for classification.
+     */
+    std::vector<Biome> biomes;
+
+    /**
+     * @brief Creates a streamed terrain sampling the given generator.
+     */
+    template <typename T>
+        requires std::is_base_of<TerrainGenerator, T>::value
+    ChunkedTerrain(T generator)
+        : generator(std::make_shared<T>(generator)) {}
+    ChunkedTerrain() = default;
+    ChunkedTerrain(const ChunkedTerrain &) = delete;
+    ChunkedTerrain &operator=(const ChunkedTerrain &) = delete;
+    ~ChunkedTerrain() override;
+
+    /**
+     * @brief Compiles the terrain shaders, builds the patch grids and starts
+     * the streaming thread.
+     */
+    void initialize() override;
+    /**
+     * @brief Pages chunks in and out around the window camera and uploads
+     * finished chunks.
+     */
+    void update(Window &window) override;
+    /**
+     * @brief Draws every loaded chunk.
+     */
+    void render(float dt, std::shared_ptr<opal::CommandBuffer> commandBuffer,
+                bool updatePipeline = false) override;
+
+    /**
+     * @brief Terrains render forward-only regardless of the window setting.
+     */
+    bool canUseDeferredRendering() override { return false; }
+    bool canCastShadows() const override { return isVisible; }
+    Position3d getPosition() const override { return position; }
+
+    void setViewMatrix(const glm::mat4 &view) override { this->view = view; };
+    void setProjectionMatrix(const glm::mat4 &projection) override {
+        this->projection = projection;
+    };
+    void setPosition(const Position3d &newPosition) override {
+        this->position = newPosition;
+    };
+    void move(const Position3d &deltaPosition) override {
+        this->position.x += deltaPosition.x;
+        this->position.y += deltaPosition.y;
+        this->position.z += deltaPosition.z;
+    };
+
+    void hide() override { isVisible = false; }
+    void show() override { isVisible = true; }
+
+    /**
+     * @brief Registers a biome definition for later map generation.
+     */
+    void addBiome(const Biome &biome) { this->biomes.push_back(biome); };
+
+    /**
+     * @brief Number of chunks currently resident on the GPU.
+     */
+    size_t getLoadedChunkCount() const { return chunks.size(); }
+
+  private:
+    struct ChunkRequest {
+        int x = 0;
+        int z = 0;
+        int lod = 0;
+    };
+
+    /**
+     * @brief CPU-side chunk data produced by the streaming thread.
+     */
+    struct ChunkData {
+        ChunkRequest request;
+        int resolution = 0;
+        std::vector<float> heights;
+        std::vector<uint8_t> moisture;
+        std::vector<uint8_t> temperature;
+    };
+
+    struct Chunk {
+        int x = 0;
+        int z = 0;
+        int lod = 0;
+        Texture heightMap;
+        Texture moistureMap;
+        Texture temperatureMap;
+    };
+
+    /** @brief Evicted chunk whose textures in-flight frames may sample. */
+    struct RetiredChunk {
+        Chunk chunk;
+        long frame = 0;
+    };
+
+    std::unordered_map<int64_t, Chunk> chunks;
+    /** @brief LOD requested for every chunk that is being generated. */
+    std::unordered_map<int64_t, int> pending;
+    /**
+     * @brief Chunk textures no frame uses anymore, by LOD. New chunks refill
+     * them, since dropping a texture does not release it on every backend.
+     */
+    std::unordered_map<int, std::vector<Chunk>> freeChunks;
+    std::deque<RetiredChunk> retiredChunks;
+
+    std::thread streamer;
+    std::mutex streamMutex;
+    std::condition_variable requestReady;
+    std::deque<ChunkRequest> requests;
+    std::vector<ChunkData> completed;
+    bool stopping = false;
+
+    /** @brief One patch grid per LOD, texture coordinates differ. */
+    std::vector<std::shared_ptr<opal::Buffer>> lodVertexBuffers;
+    std::vector<std::shared_ptr<opal::DrawingState>> lodDrawingStates;
+
+    ShaderProgram terrainShader;
+    std::shared_ptr<opal::Pipeline> terrainPipeline;
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    bool initialized = false;
+
+    static int64_t chunkKey(int x, int z);
+    int lodResolution(int lod) const;
+    int lodForDistance(int rings) const;
+    unsigned int patchVertexCount() const;
+
+    void buildPatchGrid(int lod);
+    void streamLoop();
+    ChunkData generateChunk(const ChunkRequest &request);
+    void uploadChunk(ChunkData &data, long frame);
+    void retireChunk(Chunk &&chunk, long frame);
+    void recycleRetiredChunks(long frame);
+};
+
+#endif // AURORA_CHUNKED_TERRAIN_H
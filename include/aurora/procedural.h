@@ -10,6 +10,8 @@
 #ifndef AURORA_PROCEDURAL_H
 #define AURORA_PROCEDURAL_H
 
+#include <algorithm>
+#include <array>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -28,19 +30,26 @@
  */
 struct PerlinNoise {
   private:
-    static std::vector<int> p;
+    /** @brief Doubled permutation table shared by every generator that
+     * uses the same seed. */
+    std::shared_ptr<const std::array<int, 512>> p;
 
     static float fade(float t);
     static float lerp(float t, float a, float b);
     static float grad(int hash, float x, float y);
 
-    static std::vector<int> permutation;
+    static std::shared_ptr<const std::array<int, 512>>
+    permutationFor(unsigned int seed);
+
+    friend class FractalNoise;
 
   public:
     /**
      * @brief Builds a noise generator with an optional deterministic seed.
+     * Permutation tables are cached per seed, so constructing a generator
+     * is cheap.
      *
-     * @param seed Seed value used to shuffle gradients. Defaults to random.
+     * @param seed Seed value used to shuffle gradients.
      */
     PerlinNoise(unsigned int seed = 0);
 
@@ -52,6 +61,14 @@ struct PerlinNoise {
      * @return Smoothed noise value in the range [-1, 1].
      */
     float noise(float x, float y) const;
+
+    /**
+     * @brief Samples a regular grid several points at a time. `out` receives
+     * `width * height` values in row-major order, the sample at column `i`
+     * and row `j` being `noise(x0 + i * dx, y0 + j * dy)`.
+     */
+    void fillGrid(float *out, float x0, float y0, float dx, float dy,
+                  int width, int height) const;
 };
 
 /**
@@ -72,6 +89,12 @@ class SimplexNoise {
      * @return Noise value roughly in the range [-1, 1].
      */
     static float noise(float xin, float yin);
+
+    /**
+     * @brief Samples a regular grid, see PerlinNoise::fillGrid().
+     */
+    static void fillGrid(float *out, float x0, float y0, float dx, float dy,
+                         int width, int height);
 };
 
 /**
@@ -81,6 +104,9 @@ class WorleyNoise {
   private:
     int numPoints;
     std::vector<std::pair<float, float>> featurePoints;
+    /** @brief Feature points split by axis for the batch kernel. */
+    std::vector<float> featureX;
+    std::vector<float> featureY;
 
   public:
     /**
@@ -99,6 +125,12 @@ class WorleyNoise {
      * @return Normalized cellular noise value.
      */
     float noise(float x, float y) const;
+
+    /**
+     * @brief Samples a regular grid, see PerlinNoise::fillGrid().
+     */
+    void fillGrid(float *out, float x0, float y0, float dx, float dy,
+                  int width, int height) const;
 };
 
 /**
@@ -108,12 +140,9 @@ class WorleyNoise {
  * ```cpp
  * // Create fractal noise for mountainous terrain
  * FractalNoise fractal(6, 0.5f); // 6 octaves, 0.5 persistence
- * for (int z = 0; z < gridSize; z++) {
- *     for (int x = 0; x < gridSize; x++) {
- *         float height = fractal.noise(x * 0.01f, z * 0.01f);
- *         heightmap[z][x] = height * 100.0f; // Scale to world units
- *     }
- * }
+ * std::vector<float> heightmap(gridSize * gridSize);
+ * fractal.fillGrid(heightmap.data(), 0.0f, 0.0f, 0.01f, 0.01f, gridSize,
+ *                  gridSize);
  * ```
  */
 class FractalNoise {
@@ -139,6 +168,12 @@ class FractalNoise {
      * @return Fractal noise value.
      */
     float noise(float x, float y) const;
+
+    /**
+     * @brief Samples a regular grid, see PerlinNoise::fillGrid().
+     */
+    void fillGrid(float *out, float x0, float y0, float dx, float dy,
+                  int width, int height) const;
 };
 
 /**
@@ -168,6 +203,20 @@ class Noise {
      */
     static float fractal(float x, float y, int octaves, float persistence);
 
+    /**
+     * @brief Fills `count` Perlin samples taken `dx` apart from `(x0, y)`.
+     */
+    static void perlinRow(float *out, float x0, float y, float dx, int count);
+    /**
+     * @brief Fills `count` Worley samples taken `dx` apart from `(x0, y)`.
+     */
+    static void worleyRow(float *out, float x0, float y, float dx, int count);
+    /**
+     * @brief Fills `count` fractal samples taken `dx` apart from `(x0, y)`.
+     */
+    static void fractalRow(float *out, float x0, float y, float dx, int count,
+                           int octaves, float persistence);
+
     /** @brief Global seed value used by noise helpers when enabled. */
     static float seed;
     /** @brief Indicates whether the global seed has already been initialized.
@@ -194,6 +243,25 @@ class TerrainGenerator {
      */
     virtual float generateHeight(float x, float y) = 0;
 
+    /**
+     * @brief Evaluates a row of heights, `out[i]` being
+     * `generateHeight(x0 + i * dx, y)`. Terrains call this from several
+     * threads at once for different rows, so implementations must not modify
+     * shared state.
+     *
+     * @param out Destination for `count` heights.
+     * @param x0 X coordinate of the first sample.
+     * @param y Y coordinate shared by the row.
+     * @param dx Distance between consecutive samples.
+     * @param count Number of samples to produce.
+     */
+    virtual void generateRow(float *out, float x0, float y, float dx,
+                             int count) {
+        for (int i = 0; i < count; i++) {
+            out[i] = generateHeight(x0 + (static_cast<float>(i) * dx), y);
+        }
+    }
+
     /**
      * @brief Optional hook invoked when the generator is attached to a terrain.
      */
@@ -248,6 +316,14 @@ class HillGenerator : public TerrainGenerator {
         float noise = Noise::perlin(x / scale, y / scale);
         return (noise + 1.0f) * 0.5f * amplitude / 10.0f;
     }
+
+    void generateRow(float *out, float x0, float y, float dx,
+                     int count) override {
+        Noise::perlinRow(out, x0 / scale, y / scale, dx / scale, count);
+        for (int i = 0; i < count; i++) {
+            out[i] = (out[i] + 1.0f) * 0.5f * amplitude / 10.0f;
+        }
+    }
 };
 
 /**
@@ -280,6 +356,15 @@ class MountainGenerator : public TerrainGenerator {
         float height = noise;
         return height * amplitude;
     }
+
+    void generateRow(float *out, float x0, float y, float dx,
+                     int count) override {
+        Noise::fractalRow(out, x0 * scale, y * scale, dx * scale, count,
+                          octaves, persistence);
+        for (int i = 0; i < count; i++) {
+            out[i] = out[i] * amplitude;
+        }
+    }
 };
 
 /**
@@ -304,6 +389,14 @@ class PlainGenerator : public TerrainGenerator {
         float noise = Noise::perlin(x * scale, y * scale);
         return (noise + 1.0f) * 0.5f * amplitude / 2.0f;
     }
+
+    void generateRow(float *out, float x0, float y, float dx,
+                     int count) override {
+        Noise::perlinRow(out, x0 * scale, y * scale, dx * scale, count);
+        for (int i = 0; i < count; i++) {
+            out[i] = (out[i] + 1.0f) * 0.5f * amplitude / 2.0f;
+        }
+    }
 };
 
 /**
@@ -313,10 +406,11 @@ class IslandGenerator : public TerrainGenerator {
   private:
     int numFeatures;
     float scale;
+    WorleyNoise worley;
 
   public:
     IslandGenerator(int numFeatures = 10, float scale = 0.01f)
-        : numFeatures(numFeatures), scale(scale) {}
+        : numFeatures(numFeatures), scale(scale), worley(numFeatures) {}
 
     int getNumFeatures() const { return numFeatures; }
     float getScale() const { return scale; }
@@ -325,10 +419,18 @@ class IslandGenerator : public TerrainGenerator {
      * @brief Produces island-style plateaus using cellular noise.
      */
     float generateHeight(float x, float y) override {
-        WorleyNoise worley(numFeatures);
         float noise = worley.noise(x * scale, y * scale);
         return std::clamp(noise, 0.0f, 1.0f);
     }
+
+    void generateRow(float *out, float x0, float y, float dx,
+                     int count) override {
+        worley.fillGrid(out, x0 * scale, y * scale, dx * scale, 0.0f, count,
+                        1);
+        for (int i = 0; i < count; i++) {
+            out[i] = std::clamp(out[i], 0.0f, 1.0f);
+        }
+    }
 };
 
 /**
@@ -365,6 +467,20 @@ class CompoundGenerator : public TerrainGenerator {
         }
         return height;
     }
+
+    void generateRow(float *out, float x0, float y, float dx,
+                     int count) override {
+        std::fill(out, out + count, 0.0f);
+        // Local rather than thread_local so a nested compound does not write
+        // its layers into the buffer its parent is summing.
+        std::vector<float> layer(count);
+        for (auto &g : generators) {
+            g->generateRow(layer.data(), x0, y, dx, count);
+            for (int i = 0; i < count; i++) {
+                out[i] += layer[i];
+            }
+        }
+    }
 };
 
 #endif // AURORA_PROCEDURAL_H
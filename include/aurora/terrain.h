@@ -346,6 +346,57 @@ class Terrain : public GameObject {
      */
     float seaLevel = 16.f;
 
+    /**
+     * @brief Returns the world-space terrain height under a point.
+     *
+     * Heights are read from a 16-bit copy of the heightmap kept on the CPU
+     * and interpolated bilinearly. Points outside the terrain take the height
+     * of the nearest edge. The terrain rotation is not taken into account.
+     *
+     * @param x World-space X coordinate.
+     * @param z World-space Z coordinate.
+     * @return (float) World-space Y coordinate of the surface.
+     */
+    float sampleHeight(float x, float z) const;
+    /**
+     * @brief Returns the world-space surface normal under a point.
+     */
+    Normal3d sampleNormal(float x, float z) const;
+    /**
+     * @brief Samples the height under many points at once.
+     *
+     * @param points World-space positions, with `y` holding the Z coordinate.
+     * @param heights Output array with room for `count` heights.
+     * @param count Number of points to sample.
+     */
+    void sampleHeights(const Position2d *points, float *heights,
+                       size_t count) const;
+    /**
+     * @brief Samples the surface normal under many points at once.
+     *
+     * @param points World-space positions, with `y` holding the Z coordinate.
+     * @param normals Output array with room for `count` normals.
+     * @param count Number of points to sample.
+     */
+    void sampleNormals(const Position2d *points, Normal3d *normals,
+                       size_t count) const;
+
+    /**
+     * @brief Builds a physics collider matching the rendered surface.
+     *
+     * \subsection terrain-collider-example Example
+     * ```cpp
+     * terrain.initialize();
+     * auto rigidbody = std::make_shared<Rigidbody>();
+     * terrain.addComponent(rigidbody);
+     * rigidbody->addHeightFieldCollider(terrain.createCollider());
+     * ```
+     *
+     * @return (std::shared_ptr<bezel::HeightFieldCollider>) The collider, or
+     * nullptr if the terrain has not been initialized.
+     */
+    std::shared_ptr<bezel::HeightFieldCollider> createCollider() const;
+
   private:
     std::shared_ptr<opal::DrawingState> drawingState;
     std::shared_ptr<opal::Buffer> vertexBuffer;
@@ -364,13 +415,21 @@ class Terrain : public GameObject {
     std::vector<uint8_t> moistureData;
     std::vector<uint8_t> temperatureData;
 
+    /** @brief Heights in [0, 1] quantized to 16 bits, row by row. */
+    std::vector<uint16_t> heightfield;
+    int heightfieldWidth = 0;
+    int heightfieldDepth = 0;
+
     unsigned int patch_count;
     unsigned int rez;
 
-    void generateBiomes(unsigned char *heightmapData, int width, int height,
-                        int nChannels);
-    void generateMaps(unsigned char *heightmapData, int width, int height,
-                      int generationParameter, int nChannels);
+    void generateBiomes(const float *heights, int width, int height);
+    void generateMaps(const float *heights, int width, int height,
+                      bool moisture, bool temperature);
+    void storeHeightfield(const std::vector<float> &heights, int width,
+                          int height);
+    float heightfieldAt(float column, float row) const;
+    Position2d toHeightfield(float x, float z) const;
 };
 
 namespace aurora {
@@ -386,6 +445,29 @@ namespace aurora {
  */
 float computeSlope(const uint8_t *heightMap, int width, int height, int x,
                    int y);
+
+/**
+ * @brief Computes the slope factor on a heightmap normalized to [0, 1].
+ */
+float computeSlope(const float *heightMap, int width, int height, int x,
+                   int y);
+
+/**
+ * @brief Applies the depth, culling and patch state used to draw terrain.
+ *
+ * @param pipeline Pipeline created from the terrain shader program.
+ * @param patchVertices Number of control points per patch.
+ */
+void configureTerrainPipeline(const std::shared_ptr<opal::Pipeline> &pipeline,
+                              unsigned int patchVertices);
+
+/**
+ * @brief Uploads the biome, light, shadow and camera uniforms shared by every
+ * terrain draw of a frame.
+ */
+void bindTerrainEnvironment(const std::shared_ptr<opal::Pipeline> &pipeline,
+                            std::vector<Biome> &biomes, float maxPeak,
+                            float seaLevel, int objectId);
 } // namespace aurora
 
 #endif // AURORA_TERRAIN_H
@@ -11,8 +11,11 @@
 #define BEZEL_H
 
 #include "atlas/units.h"
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <span>
 #include <string>
 #include <variant>
 #include <vector>
@@ -50,6 +53,42 @@ namespace bezel {
 
 constexpr uint32_t INVALID_JOLT_ID = UINT32_MAX;
 
+/**
+ * @brief Bitmask of interned tags, one bit per tag ID. Queries taking a tag
+ * mask only report bodies sharing at least one bit with it; a mask of zero
+ * disables tag filtering.
+ */
+using TagMask = uint64_t;
+
+/** @brief Maximum number of distinct tags that can be interned. */
+constexpr uint32_t MAX_TAGS = 64;
+/** @brief Tag ID returned when a tag is unknown or cannot be interned. */
+constexpr uint32_t INVALID_TAG = UINT32_MAX;
+
+/**
+ * @brief Interns a tag name, registering it on first use.
+ *
+ * @param tag The tag name.
+ * @return (uint32_t) The tag ID, or INVALID_TAG once MAX_TAGS distinct tags
+ * have been registered.
+ */
+uint32_t internTag(const std::string &tag);
+/**
+ * @brief Looks up the ID of a tag without registering it.
+ *
+ * @param tag The tag name.
+ * @return (uint32_t) The tag ID, or INVALID_TAG if it was never interned.
+ */
+uint32_t findTag(const std::string &tag);
+/**
+ * @brief Builds the mask matching any of the given tags, interning them as
+ * needed.
+ *
+ * @param tags The tag names.
+ * @return (TagMask) The combined mask, zero if no tag could be interned.
+ */
+TagMask makeTagMask(const std::vector<std::string> &tags);
+
 /**
  * @brief Maps between an underlying physics engine ID and an Atlas object ID.
  */
@@ -158,6 +197,42 @@ class MeshCollider : public Collider {
 #endif
 };
 
+/**
+ * @brief Regular grid of height samples, such as a terrain.
+ *
+ * A sample at column `x` and row `z` sits at
+ * `offset + scale * (x, heights[z * sampleCount + x], z)` in body space.
+ * Queries against it only touch the cells under the probe, so they stay
+ * cheap however large the grid is.
+ *
+ * \note Height fields are only supported on static bodies.
+ */
+class HeightFieldCollider : public Collider {
+  public:
+    /** @brief Square grid of `sampleCount * sampleCount` heights. */
+    std::vector<float> heights;
+    /** @brief Samples along each side of the grid. */
+    uint32_t sampleCount = 0;
+    /** @brief Body-space position of the first sample at height zero. */
+    Position3d offset;
+    /** @brief Spacing between samples and multiplier of each height. */
+    Position3d scale = {1.0, 1.0, 1.0};
+
+    float getMinExtent() const override {
+        const float span = static_cast<float>(sampleCount) - 1.0f;
+        return std::min(span * scale.x, span * scale.z);
+    }
+
+    HeightFieldCollider(const std::vector<float> &heights,
+                        uint32_t sampleCount, const Position3d &offset,
+                        const Position3d &scale)
+        : heights(heights), sampleCount(sampleCount), offset(offset),
+          scale(scale) {}
+#ifndef BEZEL_NATIVE
+    JPH::RefConst<JPH::Shape> getJoltShape() const override;
+#endif
+};
+
 /**
  * @brief Dispatch interface used to surface collision events to the engine.
  */
@@ -216,6 +291,7 @@ struct SweepHit {
     float percentage = 0.0f;
     Position3d position = {0.0f, 0.0f, 0.0f};
     Normal3d normal = {0.0f, 0.0f, 0.0f};
+    bool didHit = false;
 };
 
 /**
@@ -227,6 +303,30 @@ struct SweepResult {
     bool hitAny = false;
 };
 
+/**
+ * @brief Single ray of a batched raycast.
+ */
+struct RayQuery {
+    Position3d origin = {0.0f, 0.0f, 0.0f};
+    Position3d direction = {0.0f, 0.0f, 1.0f};
+    float maxDistance = 1000.0f;
+    uint32_t ignoreBodyId = INVALID_JOLT_ID;
+    TagMask requiredTags = 0;
+};
+
+/**
+ * @brief Single shape cast of a batched sweep. The collider is borrowed and
+ * must stay alive until the batch returns.
+ */
+struct ShapeCastQuery {
+    const Collider *collider = nullptr;
+    Position3d startPosition = {0.0f, 0.0f, 0.0f};
+    Rotation3d startRotation = {0.0f, 0.0f, 0.0f};
+    Position3d direction = {0.0f, 0.0f, 0.0f};
+    uint32_t ignoreBodyId = INVALID_JOLT_ID;
+    TagMask requiredTags = 0;
+};
+
 /**
  * @brief Marker type representing the static world as a joint endpoint.
  */
@@ -500,6 +600,13 @@ struct Rigidbody {
     /** @brief Quaternion rotation representation in world space. */
     glm::quat rotationQuat = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
 
+    /** @brief Position before the latest fixed step, used to interpolate. */
+    Position3d previousPosition;
+    /** @brief Rotation before the latest fixed step, used to interpolate. */
+    glm::quat previousRotationQuat = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    /** @brief Whether the previous transform has been captured yet. */
+    bool hasPreviousTransform = false;
+
     bool isSensor = false;
     std::string sensorSignal;
 
@@ -507,7 +614,19 @@ struct Rigidbody {
     float friction = 0.5f;
     float restitution = 0.0f;
 
+    /** @brief Tag names, mirrored by tagMask for filtering. */
     std::vector<std::string> tags;
+    /** @brief Interned mask of `tags`, maintained by addTag and removeTag. */
+    TagMask tagMask = 0;
+    /** @brief Whether tagMask still has to be pushed to the backend body. */
+    bool tagsDirty = false;
+
+    /** @brief Returns true if the body carries the given tag. */
+    bool hasTag(const std::string &tag) const;
+    /** @brief Adds a tag and updates the tag mask. */
+    void addTag(const std::string &tag);
+    /** @brief Removes a tag and updates the tag mask. */
+    void removeTag(const std::string &tag);
 
     Position3d linearVelocity = {-1.0f, -1.0f, -1.0f};
     Position3d angularVelocity = {-1.0f, -1.0f, -1.0f};
@@ -532,26 +651,31 @@ struct Rigidbody {
 
     RaycastResult raycast(const Position3d &direction, float maxDistance,
                           const std::shared_ptr<PhysicsWorld> &world,
-                          uint32_t ignoreBodyId = INVALID_JOLT_ID) const;
+                          uint32_t ignoreBodyId = INVALID_JOLT_ID,
+                          TagMask requiredTags = 0) const;
     RaycastResult raycastAll(const Position3d &direction, float maxDistance,
                              const std::shared_ptr<PhysicsWorld> &world,
-                             uint32_t ignoreBodyId = INVALID_JOLT_ID) const;
+                             uint32_t ignoreBodyId = INVALID_JOLT_ID,
+                             TagMask requiredTags = 0) const;
 
     OverlapResult overlap(const std::shared_ptr<PhysicsWorld> &world,
                           std::shared_ptr<Collider> collider,
                           const Position3d &position,
                           const Rotation3d &rotation,
-                          uint32_t ignoreBodyId = INVALID_JOLT_ID) const;
+                          uint32_t ignoreBodyId = INVALID_JOLT_ID,
+                          TagMask requiredTags = 0) const;
 
     SweepResult sweep(const std::shared_ptr<PhysicsWorld> &world,
                       std::shared_ptr<Collider> collider,
                       const Position3d &direction, Position3d &endPosition,
-                      uint32_t ignoreBodyId = INVALID_JOLT_ID) const;
+                      uint32_t ignoreBodyId = INVALID_JOLT_ID,
+                      TagMask requiredTags = 0) const;
 
     SweepResult sweepAll(const std::shared_ptr<PhysicsWorld> &world,
                          std::shared_ptr<Collider> collider,
                          const Position3d &direction, Position3d &endPosition,
-                         uint32_t ignoreBodyId = INVALID_JOLT_ID) const;
+                         uint32_t ignoreBodyId = INVALID_JOLT_ID,
+                         TagMask requiredTags = 0) const;
 
     std::shared_ptr<Collider> collider;
 
@@ -581,12 +705,66 @@ struct Rigidbody {
     void destroy(const std::shared_ptr<PhysicsWorld> &world);
 };
 
+/**
+ * @brief Options used when initializing a physics world.
+ */
+struct PhysicsWorldSettings {
+    /**
+     * @brief Steps the simulation at a fixed rate driven by an accumulator.
+     * When disabled, every update simulates the frame delta directly.
+     */
+    bool useFixedTimeStep = true;
+    /** @brief Duration of a single fixed step in seconds. */
+    float fixedTimeStep = 1.0f / 60.0f;
+    /**
+     * @brief Maximum fixed steps simulated in a single update. Time beyond
+     * this cap is dropped so a long hitch cannot snowball into longer frames.
+     */
+    int maxSubSteps = 4;
+
+    /** @brief Size of the pre-allocated per-step temp allocator, in MB. */
+    uint32_t tempAllocatorSizeMB = 16;
+    /** @brief Maximum number of jobs the job system can hold at once. */
+    uint32_t maxJobs = 4096;
+    /** @brief Maximum number of job barriers the job system can hold. */
+    uint32_t maxBarriers = 64;
+    /**
+     * @brief Number of physics worker threads. Negative values pick
+     * `hardware_concurrency() - 1`; zero runs every job on the calling thread.
+     */
+    int workerThreads = -1;
+    /**
+     * @brief Pins each worker thread to its own core, starting at
+     * `firstPinnedCore`. Only honored on platforms exposing thread affinity.
+     */
+    bool pinWorkerThreads = false;
+    /** @brief First core used when pinning worker threads. */
+    uint32_t firstPinnedCore = 1;
+};
+
+/**
+ * @brief Memory statistics of the physics temp allocator.
+ */
+struct TempAllocatorStats {
+    /** @brief Size of the pre-allocated pool in bytes. */
+    std::size_t capacity = 0;
+    /** @brief Largest pool usage observed since init, in bytes. */
+    std::size_t highWaterMark = 0;
+    /** @brief Allocations that did not fit and went to the heap instead. */
+    std::size_t fallbackAllocations = 0;
+};
+
 /**
  * @brief Physics world owning the backend simulation state.
  */
 class PhysicsWorld {
+    PhysicsWorldSettings settings;
+    float accumulator = 0.0f;
+    float interpolationAlpha = 1.0f;
+    int lastStepCount = 0;
+
 #ifndef BEZEL_NATIVE
-    std::unique_ptr<JPH::TempAllocatorMalloc> tempAllocator;
+    std::unique_ptr<PooledTempAllocator> tempAllocator;
     std::unique_ptr<JPH::JobSystemThreadPool> jobSystem;
 
     BroadPhaseLayerImpl broadPhaseLayerInterface;
@@ -596,6 +774,11 @@ class PhysicsWorld {
 
     std::vector<BodyIdentifier> bodies;
 
+    void step(float dt);
+    void storePreviousTransforms();
+    void parallelFor(
+        std::size_t count, std::size_t minChunkSize,
+        const std::function<void(std::size_t, std::size_t)> &fn) const;
 #endif
   public:
 #ifndef BEZEL_NATIVE
@@ -612,37 +795,78 @@ class PhysicsWorld {
     bool initialized = false;
 
     /** @brief Initializes the backend physics system. */
-    void init();
+    void init(const PhysicsWorldSettings &settings = {});
 
-    /** @brief Advances the physics simulation by `dt` seconds. */
+    /**
+     * @brief Advances the physics simulation by `dt` seconds. In fixed-step
+     * mode the time is accumulated and simulated in whole fixed steps.
+     */
     void update(float dt);
 
+    /** @brief Returns the settings the world was initialized with. */
+    const PhysicsWorldSettings &getSettings() const { return settings; }
+    /** @brief Returns whether the world runs in fixed-step mode. */
+    bool usesFixedTimeStep() const { return settings.useFixedTimeStep; }
+    /**
+     * @brief Returns how far the accumulator is into the next fixed step, in
+     * [0, 1). Render transforms blend the previous and current body states by
+     * this factor. Always 1 outside fixed-step mode.
+     */
+    float getInterpolationAlpha() const { return interpolationAlpha; }
+    /** @brief Returns how many steps the latest update simulated. */
+    int getLastStepCount() const { return lastStepCount; }
+    /** @brief Returns the usage statistics of the temp allocator. */
+    TempAllocatorStats getTempAllocatorStats() const;
+
     RaycastResult raycast(const Position3d &origin, const Position3d &direction,
                           float maxDistance,
-                          uint32_t ignoreBodyId = INVALID_JOLT_ID) const;
+                          uint32_t ignoreBodyId = INVALID_JOLT_ID,
+                          TagMask requiredTags = 0) const;
     RaycastResult raycastAll(const Position3d &origin,
                              const Position3d &direction, float maxDistance,
-                             uint32_t ignoreBodyId = INVALID_JOLT_ID) const;
+                             uint32_t ignoreBodyId = INVALID_JOLT_ID,
+                             TagMask requiredTags = 0) const;
 
     OverlapResult overlap(const std::shared_ptr<PhysicsWorld> &world,
                           const std::shared_ptr<Collider> &collider,
                           const Position3d &position,
                           const Rotation3d &rotation,
-                          uint32_t ignoreBodyId = INVALID_JOLT_ID) const;
+                          uint32_t ignoreBodyId = INVALID_JOLT_ID,
+                          TagMask requiredTags = 0) const;
 
     SweepResult sweep(const std::shared_ptr<PhysicsWorld> &world,
                       const std::shared_ptr<Collider> &collider,
                       const Position3d &startPosition,
                       const Rotation3d &startRotation,
                       const Position3d &direction, Position3d &endPosition,
-                      uint32_t ignoreBodyId = INVALID_JOLT_ID) const;
+                      uint32_t ignoreBodyId = INVALID_JOLT_ID,
+                      TagMask requiredTags = 0) const;
 
     SweepResult sweepAll(const std::shared_ptr<PhysicsWorld> &world,
                          const std::shared_ptr<Collider> &collider,
                          const Position3d &startPosition,
                          const Rotation3d &startRotation,
                          const Position3d &direction, Position3d &endPosition,
-                         uint32_t ignoreBodyId = INVALID_JOLT_ID) const;
+                         uint32_t ignoreBodyId = INVALID_JOLT_ID,
+                         TagMask requiredTags = 0) const;
+
+    /**
+     * @brief Casts every ray in `rays` and writes the closest hit of ray `i`
+     * into `results[i]`. `results` must hold at least `rays.size()` entries,
+     * so a caller can reuse the same buffer every frame. Large batches are
+     * split across the physics job system. Must not be called while the
+     * world is updating.
+     */
+    void raycastBatch(std::span<const RayQuery> rays,
+                      std::span<RaycastHit> results) const;
+
+    /**
+     * @brief Sweeps every shape in `casts` and writes the closest hit of cast
+     * `i` into `results[i]`. Follows the same buffer and threading rules as
+     * raycastBatch(). Casts that share a collider share one Jolt shape.
+     */
+    void sweepBatch(std::span<const ShapeCastQuery> casts,
+                    std::span<SweepHit> results) const;
 
     /** @brief Adds a rigidbody to the simulation. */
     void addBody(const std::shared_ptr<bezel::Rigidbody> &body);
@@ -9,6 +9,7 @@
 
 #ifndef BEZEL_JOLT_WORLD_H
 #define BEZEL_JOLT_WORLD_H
+#include <cstddef>
 #include <map>
 #ifndef BEZEL_NATIVE
 
@@ -41,6 +42,7 @@
 #include <Jolt/Physics/Collision/Shape/SphereShape.h>
 #include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
 #include <Jolt/Physics/Collision/Shape/MeshShape.h>
+#include <Jolt/Physics/Collision/Shape/HeightFieldShape.h>
 
 #include <Jolt/Physics/Collision/RayCast.h>
 #include <Jolt/Physics/Collision/CastResult.h>
@@ -136,6 +138,32 @@ class ObjectVsBroadPhaseLayerFilterImpl final
                        JPH::BroadPhaseLayer inLayer2) const override;
 };
 
+/**
+ * @brief Pre-sized linear allocator handed to Jolt for per-step temporary
+ * memory. It records the peak usage so the pool can be tuned, and falls back
+ * to the heap (counting each fallback) instead of failing when a step needs
+ * more than the pool holds.
+ */
+class PooledTempAllocator final : public JPH::TempAllocator {
+  public:
+    explicit PooledTempAllocator(JPH::uint size) : pool(size) {}
+
+    void *Allocate(JPH::uint inSize) override;
+    void Free(void *inAddress, JPH::uint inSize) override;
+
+    /** @brief Returns the pool size in bytes. */
+    std::size_t getCapacity() const { return pool.GetSize(); }
+    /** @brief Returns the largest pool usage observed, in bytes. */
+    std::size_t getHighWaterMark() const { return highWaterMark; }
+    /** @brief Returns how many allocations did not fit in the pool. */
+    std::size_t getFallbackCount() const { return fallbackAllocations; }
+
+  private:
+    JPH::TempAllocatorImpl pool;
+    std::size_t highWaterMark = 0;
+    std::size_t fallbackAllocations = 0;
+};
+
 class BodyActivationListenerMain final : public JPH::BodyActivationListener {
   public:
     void OnBodyActivated(const JPH::BodyID &inBodyID,
@@ -17,10 +17,13 @@
 #include <memory>
 #include "atlas/units.h"
 
-class Window;
 class Shape;
 struct Point;
 
+namespace bezel {
+class NativeWorld;
+} // namespace bezel
+
 /**
  * @brief Structure representing a point of intersection in both world and model
  * space.
@@ -191,11 +194,12 @@ class Body {
     }
 
     /**
-     * @brief Updates the body within the context of a window.
+     * @brief Checks whether the body is currently sleeping. Sleeping bodies
+     * are skipped by the solver until something wakes their island.
      *
-     * @param window The window context for the update.
+     * @return (bool) True if the body is asleep, false otherwise.
      */
-    void update(Window &window);
+    inline bool isAsleep() const { return isSleeping; }
 
     /**
      * @brief Tests static intersection between two bodies.
@@ -235,10 +239,13 @@ class Body {
     void updatePhysics(double dt);
 
   private:
-    std::shared_ptr<Body> thisShared = nullptr;
+    friend class bezel::NativeWorld;
 
     bool isSleeping = false;
     float sleepTimer = 0.0f;
+    int worldIndex = -1;
+    int proxyId = -1;
+    float localTime = 0.0f;
 
     static constexpr float SLEEP_TIME_THRESHOLD = 0.5f;
     static constexpr float SLEEP_LINEAR_THRESHOLD = 0.05f;
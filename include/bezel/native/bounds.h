@@ -10,6 +10,8 @@
 #ifndef BEZEL_BOUNDS_H
 #define BEZEL_BOUNDS_H
 
+#include <array>
+#include <cstddef>
 #include <glm/glm.hpp>
 #include <memory>
 #include <vector>
@@ -85,7 +87,7 @@ class Bounds {
      * @param other The other bounds to check intersection with.
      * @return (bool) True if the bounds intersect, false otherwise.
      */
-    bool doesIntersect(const Bounds &other);
+    bool doesIntersect(const Bounds &other) const;
     /**
      * @brief Expands the bounds to include a set of points.
      *
@@ -106,6 +108,14 @@ class Bounds {
      */
     void expand(const Bounds &rhs);
 
+    /**
+     * @brief Checks if another bounds lies completely inside this one.
+     *
+     * @param other The bounds to test.
+     * @return (bool) True if other is fully contained, false otherwise.
+     */
+    bool contains(const Bounds &other) const;
+
     /**
      * @brief Gets the width of the bounds along the X-axis.
      *
@@ -156,6 +166,88 @@ struct CollisionPair {
  *
  */
 namespace bezel {
+/**
+ * @brief Persistent broadphase based on incremental sweep and prune over the
+ * three world axes. Proxies keep fattened bounds, so a body that moves a
+ * little does not touch the structure at all. The per-axis orders survive
+ * between frames and are repaired with insertion sort, which runs in close
+ * to linear time thanks to frame-to-frame coherence. Candidate pairs are
+ * filtered on full 3D overlap before they are reported.
+ *
+ * \subsection sap-example Example
+ * ```cpp
+ * bezel::SweepAndPrune broadphase;
+ * int proxy = broadphase.addProxy(bounds, bodyIndex);
+ *
+ * // Each frame
+ * broadphase.moveProxy(proxy, newBounds, bodyIndex);
+ * std::vector<CollisionPair> pairs;
+ * broadphase.buildPairs(pairs);
+ * ```
+ */
+class SweepAndPrune {
+  public:
+    /** @brief Distance added around every proxy when its bounds are fattened.
+     */
+    float margin = 0.05f;
+
+    /**
+     * @brief Adds a proxy to the broadphase.
+     *
+     * @param bounds World-space bounds of the proxy.
+     * @param userIndex Index reported back in the collision pairs.
+     * @return (int) Identifier of the new proxy.
+     */
+    int addProxy(const Bounds &bounds, int userIndex);
+    /**
+     * @brief Removes a proxy from the broadphase.
+     *
+     * @param proxy Identifier returned by addProxy.
+     */
+    void removeProxy(int proxy);
+    /**
+     * @brief Updates the bounds of a proxy. The stored bounds only change when
+     * the new bounds escape the fattened ones, or when the fattened ones are
+     * more than twice the margin larger than needed on any axis.
+     *
+     * @param proxy Identifier returned by addProxy.
+     * @param bounds New world-space bounds of the proxy.
+     * @param userIndex Index reported back in the collision pairs.
+     * @return (bool) True if the fattened bounds had to be rebuilt.
+     */
+    bool moveProxy(int proxy, const Bounds &bounds, int userIndex);
+    /**
+     * @brief Repairs the axis orders and collects every pair of proxies whose
+     * fattened bounds overlap on all three axes.
+     *
+     * @param pairs Output vector of collision pairs, in user indices.
+     */
+    void buildPairs(std::vector<CollisionPair> &pairs);
+
+    /**
+     * @brief Gets the number of live proxies.
+     *
+     * @return (std::size_t) Number of proxies in the broadphase.
+     */
+    std::size_t getProxyCount() const {
+        return proxies.size() - freeProxies.size();
+    }
+
+  private:
+    struct Proxy {
+        Bounds bounds;
+        int userIndex = -1;
+        bool active = false;
+    };
+
+    std::vector<Proxy> proxies;
+    std::vector<int> freeProxies;
+    std::array<std::vector<int>, 3> axes;
+
+    void sortAxis(int axis);
+    int chooseSweepAxis() const;
+};
+
 /**
  * @brief Comparison function for Sweep and Prune algorithm.
  *
@@ -172,7 +264,7 @@ int compareSAP(void *a, void *b);
  * @param sortedArray Output array of sorted pseudo bodies.
  * @param dt Delta time for prediction.
  */
-void sortBodiesForBounds(std::vector<std::shared_ptr<Body>> bodies,
+void sortBodiesForBounds(const std::vector<std::shared_ptr<Body>> &bodies,
                          std::vector<PseudoBody> &sortedArray, float dt);
 
 /**
@@ -191,17 +283,18 @@ void buildPairs(std::vector<CollisionPair> &pairs,
  * @param pairs Output vector of collision pairs.
  * @param dt Delta time for prediction.
  */
-void sweepAndPrune1d(std::vector<std::shared_ptr<Body>> bodies,
+void sweepAndPrune1d(const std::vector<std::shared_ptr<Body>> &bodies,
                      std::vector<CollisionPair> &pairs, float dt);
 
 /**
- * @brief Performs broad phase collision detection.
+ * @brief Performs broad phase collision detection from scratch. Prefer a
+ * persistent SweepAndPrune when the same bodies are tested every frame.
  *
  * @param bodies Vector of physics bodies.
  * @param pairs Output vector of collision pairs.
  * @param dt Delta time for prediction.
  */
-void broadPhase(std::vector<std::shared_ptr<Body>> bodies,
+void broadPhase(const std::vector<std::shared_ptr<Body>> &bodies,
                 std::vector<CollisionPair> &pairs, float dt);
 } // namespace bezel
 
@@ -0,0 +1,130 @@
+/*
+ world.h
+ As part of the Atlas project
+ Created by Max Van den Eynde in 2025
+ --------------------------------------------------
+ Description: World-level stepping for Bezel Native
+ Copyright (c) 2025 maxvdec
+*/
+
+#ifndef BEZEL_NATIVE_WORLD_H
+#define BEZEL_NATIVE_WORLD_H
+
+#include "bezel/native/body.h"
+#include "bezel/native/bounds.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+namespace bezel {
+
+/**
+ * @brief Owns every Bezel Native body and advances them together. The
+ * broadphase and the contact generation run exactly once per step for the
+ * whole world, and contacts are solved for all bodies in a single pass.
+ * Bodies connected by contacts are grouped in islands that fall asleep and
+ * wake up together.
+ *
+ * \subsection native-world-example Example
+ * ```cpp
+ * bezel::NativeWorld world;
+ * world.gravity = {0.0f, -9.81f, 0.0f};
+ *
+ * auto ground = std::make_shared<Body>();
+ * ground->shape = std::make_shared<Sphere>(100.0f);
+ * ground->position = {0.0f, -100.0f, 0.0f};
+ * world.addBody(ground);
+ *
+ * auto ball = std::make_shared<Body>();
+ * ball->shape = std::make_shared<Sphere>(0.5f);
+ * ball->position = {0.0f, 5.0f, 0.0f};
+ * ball->applyMass(1.0f);
+ * world.addBody(ball);
+ *
+ * // Each frame
+ * world.step(window.getDeltaTime());
+ * ```
+ */
+class NativeWorld {
+  public:
+    /** @brief Gravity acceleration applied to every awake dynamic body. */
+    glm::vec3 gravity = {0.0f, -9.81f, 0.0f};
+    /** @brief Largest time step simulated in a single call to step(). */
+    float maxTimeStep = 0.0333f;
+
+    /**
+     * @brief Registers a body in the world. Adding the same body twice has no
+     * effect.
+     *
+     * @param body The body to add.
+     */
+    void addBody(const std::shared_ptr<Body> &body);
+    /**
+     * @brief Removes a body from the world.
+     *
+     * @param body The body to remove.
+     */
+    void removeBody(const std::shared_ptr<Body> &body);
+    /**
+     * @brief Gets every body registered in the world.
+     *
+     * @return (const std::vector<std::shared_ptr<Body>>&) Registered bodies.
+     */
+    const std::vector<std::shared_ptr<Body>> &getBodies() const {
+        return bodies;
+    }
+
+    /**
+     * @brief Advances the whole world by a time step. Runs the broadphase,
+     * generates contacts, solves them and updates island sleeping.
+     *
+     * @param dt Time step in seconds, clamped to maxTimeStep.
+     */
+    void step(float dt);
+
+    /**
+     * @brief Wakes the island containing the given body.
+     *
+     * @param body The body to wake.
+     */
+    void wake(const std::shared_ptr<Body> &body);
+
+    /** @brief Number of islands found during the last step. */
+    std::size_t getIslandCount() const { return islandCount; }
+    /** @brief Number of broadphase pairs found during the last step. */
+    std::size_t getPairCount() const { return pairs.size(); }
+    /** @brief Number of contacts solved during the last step. */
+    std::size_t getContactCount() const { return contacts.size(); }
+
+    /**
+     * @brief Gets the persistent broadphase used by the world.
+     *
+     * @return (SweepAndPrune&) The world's broadphase.
+     */
+    SweepAndPrune &getBroadphase() { return broadphase; }
+
+  private:
+    std::vector<std::shared_ptr<Body>> bodies;
+    SweepAndPrune broadphase;
+
+    // Scratch storage reused across steps so a frame does not allocate once
+    // the world has warmed up.
+    std::vector<CollisionPair> pairs;
+    std::vector<Contact> contacts;
+    std::vector<int> islandParent;
+    std::vector<int> islandOf;
+    std::vector<uint8_t> islandAwake;
+    std::vector<uint8_t> islandRestless;
+    std::size_t islandCount = 0;
+
+    int findIsland(int index);
+    void mergeIslands(int a, int b);
+    void buildIslands();
+    void updateSleeping(float dt);
+};
+
+} // namespace bezel
+
+#endif // BEZEL_NATIVE_WORLD_H
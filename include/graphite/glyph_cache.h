@@ -0,0 +1,197 @@
+//
+// glyph_cache.h
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: Shared glyph atlas cache definitions
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#ifndef GRAPHITE_GLYPH_CACHE_H
+#define GRAPHITE_GLYPH_CACHE_H
+
+#include "atlas/units.h"
+#include "opal/opal.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct FT_LibraryRec_;
+struct FT_FaceRec_;
+
+/**
+ * @brief Structure that represents a single character in the font atlas.
+ *
+ */
+struct Character {
+    /**
+     * @brief The size of the glyph.
+     *
+     */
+    Size2d size;
+    /**
+     * @brief The offset from the baseline to the top-left of the glyph.
+     *
+     */
+    Position2d bearing;
+    /**
+     * @brief The advance width of the glyph.
+     *
+     */
+    unsigned int advance;
+    /**
+     * @brief The top-left UV coordinate in the atlas.
+     *
+     */
+    Position2d uvMin;
+    /**
+     * @brief The bottom-right UV coordinate in the atlas.
+     *
+     */
+    Position2d uvMax;
+    /**
+     * @brief The glyph cache page holding the glyph bitmap.
+     *
+     */
+    unsigned int page = 0;
+};
+
+namespace graphite {
+
+/**
+ * @brief Decodes the UTF-8 code point starting at `index` and moves `index`
+ * past it. Malformed sequences decode to U+FFFD one byte at a time.
+ *
+ * @param text The UTF-8 encoded text.
+ * @param index Byte offset of the code point, advanced on return.
+ * @return (uint32_t) The decoded code point.
+ */
+uint32_t decodeUtf8(const std::string &text, size_t &index);
+
+/**
+ * @brief Process-wide cache of rasterized glyphs.
+ *
+ * FreeType faces are opened once per font file and shared by every font size.
+ * Glyphs are rasterized the first time a (face, size, code point) triple is
+ * requested and packed on shelves into atlas pages. Once `maxPages` pages are
+ * full, the least recently used page is cleared and reused, so any code point
+ * a face provides can be drawn without baking a fixed range up front.
+ *
+ * \subsection glyph-cache-example Example
+ * ```cpp
+ * auto &cache = graphite::GlyphCache::getInstance();
+ * int face = cache.loadFace("fonts/Inter.ttf");
+ * const Character *glyph = cache.getGlyph(face, 32, 0x00E9); // é
+ * cache.upload();
+ * ```
+ *
+ * \note The cache is not thread-safe; use it from the render thread.
+ * \note This is an alpha API and may change.
+ */
+class GlyphCache {
+  public:
+    GlyphCache(const GlyphCache &) = delete;
+    GlyphCache &operator=(const GlyphCache &) = delete;
+
+    static GlyphCache &getInstance() {
+        static GlyphCache instance;
+        return instance;
+    }
+
+    /**
+     * @brief Side length, in pixels, of every atlas page.
+     */
+    static constexpr int PAGE_SIZE = 1024;
+
+    /**
+     * @brief Number of pages kept before the least recently used one is
+     * recycled.
+     */
+    size_t maxPages = 8;
+
+    /**
+     * @brief Opens the face stored in a font file, or returns the one already
+     * opened for it.
+     *
+     * @param path Path to the font file.
+     * @return (int) Face identifier, or -1 if the file cannot be loaded.
+     */
+    int loadFace(const std::string &path);
+
+    /**
+     * @brief Returns the glyph for a code point, rasterizing it on first use.
+     *
+     * The pointer stays valid until the page holding the glyph is recycled,
+     * which bumps `getGeneration()`.
+     *
+     * @param face Face identifier returned by `loadFace`.
+     * @param size Font size in points.
+     * @param codepoint Unicode code point to look up.
+     * @return (const Character *) The glyph, or nullptr if it cannot be
+     * loaded.
+     */
+    const Character *getGlyph(int face, int size, uint32_t codepoint);
+
+    /**
+     * @brief Uploads the pages that received new glyphs since the last call.
+     */
+    void upload();
+
+    /**
+     * @brief Returns the texture backing an atlas page.
+     */
+    std::shared_ptr<opal::Texture> getPageTexture(unsigned int page) const;
+
+    /**
+     * @brief Counter bumped every time a page is recycled. Cached glyph data
+     * built with an older generation must be looked up again.
+     */
+    uint64_t getGeneration() const { return generation; }
+
+    /** @brief Number of atlas pages currently allocated. */
+    size_t getPageCount() const { return pages.size(); }
+
+  private:
+    GlyphCache() = default;
+    ~GlyphCache();
+
+    struct Shelf {
+        int y = 0;
+        int height = 0;
+        int cursor = 0;
+    };
+
+    struct Page {
+        std::vector<uint8_t> pixels;
+        std::shared_ptr<opal::Texture> texture;
+        std::vector<Shelf> shelves;
+        std::vector<uint64_t> glyphs;
+        int nextShelf = 0;
+        uint64_t lastUsed = 0;
+        bool dirty = false;
+    };
+
+    struct Face {
+        std::string path;
+        FT_FaceRec_ *handle = nullptr;
+        int activeSize = 0;
+    };
+
+    FT_LibraryRec_ *library = nullptr;
+    std::vector<Face> faces;
+    std::vector<Page> pages;
+    std::unordered_map<uint64_t, Character> glyphs;
+    uint64_t useCounter = 0;
+    uint64_t generation = 0;
+
+    bool allocate(int width, int height, unsigned int &page, int &x, int &y);
+    bool place(Page &page, int width, int height, int &x, int &y);
+    void recycle(unsigned int page);
+};
+
+} // namespace graphite
+
+#endif // GRAPHITE_GLYPH_CACHE_H
@@ -15,8 +15,10 @@
 #include "atlas/units.h"
 #include "atlas/window.h"
 #include "atlas/workspace.h"
+#include "graphite/glyph_cache.h"
 #include "graphite/style.h"
 #include <algorithm>
+#include <cstdint>
 #include <map>
 #include "opal/opal.h"
 #include <string>
@@ -24,41 +26,10 @@
 #include <utility>
 #include <vector>
 
-/**
- * @brief Structure that represents a single character in the font atlas.
- *
- */
-struct Character {
-    /**
-     * @brief The size of the glyph.
-     *
-     */
-    Size2d size;
-    /**
-     * @brief The offset from the baseline to the top-left of the glyph.
-     *
-     */
-    Position2d bearing;
-    /**
-     * @brief The advance width of the glyph.
-     *
-     */
-    unsigned int advance;
-    /**
-     * @brief The top-left UV coordinate in the atlas.
-     *
-     */
-    Position2d uvMin;
-    /**
-     * @brief The bottom-right UV coordinate in the atlas.
-     *
-     */
-    Position2d uvMax;
-};
-
 /**
  * @brief A map that associates characters with their corresponding glyph
- * information.
+ * information. Fonts keep the ASCII range here for measuring; other code
+ * points are looked up through `Font::glyph`.
  *
  */
 typedef std::map<char, Character> FontAtlas;
@@ -99,10 +70,15 @@ struct Font {
      */
     Resource resource;
     /**
-     * @brief The texture atlas containing all glyphs.
+     * @brief The glyph cache page holding the ASCII glyphs.
      *
      */
     std::shared_ptr<opal::Texture> texture;
+    /**
+     * @brief The shared FreeType face in the glyph cache.
+     *
+     */
+    int face = -1;
 
     /**
      * @brief Creates a font from a resource.
@@ -122,6 +98,15 @@ struct Font {
      */
     static Font &getFont(const std::string &fontName);
 
+    /**
+     * @brief Looks up the glyph for any code point, rasterizing it into the
+     * shared glyph cache on first use.
+     *
+     * @param codepoint The Unicode code point.
+     * @return (const Character *) The glyph, or nullptr if it is unavailable.
+     */
+    const Character *glyph(uint32_t codepoint) const;
+
     /**
      * @brief Changes the size of the font. \warning This will regenerate the
      * font. Use it when performance is not a concern.
@@ -250,11 +235,33 @@ class Text : public UIObject {
     std::shared_ptr<opal::DrawingState> vao = nullptr;
     std::shared_ptr<opal::Buffer> vertexBuffer = nullptr;
     size_t vertexBufferCapacity = sizeof(float) * 6 * 4; // capacity in bytes
+    /**
+     * @brief Glyph quads laid out relative to `position`, uploaded as a
+     * single stream.
+     */
+    std::vector<float> glyphVertices;
+    /** @brief Glyphs sharing a glyph cache page, drawn together. */
+    struct GlyphRange {
+        unsigned int page = 0;
+        size_t firstVertex = 0;
+        size_t vertexCount = 0;
+    };
+    std::vector<GlyphRange> glyphRanges;
+    /** @brief Inputs the uploaded glyph quads were built from. */
+    std::string layoutContent;
+    int layoutFace = -1;
+    int layoutFontSize = 0;
+    uint64_t layoutGeneration = 0;
+    float layoutScale = 0.0f;
+    Size2d layoutPadding;
+    bool layoutDirty = true;
     glm::mat4 projection;
     ShaderProgram shader;
     graphite::BoxRendererData backgroundRenderer;
     graphite::UIStyle localStyle;
     bool usesLocalStyle = false;
+
+    void layoutGlyphs(const Font &font, float scale, const Size2d &padding);
 };
 
 #endif // ATLAS_TEXT_H
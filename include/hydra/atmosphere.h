@@ -16,6 +16,7 @@
 #include "atlas/texture.h"
 #include "atlas/units.h"
 #include <array>
+#include <filesystem>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -51,15 +52,39 @@ class WorleyNoise3D {
      */
     Id get3dTextureAtAllChannels(int res) const;
 
+    /**
+     * @brief Computes the RGBA voxels of the detail layer without creating
+     * a texture.
+     */
+    std::vector<float> getDetailData(int res) const;
+
+    int getFrequency() const { return frequency; }
+    int getDivisions() const { return numberOfDivisions; }
+
   private:
+    friend class Clouds;
+
+    /** @brief Distances to the three closest feature points. */
+    struct Distances {
+        float f1;
+        float f2;
+        float f3;
+    };
+
     int frequency;
     int numberOfDivisions;
-    std::vector<glm::vec3> featurePoints;
+    /**
+     * @brief Feature points of every cell as structure of arrays, padded
+     * with unreachable points to a multiple of four.
+     */
+    int featureStride = 0;
+    std::vector<float> featureX;
+    std::vector<float> featureY;
+    std::vector<float> featureZ;
 
     void generateFeaturePoints();
     float getWorleyNoise(float x, float y, float z, int octave) const;
-    std::vector<float> getClosestDistances(float x, float y, float z,
-                                           int count) const;
+    Distances getClosestDistances(float x, float y, float z) const;
     glm::ivec3 getGridCell(float x, float y, float z) const;
     int getCellIndex(int cx, int cy, int cz) const;
 
@@ -78,9 +103,24 @@ class Clouds {
 
     /**
      * @brief Builds a 3D procedural cloud texture at the requested resolution.
+     *
+     * The baked volume is stored in `cacheDirectory`, so the noise is only
+     * generated once for each set of Worley parameters and resolution.
      */
     Id getCloudTexture(int res) const;
 
+    /**
+     * @brief Directory holding baked cloud volumes as half floats, named
+     * after a hash of the parameters that produced them. An empty path
+     * disables the cache.
+     */
+    std::filesystem::path cacheDirectory = getDefaultCacheDirectory();
+
+    /**
+     * @brief Default cache location inside the system temporary directory.
+     */
+    static std::filesystem::path getDefaultCacheDirectory();
+
     /**
      * @brief Center of the cloud volume in world space.
      */
@@ -14,10 +14,11 @@
 #include "atlas/core/shader.h"
 #include "atlas/texture.h"
 #include "atlas/units.h"
+#include "hydra/wave_field.h"
 #include "opal/opal.h"
-#include <array>
 #include <glm/glm.hpp>
 #include <memory>
+#include <vector>
 
 class Window;
 
@@ -51,6 +52,10 @@ class Window;
  *
  * // The fluid automatically captures reflections and refractions
  * // during the render pass
+ *
+ * // Optionally simulate the surface so objects can float on it
+ * waterSurface.enableSimulation(128);
+ * waterSurface.disturb(Position3d(0.0f, -2.0f, 0.0f), 1.5f, -2.0f);
  * ```
  *
  */
@@ -59,6 +64,31 @@ struct Fluid : GameObject {
      * @brief Speed multiplier for texture-driven wave animation.
      */
     float waveVelocity = 0.0f;
+    /**
+     * @brief Size of the reflection and refraction captures relative to the
+     * window render scale.
+     */
+    float captureRenderScale = 0.5f;
+    /**
+     * @brief Objects farther than this from the camera are left out of the
+     * captures. Zero keeps every visible object.
+     */
+    float captureDrawDistance = 0.0f;
+    /**
+     * @brief Whether objects in the captures sample shadow maps.
+     */
+    bool captureShadows = false;
+    /**
+     * @brief Renders at most one capture per frame, alternating between
+     * reflection and refraction. The older capture is reprojected with the
+     * camera it was taken from. Off by default on Metal, whose fluid shader
+     * samples the captures at the current screen position.
+     */
+#ifdef METAL
+    bool amortizeCaptures = false;
+#else
+    bool amortizeCaptures = true;
+#endif
 
     /**
      * @brief Constructs an uninitialized fluid surface.
@@ -88,8 +118,8 @@ struct Fluid : GameObject {
                 bool updatePipeline = false) override;
 
     /**
-     * @brief Triggers the generation of reflection and refraction render
-     * targets for the current frame.
+     * @brief Renders the pending reflection and refraction captures. With
+     * `amortizeCaptures` only one of them is rendered per frame.
      */
     void updateCapture(
         Window &window,
@@ -138,6 +168,50 @@ struct Fluid : GameObject {
      */
     void setWaterColor(const Color &color);
 
+    /**
+     * @brief Simulates the surface with a heightfield stepped every frame.
+     * The plane is subdivided so the waves displace it, and the simulation
+     * can be queried with `sampleHeight` and `sampleVelocity`.
+     *
+     * @param resolution Cells along each side of the heightfield.
+     */
+    void enableSimulation(int resolution = 128);
+    /**
+     * @brief Stops the simulation and goes back to a flat plane.
+     */
+    void disableSimulation();
+    bool isSimulated() const { return waveField.isCreated(); }
+
+    /**
+     * @brief Pushes the simulated water around a world-space point.
+     *
+     * @param point Point on or near the surface.
+     * @param radius Radius of the disturbance in world units.
+     * @param strength Vertical velocity added at the center. Negative values
+     * push the water down.
+     */
+    void disturb(const Position3d &point, float radius, float strength);
+
+    /**
+     * @brief Samples the surface height for a batch of world-space points.
+     * Heights are measured along `getSurfaceNormal()` from the origin, so
+     * for an unrotated fluid they are the world Y of the water above or
+     * below each point. Points outside the surface read its closest edge.
+     */
+    void sampleHeight(const std::vector<Position3d> &points,
+                      std::vector<float> &heights) const;
+    /**
+     * @brief Samples the world-space water velocity for a batch of
+     * world-space points.
+     */
+    void sampleVelocity(const std::vector<Position3d> &points,
+                        std::vector<Velocity3d> &velocities) const;
+
+    /**
+     * @brief Returns the world-space normal of the resting surface.
+     */
+    glm::vec3 getSurfaceNormal() const { return calculatePlaneNormal(); }
+
     bool isCreated() const { return fluidShader.programId != 0; }
 
     /**
@@ -163,6 +237,11 @@ struct Fluid : GameObject {
      * @brief Flow map used to animate surface movement.
      */
     Texture movementTexture;
+    /**
+     * @brief Heightfield behind the simulated surface. Wave speed and
+     * damping can be tuned directly.
+     */
+    WaveField waveField;
 
   private:
     struct FluidVertex {
@@ -173,9 +252,13 @@ struct Fluid : GameObject {
         glm::vec3 bitangent;
     };
 
-    void buildPlaneGeometry();
+    void buildPlaneGeometry(int subdivisions);
+    void uploadGeometry();
+    void updateWaveTexture();
     void updateModelMatrix();
     glm::vec3 getFinalScale() const;
+    void toSurface(const std::vector<Position3d> &points,
+                   std::vector<glm::vec2> &surfacePoints) const;
 
     Size2d extent{1.0, 1.0};
     Position3d position{0.0, 0.0, 0.0};
@@ -193,19 +276,33 @@ struct Fluid : GameObject {
     glm::mat4 viewMatrix{1.0f};
     glm::mat4 projectionMatrix{1.0f};
 
-    std::array<FluidVertex, 4> vertices{};
-    std::array<unsigned int, 6> indices{0, 1, 2, 0, 2, 3};
+    std::vector<FluidVertex> vertices;
+    std::vector<unsigned int> indices;
     bool isInitialized = false;
 
+    std::shared_ptr<opal::Texture> waveTexture = nullptr;
+    std::vector<float> waveTexels;
+
     std::shared_ptr<RenderTarget> reflectionTarget;
     std::shared_ptr<RenderTarget> refractionTarget;
-    bool captureDirty = true;
+    bool reflectionDirty = true;
+    bool refractionDirty = true;
+    bool captureReflectionNext = true;
+    long lastCaptureFrame = -1;
+    bool hasReflectionCapture = false;
+    bool hasRefractionCapture = false;
+    glm::mat4 reflectionViewProjection{1.0f};
+    glm::mat4 refractionViewProjection{1.0f};
     float captureUpdateInterval = 1.0f / 10.0f;
     float captureUpdateTimer = 0.0f;
     bool hasCaptureCameraState = false;
     glm::vec3 lastCaptureCameraPosition{0.0f};
     glm::vec3 lastCaptureCameraDirection{0.0f, 0.0f, -1.0f};
 
+    bool hasPendingCapture() const {
+        return reflectionDirty || refractionDirty;
+    }
+    void markCapturesDirty();
     void ensureTargets(Window &window);
     glm::vec4 calculateClipPlane() const;
     glm::vec3 calculatePlaneNormal() const;
@@ -214,4 +311,54 @@ struct Fluid : GameObject {
     friend class Window;
 };
 
+/**
+ * @brief Floats the rigidbody of its object on a simulated `Fluid`.
+ *
+ * Before every physics step the sample points are placed with the body
+ * transform, and the water height and velocity under all of them are read
+ * in a single batched query. Each submerged point adds lift for its share of
+ * `volume` and drag towards the water velocity. The sum is applied to the
+ * rigidbody at the center of buoyancy.
+ *
+ * \subsection buoyancy-example Example
+ * ```cpp
+ * auto buoyancy = std::make_shared<Buoyancy>();
+ * buoyancy->fluid = &waterSurface;
+ * buoyancy->volume = 0.4f;
+ * buoyancy->samplePoints = {{-0.5f, -0.2f, -1.0f}, {0.5f, -0.2f, -1.0f},
+ *                           {-0.5f, -0.2f, 1.0f}, {0.5f, -0.2f, 1.0f}};
+ * boat.addComponent(buoyancy);
+ * ```
+ *
+ * \note This is an alpha API and may change.
+ */
+class Buoyancy final : public Component {
+  public:
+    /** @brief Fluid the object floats on. */
+    Fluid *fluid = nullptr;
+    /**
+     * @brief Body-space points that sample the water. An empty list samples
+     * at the body origin.
+     */
+    std::vector<Position3d> samplePoints;
+    /** @brief Volume displaced when every point is fully submerged. */
+    float volume = 1.0f;
+    /** @brief Depth at which a sample point counts as fully submerged. */
+    float sampleDepth = 0.5f;
+    /** @brief Density of the fluid in kilograms per cubic meter. */
+    float fluidDensity = 1000.0f;
+    /** @brief Drag per submerged cubic meter and unit of relative speed. */
+    float drag = 500.0f;
+    float gravity = 9.81f;
+
+    /** @brief Applies lift and drag to the object's rigidbody. */
+    void beforePhysics() override;
+    std::shared_ptr<Component> clone() const override;
+
+  private:
+    std::vector<Position3d> worldPoints;
+    std::vector<float> heights;
+    std::vector<Velocity3d> waterVelocities;
+};
+
 #endif // HYDRA_FLUID_H
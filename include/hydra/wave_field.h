@@ -0,0 +1,159 @@
+//
+// wave_field.h
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: Heightfield water simulation used by fluid surfaces
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#ifndef HYDRA_WAVE_FIELD_H
+#define HYDRA_WAVE_FIELD_H
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <vector>
+
+/**
+ * @brief Linearized shallow-water heightfield over a rectangular surface.
+ *
+ * The surface is split into `resolution` x `resolution` cells covering
+ * `extent` world units. Every cell stores its height above the rest plane,
+ * its vertical velocity and the horizontal flow of the water column. Waves
+ * travel at `waveSpeed` and bounce off the edges of the field.
+ *
+ * `step` splits the frame into stable substeps and updates rows of cells in
+ * parallel on the job system, four cells at a time. `stepReference` runs the
+ * same update with a plain scalar loop.
+ *
+ * Positions passed to the field are local surface coordinates in world
+ * units, with (0, 0) at the center of the surface.
+ *
+ * \subsection wave-field-example Example
+ * ```cpp
+ * WaveField field;
+ * field.create(128, {50.0f, 50.0f});
+ * field.disturb({0.0f, 0.0f}, 2.0f, -1.5f);
+ * field.step(1.0f / 60.0f);
+ *
+ * std::vector<glm::vec2> points = {{0.0f, 0.0f}, {4.0f, -2.0f}};
+ * std::vector<float> heights;
+ * field.sampleHeight(points, heights);
+ * ```
+ *
+ * \note This is an alpha API and may change.
+ */
+class WaveField {
+  public:
+    /** @brief Speed at which waves travel, in world units per second. */
+    float waveSpeed = 3.0f;
+    /** @brief Fraction of wave energy removed per second. */
+    float damping = 0.25f;
+    /** @brief Acceleration that drives the horizontal flow. */
+    float gravity = 9.81f;
+    /** @brief Longest frame time simulated, so hitches do not explode. */
+    float maxFrameTime = 1.0f / 20.0f;
+
+    /**
+     * @brief Allocates a still surface.
+     *
+     * @param resolution Cells along each side of the surface.
+     * @param extent Size of the surface in world units.
+     */
+    void create(int resolution, glm::vec2 extent);
+
+    /** @brief Resizes the surface without touching the simulation state. */
+    void setExtent(glm::vec2 extent);
+
+    /** @brief Flattens the surface and stops all motion. */
+    void reset();
+
+    /** @brief Frees the grids. `isCreated` is false afterwards. */
+    void destroy();
+
+    bool isCreated() const { return resolution > 0; }
+    int getResolution() const { return resolution; }
+    glm::vec2 getExtent() const { return extent; }
+
+    /**
+     * @brief Pushes the surface with a smooth radial impulse.
+     *
+     * @param center Local position of the impulse.
+     * @param radius Radius of the impulse in world units.
+     * @param strength Vertical velocity added at the center. Negative values
+     * push the water down.
+     */
+    void disturb(glm::vec2 center, float radius, float strength);
+
+    /**
+     * @brief Advances the simulation on the job system.
+     */
+    void step(float dt);
+
+    /**
+     * @brief Advances the simulation with a scalar loop. Produces the same
+     * state as `step`.
+     */
+    void stepReference(float dt);
+
+    /**
+     * @brief Bilinearly samples the surface height at local positions.
+     * Positions outside the surface read the closest edge.
+     */
+    void sampleHeight(const std::vector<glm::vec2> &points,
+                      std::vector<float> &heights) const;
+
+    /**
+     * @brief Bilinearly samples the water velocity at local positions. The
+     * result holds the horizontal flow in x and z and the vertical surface
+     * velocity in y.
+     */
+    void sampleVelocity(const std::vector<glm::vec2> &points,
+                        std::vector<glm::vec3> &velocities) const;
+
+    /**
+     * @brief Writes one RGBA texel per cell: height, the height slope along
+     * x and z, and the vertical velocity.
+     */
+    void fillTexture(std::vector<float> &texels) const;
+
+    /** @brief Heights of every cell, row by row. */
+    std::vector<float> getHeights() const;
+
+  private:
+    int resolution = 0;
+    glm::vec2 extent{1.0f, 1.0f};
+    /** @brief Cells per row including the ghost cells on both sides. */
+    int stride = 0;
+
+    // Padded grids with a ring of ghost cells that mirror the border, so the
+    // kernels never branch on the edges.
+    std::vector<float> height;
+    std::vector<float> nextHeight;
+    std::vector<float> velocity;
+    std::vector<float> flowX;
+    std::vector<float> flowZ;
+
+    struct StepConstants {
+        float dt;
+        float waveX;
+        float waveZ;
+        float decay;
+        float pushX;
+        float pushZ;
+    };
+
+    size_t cellIndex(int x, int z) const {
+        return (static_cast<size_t>(z + 1) * stride) + (x + 1);
+    }
+
+    int substepCount(float dt, float &substep) const;
+    StepConstants makeConstants(float substep) const;
+    void mirrorEdges();
+    void stepRows(const StepConstants &constants, int firstRow, int lastRow);
+    void stepCells(const StepConstants &constants, int row, int firstColumn);
+    void swapHeights();
+    float sampleGrid(const std::vector<float> &grid, glm::vec2 point) const;
+};
+
+#endif // HYDRA_WAVE_FIELD_H
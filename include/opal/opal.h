@@ -16,10 +16,14 @@
 #include <vulkan/vulkan.hpp>
 #endif
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <glad/glad.h>
 #include <string>
+#include <string_view>
 #include <sys/types.h>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <glm/glm.hpp>
 
@@ -405,6 +409,9 @@ class Texture {
     create3DVulkan(TextureFormat format, int width, int height, int depth,
                    TextureDataFormat dataFormat = TextureDataFormat::Rgba,
                    const void *data = nullptr);
+
+    void updateDataVulkan(const void *data, int width, int height,
+                          TextureDataFormat dataFormat);
 #endif
 
   private:
@@ -603,6 +610,56 @@ struct VertexBinding {
 
 class PrimitiveAccelerationStructure;
 
+/**
+ * @brief Pre-hashed uniform name used to set uniforms without building or
+ * hashing strings on every call. Each Pipeline resolves a handle once and
+ * caches the backend location for it.
+ *
+ * \subsection uniformhandle-example Example
+ * ```cpp
+ * static const opal::UniformHandle model("model");
+ * static const auto lights = opal::UniformHandle::array("lights", 4, "color");
+ * pipeline->setUniformMat4f(model, modelMatrix);
+ * pipeline->setUniform3f(lights[1], 1.0f, 0.5f, 0.0f);
+ * ```
+ */
+class UniformHandle {
+  public:
+    UniformHandle() = default;
+    explicit UniformHandle(std::string uniformName)
+        : name(std::move(uniformName)), id(hashName(name)) {}
+    explicit UniformHandle(const char *uniformName)
+        : UniformHandle(std::string(uniformName)) {}
+
+    /**
+     * @brief Hashes a uniform name with 64-bit FNV-1a. Usable at compile
+     * time and guaranteed to match the ID of a handle built from the same
+     * name.
+     */
+    static constexpr uint64_t hashName(std::string_view uniformName) {
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : uniformName) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Builds handles for `base[0]` to `base[count - 1]`, optionally
+     * followed by `.member`.
+     */
+    static std::vector<UniformHandle> array(std::string_view base, int count,
+                                            std::string_view member = {});
+
+    const std::string &getName() const { return name; }
+    uint64_t getId() const { return id; }
+
+  private:
+    std::string name;
+    uint64_t id = hashName("");
+};
+
 class Pipeline {
   public:
     static std::shared_ptr<Pipeline> create();
@@ -672,6 +729,16 @@ class Pipeline {
     void setUniform4f(const std::string &name, float v0, float v1, float v2,
                       float v3);
 
+    void setUniform3f(const UniformHandle &handle, float v0, float v1,
+                      float v2);
+    void setUniform1i(const UniformHandle &handle, int v0);
+    void setUniformMat4f(const UniformHandle &handle, const glm::mat4 &matrix);
+    void setUniform1f(const UniformHandle &handle, float v0);
+    void setUniformBool(const UniformHandle &handle, bool value);
+    void setUniform2f(const UniformHandle &handle, float v0, float v1);
+    void setUniform4f(const UniformHandle &handle, float v0, float v1,
+                      float v2, float v3);
+
     /**
      * @brief Binds a buffer of data to a uniform buffer.
      * In OpenGL, this sets array uniforms (e.g., "lights[0].position").
@@ -702,6 +769,12 @@ class Pipeline {
     void bindBufferData(const std::string &name, const void *data, size_t size);
     void bindBuffer(const std::string &name,
                     const std::shared_ptr<Buffer> &buffer, int callerId = -1);
+    /**
+     * @brief Checks whether the shader declares a buffer binding that
+     * bindBuffer(name, buffer) can attach an opal::Buffer to. Always false
+     * on OpenGL.
+     */
+    bool hasBufferBinding(const std::string &name) const;
     void bindShaderReadWriteBuffer(const std::string &name,
                                    const std::shared_ptr<Buffer> &buffer,
                                    int callerId = -1);
@@ -715,6 +788,13 @@ class Pipeline {
                        int callerId = -1);
     void bindTextureCubemap(const std::string &name, uint textureId, int unit,
                             int callerId = -1);
+    void bindTexture(const UniformHandle &handle,
+                     const std::shared_ptr<Texture> &texture, int unit,
+                     int callerId = -1);
+    void bindTexture2D(const UniformHandle &handle, uint textureId, int unit,
+                       int callerId = -1);
+    void bindTextureCubemap(const UniformHandle &handle, uint textureId,
+                            int unit, int callerId = -1);
 
 #ifdef VULKAN
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
@@ -838,6 +918,22 @@ class Pipeline {
     uint getGLCullMode(CullMode mode) const;
     uint getGLFrontFace(FrontFace face) const;
     uint getGLVertexAttributeType(VertexAttributeType type) const;
+
+    enum class UniformKind { Int, Float, Vec2, Vec3, Vec4, Mat4 };
+
+    struct CachedUniform {
+        int location = -1;
+#ifdef VULKAN
+        const UniformBindingInfo *info = nullptr;
+#endif
+    };
+    std::unordered_map<uint64_t, CachedUniform> uniformCache;
+    // Held so the address cannot be reused by a new program while cached.
+    std::shared_ptr<ShaderProgram> uniformCacheProgram;
+
+    const CachedUniform *resolveUniform(uint64_t id, const std::string &name);
+    void uploadUniform(uint64_t id, const std::string &name, UniformKind kind,
+                       const void *data, size_t size);
 };
 
 // Template implementations for Pipeline::bindBuffer
@@ -875,6 +971,21 @@ class Buffer {
 
     void updateData(size_t offset, size_t size, const void *data);
 
+    /**
+     * @brief Maps a range of the buffer so the CPU can write into it
+     * directly. The previous contents of the range are discarded. Only one
+     * range can be mapped at a time.
+     *
+     * @return (void*) Pointer to the start of the range, or nullptr when
+     * the buffer cannot be mapped, in which case updateData should be used.
+     */
+    void *map(size_t offset, size_t size);
+    /**
+     * @brief Finishes the write started by map() and makes the data
+     * visible to the GPU.
+     */
+    void unmap();
+
     void bind(int callerId = -1) const;
     void unbind(int callerId = -1) const;
 
@@ -885,8 +996,6 @@ class Buffer {
 
 #ifdef VULKAN
     VkBuffer vkBuffer = VK_NULL_HANDLE;
-    VkBuffer stagingBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory vkStagingBufferMemory = VK_NULL_HANDLE;
     VkDeviceMemory vkBufferMemory = VK_NULL_HANDLE;
 
     static void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
@@ -895,7 +1004,88 @@ class Buffer {
     static void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer,
                            VkDeviceSize size);
 #endif
+
+  private:
+    void *mappedData = nullptr;
+    size_t mappedOffset = 0;
+    size_t mappedSize = 0;
+};
+
+#ifdef VULKAN
+/**
+ * @brief Linear upload ring that streams buffer writes without waiting on
+ * the queue. Every Buffer::updateData and Buffer::map goes through it,
+ * whatever the memory type of the buffer.
+ *
+ * The ring owns one host-visible region per frame in flight. Data is written
+ * at the head of the open region and a copy into the destination buffer is
+ * recorded into the region's transfer command buffer. The command buffer is
+ * submitted ahead of the next frame, so every draw of that frame sees the
+ * last data written. A region is only rewound once the fence of its previous
+ * submission has signaled.
+ *
+ * \subsection upload-ring-example Example
+ * ```cpp
+ * auto &ring = opal::UploadRing::getInstance();
+ * if (void *target = ring.stage(buffer->vkBuffer, 0, sizeof(data))) {
+ *     std::memcpy(target, &data, sizeof(data));
+ * }
+ * ```
+ */
+class UploadRing {
+  public:
+    UploadRing(const UploadRing &) = delete;
+    UploadRing &operator=(const UploadRing &) = delete;
+
+    static UploadRing &getInstance() {
+        static UploadRing instance;
+        return instance;
+    }
+
+    /** @brief Number of regions, one per frame a command buffer keeps in
+     * flight. */
+    static constexpr uint32_t REGION_COUNT = 3;
+    /** @brief Bytes available to the uploads of a single frame. */
+    static constexpr VkDeviceSize REGION_SIZE = 8ull * 1024 * 1024;
+
+    /**
+     * @brief Reserves ring space for a write into a device buffer and records
+     * the copy. The caller fills the returned memory before the next flush.
+     *
+     * @param destination Buffer receiving the data.
+     * @param offset Byte offset inside the destination buffer.
+     * @param size Number of bytes written.
+     * @return (void*) Memory to write into, or nullptr when the write is
+     * larger than a region.
+     */
+    void *stage(VkBuffer destination, VkDeviceSize offset, VkDeviceSize size);
+
+    /**
+     * @brief Submits the copies recorded since the last flush. Called before
+     * every frame submission.
+     */
+    void flush();
+
+  private:
+    UploadRing() = default;
+
+    struct Region {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        VkDeviceSize head = 0;
+        bool recording = false;
+    };
+
+    Region regions[REGION_COUNT];
+    uint32_t current = 0;
+    VkBuffer ringBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory ringMemory = VK_NULL_HANDLE;
+    uint8_t *ringData = nullptr;
+
+    bool initialize();
+    void open(Region &region);
 };
+#endif
 
 struct VertexAttributeBinding {
     VertexAttribute attribute;
@@ -1174,6 +1364,18 @@ class InstanceAccelerationStructure {
 
 #endif
 
+/**
+ * @brief Arguments of an indirect indexed draw as read by the GPU. The
+ * layout is shared by OpenGL, Vulkan and Metal.
+ */
+struct DrawIndexedIndirectArguments {
+    uint indexCount = 0;
+    uint instanceCount = 0;
+    uint firstIndex = 0;
+    int vertexOffset = 0;
+    uint firstInstance = 0;
+};
+
 class CommandBuffer {
   public:
     ~CommandBuffer();
@@ -1201,6 +1403,14 @@ class CommandBuffer {
      * Requires Pipeline with PrimitiveStyle::Patches and setPatchVertices().
      */
     void drawPatches(uint vertexCount, uint firstVertex = 0, int objectId = -1);
+    /**
+     * @brief Draws the bound drawing state with counts read from a buffer.
+     * @param argumentBuffer Buffer holding DrawIndexedIndirectArguments,
+     * usually written by a compute shader.
+     * @param offset Byte offset of the arguments inside the buffer.
+     */
+    void drawIndexedIndirect(const std::shared_ptr<Buffer> &argumentBuffer,
+                             size_t offset = 0, int objectId = -1);
     void dispatch(uint threadCountX, uint threadCountY = 1,
                   uint threadCountZ = 1);
     void computeBarrier();
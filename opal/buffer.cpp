@@ -53,6 +53,83 @@ uint getGLVertexAttributeType(VertexAttributeType type) {
 
 #endif
 
+#ifdef VULKAN
+// Copies data into a device buffer through a temporary staging buffer and
+// waits for the transfer to finish. Only used for writes that do not fit in
+// the upload ring.
+void uploadBlocking(VkBuffer deviceBuffer, size_t offset, size_t size,
+                    const void *data) {
+    // Copies already staged in the ring must land first.
+    UploadRing::getInstance().flush();
+
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+    Buffer::createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         stagingBuffer, stagingMemory);
+    void *stagingData = nullptr;
+    if (vkMapMemory(Device::globalDevice, stagingMemory, 0, size, 0,
+                    &stagingData) != VK_SUCCESS) {
+        throw std::runtime_error(
+            "Buffer::updateData: failed to map staging buffer memory");
+    }
+    memcpy(stagingData, data, size);
+    vkUnmapMemory(Device::globalDevice, stagingMemory);
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = Device::globalInstance->commandPool;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer;
+    vkAllocateCommandBuffers(Device::globalDevice, &allocInfo, &commandBuffer);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = 0;
+    copyRegion.dstOffset = offset;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, deviceBuffer, 1,
+                    &copyRegion);
+
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    vkQueueSubmit(Device::globalInstance->graphicsQueue, 1, &submitInfo,
+                  VK_NULL_HANDLE);
+    vkQueueWaitIdle(Device::globalInstance->graphicsQueue);
+
+    vkFreeCommandBuffers(Device::globalDevice,
+                         Device::globalInstance->commandPool, 1,
+                         &commandBuffer);
+    vkDestroyBuffer(Device::globalDevice, stagingBuffer, nullptr);
+    vkFreeMemory(Device::globalDevice, stagingMemory, nullptr);
+}
+
+// Writes into a buffer through the upload ring, falling back to a blocking
+// copy when the write is larger than a ring region.
+void uploadStaged(VkBuffer deviceBuffer, size_t offset, size_t size,
+                  const void *data) {
+    void *target =
+        UploadRing::getInstance().stage(deviceBuffer, offset, size);
+    if (target != nullptr) {
+        memcpy(target, data, size);
+        return;
+    }
+    uploadBlocking(deviceBuffer, offset, size, data);
+}
+#endif
 } // namespace
 
 std::shared_ptr<Buffer> Buffer::create(BufferUsage usage, size_t size,
@@ -92,7 +169,9 @@ std::shared_ptr<Buffer> Buffer::create(BufferUsage usage, size_t size,
         break;
     }
     glBindBuffer(glTarget, buffer->bufferID);
-    glBufferData(glTarget, size, data, GL_STATIC_DRAW);
+    glBufferData(glTarget, size, data,
+                 memoryUsage == MemoryUsageType::CPUToGPU ? GL_DYNAMIC_DRAW
+                                                          : GL_STATIC_DRAW);
     glBindBuffer(glTarget, 0);
 #elif defined(VULKAN)
     auto bufferSize = static_cast<VkDeviceSize>(size);
@@ -119,7 +198,9 @@ std::shared_ptr<Buffer> Buffer::create(BufferUsage usage, size_t size,
                      VK_BUFFER_USAGE_TRANSFER_DST_BIT;
         break;
     case BufferUsage::ShaderReadWrite:
+        // Compute shaders can write draw arguments into these buffers.
         usageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                     VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
                      VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
                      VK_BUFFER_USAGE_TRANSFER_DST_BIT;
         break;
@@ -144,28 +225,23 @@ std::shared_ptr<Buffer> Buffer::create(BufferUsage usage, size_t size,
         break;
     }
 
-    // Store staging buffer in the buffer object so updateData can use it
-    createBuffer(bufferSize,
-                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
-                     VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                 buffer->stagingBuffer, buffer->vkStagingBufferMemory);
-
-    if (data != nullptr) {
-        void *mappedData;
-        vkMapMemory(Device::globalInstance->logicalDevice,
-                    buffer->vkStagingBufferMemory, 0, bufferSize, 0,
-                    &mappedData);
-        memcpy(mappedData, data, static_cast<size_t>(bufferSize));
-        vkUnmapMemory(Device::globalInstance->logicalDevice,
-                      buffer->vkStagingBufferMemory);
-    }
-
     createBuffer(bufferSize, usageFlags, properties, buffer->vkBuffer,
                  buffer->vkBufferMemory);
-    if (data != nullptr) {
-        Buffer::copyBuffer(buffer->stagingBuffer, buffer->vkBuffer, bufferSize);
+    if (data != nullptr && size > 0 &&
+        memoryUsage != MemoryUsageType::GPUOnly) {
+        // No frame can read a new buffer yet, so its first contents are
+        // written in place.
+        void *mappedMemory = nullptr;
+        if (vkMapMemory(Device::globalInstance->logicalDevice,
+                        buffer->vkBufferMemory, 0, bufferSize, 0,
+                        &mappedMemory) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to map host-visible buffer!");
+        }
+        memcpy(mappedMemory, data, size);
+        vkUnmapMemory(Device::globalInstance->logicalDevice,
+                      buffer->vkBufferMemory);
+    } else if (data != nullptr && size > 0) {
+        uploadStaged(buffer->vkBuffer, 0, size, data);
     }
 
 #elif defined(METAL)
@@ -237,57 +313,15 @@ void Buffer::updateData(size_t offset, size_t size, const void *data) {
     glBufferSubData(glTarget, offset, size, data);
     glBindBuffer(glTarget, 0);
 #elif defined(VULKAN)
-    if (vkStagingBufferMemory == VK_NULL_HANDLE ||
-        stagingBuffer == VK_NULL_HANDLE) {
-        throw std::runtime_error(
-            "Buffer::updateData: staging buffer not initialized");
+    if (vkBuffer == VK_NULL_HANDLE) {
+        throw std::runtime_error("Buffer::updateData: buffer not initialized");
     }
-    void *mappedData;
-    VkResult result =
-        vkMapMemory(Device::globalInstance->logicalDevice,
-                    vkStagingBufferMemory, offset, size, 0, &mappedData);
-    if (result != VK_SUCCESS) {
-        throw std::runtime_error(
-            "Buffer::updateData: failed to map staging buffer memory");
+    if (data == nullptr || size == 0) {
+        return;
     }
-    memcpy(mappedData, data, size);
-    vkUnmapMemory(Device::globalInstance->logicalDevice, vkStagingBufferMemory);
-
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = Device::globalInstance->commandPool;
-    allocInfo.commandBufferCount = 1;
-
-    VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(Device::globalDevice, &allocInfo, &commandBuffer);
-
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-    VkBufferCopy copyRegion{};
-    copyRegion.srcOffset = offset;
-    copyRegion.dstOffset = offset;
-    copyRegion.size = size;
-    vkCmdCopyBuffer(commandBuffer, stagingBuffer, vkBuffer, 1, &copyRegion);
-
-    vkEndCommandBuffer(commandBuffer);
-
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
-
-    vkQueueSubmit(Device::globalInstance->graphicsQueue, 1, &submitInfo,
-                  VK_NULL_HANDLE);
-    vkQueueWaitIdle(Device::globalInstance->graphicsQueue);
-
-    vkFreeCommandBuffers(Device::globalDevice,
-                         Device::globalInstance->commandPool, 1,
-                         &commandBuffer);
+    // Host-visible buffers go through the ring too. Writing their memory
+    // directly would race with earlier frames still reading it.
+    uploadStaged(vkBuffer, offset, size, data);
 #elif defined(METAL)
     if (Device::globalInstance == nullptr) {
         throw std::runtime_error("Cannot update Metal buffer without device");
@@ -335,6 +369,66 @@ void Buffer::updateData(size_t offset, size_t size, const void *data) {
 #endif
 }
 
+void *Buffer::map(size_t offset, size_t size) {
+    if (mappedData != nullptr || size == 0) {
+        return nullptr;
+    }
+#ifdef OPENGL
+    uint glTarget = usage == BufferUsage::IndexArray ? GL_ELEMENT_ARRAY_BUFFER
+                                                     : GL_ARRAY_BUFFER;
+    if (usage == BufferUsage::UniformBuffer ||
+        usage == BufferUsage::ShaderRead) {
+        return nullptr;
+    }
+    glBindBuffer(glTarget, bufferID);
+    mappedData = glMapBufferRange(glTarget, offset, size,
+                                  GL_MAP_WRITE_BIT |
+                                      GL_MAP_INVALIDATE_RANGE_BIT);
+    glBindBuffer(glTarget, 0);
+#elif defined(VULKAN)
+    // The copy is recorded now and reads the ring memory when the uploads
+    // are flushed, after the caller has filled it.
+    mappedData = UploadRing::getInstance().stage(vkBuffer, offset, size);
+#elif defined(METAL)
+    auto &bufferState = metal::bufferState(this);
+    if (bufferState.buffer == nullptr || offset + size > bufferState.size) {
+        return nullptr;
+    }
+    mappedData =
+        static_cast<uint8_t *>(bufferState.buffer->contents()) + offset;
+#endif
+    if (mappedData != nullptr) {
+        mappedOffset = offset;
+        mappedSize = size;
+    }
+    return mappedData;
+}
+
+void Buffer::unmap() {
+    if (mappedData == nullptr) {
+        return;
+    }
+#ifdef OPENGL
+    uint glTarget = usage == BufferUsage::IndexArray ? GL_ELEMENT_ARRAY_BUFFER
+                                                     : GL_ARRAY_BUFFER;
+    glBindBuffer(glTarget, bufferID);
+    glUnmapBuffer(glTarget);
+    glBindBuffer(glTarget, 0);
+#elif defined(VULKAN)
+    // The staged copy is submitted with the next ring flush.
+#elif defined(METAL)
+    auto &bufferState = metal::bufferState(this);
+    if (bufferState.buffer->storageMode() == MTL::StorageModeManaged) {
+        bufferState.buffer->didModifyRange(
+            NS::Range::Make(static_cast<NS::UInteger>(mappedOffset),
+                            static_cast<NS::UInteger>(mappedSize)));
+    }
+#endif
+    mappedData = nullptr;
+    mappedOffset = 0;
+    mappedSize = 0;
+}
+
 void Buffer::bind(int callerId) const {
 #ifdef OPENGL
     uint glTarget;
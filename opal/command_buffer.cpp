@@ -1387,6 +1387,10 @@ void CommandBuffer::commit() {
         throw std::runtime_error("Failed to end command buffer recording!");
     }
 
+    // Buffer writes made while recording must reach the GPU before the
+    // frame reads them.
+    UploadRing::getInstance().flush();
+
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
@@ -1986,6 +1990,136 @@ void CommandBuffer::drawPatches(uint vertexCount, uint firstVertex,
     drawCallCount++;
 }
 
+void CommandBuffer::drawIndexedIndirect(
+    const std::shared_ptr<Buffer> &argumentBuffer, size_t offset,
+    int objectId) {
+    if (argumentBuffer == nullptr) {
+        return;
+    }
+#ifdef OPENGL
+    if (boundDrawingState != nullptr) {
+        boundDrawingState->bind();
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, argumentBuffer->bufferID);
+    glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                           (void *)(uintptr_t)offset);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    if (boundDrawingState != nullptr) {
+        boundDrawingState->unbind();
+    }
+#elif defined(VULKAN)
+    if (renderPass == nullptr || renderPass->currentRenderPass == nullptr) {
+        return;
+    }
+    if (!imageAcquired && framebuffer != nullptr &&
+        framebuffer->isDefaultFramebuffer) {
+        vkAcquireNextImageKHR(device->logicalDevice, device->swapChain,
+                              UINT64_MAX,
+                              imageAvailableSemaphores[currentFrame],
+                              VK_NULL_HANDLE, &imageIndex);
+        imageAcquired = true;
+    }
+    beginCommandBufferIfNeeded();
+    if (!hasStarted) {
+        this->record(imageIndex);
+        hasStarted = true;
+    }
+    vkCmdBindPipeline(commandBuffers[currentFrame],
+                      VK_PIPELINE_BIND_POINT_GRAPHICS,
+                      renderPass->currentRenderPass->pipeline);
+    if (boundPipeline != nullptr) {
+        boundPipeline->bindDescriptorSets(commandBuffers[currentFrame]);
+    }
+    if (boundDrawingState != nullptr) {
+        bindVertexBuffersIfNeeded();
+        if (boundDrawingState->indexBuffer != nullptr) {
+            vkCmdBindIndexBuffer(commandBuffers[currentFrame],
+                                 boundDrawingState->indexBuffer->vkBuffer, 0,
+                                 VK_INDEX_TYPE_UINT32);
+        }
+    }
+    if (boundPipeline != nullptr) {
+        VkViewport viewport = boundPipeline->vkViewport;
+        if (viewport.width != 0.0f) {
+            vkCmdSetViewport(commandBuffers[currentFrame], 0, 1, &viewport);
+        } else if (framebuffer != nullptr) {
+            VkViewport defaultViewport{};
+            defaultViewport.x = 0.0f;
+            defaultViewport.y = 0.0f;
+            defaultViewport.width = static_cast<float>(framebuffer->width);
+            defaultViewport.height = static_cast<float>(framebuffer->height);
+            defaultViewport.minDepth = 0.0f;
+            defaultViewport.maxDepth = 1.0f;
+            vkCmdSetViewport(commandBuffers[currentFrame], 0, 1,
+                             &defaultViewport);
+        }
+        boundPipeline->flushPushConstants(commandBuffers[currentFrame]);
+    }
+    vkCmdDrawIndexedIndirect(commandBuffers[currentFrame],
+                             argumentBuffer->vkBuffer,
+                             static_cast<VkDeviceSize>(offset), 1,
+                             sizeof(DrawIndexedIndirectArguments));
+#elif defined(METAL)
+    if (boundPipeline == nullptr || framebuffer == nullptr) {
+        return;
+    }
+    if (boundDrawingState == nullptr ||
+        boundDrawingState->indexBuffer == nullptr) {
+        return;
+    }
+
+    auto &state = metal::commandBufferState(this);
+    if (state.computeEncoder != nullptr) {
+        state.computeEncoder->endEncoding();
+        state.computeEncoder = nullptr;
+    }
+    ensureRenderEncoder(this, device, framebuffer, boundPipeline,
+                        clearColorValue, clearDepthValue);
+    if (state.encoder == nullptr) {
+        return;
+    }
+
+    if (boundDrawingState->vertexBuffer != nullptr) {
+        auto &vertexState =
+            metal::bufferState(boundDrawingState->vertexBuffer.get());
+        if (vertexState.buffer != nullptr) {
+            state.encoder->setVertexBuffer(vertexState.buffer, 0,
+                                           kVertexStreamBufferIndex);
+        }
+    }
+    if (boundDrawingState->instanceBuffer != nullptr) {
+        auto &instanceState =
+            metal::bufferState(boundDrawingState->instanceBuffer.get());
+        if (instanceState.buffer != nullptr) {
+            state.encoder->setVertexBuffer(instanceState.buffer, 0,
+                                           kInstanceStreamBufferIndex);
+        }
+    }
+
+    auto &indexState = metal::bufferState(boundDrawingState->indexBuffer.get());
+    auto &argumentState = metal::bufferState(argumentBuffer.get());
+    if (indexState.buffer == nullptr || argumentState.buffer == nullptr) {
+        return;
+    }
+
+    auto &pipelineState = metal::pipelineState(boundPipeline.get());
+    state.encoder->drawIndexedPrimitives(
+        pipelineState.primitiveType, MTL::IndexTypeUInt32, indexState.buffer,
+        0, argumentState.buffer, static_cast<NS::UInteger>(offset));
+    state.hasDraw = true;
+#endif
+
+    if (TracerServices::getInstance().isOk()) {
+        DrawCallInfo info;
+        info.callerObject = std::to_string(objectId);
+        info.frameNumber = (int)device->frameCount;
+        info.type = DrawCallType::Indexed;
+        info.send();
+    }
+
+    drawCallCount++;
+}
+
 void CommandBuffer::dispatch(uint threadCountX, uint threadCountY,
                              uint threadCountZ) {
 #ifdef OPENGL
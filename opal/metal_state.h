@@ -126,6 +126,9 @@ struct PipelineState {
     std::unordered_map<uint32_t, MTL::Buffer *> uniformBuffers;
     std::unordered_map<uint32_t, std::shared_ptr<Buffer>> shaderBuffers;
     std::unordered_map<int, std::shared_ptr<Texture>> texturesByUnit;
+    std::unordered_map<uint64_t, std::vector<UniformLocation>>
+        uniformLocations;
+    const ProgramState *uniformLocationProgram = nullptr;
     MTL::PrimitiveType primitiveType = MTL::PrimitiveTypeTriangle;
     MTL::CullMode cullMode = MTL::CullModeBack;
     MTL::Winding frontFace = MTL::WindingCounterClockwise;
@@ -12,6 +12,8 @@
 #include <cstring>
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #ifdef METAL
@@ -296,8 +298,8 @@ MTL::VertexFormat toMetalVertexFormat(VertexAttributeType type, uint size,
     }
 }
 
-void updateMetalUniform(Pipeline *pipeline, const std::string &name,
-                        const void *data, size_t size,
+void updateMetalUniform(Pipeline *pipeline, uint64_t id,
+                        const std::string &name, const void *data, size_t size,
                         bool clampToDeclaredSize) {
     if (pipeline == nullptr || pipeline->shaderProgram == nullptr ||
         data == nullptr || size == 0) {
@@ -305,12 +307,23 @@ void updateMetalUniform(Pipeline *pipeline, const std::string &name,
     }
 
     auto &programState = metal::programState(pipeline->shaderProgram.get());
-    auto locations = metal::resolveUniformLocations(programState, name);
+    auto &pipelineState = metal::pipelineState(pipeline);
+    if (pipelineState.uniformLocationProgram != &programState) {
+        pipelineState.uniformLocations.clear();
+        pipelineState.uniformLocationProgram = &programState;
+    }
+    auto cacheIt = pipelineState.uniformLocations.find(id);
+    if (cacheIt == pipelineState.uniformLocations.end()) {
+        cacheIt = pipelineState.uniformLocations
+                      .emplace(id, metal::resolveUniformLocations(
+                                       programState, name))
+                      .first;
+    }
+    const auto &locations = cacheIt->second;
     if (locations.empty()) {
         return;
     }
 
-    auto &pipelineState = metal::pipelineState(pipeline);
     for (const auto &location : locations) {
         auto writeStage = [&](metal::MetalProgramStage stage) {
             uint32_t key = metal::stageBindingKey(location.bufferIndex, stage);
@@ -879,168 +892,186 @@ bool Pipeline::operator==(const std::shared_ptr<Pipeline> &pipeline) const {
     return true;
 }
 
-void Pipeline::setUniform1f(const std::string &name, float v0) {
+std::vector<UniformHandle> UniformHandle::array(std::string_view base,
+                                                int count,
+                                                std::string_view member) {
+    std::vector<UniformHandle> handles;
+    handles.reserve(static_cast<size_t>(std::max(count, 0)));
+    for (int i = 0; i < count; i++) {
+        std::string name(base);
+        name += "[" + std::to_string(i) + "]";
+        if (!member.empty()) {
+            name += ".";
+            name += member;
+        }
+        handles.emplace_back(std::move(name));
+    }
+    return handles;
+}
+
+const Pipeline::CachedUniform *
+Pipeline::resolveUniform(uint64_t id, const std::string &name) {
+    if (shaderProgram == nullptr) {
+        return nullptr;
+    }
+    if (uniformCacheProgram != shaderProgram) {
+        uniformCache.clear();
+        uniformCacheProgram = shaderProgram;
+    }
+
+    auto it = uniformCache.find(id);
+    if (it != uniformCache.end()) {
+        return &it->second;
+    }
+
+    CachedUniform cached;
 #ifdef OPENGL
-    glUniform1f(
-        glGetUniformLocation(this->shaderProgram->programID, name.c_str()), v0);
+    cached.location =
+        glGetUniformLocation(shaderProgram->programID, name.c_str());
 #elif defined(VULKAN)
-    const UniformBindingInfo *info = this->shaderProgram->findUniform(name);
-    if (!info) {
+    cached.info = shaderProgram->findUniform(name);
+    if (cached.info == nullptr) {
+        // Misses are not cached so late reflection data is still picked up.
         logMissingUniformOnce(name);
-        return;
-    }
-    if (!info->isBuffer) {
-        // Push constant
-        updatePushConstant(info->offset, &v0, sizeof(float));
-    } else {
-        updateUniformData(info->set, info->binding, info->offset, &v0,
-                          sizeof(float));
+        return nullptr;
     }
-#elif defined(METAL)
-    updateMetalUniform(this, name, &v0, sizeof(float), true);
+#else
+    (void)name;
 #endif
+    return &uniformCache.emplace(id, cached).first->second;
 }
 
-void Pipeline::setUniformMat4f(const std::string &name,
-                               const glm::mat4 &matrix) {
+void Pipeline::uploadUniform(uint64_t id, const std::string &name,
+                             UniformKind kind, const void *data, size_t size) {
 #ifdef OPENGL
-    glUniformMatrix4fv(
-        glGetUniformLocation(this->shaderProgram->programID, name.c_str()), 1,
-        GL_FALSE, &matrix[0][0]);
+    (void)size;
+    const CachedUniform *cached = resolveUniform(id, name);
+    if (cached == nullptr || cached->location < 0) {
+        return;
+    }
+    const int location = cached->location;
+    const float *values = static_cast<const float *>(data);
+    switch (kind) {
+    case UniformKind::Int:
+        glUniform1i(location, *static_cast<const int *>(data));
+        break;
+    case UniformKind::Float:
+        glUniform1f(location, values[0]);
+        break;
+    case UniformKind::Vec2:
+        glUniform2fv(location, 1, values);
+        break;
+    case UniformKind::Vec3:
+        glUniform3fv(location, 1, values);
+        break;
+    case UniformKind::Vec4:
+        glUniform4fv(location, 1, values);
+        break;
+    case UniformKind::Mat4:
+        glUniformMatrix4fv(location, 1, GL_FALSE, values);
+        break;
+    }
 #elif defined(VULKAN)
-    const UniformBindingInfo *info = this->shaderProgram->findUniform(name);
-    if (!info) {
-        logMissingUniformOnce(name);
+    (void)kind;
+    const CachedUniform *cached = resolveUniform(id, name);
+    if (cached == nullptr) {
         return;
     }
+    const UniformBindingInfo *info = cached->info;
     if (!info->isBuffer) {
-        updatePushConstant(info->offset, &matrix[0][0], sizeof(glm::mat4));
+        // Push constant
+        updatePushConstant(info->offset, data, size);
     } else {
-        updateUniformData(info->set, info->binding, info->offset, &matrix[0][0],
-                          sizeof(glm::mat4));
+        updateUniformData(info->set, info->binding, info->offset, data, size);
     }
 #elif defined(METAL)
-    updateMetalUniform(this, name, &matrix[0][0], sizeof(glm::mat4), true);
+    (void)kind;
+    updateMetalUniform(this, id, name, data, size, true);
 #endif
 }
 
+void Pipeline::setUniform1f(const std::string &name, float v0) {
+    uploadUniform(UniformHandle::hashName(name), name, UniformKind::Float,
+                  &v0, sizeof(float));
+}
+
+void Pipeline::setUniformMat4f(const std::string &name,
+                               const glm::mat4 &matrix) {
+    uploadUniform(UniformHandle::hashName(name), name, UniformKind::Mat4,
+                  &matrix[0][0], sizeof(glm::mat4));
+}
+
 void Pipeline::setUniform3f(const std::string &name, float v0, float v1,
                             float v2) {
-#ifdef OPENGL
-    glUniform3f(
-        glGetUniformLocation(this->shaderProgram->programID, name.c_str()), v0,
-        v1, v2);
-#elif defined(VULKAN)
-    const UniformBindingInfo *info = this->shaderProgram->findUniform(name);
-    if (!info) {
-        logMissingUniformOnce(name);
-        return;
-    }
-    float data[3] = {v0, v1, v2};
-    if (!info->isBuffer) {
-        updatePushConstant(info->offset, data, sizeof(data));
-    } else {
-        updateUniformData(info->set, info->binding, info->offset, data,
-                          sizeof(data));
-    }
-#elif defined(METAL)
     float data[3] = {v0, v1, v2};
-    updateMetalUniform(this, name, data, sizeof(data), true);
-#endif
+    uploadUniform(UniformHandle::hashName(name), name, UniformKind::Vec3, data,
+                  sizeof(data));
 }
 
 void Pipeline::setUniform1i(const std::string &name, int v0) {
-#ifdef OPENGL
-    glUniform1i(
-        glGetUniformLocation(this->shaderProgram->programID, name.c_str()), v0);
-#elif defined(VULKAN)
-    const UniformBindingInfo *info = this->shaderProgram->findUniform(name);
-    if (!info) {
-        logMissingUniformOnce(name);
-        return;
-    }
-    if (!info->isBuffer) {
-        updatePushConstant(info->offset, &v0, sizeof(int));
-    } else {
-        updateUniformData(info->set, info->binding, info->offset, &v0,
-                          sizeof(int));
-    }
-#elif defined(METAL)
-    updateMetalUniform(this, name, &v0, sizeof(int), true);
-#endif
+    uploadUniform(UniformHandle::hashName(name), name, UniformKind::Int, &v0,
+                  sizeof(int));
 }
 
 void Pipeline::setUniformBool(const std::string &name, bool value) {
-#ifdef OPENGL
-    glUniform1i(
-        glGetUniformLocation(this->shaderProgram->programID, name.c_str()),
-        (int)value);
-#elif defined(VULKAN)
-    const UniformBindingInfo *info = this->shaderProgram->findUniform(name);
-    if (!info) {
-        logMissingUniformOnce(name);
-        return;
-    }
-    int intValue = value ? 1 : 0;
-    if (!info->isBuffer) {
-        updatePushConstant(info->offset, &intValue, sizeof(int));
-    } else {
-        updateUniformData(info->set, info->binding, info->offset, &intValue,
-                          sizeof(int));
-    }
-#elif defined(METAL)
     int intValue = value ? 1 : 0;
-    updateMetalUniform(this, name, &intValue, sizeof(int), true);
-#endif
+    uploadUniform(UniformHandle::hashName(name), name, UniformKind::Int,
+                  &intValue, sizeof(int));
 }
 
 void Pipeline::setUniform4f(const std::string &name, float v0, float v1,
                             float v2, float v3) {
-#ifdef OPENGL
-    glUniform4f(
-        glGetUniformLocation(this->shaderProgram->programID, name.c_str()), v0,
-        v1, v2, v3);
-#elif defined(VULKAN)
-    const UniformBindingInfo *info = this->shaderProgram->findUniform(name);
-    if (!info) {
-        logMissingUniformOnce(name);
-        return;
-    }
     float data[4] = {v0, v1, v2, v3};
-    if (!info->isBuffer) {
-        updatePushConstant(info->offset, data, sizeof(data));
-    } else {
-        updateUniformData(info->set, info->binding, info->offset, data,
-                          sizeof(data));
-    }
-#elif defined(METAL)
-    float data[4] = {v0, v1, v2, v3};
-    updateMetalUniform(this, name, data, sizeof(data), true);
-#endif
+    uploadUniform(UniformHandle::hashName(name), name, UniformKind::Vec4, data,
+                  sizeof(data));
 }
 
 void Pipeline::setUniform2f(const std::string &name, float v0, float v1) {
-#ifdef OPENGL
-    glUniform2f(
-        glGetUniformLocation(this->shaderProgram->programID, name.c_str()), v0,
-        v1);
-#elif defined(VULKAN)
-    const UniformBindingInfo *info = this->shaderProgram->findUniform(name);
-    if (!info) {
-        logMissingUniformOnce(name);
-        return;
-    }
     float data[2] = {v0, v1};
-    if (!info->isBuffer) {
-        updatePushConstant(info->offset, data, sizeof(data));
-    } else {
-        updateUniformData(info->set, info->binding, info->offset, data,
-                          sizeof(data));
-    }
-#elif defined(METAL)
+    uploadUniform(UniformHandle::hashName(name), name, UniformKind::Vec2, data,
+                  sizeof(data));
+}
+
+void Pipeline::setUniform1f(const UniformHandle &handle, float v0) {
+    uploadUniform(handle.getId(), handle.getName(), UniformKind::Float, &v0,
+                  sizeof(float));
+}
+
+void Pipeline::setUniformMat4f(const UniformHandle &handle,
+                               const glm::mat4 &matrix) {
+    uploadUniform(handle.getId(), handle.getName(), UniformKind::Mat4,
+                  &matrix[0][0], sizeof(glm::mat4));
+}
+
+void Pipeline::setUniform3f(const UniformHandle &handle, float v0, float v1,
+                            float v2) {
+    float data[3] = {v0, v1, v2};
+    uploadUniform(handle.getId(), handle.getName(), UniformKind::Vec3, data,
+                  sizeof(data));
+}
+
+void Pipeline::setUniform1i(const UniformHandle &handle, int v0) {
+    uploadUniform(handle.getId(), handle.getName(), UniformKind::Int, &v0,
+                  sizeof(int));
+}
+
+void Pipeline::setUniformBool(const UniformHandle &handle, bool value) {
+    int intValue = value ? 1 : 0;
+    uploadUniform(handle.getId(), handle.getName(), UniformKind::Int,
+                  &intValue, sizeof(int));
+}
+
+void Pipeline::setUniform4f(const UniformHandle &handle, float v0, float v1,
+                            float v2, float v3) {
+    float data[4] = {v0, v1, v2, v3};
+    uploadUniform(handle.getId(), handle.getName(), UniformKind::Vec4, data,
+                  sizeof(data));
+}
+
+void Pipeline::setUniform2f(const UniformHandle &handle, float v0, float v1) {
     float data[2] = {v0, v1};
-    updateMetalUniform(this, name, data, sizeof(data), true);
-#endif
+    uploadUniform(handle.getId(), handle.getName(), UniformKind::Vec2, data,
+                  sizeof(data));
 }
 
 void Pipeline::bindBufferData(const std::string &name, const void *data,
@@ -1112,7 +1143,11 @@ void Pipeline::bindBuffer(const std::string &name,
             : (info->isStorageBuffer ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
                                      : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
     VkDeviceSize range = 256;
-    if (bindingInfo != nullptr && bindingInfo->minBufferSize > 0) {
+    if (descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) {
+        // Storage buffers usually end in a runtime array, so the declared
+        // size only covers the fixed part.
+        range = VK_WHOLE_SIZE;
+    } else if (bindingInfo != nullptr && bindingInfo->minBufferSize > 0) {
         range = bindingInfo->minBufferSize;
     } else if (info->size > 0) {
         range = info->size;
@@ -1194,6 +1229,22 @@ void Pipeline::bindBuffer(const std::string &name,
 #endif
 }
 
+bool Pipeline::hasBufferBinding(const std::string &name) const {
+    if (!shaderProgram) {
+        return false;
+    }
+#ifdef VULKAN
+    const UniformBindingInfo *info = shaderProgram->findUniform(name);
+    return info != nullptr && info->isBuffer;
+#elif defined(METAL)
+    auto &programState = metal::programState(shaderProgram.get());
+    return !metal::resolveBufferBindings(programState, name).empty();
+#else
+    (void)name;
+    return false;
+#endif
+}
+
 void Pipeline::bindShaderReadWriteBuffer(const std::string &name,
                                          const std::shared_ptr<Buffer> &buffer,
                                          int callerId) {
@@ -1598,6 +1649,9 @@ void Pipeline::bindUniformBufferDescriptor(uint32_t set, uint32_t binding) {
         descriptorBufferIt->second->vkBuffer != VK_NULL_HANDLE) {
         VkDeviceSize range =
             info->minBufferSize > 0 ? info->minBufferSize : 256;
+        if (info->type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) {
+            range = VK_WHOLE_SIZE;
+        }
         VkDescriptorBufferInfo externalBufferInfo{};
         externalBufferInfo.buffer = descriptorBufferIt->second->vkBuffer;
         externalBufferInfo.offset = 0;
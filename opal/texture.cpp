@@ -674,10 +674,7 @@ void Texture::updateData(const void *data, int width, int height,
         this->height = height;
     }
 #elif defined(VULKAN)
-    (void)data;
-    (void)width;
-    (void)height;
-    (void)dataFormat;
+    updateDataVulkan(data, width, height, dataFormat);
 #elif defined(METAL)
     auto &state = metal::textureState(this);
     if (state.texture == nullptr || data == nullptr || width <= 0 ||
@@ -927,16 +924,18 @@ void Pipeline::bindTexture(const std::string &name,
 #ifdef OPENGL
     glActiveTexture(GL_TEXTURE0 + unit);
     glBindTexture(texture->glType, texture->textureID);
-    int location = glGetUniformLocation(shaderProgram->programID, name.c_str());
-    glUniform1i(location, unit);
+    uploadUniform(UniformHandle::hashName(name), name, UniformKind::Int, &unit,
+                  sizeof(int));
 #elif defined(VULKAN)
     if (!shaderProgram || texture == nullptr) {
         return;
     }
-    const UniformBindingInfo *info = shaderProgram->findUniform(name);
-    if (info == nullptr || !info->isSampler) {
+    const CachedUniform *cached =
+        resolveUniform(UniformHandle::hashName(name), name);
+    if (cached == nullptr || !cached->info->isSampler) {
         return;
     }
+    const UniformBindingInfo *info = cached->info;
 
     ensureDescriptorResources();
     if (descriptorSets.size() <= info->set ||
@@ -1015,8 +1014,8 @@ void Pipeline::bindTexture2D(const std::string &name, uint textureId, int unit,
 #ifdef OPENGL
     glActiveTexture(GL_TEXTURE0 + unit);
     glBindTexture(GL_TEXTURE_2D, textureId);
-    int location = glGetUniformLocation(shaderProgram->programID, name.c_str());
-    glUniform1i(location, unit);
+    uploadUniform(UniformHandle::hashName(name), name, UniformKind::Int, &unit,
+                  sizeof(int));
     (void)callerId;
 #elif defined(VULKAN)
     auto texture = Texture::getTextureFromHandle(textureId);
@@ -1032,8 +1031,8 @@ void Pipeline::bindTexture3D(const std::string &name, uint textureId, int unit,
 #ifdef OPENGL
     glActiveTexture(GL_TEXTURE0 + unit);
     glBindTexture(GL_TEXTURE_3D, textureId);
-    int location = glGetUniformLocation(shaderProgram->programID, name.c_str());
-    glUniform1i(location, unit);
+    uploadUniform(UniformHandle::hashName(name), name, UniformKind::Int, &unit,
+                  sizeof(int));
     (void)callerId;
 
 #elif defined(VULKAN)
@@ -1050,8 +1049,8 @@ void Pipeline::bindTextureCubemap(const std::string &name, uint textureId,
 #ifdef OPENGL
     glActiveTexture(GL_TEXTURE0 + unit);
     glBindTexture(GL_TEXTURE_CUBE_MAP, textureId);
-    int location = glGetUniformLocation(shaderProgram->programID, name.c_str());
-    glUniform1i(location, unit);
+    uploadUniform(UniformHandle::hashName(name), name, UniformKind::Int, &unit,
+                  sizeof(int));
     (void)callerId;
 #elif defined(VULKAN)
     auto texture = Texture::getTextureFromHandle(textureId);
@@ -1062,6 +1061,46 @@ void Pipeline::bindTextureCubemap(const std::string &name, uint textureId,
 #endif
 }
 
+void Pipeline::bindTexture(const UniformHandle &handle,
+                           const std::shared_ptr<Texture> &texture, int unit,
+                           int callerId) {
+#ifdef OPENGL
+    (void)callerId;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(texture->glType, texture->textureID);
+    uploadUniform(handle.getId(), handle.getName(), UniformKind::Int, &unit,
+                  sizeof(int));
+#else
+    bindTexture(handle.getName(), texture, unit, callerId);
+#endif
+}
+
+void Pipeline::bindTexture2D(const UniformHandle &handle, uint textureId,
+                             int unit, int callerId) {
+#ifdef OPENGL
+    (void)callerId;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    uploadUniform(handle.getId(), handle.getName(), UniformKind::Int, &unit,
+                  sizeof(int));
+#else
+    bindTexture2D(handle.getName(), textureId, unit, callerId);
+#endif
+}
+
+void Pipeline::bindTextureCubemap(const UniformHandle &handle, uint textureId,
+                                  int unit, int callerId) {
+#ifdef OPENGL
+    (void)callerId;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, textureId);
+    uploadUniform(handle.getId(), handle.getName(), UniformKind::Int, &unit,
+                  sizeof(int));
+#else
+    bindTextureCubemap(handle.getName(), textureId, unit, callerId);
+#endif
+}
+
 std::shared_ptr<Texture> Texture::createMultisampled(TextureFormat format,
                                                      int width, int height,
                                                      int samples) {
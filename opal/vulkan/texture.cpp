@@ -10,6 +10,7 @@
 #ifdef VULKAN
 #include <opal/opal.h>
 #include <cstring>
+#include <glm/gtc/packing.hpp>
 #include <vulkan/vulkan.hpp>
 
 namespace opal {
@@ -248,6 +249,90 @@ static VkSampler createSampler(TextureFilterMode minFilter,
     return sampler;
 }
 
+// Stages `data` and copies it over the whole image, leaving the image ready
+// to be sampled.
+static void uploadTexturePixels(Texture &texture, VkFormat vkFormat,
+                                TextureDataFormat dataFormat, const void *data,
+                                uint32_t arrayLayers) {
+    size_t inputBytesPerPixel = 0;
+    switch (dataFormat) {
+    case TextureDataFormat::Rgba:
+        inputBytesPerPixel = 4;
+        break;
+    case TextureDataFormat::Rgb:
+        inputBytesPerPixel = 3;
+        break;
+    case TextureDataFormat::Red:
+        inputBytesPerPixel = 1;
+        break;
+    default:
+        inputBytesPerPixel = 4;
+        break;
+    }
+
+    size_t outputBytesPerPixel = 4; // Default for RGBA formats
+    if (vkFormat == VK_FORMAT_R8_UNORM || vkFormat == VK_FORMAT_R16_SFLOAT) {
+        outputBytesPerPixel = (vkFormat == VK_FORMAT_R16_SFLOAT) ? 2 : 1;
+    } else if (vkFormat == VK_FORMAT_R16G16B16A16_SFLOAT) {
+        outputBytesPerPixel = 8;
+    }
+
+    size_t pixelCount = static_cast<size_t>(texture.width) * texture.height;
+    VkDeviceSize imageSize = pixelCount * outputBytesPerPixel;
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    Buffer::createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         stagingBuffer, stagingBufferMemory);
+
+    void *mappedData;
+    vkMapMemory(Device::globalDevice, stagingBufferMemory, 0, imageSize, 0,
+                &mappedData);
+
+    if (vkFormat == VK_FORMAT_R16_SFLOAT &&
+        dataFormat == TextureDataFormat::Red) {
+        // Single-channel float data, as the other backends accept it.
+        const auto *src = static_cast<const float *>(data);
+        auto *dst = static_cast<uint16_t *>(mappedData);
+        for (size_t i = 0; i < pixelCount; ++i) {
+            dst[i] = glm::packHalf1x16(src[i]);
+        }
+    } else if (dataFormat == TextureDataFormat::Rgb &&
+               outputBytesPerPixel == 4) {
+        const auto *src = static_cast<const uint8_t *>(data);
+        auto *dst = static_cast<uint8_t *>(mappedData);
+        for (size_t i = 0; i < pixelCount; ++i) {
+            dst[(i * 4) + 0] = src[(i * 3) + 0];
+            dst[(i * 4) + 1] = src[(i * 3) + 1];
+            dst[(i * 4) + 2] = src[(i * 3) + 2];
+            dst[(i * 4) + 3] = 255; // Full alpha
+        }
+    } else {
+        memcpy(mappedData, data, pixelCount * inputBytesPerPixel);
+    }
+
+    vkUnmapMemory(Device::globalDevice, stagingBufferMemory);
+
+    Framebuffer::transitionImageLayout(
+        texture.vkImage, vkFormat, texture.currentLayout,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, arrayLayers);
+
+    copyBufferToImage(stagingBuffer, texture.vkImage,
+                      static_cast<uint32_t>(texture.width),
+                      static_cast<uint32_t>(texture.height), arrayLayers);
+
+    Framebuffer::transitionImageLayout(
+        texture.vkImage, vkFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, arrayLayers);
+
+    texture.currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    vkDestroyBuffer(Device::globalDevice, stagingBuffer, nullptr);
+    vkFreeMemory(Device::globalDevice, stagingBufferMemory, nullptr);
+}
+
 std::shared_ptr<Texture>
 Texture::createVulkan(TextureType type, TextureFormat format, int width,
                       int height, TextureDataFormat dataFormat,
@@ -288,74 +373,7 @@ Texture::createVulkan(TextureType type, TextureFormat format, int width,
                       : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
     if (data != nullptr && width > 0 && height > 0) {
-        size_t inputBytesPerPixel = 0;
-        switch (dataFormat) {
-        case TextureDataFormat::Rgba:
-            inputBytesPerPixel = 4;
-            break;
-        case TextureDataFormat::Rgb:
-            inputBytesPerPixel = 3;
-            break;
-        case TextureDataFormat::Red:
-            inputBytesPerPixel = 1;
-            break;
-        default:
-            inputBytesPerPixel = 4;
-            break;
-        }
-
-        size_t outputBytesPerPixel = 4; // Default for RGBA formats
-        if (vkFormat == VK_FORMAT_R8_UNORM ||
-            vkFormat == VK_FORMAT_R16_SFLOAT) {
-            outputBytesPerPixel = (vkFormat == VK_FORMAT_R16_SFLOAT) ? 2 : 1;
-        } else if (vkFormat == VK_FORMAT_R16G16B16A16_SFLOAT) {
-            outputBytesPerPixel = 8;
-        }
-
-        size_t pixelCount = static_cast<size_t>(width) * height;
-        VkDeviceSize imageSize = pixelCount * outputBytesPerPixel;
-
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        Buffer::createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                                 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                             stagingBuffer, stagingBufferMemory);
-
-        void *mappedData;
-        vkMapMemory(Device::globalDevice, stagingBufferMemory, 0, imageSize, 0,
-                    &mappedData);
-
-        if (dataFormat == TextureDataFormat::Rgb && outputBytesPerPixel == 4) {
-            const auto *src = static_cast<const uint8_t *>(data);
-            auto *dst = static_cast<uint8_t *>(mappedData);
-            for (size_t i = 0; i < pixelCount; ++i) {
-                dst[(i * 4) + 0] = src[(i * 3) + 0];
-                dst[(i * 4) + 1] = src[(i * 3) + 1];
-                dst[(i * 4) + 2] = src[(i * 3) + 2];
-                dst[(i * 4) + 3] = 255; // Full alpha
-            }
-        } else {
-            memcpy(mappedData, data, pixelCount * inputBytesPerPixel);
-        }
-
-        vkUnmapMemory(Device::globalDevice, stagingBufferMemory);
-
-        Framebuffer::transitionImageLayout(
-            texture->vkImage, vkFormat, VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, arrayLayers);
-
-        copyBufferToImage(stagingBuffer, texture->vkImage, width, height,
-                          arrayLayers);
-
-        Framebuffer::transitionImageLayout(
-            texture->vkImage, vkFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, arrayLayers);
-
-        texture->currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-        vkDestroyBuffer(Device::globalDevice, stagingBuffer, nullptr);
-        vkFreeMemory(Device::globalDevice, stagingBufferMemory, nullptr);
+        uploadTexturePixels(*texture, vkFormat, dataFormat, data, arrayLayers);
     } else if (width > 0 && height > 0) {
         Framebuffer::transitionImageLayout(texture->vkImage, vkFormat,
                                            VK_IMAGE_LAYOUT_UNDEFINED,
@@ -368,6 +386,17 @@ Texture::createVulkan(TextureType type, TextureFormat format, int width,
     return texture;
 }
 
+void Texture::updateDataVulkan(const void *data, int width, int height,
+                               TextureDataFormat dataFormat) {
+    if (data == nullptr || vkImage == VK_NULL_HANDLE ||
+        width != this->width || height != this->height) {
+        return;
+    }
+    uint32_t arrayLayers = (type == TextureType::TextureCubeMap) ? 6 : 1;
+    uploadTexturePixels(*this, opalTextureFormatToVulkanFormat(format),
+                        dataFormat, data, arrayLayers);
+}
+
 std::shared_ptr<Texture> Texture::createMultisampledVulkan(TextureFormat format,
                                                            int width,
                                                            int height,
@@ -0,0 +1,160 @@
+//
+// upload.cpp
+// As part of the Atlas project
+// Created by Max Van den Eynde in 2025
+// --------------------------------------------------
+// Description: Vulkan upload ring for non-blocking buffer updates
+// Copyright (c) 2025 Max Van den Eynde
+//
+
+#ifdef VULKAN
+#include <opal/opal.h>
+#include <stdexcept>
+
+namespace opal {
+
+namespace {
+// Keeps every staged write aligned for wide memcpy and copy offsets.
+constexpr VkDeviceSize UPLOAD_ALIGNMENT = 16;
+} // namespace
+
+bool UploadRing::initialize() {
+    if (ringBuffer != VK_NULL_HANDLE) {
+        return true;
+    }
+    if (Device::globalInstance == nullptr ||
+        Device::globalInstance->commandPool == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    VkCommandBuffer commandBuffers[REGION_COUNT];
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = Device::globalInstance->commandPool;
+    allocInfo.commandBufferCount = REGION_COUNT;
+    if (vkAllocateCommandBuffers(Device::globalDevice, &allocInfo,
+                                 commandBuffers) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate upload command buffers!");
+    }
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    for (uint32_t i = 0; i < REGION_COUNT; i++) {
+        regions[i].commandBuffer = commandBuffers[i];
+        if (vkCreateFence(Device::globalDevice, &fenceInfo, nullptr,
+                          &regions[i].fence) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create upload fence!");
+        }
+    }
+
+    Buffer::createBuffer(REGION_SIZE * REGION_COUNT,
+                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         ringBuffer, ringMemory);
+    void *mapped = nullptr;
+    if (vkMapMemory(Device::globalDevice, ringMemory, 0, VK_WHOLE_SIZE, 0,
+                    &mapped) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to map upload ring memory!");
+    }
+    ringData = static_cast<uint8_t *>(mapped);
+    return true;
+}
+
+void UploadRing::open(Region &region) {
+    // The fence guards the submission made REGION_COUNT flushes ago, which
+    // has normally finished long before the region comes around again.
+    vkWaitForFences(Device::globalDevice, 1, &region.fence, VK_TRUE,
+                    UINT64_MAX);
+    vkResetFences(Device::globalDevice, 1, &region.fence);
+    vkResetCommandBuffer(region.commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(region.commandBuffer, &beginInfo);
+
+    // Earlier frames may still read the buffers about to be overwritten.
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(region.commandBuffer,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0,
+                         nullptr, 0, nullptr);
+
+    region.head = 0;
+    region.recording = true;
+}
+
+void *UploadRing::stage(VkBuffer destination, VkDeviceSize offset,
+                        VkDeviceSize size) {
+    if (destination == VK_NULL_HANDLE || size == 0 || size > REGION_SIZE ||
+        !initialize()) {
+        return nullptr;
+    }
+
+    if (!regions[current].recording) {
+        open(regions[current]);
+    }
+    VkDeviceSize head = (regions[current].head + UPLOAD_ALIGNMENT - 1) &
+                        ~(UPLOAD_ALIGNMENT - 1);
+    if (head + size > REGION_SIZE) {
+        flush();
+        open(regions[current]);
+        head = 0;
+    }
+
+    Region &region = regions[current];
+    const VkDeviceSize source = (current * REGION_SIZE) + head;
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = source;
+    copyRegion.dstOffset = offset;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(region.commandBuffer, ringBuffer, destination, 1,
+                    &copyRegion);
+    region.head = head + size;
+    return ringData + source;
+}
+
+void UploadRing::flush() {
+    Region &region = regions[current];
+    if (!region.recording) {
+        return;
+    }
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask =
+        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+        VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT |
+        VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+        VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(region.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0,
+                         nullptr, 0, nullptr);
+
+    if (vkEndCommandBuffer(region.commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to end upload command buffer!");
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &region.commandBuffer;
+    if (vkQueueSubmit(Device::globalInstance->graphicsQueue, 1, &submitInfo,
+                      region.fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit upload command buffer!");
+    }
+
+    region.recording = false;
+    current = (current + 1) % REGION_COUNT;
+}
+
+} // namespace opal
+
+#endif
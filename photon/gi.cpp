@@ -581,156 +581,54 @@ void photon::GlobalIllumination::render(
     Scene *scene = (Window::mainWindow != nullptr)
                        ? Window::mainWindow->currentScene
                        : nullptr;
-    std::vector<GPUDirectionalLight> directionalLights;
-    std::vector<GPUPointLight> pointLights;
-    std::vector<GPUSpotLight> spotLights;
-    std::vector<GPUAreaLight> areaLights;
-
-    if (scene != nullptr) {
-        constexpr size_t maxDirectionalGI = 2;
-        constexpr size_t maxPointGI = 4;
-        constexpr size_t maxSpotGI = 2;
-        constexpr size_t maxAreaGI = 2;
-        const auto &sceneDirectionalLights = scene->getDirectionalLights();
-        directionalLights.reserve(
-            std::min<size_t>(sceneDirectionalLights.size(), maxDirectionalGI));
-        for (auto *light : sceneDirectionalLights) {
-            if (light == nullptr) {
-                continue;
-            }
-            GPUDirectionalLight gpu{};
-            gpu.direction = light->direction.toGlm();
-            gpu.diffuse =
-                glm::vec3(light->color.r, light->color.g, light->color.b);
-            gpu.specular = glm::vec3(light->shineColor.r, light->shineColor.g,
-                                     light->shineColor.b);
-            gpu.intensity = light->intensity;
-            directionalLights.push_back(gpu);
-            if (directionalLights.size() >= maxDirectionalGI) {
-                break;
-            }
-        }
-        if (directionalLights.empty() && scene->atmosphere.isEnabled()) {
-            GPUDirectionalLight gpu{};
-            glm::vec3 sunDir = scene->atmosphere.getSunAngle().toGlm();
-            if (glm::length(sunDir) > 0.0001f) {
-                gpu.direction = -glm::normalize(sunDir);
-            } else {
-                gpu.direction = glm::vec3(0.0f, -1.0f, 0.0f);
-            }
-            Color skyLight = scene->atmosphere.getLightColor();
-            gpu.diffuse = glm::vec3(skyLight.r, skyLight.g, skyLight.b);
-            gpu.specular = gpu.diffuse;
-            gpu.intensity = scene->atmosphere.getLightIntensity() * 1.2f;
-            directionalLights.push_back(gpu);
-        }
-
-        const auto &scenePointLights = scene->getPointLights();
-        pointLights.reserve(
-            std::min<size_t>(scenePointLights.size(), maxPointGI));
-        for (auto *light : scenePointLights) {
-            if (light == nullptr) {
-                continue;
-            }
-            PointLightConstants plc = light->calculateConstants();
-            GPUPointLight gpu{};
-            gpu.position = light->position.toGlm();
-            gpu.diffuse =
-                glm::vec3(light->color.r, light->color.g, light->color.b);
-            gpu.specular = glm::vec3(light->shineColor.r, light->shineColor.g,
-                                     light->shineColor.b);
-            gpu.intensity = light->intensity;
-            gpu.constant = plc.constant;
-            gpu.linear = plc.linear;
-            gpu.quadratic = plc.quadratic;
-            gpu.radius = plc.radius;
-            pointLights.push_back(gpu);
-            if (pointLights.size() >= maxPointGI) {
-                break;
-            }
-        }
-
-        const auto &sceneSpotLights = scene->getSpotlights();
-        spotLights.reserve(std::min<size_t>(sceneSpotLights.size(), maxSpotGI));
-        for (auto *light : sceneSpotLights) {
-            if (light == nullptr) {
-                continue;
-            }
-            GPUSpotLight gpu{};
-            gpu.position = light->position.toGlm();
-            gpu.direction = light->direction.toGlm();
-            gpu.cutOff = light->cutOff;
-            gpu.outerCutOff = light->outerCutoff;
-            gpu.intensity = light->intensity;
-            gpu.range = light->range;
-            gpu.diffuse =
-                glm::vec3(light->color.r, light->color.g, light->color.b);
-            gpu.specular = glm::vec3(light->shineColor.r, light->shineColor.g,
-                                     light->shineColor.b);
-            spotLights.push_back(gpu);
-            if (spotLights.size() >= maxSpotGI) {
-                break;
-            }
-        }
-
-        const auto &sceneAreaLights = scene->getAreaLights();
-        areaLights.reserve(std::min<size_t>(sceneAreaLights.size(), maxAreaGI));
-        for (auto *light : sceneAreaLights) {
-            if (light == nullptr) {
-                continue;
-            }
-            GPUAreaLight gpu{};
-            gpu.position = light->position.toGlm();
-            gpu.right = light->right.toGlm();
-            gpu.up = light->up.toGlm();
-            gpu.size =
-                glm::vec2((float)light->size.width, (float)light->size.height);
-            gpu.diffuse =
-                glm::vec3(light->color.r, light->color.g, light->color.b);
-            gpu.specular = glm::vec3(light->shineColor.r, light->shineColor.g,
-                                     light->shineColor.b);
-            gpu.angle = light->angle;
-            gpu.castsBothSides = light->castsBothSides ? 1 : 0;
-            gpu.intensity = light->intensity;
-            gpu.range = light->range;
-            areaLights.push_back(gpu);
-            if (areaLights.size() >= maxAreaGI) {
-                break;
-            }
-        }
+    // Probes trace a handful of lights from the buffers the window packed
+    // for this frame.
+    constexpr int maxDirectionalGI = 2;
+    constexpr int maxPointGI = 4;
+    constexpr int maxSpotGI = 2;
+    constexpr int maxAreaGI = 2;
+    const LightFrameData *lightFrame =
+        Window::mainWindow != nullptr ? &Window::mainWindow->lightFrameData
+                                      : nullptr;
+    uint32_t directionalLightCount = 0;
+    uint32_t pointLightCount = 0;
+    uint32_t spotLightCount = 0;
+    uint32_t areaLightCount = 0;
+    if (scene != nullptr && lightFrame != nullptr &&
+        lightFrame->getDirectionalLightBuffer() != nullptr) {
+        directionalLightCount = static_cast<uint32_t>(std::min(
+            lightFrame->getDirectionalLightCount(true), maxDirectionalGI));
+        pointLightCount = static_cast<uint32_t>(
+            std::min(lightFrame->getPointLightCount(), maxPointGI));
+        spotLightCount = static_cast<uint32_t>(
+            std::min(lightFrame->getSpotlightCount(), maxSpotGI));
+        areaLightCount = static_cast<uint32_t>(
+            std::min(lightFrame->getAreaLightCount(), maxAreaGI));
+
+        giRaytracingPipeline->bindBuffer(
+            "directionalLights", lightFrame->getDirectionalLightBuffer());
+        giRaytracingPipeline->bindBuffer("pointLights",
+                                         lightFrame->getPointLightBuffer());
+        giRaytracingPipeline->bindBuffer("spotLights",
+                                         lightFrame->getSpotlightBuffer());
+        giRaytracingPipeline->bindBuffer("areaLights",
+                                         lightFrame->getAreaLightBuffer());
+    } else {
+        GPUDirectionalLight fallbackDirectional{};
+        GPUPointLight fallbackPoint{};
+        GPUSpotLight fallbackSpot{};
+        GPUAreaLight fallbackArea{};
+        giRaytracingPipeline->bindBufferData("directionalLights",
+                                             &fallbackDirectional,
+                                             sizeof(fallbackDirectional));
+        giRaytracingPipeline->bindBufferData("pointLights", &fallbackPoint,
+                                             sizeof(fallbackPoint));
+        giRaytracingPipeline->bindBufferData("spotLights", &fallbackSpot,
+                                             sizeof(fallbackSpot));
+        giRaytracingPipeline->bindBufferData("areaLights", &fallbackArea,
+                                             sizeof(fallbackArea));
     }
 
-    GPUDirectionalLight fallbackDirectional{};
-    GPUPointLight fallbackPoint{};
-    GPUSpotLight fallbackSpot{};
-    GPUAreaLight fallbackArea{};
-    giRaytracingPipeline->bindBufferData(
-        "directionalLights",
-        directionalLights.empty()
-            ? static_cast<const void *>(&fallbackDirectional)
-            : static_cast<const void *>(directionalLights.data()),
-        directionalLights.empty()
-            ? sizeof(GPUDirectionalLight)
-            : directionalLights.size() * sizeof(GPUDirectionalLight));
-    giRaytracingPipeline->bindBufferData(
-        "pointLights",
-        pointLights.empty() ? static_cast<const void *>(&fallbackPoint)
-                            : static_cast<const void *>(pointLights.data()),
-        pointLights.empty() ? sizeof(GPUPointLight)
-                            : pointLights.size() * sizeof(GPUPointLight));
-    giRaytracingPipeline->bindBufferData(
-        "spotLights",
-        spotLights.empty() ? static_cast<const void *>(&fallbackSpot)
-                           : static_cast<const void *>(spotLights.data()),
-        spotLights.empty() ? sizeof(GPUSpotLight)
-                           : spotLights.size() * sizeof(GPUSpotLight));
-    giRaytracingPipeline->bindBufferData(
-        "areaLights",
-        areaLights.empty() ? static_cast<const void *>(&fallbackArea)
-                           : static_cast<const void *>(areaLights.data()),
-        areaLights.empty() ? sizeof(GPUAreaLight)
-                           : areaLights.size() * sizeof(GPUAreaLight));
-
     DDGITriangle fallbackTriangle{};
     DDGIMaterial fallbackMaterial{};
     const void *triangleData =
@@ -762,11 +660,10 @@ void photon::GlobalIllumination::render(
     GPUSceneCounts sceneCounts{};
     sceneCounts.triCount = static_cast<uint32_t>(triangles.size());
     sceneCounts.materialCount = static_cast<uint32_t>(materials.size());
-    sceneCounts.directionalLightCount =
-        static_cast<uint32_t>(directionalLights.size());
-    sceneCounts.pointLightCount = static_cast<uint32_t>(pointLights.size());
-    sceneCounts.spotLightCount = static_cast<uint32_t>(spotLights.size());
-    sceneCounts.areaLightCount = static_cast<uint32_t>(areaLights.size());
+    sceneCounts.directionalLightCount = directionalLightCount;
+    sceneCounts.pointLightCount = pointLightCount;
+    sceneCounts.spotLightCount = spotLightCount;
+    sceneCounts.areaLightCount = areaLightCount;
     sceneCounts.textureCount = static_cast<uint32_t>(std::min<int>(
         static_cast<int>(materialTextures.size()), kDdgiMaxMaterialTextures));
     giRaytracingPipeline->bindBufferData("sc", &sceneCounts,
@@ -6094,31 +6094,21 @@ bool parseJointMember(JSContext *ctx, ScriptHost &host, JSValueConst value,
 }
 
 bezel::RaycastResult
-convertToTaggedRaycastResult(const bezel::RaycastResult &input,
-                             const std::vector<std::string> &tags) {
-    if (tags.empty()) {
-        return input;
-    }
-
-    bezel::RaycastResult result;
-    result.closestDistance = -1.0f;
-    for (const auto &hit : input.hits) {
-        if (hit.rigidbody == nullptr) {
-            continue;
-        }
-        if (std::find_first_of(hit.rigidbody->tags.begin(),
-                               hit.rigidbody->tags.end(), tags.begin(),
-                               tags.end()) == hit.rigidbody->tags.end()) {
-            continue;
+runTaggedRaycast(bezel::Rigidbody &body, const std::vector<std::string> &tags,
+                 const Normal3d &direction, float maxDistance,
+                 const std::shared_ptr<bezel::PhysicsWorld> &world,
+                 bool allHits) {
+    bezel::TagMask requiredTags = 0;
+    if (!tags.empty()) {
+        requiredTags = bezel::makeTagMask(tags);
+        if (requiredTags == 0) {
+            return {};
         }
-        result.hits.push_back(hit);
     }
-
-    if (!result.hits.empty()) {
-        result.hit = result.hits.front();
-        result.closestDistance = result.hit.distance;
-    }
-    return result;
+    return allHits ? body.raycastAll(direction, maxDistance, world,
+                                     bezel::INVALID_JOLT_ID, requiredTags)
+                   : body.raycast(direction, maxDistance, world,
+                                  bezel::INVALID_JOLT_ID, requiredTags);
 }
 
 RaycastResult convertRaycastResult(const bezel::RaycastResult &input) {
@@ -11551,10 +11541,9 @@ JSValue jsRigidbodyRaycastTagged(JSContext *ctx, JSValueConst, int argc,
     auto body = ensureBezelBody(*state->component);
     return runRigidbodyRaycastQuery(
         ctx, *host, *state->component, QueryOperation::RaycastTagged,
-        convertToTaggedRaycastResult(
-            body->raycast(direction, static_cast<float>(maxDistance),
-                          host->context->window->physicsWorld),
-            tags));
+        runTaggedRaycast(*body, tags, direction,
+                         static_cast<float>(maxDistance),
+                         host->context->window->physicsWorld, false));
 }
 
 JSValue jsRigidbodyRaycastTaggedAll(JSContext *ctx, JSValueConst, int argc,
@@ -11580,10 +11569,9 @@ JSValue jsRigidbodyRaycastTaggedAll(JSContext *ctx, JSValueConst, int argc,
     auto body = ensureBezelBody(*state->component);
     return runRigidbodyRaycastQuery(
         ctx, *host, *state->component, QueryOperation::RaycastTaggedAll,
-        convertToTaggedRaycastResult(
-            body->raycastAll(direction, static_cast<float>(maxDistance),
-                             host->context->window->physicsWorld),
-            tags));
+        runTaggedRaycast(*body, tags, direction,
+                         static_cast<float>(maxDistance),
+                         host->context->window->physicsWorld, true));
 }
 
 JSValue jsRigidbodyOverlap(JSContext *ctx, JSValueConst, int argc,
@@ -485,11 +485,11 @@ static inline __attribute__((always_inline)) float4 sampleTextureAt(
 
 static inline __attribute__((always_inline)) float calculateShadow(
     thread const ShadowParameters &shadowParam, thread const float3 &fragPos,
-    thread const float3 &normal, texture2d<float> texture1,
-    sampler texture1Smplr, texture2d<float> texture2, sampler texture2Smplr,
-    texture2d<float> texture3, sampler texture3Smplr, texture2d<float> texture4,
-    sampler texture4Smplr, texture2d<float> texture5, sampler texture5Smplr,
-    constant UBO &_526) {
+    thread const float3 &normal, thread const float4 &tile,
+    texture2d<float> texture1, sampler texture1Smplr, texture2d<float> texture2,
+    sampler texture2Smplr, texture2d<float> texture3, sampler texture3Smplr,
+    texture2d<float> texture4, sampler texture4Smplr, texture2d<float> texture5,
+    sampler texture5Smplr, constant UBO &_526) {
     int param = shadowParam.textureIndex;
     float2 dims = getTextureDimensions(
         param, texture1, texture1Smplr, texture2, texture2Smplr, texture3,
@@ -566,9 +566,10 @@ static inline __attribute__((always_inline)) float calculateShadow(
         bias0 += 0.0002500000118743628;
     }
     float shadow = 0.0;
-    float2 texelSize = float2(1.0) / dims;
+    // Filter offsets are measured in texels of the tile, not of the map.
+    float2 shadowMapSize = dims * tile.zw;
+    float2 texelSize = float2(1.0) / shadowMapSize;
     float _distance = length(float3(_526.cameraPosition) - fragPos);
-    float2 shadowMapSize = dims;
     float avgDim = 0.5 * (shadowMapSize.x + shadowMapSize.y);
     float resFactor = fast::clamp(1024.0 / fast::max(avgDim, 1.0), 0.75, 1.25);
     float distFactor = fast::clamp(_distance / 800.0, 0.0, 1.0);
@@ -577,6 +578,9 @@ static inline __attribute__((always_inline)) float calculateShadow(
             isAreaShadow ? 4.199999809265137 : 3.0, distFactor) *
         resFactor;
     float2 filterRadius = texelSize * texelRadius;
+    // Keep the filter inside the tile so it never reads a neighbouring one.
+    float2 tileMin = tile.xy + ((texelSize * tile.zw) * 0.5);
+    float2 tileMax = (tile.xy + tile.zw) - ((texelSize * tile.zw) * 0.5);
     int kernelSamples = isAreaShadow ? 6 : 8;
     int sampleCount = 0;
     for (int i = 0; i < kernelSamples; i++) {
@@ -605,7 +609,8 @@ static inline __attribute__((always_inline)) float calculateShadow(
             continue;
         }
         int param_1 = shadowParam.textureIndex;
-        float2 param_2 = uv;
+        float2 param_2 =
+            fast::clamp(tile.xy + (uv * tile.zw), tileMin, tileMax);
         float pcfDepth =
             sampleTextureAt(param_1, param_2, texture1, texture1Smplr, texture2,
                             texture2Smplr, texture3, texture3Smplr, texture4,
@@ -623,6 +628,78 @@ static inline __attribute__((always_inline)) float calculateShadow(
     return shadow;
 }
 
+// The cascades of a directional light share one shadow map split into a 2x2
+// grid. The first cascade has lightType 0 and the others follow it with
+// lightType 4; farPlane holds the view depth each cascade ends at and
+// lightPos the camera axis that depth is measured along.
+static inline __attribute__((always_inline)) float4
+cascadeTile(int cascade, int cascadeCount) {
+    if (cascadeCount <= 1) {
+        return float4(0.0, 0.0, 1.0, 1.0);
+    }
+    return float4(float(cascade % 2) * 0.5, float(cascade / 2) * 0.5, 0.5,
+                  0.5);
+}
+
+static inline __attribute__((always_inline)) ShadowParameters
+loadShadowParameters(int index, device ShadowParams &_1372) {
+    ShadowParameters param;
+    param.lightView = _1372.shadowParams[index].lightView;
+    param.lightProjection = _1372.shadowParams[index].lightProjection;
+    param.bias0 = _1372.shadowParams[index].bias0;
+    param.textureIndex = _1372.shadowParams[index].textureIndex;
+    param.farPlane = _1372.shadowParams[index].farPlane;
+    param._pad1 = _1372.shadowParams[index]._pad1;
+    param.lightPos = float3(_1372.shadowParams[index].lightPos);
+    param.lightType = _1372.shadowParams[index].lightType;
+    return param;
+}
+
+static inline __attribute__((always_inline)) float calculateCascadedShadow(
+    int first, int shadowCount, device ShadowParams &_1372,
+    thread const float3 &fragPos, thread const float3 &normal,
+    texture2d<float> texture1, sampler texture1Smplr, texture2d<float> texture2,
+    sampler texture2Smplr, texture2d<float> texture3, sampler texture3Smplr,
+    texture2d<float> texture4, sampler texture4Smplr, texture2d<float> texture5,
+    sampler texture5Smplr, constant UBO &_526) {
+    int cascadeCount = 1;
+    while (first + cascadeCount < shadowCount &&
+           _1372.shadowParams[first + cascadeCount].lightType == 4) {
+        cascadeCount++;
+    }
+    // Use the first cascade that reaches the fragment and fade into the next
+    // one over the last tenth of its slice so the split is not visible.
+    float depth = dot(fragPos - float3(_526.cameraPosition),
+                      float3(_1372.shadowParams[first].lightPos));
+    float sliceNear = 0.0;
+    for (int c = 0; c < cascadeCount; c++) {
+        ShadowParameters cascade = loadShadowParameters(first + c, _1372);
+        if (cascadeCount > 1 && depth > cascade.farPlane) {
+            sliceNear = cascade.farPlane;
+            continue;
+        }
+        float4 tile = cascadeTile(c, cascadeCount);
+        float shadow = calculateShadow(
+            cascade, fragPos, normal, tile, texture1, texture1Smplr, texture2,
+            texture2Smplr, texture3, texture3Smplr, texture4, texture4Smplr,
+            texture5, texture5Smplr, _526);
+        float blendStart = mix(sliceNear, cascade.farPlane, 0.9);
+        if (c + 1 < cascadeCount && depth > blendStart) {
+            ShadowParameters next =
+                loadShadowParameters(first + c + 1, _1372);
+            float4 nextTile = cascadeTile(c + 1, cascadeCount);
+            float nextShadow = calculateShadow(
+                next, fragPos, normal, nextTile, texture1, texture1Smplr,
+                texture2, texture2Smplr, texture3, texture3Smplr, texture4,
+                texture4Smplr, texture5, texture5Smplr, _526);
+            shadow = mix(shadow, nextShadow,
+                         smoothstep(blendStart, cascade.farPlane, depth));
+        }
+        return shadow;
+    }
+    return 0.0;
+}
+
 static inline __attribute__((always_inline)) float
 distributionGGX(thread const float3 &N, thread const float3 &H,
                 thread const float &roughness) {
@@ -1212,9 +1289,10 @@ fragment main0_out main0(
             ShadowParameters param_2 = _1397;
             float3 param_3 = FragPos;
             float3 param_4 = shadowNormal;
+            float4 param_5 = float4(0.0, 0.0, 1.0, 1.0);
             spotShadow = fast::max(
                 spotShadow,
-                calculateShadow(param_2, param_3, param_4, texture1,
+                calculateShadow(param_2, param_3, param_4, param_5, texture1,
                                 texture1Smplr, texture2, texture2Smplr,
                                 texture3, texture3Smplr, texture4,
                                 texture4Smplr, texture5, texture5Smplr, _526));
@@ -1231,30 +1309,20 @@ fragment main0_out main0(
             ShadowParameters param_2 = _1397;
             float3 param_3 = FragPos;
             float3 param_4 = shadowNormal;
+            float4 param_5 = float4(0.0, 0.0, 1.0, 1.0);
             areaShadow += calculateShadow(
-                param_2, param_3, param_4, texture1, texture1Smplr, texture2,
-                texture2Smplr, texture3, texture3Smplr, texture4, texture4Smplr,
-                texture5, texture5Smplr, _526);
+                param_2, param_3, param_4, param_5, texture1, texture1Smplr,
+                texture2, texture2Smplr, texture3, texture3Smplr, texture4,
+                texture4Smplr, texture5, texture5Smplr, _526);
             areaShadowCount++;
-        } else {
-            ShadowParameters _1397;
-            _1397.lightView = _1372.shadowParams[i].lightView;
-            _1397.lightProjection = _1372.shadowParams[i].lightProjection;
-            _1397.bias0 = _1372.shadowParams[i].bias0;
-            _1397.textureIndex = _1372.shadowParams[i].textureIndex;
-            _1397.farPlane = _1372.shadowParams[i].farPlane;
-            _1397._pad1 = _1372.shadowParams[i]._pad1;
-            _1397.lightPos = float3(_1372.shadowParams[i].lightPos);
-            _1397.lightType = _1372.shadowParams[i].lightType;
-            ShadowParameters param_2 = _1397;
-            float3 param_3 = FragPos;
-            float3 param_4 = shadowNormal;
+        } else if (_1372.shadowParams[i].lightType == 0) {
             directionalShadow = fast::max(
                 directionalShadow,
-                calculateShadow(param_2, param_3, param_4, texture1,
-                                texture1Smplr, texture2, texture2Smplr,
-                                texture3, texture3Smplr, texture4,
-                                texture4Smplr, texture5, texture5Smplr, _526));
+                calculateCascadedShadow(
+                    i, shadowCount, _1372, FragPos, shadowNormal, texture1,
+                    texture1Smplr, texture2, texture2Smplr, texture3,
+                    texture3Smplr, texture4, texture4Smplr, texture5,
+                    texture5Smplr, _526));
         }
     }
     if (areaShadowCount > 0) {
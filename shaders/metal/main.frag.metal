@@ -540,7 +540,7 @@ float2 getTextureDimensions(thread const int& textureIndex, texture2d<float> tex
 }
 
 static inline __attribute__((always_inline))
-float calculateShadow(thread const ShadowParameters& shadowParam, thread const float4& fragPosLightSpace, constant Uniforms& _163, texture2d<float> texture1, sampler texture1Smplr, texture2d<float> texture2, sampler texture2Smplr, texture2d<float> texture3, sampler texture3Smplr, texture2d<float> texture4, sampler texture4Smplr, texture2d<float> texture5, sampler texture5Smplr, texture2d<float> texture6, sampler texture6Smplr, texture2d<float> texture7, sampler texture7Smplr, texture2d<float> texture8, sampler texture8Smplr, texture2d<float> texture9, sampler texture9Smplr, texture2d<float> texture10, sampler texture10Smplr, device DirectionalLightsUBO& _1083, thread float3& Normal, thread float3& FragPos)
+float calculateShadow(thread const ShadowParameters& shadowParam, thread const float4& fragPosLightSpace, thread const float4& tile, constant Uniforms& _163, texture2d<float> texture1, sampler texture1Smplr, texture2d<float> texture2, sampler texture2Smplr, texture2d<float> texture3, sampler texture3Smplr, texture2d<float> texture4, sampler texture4Smplr, texture2d<float> texture5, sampler texture5Smplr, texture2d<float> texture6, sampler texture6Smplr, texture2d<float> texture7, sampler texture7Smplr, texture2d<float> texture8, sampler texture8Smplr, texture2d<float> texture9, sampler texture9Smplr, texture2d<float> texture10, sampler texture10Smplr, device DirectionalLightsUBO& _1083, thread float3& Normal, thread float3& FragPos)
 {
     float3 projCoords = fragPosLightSpace.xyz / float3(fragPosLightSpace.w);
     projCoords = (projCoords * 0.5) + float3(0.5);
@@ -604,6 +604,10 @@ float calculateShadow(thread const ShadowParameters& shadowParam, thread const f
     float2 texelSize = float2(1.0) / getTextureDimensions(param, texture1, texture1Smplr, texture2, texture2Smplr, texture3, texture3Smplr, texture4, texture4Smplr, texture5, texture5Smplr, texture6, texture6Smplr, texture7, texture7Smplr, texture8, texture8Smplr, texture9, texture9Smplr, texture10, texture10Smplr);
     float _distance = length(_163.cameraPosition - FragPos);
     int kernelSize = int(mix(1.0, 3.0, fast::clamp(_distance / 100.0, 0.0, 1.0)));
+    // Keep the filter inside the tile so it never reads a neighbouring one.
+    float2 uv = tile.xy + (projCoords.xy * tile.zw);
+    float2 tileMin = tile.xy + (texelSize * 0.5);
+    float2 tileMax = (tile.xy + tile.zw) - (texelSize * 0.5);
     int sampleCount = 0;
     int _1444 = -kernelSize;
     for (int x = _1444; x <= kernelSize; x++)
@@ -612,7 +616,7 @@ float calculateShadow(thread const ShadowParameters& shadowParam, thread const f
         for (int y = _1455; y <= kernelSize; y++)
         {
             int param_1 = shadowParam.textureIndex;
-            float2 param_2 = projCoords.xy + (float2(float(x), float(y)) * texelSize);
+            float2 param_2 = fast::clamp(uv + (float2(float(x), float(y)) * texelSize), tileMin, tileMax);
             float pcfDepth = sampleTextureAt(param_1, param_2, texture1, texture1Smplr, texture2, texture2Smplr, texture3, texture3Smplr, texture4, texture4Smplr, texture5, texture5Smplr, texture6, texture6Smplr, texture7, texture7Smplr, texture8, texture8Smplr, texture9, texture9Smplr, texture10, texture10Smplr).x;
             shadow += float((currentDepth - bias0) > pcfDepth);
             sampleCount++;
@@ -622,6 +626,72 @@ float calculateShadow(thread const ShadowParameters& shadowParam, thread const f
     return shadow;
 }
 
+// The cascades of a directional light share one shadow map split into a 2x2
+// grid. The first cascade has lightType 0 and the others follow it with
+// lightType 4; farPlane holds the view depth each cascade ends at and
+// lightPos the camera axis that depth is measured along.
+static inline __attribute__((always_inline))
+float4 cascadeTile(int cascade, int cascadeCount)
+{
+    if (cascadeCount <= 1)
+    {
+        return float4(0.0, 0.0, 1.0, 1.0);
+    }
+    return float4(float(cascade % 2) * 0.5, float(cascade / 2) * 0.5, 0.5, 0.5);
+}
+
+static inline __attribute__((always_inline))
+ShadowParameters loadShadowParameters(int index, device ShadowParametersUBO& _1905)
+{
+    ShadowParameters param;
+    param.lightView = _1905.shadowParams[index].lightView;
+    param.lightProjection = _1905.shadowParams[index].lightProjection;
+    param.bias0 = _1905.shadowParams[index].bias0;
+    param.textureIndex = _1905.shadowParams[index].textureIndex;
+    param.farPlane = _1905.shadowParams[index].farPlane;
+    param._pad1 = _1905.shadowParams[index]._pad1;
+    param.lightPos = float3(_1905.shadowParams[index].lightPos);
+    param.lightType = _1905.shadowParams[index].lightType;
+    return param;
+}
+
+static inline __attribute__((always_inline))
+float calculateCascadedShadow(int first, constant PushConstants& _1073, device ShadowParametersUBO& _1905, constant Uniforms& _163, texture2d<float> texture1, sampler texture1Smplr, texture2d<float> texture2, sampler texture2Smplr, texture2d<float> texture3, sampler texture3Smplr, texture2d<float> texture4, sampler texture4Smplr, texture2d<float> texture5, sampler texture5Smplr, texture2d<float> texture6, sampler texture6Smplr, texture2d<float> texture7, sampler texture7Smplr, texture2d<float> texture8, sampler texture8Smplr, texture2d<float> texture9, sampler texture9Smplr, texture2d<float> texture10, sampler texture10Smplr, device DirectionalLightsUBO& _1083, thread float3& Normal, thread float3& FragPos)
+{
+    int cascadeCount = 1;
+    while (((first + cascadeCount) < _1073.shadowParamCount) && (_1905.shadowParams[first + cascadeCount].lightType == 4))
+    {
+        cascadeCount++;
+    }
+    // Use the first cascade that reaches the fragment and fade into the next
+    // one over the last tenth of its slice so the split is not visible.
+    float depth = dot(FragPos - _163.cameraPosition, float3(_1905.shadowParams[first].lightPos));
+    float sliceNear = 0.0;
+    for (int c = 0; c < cascadeCount; c++)
+    {
+        ShadowParameters cascade = loadShadowParameters(first + c, _1905);
+        if ((cascadeCount > 1) && (depth > cascade.farPlane))
+        {
+            sliceNear = cascade.farPlane;
+            continue;
+        }
+        float4 fragPosLightSpace = (cascade.lightProjection * cascade.lightView) * float4(FragPos, 1.0);
+        float4 tile = cascadeTile(c, cascadeCount);
+        float shadow = calculateShadow(cascade, fragPosLightSpace, tile, _163, texture1, texture1Smplr, texture2, texture2Smplr, texture3, texture3Smplr, texture4, texture4Smplr, texture5, texture5Smplr, texture6, texture6Smplr, texture7, texture7Smplr, texture8, texture8Smplr, texture9, texture9Smplr, texture10, texture10Smplr, _1083, Normal, FragPos);
+        float blendStart = mix(sliceNear, cascade.farPlane, 0.9);
+        if (((c + 1) < cascadeCount) && (depth > blendStart))
+        {
+            ShadowParameters next = loadShadowParameters(first + c + 1, _1905);
+            float4 nextLightSpace = (next.lightProjection * next.lightView) * float4(FragPos, 1.0);
+            float4 nextTile = cascadeTile(c + 1, cascadeCount);
+            float nextShadow = calculateShadow(next, nextLightSpace, nextTile, _163, texture1, texture1Smplr, texture2, texture2Smplr, texture3, texture3Smplr, texture4, texture4Smplr, texture5, texture5Smplr, texture6, texture6Smplr, texture7, texture7Smplr, texture8, texture8Smplr, texture9, texture9Smplr, texture10, texture10Smplr, _1083, Normal, FragPos);
+            shadow = mix(shadow, nextShadow, smoothstep(blendStart, cascade.farPlane, depth));
+        }
+        return shadow;
+    }
+    return 0.0;
+}
+
 static inline __attribute__((always_inline))
 float4 sampleCubeTextureAt(thread const int& textureIndex, thread const float3& direction, texturecube<float> cubeMap1, sampler cubeMap1Smplr, texturecube<float> cubeMap2, sampler cubeMap2Smplr, texturecube<float> cubeMap3, sampler cubeMap3Smplr, texturecube<float> cubeMap4, sampler cubeMap4Smplr, texturecube<float> cubeMap5, sampler cubeMap5Smplr)
 {
@@ -1065,19 +1135,7 @@ fragment main0_out main0(main0_in in [[stage_in]], constant Uniforms& _163 [[buf
         {
             if (_1905.shadowParams[i_1].lightType == 0)
             {
-                float4 fragPosLightSpace = (_1905.shadowParams[i_1].lightProjection * _1905.shadowParams[i_1].lightView) * float4(in.FragPos, 1.0);
-                ShadowParameters _1934;
-                _1934.lightView = _1905.shadowParams[i_1].lightView;
-                _1934.lightProjection = _1905.shadowParams[i_1].lightProjection;
-                _1934.bias0 = _1905.shadowParams[i_1].bias0;
-                _1934.textureIndex = _1905.shadowParams[i_1].textureIndex;
-                _1934.farPlane = _1905.shadowParams[i_1].farPlane;
-                _1934._pad1 = _1905.shadowParams[i_1]._pad1;
-                _1934.lightPos = float3(_1905.shadowParams[i_1].lightPos);
-                _1934.lightType = _1905.shadowParams[i_1].lightType;
-                ShadowParameters param_7 = _1934;
-                float4 param_8 = fragPosLightSpace;
-                areaShadow = fast::max(areaShadow, calculateShadow(param_7, param_8, _163, texture1, texture1Smplr, texture2, texture2Smplr, texture3, texture3Smplr, texture4, texture4Smplr, texture5, texture5Smplr, texture6, texture6Smplr, texture7, texture7Smplr, texture8, texture8Smplr, texture9, texture9Smplr, texture10, texture10Smplr, _1083, in.Normal, in.FragPos));
+                areaShadow = fast::max(areaShadow, calculateCascadedShadow(i_1, _1073, _1905, _163, texture1, texture1Smplr, texture2, texture2Smplr, texture3, texture3Smplr, texture4, texture4Smplr, texture5, texture5Smplr, texture6, texture6Smplr, texture7, texture7Smplr, texture8, texture8Smplr, texture9, texture9Smplr, texture10, texture10Smplr, _1083, in.Normal, in.FragPos));
             }
             else if (_1905.shadowParams[i_1].lightType == 1)
             {
@@ -1093,7 +1151,8 @@ fragment main0_out main0(main0_in in [[stage_in]], constant Uniforms& _163 [[buf
                 _1934.lightType = _1905.shadowParams[i_1].lightType;
                 ShadowParameters param_7 = _1934;
                 float4 param_8 = fragPosLightSpace;
-                spotShadow = fast::max(spotShadow, calculateShadow(param_7, param_8, _163, texture1, texture1Smplr, texture2, texture2Smplr, texture3, texture3Smplr, texture4, texture4Smplr, texture5, texture5Smplr, texture6, texture6Smplr, texture7, texture7Smplr, texture8, texture8Smplr, texture9, texture9Smplr, texture10, texture10Smplr, _1083, in.Normal, in.FragPos));
+                float4 fullTile = float4(0.0, 0.0, 1.0, 1.0);
+                spotShadow = fast::max(spotShadow, calculateShadow(param_7, param_8, fullTile, _163, texture1, texture1Smplr, texture2, texture2Smplr, texture3, texture3Smplr, texture4, texture4Smplr, texture5, texture5Smplr, texture6, texture6Smplr, texture7, texture7Smplr, texture8, texture8Smplr, texture9, texture9Smplr, texture10, texture10Smplr, _1083, in.Normal, in.FragPos));
             }
             else if (_1905.shadowParams[i_1].lightType == 2)
             {
@@ -1109,9 +1168,10 @@ fragment main0_out main0(main0_in in [[stage_in]], constant Uniforms& _163 [[buf
                 _1934.lightType = _1905.shadowParams[i_1].lightType;
                 ShadowParameters param_7 = _1934;
                 float4 param_8 = fragPosLightSpace;
-                directionalShadow = fast::max(directionalShadow, calculateShadow(param_7, param_8, _163, texture1, texture1Smplr, texture2, texture2Smplr, texture3, texture3Smplr, texture4, texture4Smplr, texture5, texture5Smplr, texture6, texture6Smplr, texture7, texture7Smplr, texture8, texture8Smplr, texture9, texture9Smplr, texture10, texture10Smplr, _1083, in.Normal, in.FragPos));
+                float4 fullTile = float4(0.0, 0.0, 1.0, 1.0);
+                directionalShadow = fast::max(directionalShadow, calculateShadow(param_7, param_8, fullTile, _163, texture1, texture1Smplr, texture2, texture2Smplr, texture3, texture3Smplr, texture4, texture4Smplr, texture5, texture5Smplr, texture6, texture6Smplr, texture7, texture7Smplr, texture8, texture8Smplr, texture9, texture9Smplr, texture10, texture10Smplr, _1083, in.Normal, in.FragPos));
             }
-            else
+            else if (_1905.shadowParams[i_1].lightType == 3)
             {
                 ShadowParameters _1945;
                 _1945.lightView = _1905.shadowParams[i_1].lightView;
@@ -19,6 +19,7 @@ struct PushConstants
     int biomesCount;
     float diffuseStrength;
     float specularStrength;
+    float4 shadowAtlasRect;
 };
 
 struct TerrainParameters
@@ -213,11 +214,15 @@ float calculateShadow(thread const float4& fragPosLightSpace, thread const float
     float bias0 = fast::max(_331.shadowBias * (1.0 - dot(normal, _331.lightDir)), _331.shadowBias * 0.100000001490116119384765625);
     float shadow = 0.0;
     float2 texelSize = float2(1.0) / float2(int2(shadowMap.get_width(), shadowMap.get_height()));
+    // The shadow map can hold several cascades; only read from this one.
+    float2 uv = _331.shadowAtlasRect.xy + (projCoords.xy * _331.shadowAtlasRect.zw);
+    float2 tileMin = _331.shadowAtlasRect.xy + (texelSize * 0.5);
+    float2 tileMax = (_331.shadowAtlasRect.xy + _331.shadowAtlasRect.zw) - (texelSize * 0.5);
     for (int x = -1; x <= 1; x++)
     {
         for (int y = -1; y <= 1; y++)
         {
-            float pcfDepth = shadowMap.sample(shadowMapSmplr, (projCoords.xy + (float2(float(x), float(y)) * texelSize))).x;
+            float pcfDepth = shadowMap.sample(shadowMapSmplr, fast::clamp(uv + (float2(float(x), float(y)) * texelSize), tileMin, tileMax)).x;
             shadow += float((currentDepth - bias0) > pcfDepth);
         }
     }
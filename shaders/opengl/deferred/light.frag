@@ -164,7 +164,7 @@ vec3 fresnelSchlick(float cosTheta, vec3 F0) {
     return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0);
 }
 
-float calculateShadow(ShadowParameters shadowParam, vec3 fragPos, vec3 normal) {
+float calculateShadowInTile(ShadowParameters shadowParam, vec3 fragPos, vec3 normal, vec4 tile) {
     vec4 fragPosLightSpace = shadowParam.lightProjection * shadowParam.lightView * vec4(fragPos, 1.0);
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     projCoords = projCoords * 0.5 + 0.5;
@@ -184,10 +184,11 @@ float calculateShadow(ShadowParameters shadowParam, vec3 fragPos, vec3 normal) {
     float bias = max(biasValue * (1.0 - ndotl), minBias);
 
     float shadow = 0.0;
-    vec2 texelSize = 1.0 / getTextureDimensions(shadowParam.textureIndex);
+    // Filter offsets are measured in texels of the tile, not of the map.
+    vec2 shadowMapSize = getTextureDimensions(shadowParam.textureIndex) * tile.zw;
+    vec2 texelSize = 1.0 / shadowMapSize;
 
     float distance = length(cameraPosition - fragPos);
-    vec2 shadowMapSize = getTextureDimensions(shadowParam.textureIndex);
     float avgDim = 0.5 * (shadowMapSize.x + shadowMapSize.y);
     float resFactor = clamp(1024.0 / max(avgDim, 1.0), 0.75, 1.25);
     float distFactor = clamp(distance / 800.0, 0.0, 1.0);
@@ -202,6 +203,9 @@ float calculateShadow(ShadowParameters shadowParam, vec3 fragPos, vec3 normal) {
         );
     float texelRadius = mix(1.0, 3.0, distFactor) * resFactor;
     vec2 filterRadius = texelSize * texelRadius;
+    // Keep the filter inside the tile so it never reads a neighbouring one.
+    vec2 tileMin = tile.xy + texelSize * tile.zw * 0.5;
+    vec2 tileMax = tile.xy + tile.zw - texelSize * tile.zw * 0.5;
 
     int sampleCount = 0;
     for (int i = 0; i < 12; ++i) {
@@ -210,7 +214,8 @@ float calculateShadow(ShadowParameters shadowParam, vec3 fragPos, vec3 normal) {
         if (uv.x < 0.0 || uv.x > 1.0 || uv.y < 0.0 || uv.y > 1.0) {
             continue;
         }
-        float pcfDepth = sampleTextureAt(shadowParam.textureIndex, uv).r;
+        float pcfDepth = sampleTextureAt(shadowParam.textureIndex,
+                clamp(tile.xy + uv * tile.zw, tileMin, tileMax)).r;
         shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
         sampleCount++;
     }
@@ -221,6 +226,55 @@ float calculateShadow(ShadowParameters shadowParam, vec3 fragPos, vec3 normal) {
     return shadow;
 }
 
+float calculateShadow(ShadowParameters shadowParam, vec3 fragPos, vec3 normal) {
+    return calculateShadowInTile(shadowParam, fragPos, normal, vec4(0.0, 0.0, 1.0, 1.0));
+}
+
+// The cascades of a directional light share one shadow map split into a 2x2
+// grid. The first cascade has lightType 0 and the others follow it with
+// lightType 4; farPlane holds the view depth each cascade ends at and
+// lightPos the camera axis that depth is measured along.
+vec4 cascadeTile(int cascade, int cascadeCount) {
+    if (cascadeCount <= 1) {
+        return vec4(0.0, 0.0, 1.0, 1.0);
+    }
+    return vec4(float(cascade % 2) * 0.5, float(cascade / 2) * 0.5, 0.5, 0.5);
+}
+
+float calculateCascadedShadow(int first, vec3 fragPos, vec3 normal) {
+    int cascadeCount = 1;
+    while (first + cascadeCount < shadowParamCount &&
+            shadowParams[first + cascadeCount].lightType == 4) {
+        cascadeCount++;
+    }
+    if (cascadeCount == 1) {
+        return calculateShadow(shadowParams[first], fragPos, normal);
+    }
+
+    // Use the first cascade that reaches the fragment and fade into the next
+    // one over the last tenth of its slice so the split is not visible.
+    float depth = dot(fragPos - cameraPosition, shadowParams[first].lightPos);
+    float sliceNear = 0.0;
+    for (int c = 0; c < cascadeCount; c++) {
+        ShadowParameters cascade = shadowParams[first + c];
+        if (depth > cascade.farPlane) {
+            sliceNear = cascade.farPlane;
+            continue;
+        }
+        float shadow = calculateShadowInTile(cascade, fragPos, normal,
+                cascadeTile(c, cascadeCount));
+        float blendStart = mix(sliceNear, cascade.farPlane, 0.9);
+        if (c + 1 < cascadeCount && depth > blendStart) {
+            float nextShadow = calculateShadowInTile(shadowParams[first + c + 1],
+                    fragPos, normal, cascadeTile(c + 1, cascadeCount));
+            shadow = mix(shadow, nextShadow,
+                    smoothstep(blendStart, cascade.farPlane, depth));
+        }
+        return shadow;
+    }
+    return 0.0;
+}
+
 float calculatePointShadow(ShadowParameters shadowParam, vec3 fragPos) {
     vec3 fragToLight = fragPos - shadowParam.lightPos;
     float currentDepth = length(fragToLight);
@@ -383,8 +437,8 @@ void main() {
             spotShadow = max(spotShadow, calculateShadow(shadowParams[i], FragPos, N));
         } else if (shadowParams[i].lightType == 2) {
             areaShadow = max(areaShadow, calculateShadow(shadowParams[i], FragPos, N));
-        } else {
-            directionalShadow = max(directionalShadow, calculateShadow(shadowParams[i], FragPos, N));
+        } else if (shadowParams[i].lightType == 0) {
+            directionalShadow = max(directionalShadow, calculateCascadedShadow(i, FragPos, N));
         }
     }
     directionalShadow = clamp(directionalShadow * 0.85, 0.0, 1.0);
@@ -518,7 +518,7 @@ vec3 calcAllSpotLights(vec3 N, vec3 fragPos, vec3 L, vec3 viewDir, vec3 albedo,
 }
 
 // ----- Shadow Calculations -----
-float calculateShadow(ShadowParameters shadowParam, vec4 fragPosLightSpace) {
+float calculateShadowInTile(ShadowParameters shadowParam, vec4 fragPosLightSpace, vec4 tile) {
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     projCoords = projCoords * 0.5 + 0.5;
 
@@ -537,6 +537,10 @@ float calculateShadow(ShadowParameters shadowParam, vec4 fragPosLightSpace) {
 
     float shadow = 0.0;
     vec2 texelSize = 1.0 / getTextureDimensions(shadowParam.textureIndex);
+    // Keep the filter inside the tile so it never reads a neighbouring one.
+    vec2 uv = tile.xy + projCoords.xy * tile.zw;
+    vec2 tileMin = tile.xy + texelSize * 0.5;
+    vec2 tileMax = tile.xy + tile.zw - texelSize * 0.5;
 
     float distance = length(cameraPosition - FragPos);
     int kernelSize = int(mix(1.0, 3.0, clamp(distance / 100.0, 0.0, 1.0)));
@@ -545,7 +549,7 @@ float calculateShadow(ShadowParameters shadowParam, vec4 fragPosLightSpace) {
     for (int x = -kernelSize; x <= kernelSize; ++x) {
         for (int y = -kernelSize; y <= kernelSize; ++y) {
             float pcfDepth = sampleTextureAt(shadowParam.textureIndex,
-                    projCoords.xy + vec2(x, y) * texelSize).r;
+                    clamp(uv + vec2(x, y) * texelSize, tileMin, tileMax)).r;
             shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
             sampleCount++;
         }
@@ -555,6 +559,62 @@ float calculateShadow(ShadowParameters shadowParam, vec4 fragPosLightSpace) {
     return shadow;
 }
 
+float calculateShadow(ShadowParameters shadowParam, vec4 fragPosLightSpace) {
+    return calculateShadowInTile(shadowParam, fragPosLightSpace, vec4(0.0, 0.0, 1.0, 1.0));
+}
+
+// The cascades of a directional light share one shadow map split into a 2x2
+// grid. The first cascade has lightType 0 and the others follow it with
+// lightType 4; farPlane holds the view depth each cascade ends at and
+// lightPos the camera axis that depth is measured along.
+vec4 cascadeTile(int cascade, int cascadeCount) {
+    if (cascadeCount <= 1) {
+        return vec4(0.0, 0.0, 1.0, 1.0);
+    }
+    return vec4(float(cascade % 2) * 0.5, float(cascade / 2) * 0.5, 0.5, 0.5);
+}
+
+float calculateCascadedShadow(int first, vec3 fragPos) {
+    int cascadeCount = 1;
+    while (first + cascadeCount < shadowParamCount &&
+            shadowParams[first + cascadeCount].lightType == 4) {
+        cascadeCount++;
+    }
+    if (cascadeCount == 1) {
+        vec4 fragPosLightSpace = shadowParams[first].lightProjection *
+                shadowParams[first].lightView * vec4(fragPos, 1.0);
+        return calculateShadow(shadowParams[first], fragPosLightSpace);
+    }
+
+    // Use the first cascade that reaches the fragment and fade into the next
+    // one over the last tenth of its slice so the split is not visible.
+    float depth = dot(fragPos - cameraPosition, shadowParams[first].lightPos);
+    float sliceNear = 0.0;
+    for (int c = 0; c < cascadeCount; c++) {
+        ShadowParameters cascade = shadowParams[first + c];
+        if (depth > cascade.farPlane) {
+            sliceNear = cascade.farPlane;
+            continue;
+        }
+        vec4 fragPosLightSpace = cascade.lightProjection * cascade.lightView *
+                vec4(fragPos, 1.0);
+        float shadow = calculateShadowInTile(cascade, fragPosLightSpace,
+                cascadeTile(c, cascadeCount));
+        float blendStart = mix(sliceNear, cascade.farPlane, 0.9);
+        if (c + 1 < cascadeCount && depth > blendStart) {
+            ShadowParameters next = shadowParams[first + c + 1];
+            vec4 nextLightSpace = next.lightProjection * next.lightView *
+                    vec4(fragPos, 1.0);
+            float nextShadow = calculateShadowInTile(next, nextLightSpace,
+                    cascadeTile(c + 1, cascadeCount));
+            shadow = mix(shadow, nextShadow,
+                    smoothstep(blendStart, cascade.farPlane, depth));
+        }
+        return shadow;
+    }
+    return 0.0;
+}
+
 float calculateShadowRaw(ShadowParameters shadowParam, vec4 fragPosLightSpace) {
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     projCoords = projCoords * 0.5 + 0.5;
@@ -721,10 +781,7 @@ void main() {
     if (shadowParamCount > 0) {
         for (int i = 0; i < shadowParamCount; i++) {
             if (shadowParams[i].lightType == 0) {
-                vec4 fragPosLightSpace = shadowParams[i].lightProjection *
-                        shadowParams[i].lightView *
-                        vec4(FragPos, 1.0);
-                directionalShadow = max(directionalShadow, calculateShadow(shadowParams[i], fragPosLightSpace));
+                directionalShadow = max(directionalShadow, calculateCascadedShadow(i, FragPos));
             } else if (shadowParams[i].lightType == 1) {
                 vec4 fragPosLightSpace = shadowParams[i].lightProjection *
                         shadowParams[i].lightView *
@@ -29,6 +29,15 @@ uniform sampler2D normalTexture;
 uniform int hasNormalTexture;
 uniform int hasMovementTexture;
 uniform vec3 windForce;
+uniform mat4 reflectionViewProjection;
+uniform mat4 refractionViewProjection;
+
+// Captures can be a few frames old, so they are looked up where this point
+// was on screen when they were rendered.
+vec2 captureUV(mat4 viewProjection, vec3 worldPos) {
+    vec4 captureClip = viewProjection * vec4(worldPos, 1.0);
+    return captureClip.xy / captureClip.w * 0.5 + 0.5;
+}
 
 void main()
 {
@@ -88,11 +97,12 @@ void main()
         normal = normalize(mix(N, worldSpaceNormal, normalStrength));
     }
     
-    vec2 reflectionUV = screenUV;
+    vec2 reflectionUV = captureUV(reflectionViewProjection, WorldPos);
     reflectionUV.y = 1.0 - reflectionUV.y;  
     reflectionUV += waveOffset * 0.3;
     
-    vec2 refractionUV = screenUV - waveOffset * 0.2;
+    vec2 refractionUV =
+        captureUV(refractionViewProjection, WorldPos) - waveOffset * 0.2;
     
     bool reflectionInBounds = (reflectionUV.x >= 0.0 && reflectionUV.x <= 1.0 && 
                                reflectionUV.y >= 0.0 && reflectionUV.y <= 1.0);
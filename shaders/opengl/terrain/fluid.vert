@@ -8,6 +8,8 @@ layout(location = 4) in vec3 aBitangent;
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform sampler2D waveTexture;
+uniform int hasWaveTexture;
 
 out vec2 TexCoord;
 out vec3 WorldPos;
@@ -16,10 +18,25 @@ out vec3 WorldTangent;
 out vec3 WorldBitangent;
 
 void main() {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    vec3 worldPos = vec3(model * vec4(aPos, 1.0));
+    vec3 normal = normalize(mat3(model) * aNormal);
+    vec3 tangent = normalize(mat3(model) * aTangent);
+    vec3 bitangent = normalize(mat3(model) * aBitangent);
+
+    if (hasWaveTexture == 1) {
+        // r: height, g/b: slope along the tangent and bitangent.
+        vec4 wave = textureLod(waveTexture, aTexCoord, 0.0);
+        worldPos += normal * wave.r;
+        vec3 flatNormal = normal;
+        normal = normalize(normal - tangent * wave.g - bitangent * wave.b);
+        tangent = normalize(tangent + flatNormal * wave.g);
+        bitangent = normalize(bitangent + flatNormal * wave.b);
+    }
+
+    gl_Position = projection * view * vec4(worldPos, 1.0);
     TexCoord = aTexCoord;
-    WorldPos = vec3(model * vec4(aPos, 1.0));
-    WorldNormal = normalize(mat3(model) * aNormal);
-    WorldTangent = normalize(mat3(model) * aTangent);
-    WorldBitangent = normalize(mat3(model) * aBitangent);
+    WorldPos = worldPos;
+    WorldNormal = normal;
+    WorldTangent = tangent;
+    WorldBitangent = bitangent;
 }
@@ -57,6 +57,7 @@ uniform float ambientStrength = 0.3;
 const float diffuseStrength = 0.8;
 const float specularStrength = 0.2;
 uniform float shadowBias = 0.005;
+uniform vec4 shadowAtlasRect = vec4(0.0, 0.0, 1.0, 1.0);
 
 vec4 sampleBiomeTexture(int id, vec2 uv) {
     if (id == 0) return texture(texture0, uv);
@@ -115,9 +116,13 @@ float calculateShadow(vec4 fragPosLightSpace, vec3 normal) {
     
     float shadow = 0.0;
     vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+    // The shadow map can hold several cascades; only read from this one.
+    vec2 uv = shadowAtlasRect.xy + projCoords.xy * shadowAtlasRect.zw;
+    vec2 tileMin = shadowAtlasRect.xy + texelSize * 0.5;
+    vec2 tileMax = shadowAtlasRect.xy + shadowAtlasRect.zw - texelSize * 0.5;
     for(int x = -1; x <= 1; ++x) {
         for(int y = -1; y <= 1; ++y) {
-            float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+            float pcfDepth = texture(shadowMap, clamp(uv + vec2(x, y) * texelSize, tileMin, tileMax)).r;
             shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
         }
     }
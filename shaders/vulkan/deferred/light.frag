@@ -113,6 +113,18 @@ layout(set = 4, binding = 3) buffer AreaLights {
     AreaLight areaLights[];
 };
 
+layout(set = 4, binding = 4) buffer LightClusters {
+    uvec4 clusterGrid; // tiles x, tiles y, slices, enabled
+    vec4 clusterDepth; // near, far, slice scale, slice bias
+    vec4 clusterProjection; // tan(fov x / 2), tan(fov y / 2)
+    mat4 clusterView;
+    uvec2 clusterRanges[]; // offset, count
+};
+
+layout(set = 4, binding = 5) buffer LightClusterIndices {
+    uint clusterLightIndices[];
+};
+
 layout(set = 5, binding = 0) buffer ShadowParams {
     ShadowParameters shadowParams[];
 };
@@ -137,6 +149,8 @@ layout(set = 1, binding = 2) uniform AmbientLight {
 } ambientLight;
 
 const float PI = 3.14159265;
+const uint CLUSTER_TYPE_SHIFT = 30u;
+const uint CLUSTER_INDEX_MASK = (1u << CLUSTER_TYPE_SHIFT) - 1u;
 
 vec4 sampleTextureAt(int textureIndex, vec2 uv) {
     if (textureIndex == 0) return texture(texture1, uv);
@@ -200,7 +214,7 @@ vec3 fresnelSchlick(float cosTheta, vec3 F0) {
     return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0);
 }
 
-float calculateShadow(ShadowParameters shadowParam, vec3 fragPos, vec3 normal) {
+float calculateShadowInTile(ShadowParameters shadowParam, vec3 fragPos, vec3 normal, vec4 tile) {
     vec2 dims = getTextureDimensions(shadowParam.textureIndex);
     if (dims.x == 0.0 || dims.y == 0.0) {
         return 0.0; // No valid shadow map bound
@@ -229,10 +243,11 @@ float calculateShadow(ShadowParameters shadowParam, vec3 fragPos, vec3 normal) {
     float bias = max(biasValue * (1.0 - ndotl), minBias);
 
     float shadow = 0.0;
-    vec2 texelSize = 1.0 / dims;
+    // Filter offsets are measured in texels of the tile, not of the map.
+    vec2 texelSize = 1.0 / (dims * tile.zw);
 
     float distance = length(cameraPosition - fragPos);
-    vec2 shadowMapSize = dims;
+    vec2 shadowMapSize = dims * tile.zw;
     float avgDim = 0.5 * (shadowMapSize.x + shadowMapSize.y);
     float resFactor = clamp(1024.0 / max(avgDim, 1.0), 0.75, 1.25);
     float distFactor = clamp(distance / 800.0, 0.0, 1.0);
@@ -247,6 +262,9 @@ float calculateShadow(ShadowParameters shadowParam, vec3 fragPos, vec3 normal) {
         );
     float texelRadius = mix(1.0, 3.0, distFactor) * resFactor;
     vec2 filterRadius = texelSize * texelRadius;
+    // Keep the filter inside the tile so it never reads a neighbouring one.
+    vec2 tileMin = tile.xy + texelSize * tile.zw * 0.5;
+    vec2 tileMax = tile.xy + tile.zw - texelSize * tile.zw * 0.5;
 
     int sampleCount = 0;
     for (int i = 0; i < 12; ++i) {
@@ -255,7 +273,8 @@ float calculateShadow(ShadowParameters shadowParam, vec3 fragPos, vec3 normal) {
         if (uv.x < 0.0 || uv.x > 1.0 || uv.y < 0.0 || uv.y > 1.0) {
             continue;
         }
-        float pcfDepth = sampleTextureAt(shadowParam.textureIndex, uv).r;
+        float pcfDepth = sampleTextureAt(shadowParam.textureIndex,
+                clamp(tile.xy + uv * tile.zw, tileMin, tileMax)).r;
         shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
         sampleCount++;
     }
@@ -266,6 +285,55 @@ float calculateShadow(ShadowParameters shadowParam, vec3 fragPos, vec3 normal) {
     return shadow;
 }
 
+float calculateShadow(ShadowParameters shadowParam, vec3 fragPos, vec3 normal) {
+    return calculateShadowInTile(shadowParam, fragPos, normal, vec4(0.0, 0.0, 1.0, 1.0));
+}
+
+// The cascades of a directional light share one shadow map split into a 2x2
+// grid. The first cascade has lightType 0 and the others follow it with
+// lightType 4; farPlane holds the view depth each cascade ends at and
+// lightPos the camera axis that depth is measured along.
+vec4 cascadeTile(int cascade, int cascadeCount) {
+    if (cascadeCount <= 1) {
+        return vec4(0.0, 0.0, 1.0, 1.0);
+    }
+    return vec4(float(cascade % 2) * 0.5, float(cascade / 2) * 0.5, 0.5, 0.5);
+}
+
+float calculateCascadedShadow(int first, vec3 fragPos, vec3 normal) {
+    int cascadeCount = 1;
+    while (first + cascadeCount < shadowParamCount &&
+            shadowParams[first + cascadeCount].lightType == 4) {
+        cascadeCount++;
+    }
+    if (cascadeCount == 1) {
+        return calculateShadow(shadowParams[first], fragPos, normal);
+    }
+
+    // Use the first cascade that reaches the fragment and fade into the next
+    // one over the last tenth of its slice so the split is not visible.
+    float depth = dot(fragPos - cameraPosition, shadowParams[first].lightPos);
+    float sliceNear = 0.0;
+    for (int c = 0; c < cascadeCount; c++) {
+        ShadowParameters cascade = shadowParams[first + c];
+        if (depth > cascade.farPlane) {
+            sliceNear = cascade.farPlane;
+            continue;
+        }
+        float shadow = calculateShadowInTile(cascade, fragPos, normal,
+                cascadeTile(c, cascadeCount));
+        float blendStart = mix(sliceNear, cascade.farPlane, 0.9);
+        if (c + 1 < cascadeCount && depth > blendStart) {
+            float nextShadow = calculateShadowInTile(shadowParams[first + c + 1],
+                    fragPos, normal, cascadeTile(c + 1, cascadeCount));
+            shadow = mix(shadow, nextShadow,
+                    smoothstep(blendStart, cascade.farPlane, depth));
+        }
+        return shadow;
+    }
+    return 0.0;
+}
+
 float calculatePointShadow(ShadowParameters shadowParam, vec3 fragPos) {
         vec2 dims = getTextureDimensions(shadowParam.textureIndex);
         if (dims.x == 0.0 || dims.y == 0.0) {
@@ -357,6 +425,51 @@ vec3 calcSpotLight(SpotLight light, vec3 fragPos, vec3 N, vec3 V, vec3 F0, vec3
     return evaluateBRDF(direction, radiance, N, V, F0, albedo, metallic, roughness);
 }
 
+vec3 calcAreaLight(AreaLight light, vec3 fragPos, vec3 N, vec3 V, vec3 F0, vec3 albedo, float metallic, float roughness) {
+    vec3 P = light.position;
+    vec3 R = normalize(light.right);
+    vec3 U = normalize(light.up);
+    vec2 halfSize = light.size * 0.5;
+
+    vec3 toPoint = fragPos - P;
+    float s = clamp(dot(toPoint, R), -halfSize.x, halfSize.x);
+    float t = clamp(dot(toPoint, U), -halfSize.y, halfSize.y);
+    vec3 Q = P + R * s + U * t;
+
+    vec3 Lvec = Q - fragPos;
+    float dist = length(Lvec);
+    if (dist <= 0.0001) {
+        return vec3(0.0);
+    }
+    vec3 L = Lvec / dist;
+    vec3 Nl = normalize(cross(R, U));
+    float ndotl = dot(Nl, -L);
+
+    float facing = (light.castsBothSides != 0) ? abs(ndotl) : max(ndotl, 0.0);
+    float cosTheta = cos(radians(light.angle));
+    if (facing < cosTheta || facing <= 0.0) {
+        return vec3(0.0);
+    }
+
+    float range = max(light.range, 0.001);
+    float attenuation = 1.0 / (1.0 + (dist / range) + (dist * dist) / (range * range));
+    float fade = 1.0 - smoothstep(range * 0.9, range, dist);
+    vec3 radiance = light.diffuse * max(light.intensity, 0.0) * attenuation * facing * fade;
+    return evaluateBRDF(L, radiance, N, V, F0, albedo, metallic, roughness);
+}
+
+// Returns the (offset, count) of the cluster holding a world-space position.
+uvec2 findLightCluster(vec3 worldPos) {
+    vec3 viewPos = (clusterView * vec4(worldPos, 1.0)).xyz;
+    float depth = max(-viewPos.z, clusterDepth.x);
+    vec2 ndc = viewPos.xy / (depth * clusterProjection.xy);
+    ivec3 dims = ivec3(clusterGrid.xyz);
+    ivec2 tile = ivec2(floor((ndc * 0.5 + 0.5) * vec2(dims.xy)));
+    int slice = int(floor(log(depth) * clusterDepth.z + clusterDepth.w));
+    ivec3 cell = clamp(ivec3(tile, slice), ivec3(0), dims - 1);
+    return clusterRanges[(cell.z * dims.y + cell.y) * dims.x + cell.x];
+}
+
 vec3 sampleEnvironmentRadiance(vec3 direction) {
     return texture(skybox, direction).rgb;
 }
@@ -434,8 +547,8 @@ void main() {
             spotShadow = max(spotShadow, calculateShadow(shadowParams[i], FragPos, N));
         } else if (shadowParams[i].lightType == 2) {
             areaShadow = max(areaShadow, calculateShadow(shadowParams[i], FragPos, N));
-        } else {
-            directionalShadow = max(directionalShadow, calculateShadow(shadowParams[i], FragPos, N));
+        } else if (shadowParams[i].lightType == 0) {
+            directionalShadow = max(directionalShadow, calculateCascadedShadow(i, FragPos, N));
         }
     }
     directionalShadow = clamp(directionalShadow * 0.85, 0.0, 1.0);
@@ -450,48 +563,36 @@ void main() {
     directionalResult *= (1.0 - directionalShadow);
 
     vec3 pointResult = vec3(0.0);
-    for (int i = 0; i < pointLightCount; ++i) {
-        pointResult += calcPointLight(pointLights[i], FragPos, N, V, F0, albedo, metallic, roughness);
-    }
-    pointResult *= (1.0 - pointShadow);
-
     vec3 spotResult = vec3(0.0);
-    for (int i = 0; i < spotlightCount; ++i) {
-        spotResult += calcSpotLight(spotlights[i], FragPos, N, V, F0, albedo, metallic, roughness);
-    }
-    spotResult *= (1.0 - spotShadow);
-
     vec3 areaResult = vec3(0.0);
-    for (int i = 0; i < areaLightCount; ++i) {
-        vec3 P = areaLights[i].position;
-        vec3 R = normalize(areaLights[i].right);
-        vec3 U = normalize(areaLights[i].up);
-        vec2 halfSize = areaLights[i].size * 0.5;
-
-        vec3 toPoint = FragPos - P;
-        float s = clamp(dot(toPoint, R), -halfSize.x, halfSize.x);
-        float t = clamp(dot(toPoint, U), -halfSize.y, halfSize.y);
-        vec3 Q = P + R * s + U * t;
-
-        vec3 Lvec = Q - FragPos;
-        float dist = length(Lvec);
-        if (dist > 0.0001) {
-            vec3 L = Lvec / dist;
-            vec3 Nl = normalize(cross(R, U));
-            float ndotl = dot(Nl, -L);
-
-            float facing = (areaLights[i].castsBothSides != 0) ? abs(ndotl) : max(ndotl, 0.0);
-            float cosTheta = cos(radians(areaLights[i].angle));
-
-            if (facing >= cosTheta && facing > 0.0) {
-                float range = max(areaLights[i].range, 0.001);
-                float attenuation = 1.0 / (1.0 + (dist / range) + (dist * dist) / (range * range));
-                float fade = 1.0 - smoothstep(range * 0.9, range, dist);
-                vec3 radiance = areaLights[i].diffuse * max(areaLights[i].intensity, 0.0) * attenuation * facing * fade;
-                areaResult += evaluateBRDF(L, radiance, N, V, F0, albedo, metallic, roughness);
+    if (clusterGrid.w != 0u) {
+        // Only visit the lights binned into this pixel's cluster.
+        uvec2 cluster = findLightCluster(FragPos);
+        for (uint i = 0u; i < cluster.y; ++i) {
+            uint entry = clusterLightIndices[cluster.x + i];
+            uint index = entry & CLUSTER_INDEX_MASK;
+            uint type = entry >> CLUSTER_TYPE_SHIFT;
+            if (type == 0u) {
+                pointResult += calcPointLight(pointLights[index], FragPos, N, V, F0, albedo, metallic, roughness);
+            } else if (type == 1u) {
+                spotResult += calcSpotLight(spotlights[index], FragPos, N, V, F0, albedo, metallic, roughness);
+            } else {
+                areaResult += calcAreaLight(areaLights[index], FragPos, N, V, F0, albedo, metallic, roughness);
             }
         }
+    } else {
+        for (int i = 0; i < pointLightCount; ++i) {
+            pointResult += calcPointLight(pointLights[i], FragPos, N, V, F0, albedo, metallic, roughness);
+        }
+        for (int i = 0; i < spotlightCount; ++i) {
+            spotResult += calcSpotLight(spotlights[i], FragPos, N, V, F0, albedo, metallic, roughness);
+        }
+        for (int i = 0; i < areaLightCount; ++i) {
+            areaResult += calcAreaLight(areaLights[i], FragPos, N, V, F0, albedo, metallic, roughness);
+        }
     }
+    pointResult *= (1.0 - pointShadow);
+    spotResult *= (1.0 - spotShadow);
     areaResult *= (1.0 - areaShadow);
 
     vec3 rimResult = getRimLight(FragPos, N, V, F0, albedo, metallic, roughness);
@@ -170,6 +170,33 @@ layout(set = 3, binding = 5) buffer ShadowParametersUBO {
     ShadowParameters shadowParams[];
 };
 
+layout(set = 3, binding = 6) buffer LightClustersUBO {
+    uvec4 clusterGrid; // tiles x, tiles y, slices, enabled
+    vec4 clusterDepth; // near, far, slice scale, slice bias
+    vec4 clusterProjection; // tan(fov x / 2), tan(fov y / 2)
+    mat4 clusterView;
+    uvec2 clusterRanges[]; // offset, count
+};
+
+layout(set = 3, binding = 7) buffer LightClusterIndicesUBO {
+    uint clusterLightIndices[];
+};
+
+const uint CLUSTER_TYPE_SHIFT = 30u;
+const uint CLUSTER_INDEX_MASK = (1u << CLUSTER_TYPE_SHIFT) - 1u;
+
+// ----- Light Clusters -----
+uvec2 findLightCluster(vec3 worldPos) {
+    vec3 viewPos = (clusterView * vec4(worldPos, 1.0)).xyz;
+    float depth = max(-viewPos.z, clusterDepth.x);
+    vec2 ndc = viewPos.xy / (depth * clusterProjection.xy);
+    ivec3 dims = ivec3(clusterGrid.xyz);
+    ivec2 tile = ivec2(floor((ndc * 0.5 + 0.5) * vec2(dims.xy)));
+    int slice = int(floor(log(depth) * clusterDepth.z + clusterDepth.w));
+    ivec3 cell = clamp(ivec3(tile, slice), ivec3(0), dims - 1);
+    return clusterRanges[(cell.z * dims.y + cell.y) * dims.x + cell.x];
+}
+
 // ----- Helper Functions -----
 vec4 enableTextures(int type) {
     vec4 color = vec4(0.0);
@@ -479,71 +506,130 @@ float calcAttenuation(PointLight light, vec3 fragPos) {
     return 1.0 / (light.constant + light.linear * distance + light.quadratic * distance);
 }
 
-vec3 calcAllPointLights(vec3 fragPos, vec3 N, vec3 V, vec3 albedo, float metallic, float roughness, vec3 F0, float reflectivity) {
-    vec3 Lo = vec3(0.0);
-    for (int i = 0; i < pointLightCount; i++) {
-        vec3 L = pointLights[i].position - fragPos;
-        float distance = length(L);
+vec3 calcPointLight(int i, vec3 fragPos, vec3 N, vec3 V, vec3 albedo, float metallic, float roughness, vec3 F0) {
+    vec3 L = pointLights[i].position - fragPos;
+    float distance = length(L);
 
-        distance = max(distance, 0.001);
+    distance = max(distance, 0.001);
 
-        L = normalize(L);
+    L = normalize(L);
 
-        float range = max(pointLights[i].radius, 0.001);
-        vec3 radiance = pointLights[i].diffuse * max(pointLights[i].intensity, 0.0);
-        float attenuation = 1.0 / (1.0 + (distance / range) + (distance * distance) / (range * range));
-        float fade = 1.0 - smoothstep(range * 0.9, range, distance);
-        vec3 radianceAttenuated = radiance * attenuation;
-        radianceAttenuated *= fade;
+    float range = max(pointLights[i].radius, 0.001);
+    vec3 radiance = pointLights[i].diffuse * max(pointLights[i].intensity, 0.0);
+    float attenuation = 1.0 / (1.0 + (distance / range) + (distance * distance) / (range * range));
+    float fade = 1.0 - smoothstep(range * 0.9, range, distance);
+    vec3 radianceAttenuated = radiance * attenuation;
+    radianceAttenuated *= fade;
 
-        vec3 H = normalize(V + L);
+    vec3 H = normalize(V + L);
 
-        float NDF = distributionGGX(N, H, roughness);
-        float G = geometrySmith(N, V, L, roughness);
-        vec3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
+    float NDF = distributionGGX(N, H, roughness);
+    float G = geometrySmith(N, V, L, roughness);
+    vec3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
 
-        vec3 kS = F;
-        vec3 kD = vec3(1.0) - kS;
-        kD *= 1.0 - metallic;
+    vec3 kS = F;
+    vec3 kD = vec3(1.0) - kS;
+    kD *= 1.0 - metallic;
 
-        vec3 numerator = NDF * G * F;
-        float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001;
-        vec3 specular = numerator / denominator;
+    vec3 numerator = NDF * G * F;
+    float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001;
+    vec3 specular = numerator / denominator;
 
-        float NdotL = max(dot(N, L), 0.0);
+    float NdotL = max(dot(N, L), 0.0);
 
-        Lo += (kD * albedo / 3.14159265 + specular) * radianceAttenuated * NdotL;
+    return (kD * albedo / 3.14159265 + specular) * radianceAttenuated * NdotL;
+}
+
+vec3 calcAllPointLights(vec3 fragPos, vec3 N, vec3 V, vec3 albedo, float metallic, float roughness, vec3 F0, float reflectivity) {
+    vec3 Lo = vec3(0.0);
+    for (int i = 0; i < pointLightCount; i++) {
+        Lo += calcPointLight(i, fragPos, N, V, albedo, metallic, roughness, F0);
     }
     return Lo;
 }
 
 // ----- Spot Light -----
+vec3 calcSpotLight(int i, vec3 N, vec3 fragPos, vec3 viewDir, vec3 albedo, float metallic, float roughness, vec3 F0, float reflectivity) {
+    vec3 L = normalize(spotlights[i].position - fragPos);
+
+    vec3 spotDirection = normalize(spotlights[i].direction);
+    float theta = dot(L, -spotDirection);
+    float intensity = smoothstep(spotlights[i].outerCutOff, spotlights[i].cutOff, theta);
+
+    float distance = length(spotlights[i].position - fragPos);
+    distance = max(distance, 0.001);
+    float range = max(spotlights[i].range, 0.001);
+    float attenuation = 1.0 / (1.0 + (distance / range) + (distance * distance) / (range * range));
+    float fade = 1.0 - smoothstep(range * 0.9, range, distance);
+
+    vec3 radiance = spotlights[i].diffuse * max(spotlights[i].intensity, 0.0) * attenuation * intensity * fade;
+
+    return calculatePBR(N, viewDir, L, F0, radiance, albedo, metallic, roughness, reflectivity);
+}
+
 vec3 calcAllSpotLights(vec3 N, vec3 fragPos, vec3 L, vec3 viewDir, vec3 albedo, float metallic, float roughness, vec3 F0, float reflectivity) {
     vec3 Lo = vec3(0.0);
 
     for (int i = 0; i < spotlightCount; i++) {
-        vec3 L = normalize(spotlights[i].position - fragPos);
+        Lo += calcSpotLight(i, N, fragPos, viewDir, albedo, metallic, roughness, F0, reflectivity);
+    }
 
-        vec3 spotDirection = normalize(spotlights[i].direction);
-        float theta = dot(L, -spotDirection);
-        float intensity = smoothstep(spotlights[i].outerCutOff, spotlights[i].cutOff, theta);
+    return Lo;
+}
 
-        float distance = length(spotlights[i].position - fragPos);
-        distance = max(distance, 0.001);
-        float range = max(spotlights[i].range, 0.001);
-        float attenuation = 1.0 / (1.0 + (distance / range) + (distance * distance) / (range * range));
-        float fade = 1.0 - smoothstep(range * 0.9, range, distance);
+// ----- Area Light -----
+vec3 calcAreaLight(int i, vec3 fragPos, vec3 N, vec3 V, vec3 albedo, float metallic, float roughness, vec3 F0) {
+    vec3 P = areaLights[i].position;
+    vec3 R = normalize(areaLights[i].right);
+    vec3 U = normalize(areaLights[i].up);
+    vec2 halfSize = areaLights[i].size * 0.5;
+
+    vec3 toPoint = fragPos - P;
+    float s = clamp(dot(toPoint, R), -halfSize.x, halfSize.x);
+    float t = clamp(dot(toPoint, U), -halfSize.y, halfSize.y);
+    vec3 Q = P + R * s + U * t;
+
+    vec3 Lvec = Q - fragPos;
+    float dist = length(Lvec);
+    if (dist <= 0.0001) {
+        return vec3(0.0);
+    }
+    vec3 L = Lvec / dist;
+    vec3 Nl = normalize(cross(R, U));
+    float ndotl = dot(Nl, -L);
+    float facing = (areaLights[i].castsBothSides != 0) ? abs(ndotl) : max(ndotl, 0.0);
+    float cosTheta = cos(radians(areaLights[i].angle));
+    if (facing < cosTheta || facing <= 0.0) {
+        return vec3(0.0);
+    }
 
-        vec3 radiance = spotlights[i].diffuse * max(spotlights[i].intensity, 0.0) * attenuation * intensity * fade;
+    float range = max(areaLights[i].range, 0.001);
+    float attenuation = 1.0 / (1.0 + (dist / range) + (dist * dist) / (range * range));
+    float fade = 1.0 - smoothstep(range * 0.9, range, dist);
+    vec3 radiance = areaLights[i].diffuse * max(areaLights[i].intensity, 0.0) * attenuation * facing * fade;
+    vec3 H = normalize(V + L);
+    float NDF = distributionGGX(N, H, roughness);
+    float G = geometrySmith(N, V, L, roughness);
+    vec3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
+    vec3 kS = F;
+    vec3 kD = (vec3(1.0) - kS) * (1.0 - metallic);
+    vec3 numerator = NDF * G * F;
+    float denominator = max(4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0), 0.0001);
+    vec3 specular = numerator / denominator;
+    float NdotL = max(dot(N, L), 0.0);
+    return (kD * albedo / PI + specular) * radiance * NdotL;
+}
 
-        Lo += calculatePBR(N, viewDir, L, F0, radiance, albedo, metallic, roughness, reflectivity);
+vec3 calcAllAreaLights(vec3 fragPos, vec3 N, vec3 V, vec3 albedo, float metallic, float roughness, vec3 F0) {
+    vec3 Lo = vec3(0.0);
+    for (int i = 0; i < areaLightCount; ++i) {
+        Lo += calcAreaLight(i, fragPos, N, V, albedo, metallic, roughness, F0);
     }
-
     return Lo;
 }
 
 // ----- Shadow Calculations -----
-float calculateShadow(ShadowParameters shadowParam, vec4 fragPosLightSpace) {
+float calculateShadowInTile(ShadowParameters shadowParam, vec4 fragPosLightSpace, vec4 tile) {
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     // Transform from [-1,1] to [0,1] for texture sampling
     projCoords = projCoords * 0.5 + 0.5;
@@ -566,6 +652,10 @@ float calculateShadow(ShadowParameters shadowParam, vec4 fragPosLightSpace) {
 
     float shadow = 0.0;
     vec2 texelSize = 1.0 / getTextureDimensions(shadowParam.textureIndex);
+    // Keep the filter inside the tile so it never reads a neighbouring one.
+    vec2 uv = tile.xy + projCoords.xy * tile.zw;
+    vec2 tileMin = tile.xy + texelSize * 0.5;
+    vec2 tileMax = tile.xy + tile.zw - texelSize * 0.5;
 
     float distance = length(cameraPosition - FragPos);
     int kernelSize = int(mix(1.0, 3.0, clamp(distance / 100.0, 0.0, 1.0)));
@@ -574,7 +664,7 @@ float calculateShadow(ShadowParameters shadowParam, vec4 fragPosLightSpace) {
     for (int x = -kernelSize; x <= kernelSize; ++x) {
         for (int y = -kernelSize; y <= kernelSize; ++y) {
             float pcfDepth = sampleTextureAt(shadowParam.textureIndex,
-                    projCoords.xy + vec2(x, y) * texelSize).r;
+                    clamp(uv + vec2(x, y) * texelSize, tileMin, tileMax)).r;
             shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
             sampleCount++;
         }
@@ -584,6 +674,62 @@ float calculateShadow(ShadowParameters shadowParam, vec4 fragPosLightSpace) {
     return shadow;
 }
 
+float calculateShadow(ShadowParameters shadowParam, vec4 fragPosLightSpace) {
+    return calculateShadowInTile(shadowParam, fragPosLightSpace, vec4(0.0, 0.0, 1.0, 1.0));
+}
+
+// The cascades of a directional light share one shadow map split into a 2x2
+// grid. The first cascade has lightType 0 and the others follow it with
+// lightType 4; farPlane holds the view depth each cascade ends at and
+// lightPos the camera axis that depth is measured along.
+vec4 cascadeTile(int cascade, int cascadeCount) {
+    if (cascadeCount <= 1) {
+        return vec4(0.0, 0.0, 1.0, 1.0);
+    }
+    return vec4(float(cascade % 2) * 0.5, float(cascade / 2) * 0.5, 0.5, 0.5);
+}
+
+float calculateCascadedShadow(int first, vec3 fragPos) {
+    int cascadeCount = 1;
+    while (first + cascadeCount < shadowParamCount &&
+            shadowParams[first + cascadeCount].lightType == 4) {
+        cascadeCount++;
+    }
+    if (cascadeCount == 1) {
+        vec4 fragPosLightSpace = shadowParams[first].lightProjection *
+                shadowParams[first].lightView * vec4(fragPos, 1.0);
+        return calculateShadow(shadowParams[first], fragPosLightSpace);
+    }
+
+    // Use the first cascade that reaches the fragment and fade into the next
+    // one over the last tenth of its slice so the split is not visible.
+    float depth = dot(fragPos - cameraPosition, shadowParams[first].lightPos);
+    float sliceNear = 0.0;
+    for (int c = 0; c < cascadeCount; c++) {
+        ShadowParameters cascade = shadowParams[first + c];
+        if (depth > cascade.farPlane) {
+            sliceNear = cascade.farPlane;
+            continue;
+        }
+        vec4 fragPosLightSpace = cascade.lightProjection * cascade.lightView *
+                vec4(fragPos, 1.0);
+        float shadow = calculateShadowInTile(cascade, fragPosLightSpace,
+                cascadeTile(c, cascadeCount));
+        float blendStart = mix(sliceNear, cascade.farPlane, 0.9);
+        if (c + 1 < cascadeCount && depth > blendStart) {
+            ShadowParameters next = shadowParams[first + c + 1];
+            vec4 nextLightSpace = next.lightProjection * next.lightView *
+                    vec4(fragPos, 1.0);
+            float nextShadow = calculateShadowInTile(next, nextLightSpace,
+                    cascadeTile(c + 1, cascadeCount));
+            shadow = mix(shadow, nextShadow,
+                    smoothstep(blendStart, cascade.farPlane, depth));
+        }
+        return shadow;
+    }
+    return 0.0;
+}
+
 float calculateShadowRaw(ShadowParameters shadowParam, vec4 fragPosLightSpace) {
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     projCoords = projCoords * 0.5 + 0.5;
@@ -751,10 +897,7 @@ void main() {
     if (shadowParamCount > 0) {
         for (int i = 0; i < shadowParamCount; i++) {
             if (shadowParams[i].lightType == 0) {
-                vec4 fragPosLightSpace = shadowParams[i].lightProjection *
-                        shadowParams[i].lightView *
-                        vec4(FragPos, 1.0);
-                directionalShadow = max(directionalShadow, calculateShadow(shadowParams[i], fragPosLightSpace));
+                directionalShadow = max(directionalShadow, calculateCascadedShadow(i, FragPos));
             } else if (shadowParams[i].lightType == 1) {
                 vec4 fragPosLightSpace = shadowParams[i].lightProjection *
                         shadowParams[i].lightView *
@@ -777,52 +920,34 @@ void main() {
     vec3 lighting = vec3(0.0);
 
     lighting += calcAllDirectionalLights(N, V, albedo, metallic, roughness, F0, reflectivity) * (1.0 - directionalShadow);
-    lighting += calcAllPointLights(FragPos, N, V, albedo, metallic, roughness, F0, reflectivity) * (1.0 - pointShadow);
-    lighting += calcAllSpotLights(N, FragPos, V, viewDir, albedo, metallic, roughness, F0, reflectivity) * (1.0 - spotShadow);
-    lighting += getRimLight(FragPos, N, V, F0, albedo, metallic, roughness);
 
-    {
-        vec3 areaResult = vec3(0.0);
-        for (int i = 0; i < areaLightCount; ++i) {
-            vec3 P = areaLights[i].position;
-            vec3 R = normalize(areaLights[i].right);
-            vec3 U = normalize(areaLights[i].up);
-            vec2 halfSize = areaLights[i].size * 0.5;
-
-            vec3 toPoint = FragPos - P;
-            float s = clamp(dot(toPoint, R), -halfSize.x, halfSize.x);
-            float t = clamp(dot(toPoint, U), -halfSize.y, halfSize.y);
-            vec3 Q = P + R * s + U * t;
-
-            vec3 Lvec = Q - FragPos;
-            float dist = length(Lvec);
-            if (dist > 0.0001) {
-                vec3 L = Lvec / dist;
-                vec3 Nl = normalize(cross(R, U));
-                float ndotl = dot(Nl, -L);
-                float facing = (areaLights[i].castsBothSides != 0) ? abs(ndotl) : max(ndotl, 0.0);
-                float cosTheta = cos(radians(areaLights[i].angle));
-                if (facing >= cosTheta && facing > 0.0) {
-                    float range = max(areaLights[i].range, 0.001);
-                    float attenuation = 1.0 / (1.0 + (dist / range) + (dist * dist) / (range * range));
-                    float fade = 1.0 - smoothstep(range * 0.9, range, dist);
-                    vec3 radiance = areaLights[i].diffuse * max(areaLights[i].intensity, 0.0) * attenuation * facing * fade;
-                    vec3 H = normalize(V + L);
-                    float NDF = distributionGGX(N, H, roughness);
-                    float G = geometrySmith(N, V, L, roughness);
-                    vec3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
-                    vec3 kS = F;
-                    vec3 kD = (vec3(1.0) - kS) * (1.0 - metallic);
-                    vec3 numerator = NDF * G * F;
-                    float denominator = max(4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0), 0.0001);
-                    vec3 specular = numerator / denominator;
-                    float NdotL = max(dot(N, L), 0.0);
-                    areaResult += (kD * albedo / PI + specular) * radiance * NdotL;
-                }
+    vec3 pointResult = vec3(0.0);
+    vec3 spotResult = vec3(0.0);
+    vec3 areaResult = vec3(0.0);
+    if (clusterGrid.w != 0u) {
+        // Only visit the lights binned into this fragment's cluster.
+        uvec2 cluster = findLightCluster(FragPos);
+        for (uint i = 0u; i < cluster.y; i++) {
+            uint entry = clusterLightIndices[cluster.x + i];
+            int index = int(entry & CLUSTER_INDEX_MASK);
+            uint type = entry >> CLUSTER_TYPE_SHIFT;
+            if (type == 0u) {
+                pointResult += calcPointLight(index, FragPos, N, V, albedo, metallic, roughness, F0);
+            } else if (type == 1u) {
+                spotResult += calcSpotLight(index, N, FragPos, viewDir, albedo, metallic, roughness, F0, reflectivity);
+            } else {
+                areaResult += calcAreaLight(index, FragPos, N, V, albedo, metallic, roughness, F0);
             }
         }
-        lighting += areaResult * (1.0 - areaShadow);
+    } else {
+        pointResult = calcAllPointLights(FragPos, N, V, albedo, metallic, roughness, F0, reflectivity);
+        spotResult = calcAllSpotLights(N, FragPos, V, viewDir, albedo, metallic, roughness, F0, reflectivity);
+        areaResult = calcAllAreaLights(FragPos, N, V, albedo, metallic, roughness, F0);
     }
+    lighting += pointResult * (1.0 - pointShadow);
+    lighting += spotResult * (1.0 - spotShadow);
+    lighting += getRimLight(FragPos, N, V, F0, albedo, metallic, roughness);
+    lighting += areaResult * (1.0 - areaShadow);
 
     float aoClamped = clamp(ao, 0.0, 1.0);
     float aoWithFloor = max(aoClamped, 0.2);
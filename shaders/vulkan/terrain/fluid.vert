@@ -9,8 +9,11 @@ layout(set = 0, binding = 0) uniform UBO {
     mat4 model;
     mat4 view;
     mat4 projection;
+    int hasWaveTexture;
 };
 
+layout(set = 2, binding = 6) uniform sampler2D waveTexture;
+
 layout(location = 0) out vec2 TexCoord;
 layout(location = 1) out vec3 WorldPos;
 layout(location = 2) out vec3 WorldNormal;
@@ -18,10 +21,25 @@ layout(location = 3) out vec3 WorldTangent;
 layout(location = 4) out vec3 WorldBitangent;
 
 void main() {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    vec3 worldPos = vec3(model * vec4(aPos, 1.0));
+    vec3 normal = normalize(mat3(model) * aNormal);
+    vec3 tangent = normalize(mat3(model) * aTangent);
+    vec3 bitangent = normalize(mat3(model) * aBitangent);
+
+    if (hasWaveTexture == 1) {
+        // r: height, g/b: slope along the tangent and bitangent.
+        vec4 wave = textureLod(waveTexture, aTexCoord, 0.0);
+        worldPos += normal * wave.r;
+        vec3 flatNormal = normal;
+        normal = normalize(normal - tangent * wave.g - bitangent * wave.b);
+        tangent = normalize(tangent + flatNormal * wave.g);
+        bitangent = normalize(bitangent + flatNormal * wave.b);
+    }
+
+    gl_Position = projection * view * vec4(worldPos, 1.0);
     TexCoord = aTexCoord;
-    WorldPos = vec3(model * vec4(aPos, 1.0));
-    WorldNormal = normalize(mat3(model) * aNormal);
-    WorldTangent = normalize(mat3(model) * aTangent);
-    WorldBitangent = normalize(mat3(model) * aBitangent);
-}
\ No newline at end of file
+    WorldPos = worldPos;
+    WorldNormal = normal;
+    WorldTangent = tangent;
+    WorldBitangent = bitangent;
+}
@@ -38,6 +38,7 @@ layout(push_constant) uniform PushConstants {
     int biomesCount;
     float diffuseStrength;
     float specularStrength;
+    vec4 shadowAtlasRect;
 } ;
 
 layout(set = 1, binding = 0) uniform TerrainParameters {
@@ -119,9 +120,13 @@ float calculateShadow(vec4 fragPosLightSpace, vec3 normal) {
     
     float shadow = 0.0;
     vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+    // The shadow map can hold several cascades; only read from this one.
+    vec2 uv = shadowAtlasRect.xy + projCoords.xy * shadowAtlasRect.zw;
+    vec2 tileMin = shadowAtlasRect.xy + texelSize * 0.5;
+    vec2 tileMax = shadowAtlasRect.xy + shadowAtlasRect.zw - texelSize * 0.5;
     for(int x = -1; x <= 1; ++x) {
         for(int y = -1; y <= 1; ++y) {
-            float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+            float pcfDepth = texture(shadowMap, clamp(uv + vec2(x, y) * texelSize, tileMin, tileMax)).r;
             shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
         }
     }